@@ -184,6 +184,7 @@ MaceStatus MaceEngine::Impl::Init(
                          NetMode::INIT);
     MACE_RETURN_IF_ERROR(net->Run());
     net_ = CreateNet(op_registry_, *net_def, ws_.get(), device_type_);
+    MACE_RETURN_IF_ERROR(net_->Init());
 #ifdef MACE_ENABLE_HEXAGON
   }
 #endif
@@ -24,4 +24,11 @@ void SetKVStorageFactory(std::shared_ptr<KVStorageFactory> storage_factory) {
   kStorageFactory = storage_factory;
 }
 
+bool kKeepUnpackedWeights = true;
+
+void SetKeepUnpackedWeights(bool keep_unpacked_weights) {
+  VLOG(1) << "Keep unpacked weights: " << keep_unpacked_weights;
+  kKeepUnpackedWeights = keep_unpacked_weights;
+}
+
 };  // namespace mace
@@ -57,6 +57,14 @@ SerialNet::SerialNet(const std::shared_ptr<const OperatorRegistry> op_registry,
   }
 }
 
+MaceStatus SerialNet::Init() {
+  MACE_LATENCY_LOGGER(1, "Initializing net");
+  for (auto &op : operators_) {
+    MACE_RETURN_IF_ERROR(op->Init());
+  }
+  return MaceStatus::MACE_SUCCESS;
+}
+
 MaceStatus SerialNet::Run(RunMetadata *run_metadata) {
   MACE_MEMORY_LOGGING_GUARD();
   MACE_LATENCY_LOGGER(1, "Running net");
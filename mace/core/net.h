@@ -36,6 +36,8 @@ class NetBase {
           DeviceType type);
   virtual ~NetBase() noexcept {}
 
+  virtual MaceStatus Init() = 0;
+
   virtual MaceStatus Run(RunMetadata *run_metadata = nullptr) = 0;
 
   const std::string &Name() const { return name_; }
@@ -55,6 +57,8 @@ class SerialNet : public NetBase {
             DeviceType type,
             const NetMode mode = NetMode::NORMAL);
 
+  MaceStatus Init() override;
+
   MaceStatus Run(RunMetadata *run_metadata = nullptr) override;
 
  protected:
@@ -25,6 +25,16 @@ OperatorBase::OperatorBase(const OperatorDef &operator_def, Workspace *ws)
     : operator_ws_(ws),
       operator_def_(std::make_shared<OperatorDef>(operator_def)) {}
 
+Tensor *OperatorBase::InPlacePackableWeight(unsigned int idx) {
+  extern bool kKeepUnpackedWeights;
+  const std::string &name = operator_def_->input(idx);
+  if (kKeepUnpackedWeights || !Input(idx)->is_weight()
+      || operator_ws_->IsSharedWeight(name)) {
+    return nullptr;
+  }
+  return operator_ws_->GetTensor(name);
+}
+
 OpKeyBuilder::OpKeyBuilder(const char *op_name) : op_name_(op_name) {}
 
 OpKeyBuilder &OpKeyBuilder::Device(DeviceType device) {
@@ -89,8 +99,10 @@ extern void Register_DepthToSpace(OperatorRegistry *op_registry);
 extern void Register_DepthwiseConv2d(OperatorRegistry *op_registry);
 extern void Register_Dequantize(OperatorRegistry *op_registry);
 extern void Register_Eltwise(OperatorRegistry *op_registry);
+extern void Register_EmbeddingBag(OperatorRegistry *op_registry);
 extern void Register_FoldedBatchNorm(OperatorRegistry *op_registry);
 extern void Register_FullyConnected(OperatorRegistry *op_registry);
+extern void Register_FusedElementwise(OperatorRegistry *op_registry);
 extern void Register_Gather(OperatorRegistry *op_registry);
 extern void Register_Identity(OperatorRegistry *op_registry);
 extern void Register_LocalResponseNorm(OperatorRegistry *op_registry);
@@ -99,6 +111,7 @@ extern void Register_Pad(OperatorRegistry *op_registry);
 extern void Register_Pooling(OperatorRegistry *op_registry);
 extern void Register_Proposal(OperatorRegistry *op_registry);
 extern void Register_Quantize(OperatorRegistry *op_registry);
+extern void Register_Reduce(OperatorRegistry *op_registry);
 extern void Register_ReduceMean(OperatorRegistry *op_registry);
 extern void Register_Requantize(OperatorRegistry *op_registry);
 extern void Register_Reshape(OperatorRegistry *op_registry);
@@ -111,6 +124,8 @@ extern void Register_StridedSlice(OperatorRegistry *op_registry);
 extern void Register_SpaceToBatchND(OperatorRegistry *op_registry);
 extern void Register_SpaceToDepth(OperatorRegistry *op_registry);
 extern void Register_Squeeze(OperatorRegistry *op_registry);
+extern void Register_TopK(OperatorRegistry *op_registry);
+extern void Register_TransformDataFormat(OperatorRegistry *op_registry);
 extern void Register_Transpose(OperatorRegistry *op_registry);
 extern void Register_WinogradInverseTransform(OperatorRegistry *op_registry);
 extern void Register_WinogradTransform(OperatorRegistry *op_registry);
@@ -138,8 +153,10 @@ OperatorRegistry::OperatorRegistry() {
   ops::Register_DepthwiseConv2d(this);
   ops::Register_Dequantize(this);
   ops::Register_Eltwise(this);
+  ops::Register_EmbeddingBag(this);
   ops::Register_FoldedBatchNorm(this);
   ops::Register_FullyConnected(this);
+  ops::Register_FusedElementwise(this);
   ops::Register_Gather(this);
   ops::Register_Identity(this);
   ops::Register_LocalResponseNorm(this);
@@ -148,6 +165,7 @@ OperatorRegistry::OperatorRegistry() {
   ops::Register_Pooling(this);
   ops::Register_Proposal(this);
   ops::Register_Quantize(this);
+  ops::Register_Reduce(this);
   ops::Register_ReduceMean(this);
   ops::Register_Requantize(this);
   ops::Register_Reshape(this);
@@ -160,6 +178,8 @@ OperatorRegistry::OperatorRegistry() {
   ops::Register_SpaceToBatchND(this);
   ops::Register_SpaceToDepth(this);
   ops::Register_Squeeze(this);
+  ops::Register_TopK(this);
+  ops::Register_TransformDataFormat(this);
   ops::Register_Transpose(this);
   ops::Register_WinogradInverseTransform(this);
   ops::Register_WinogradTransform(this);
@@ -62,6 +62,10 @@ class OperatorBase {
   inline const std::vector<const Tensor *> &Inputs() const { return inputs_; }
   inline const std::vector<Tensor *> &Outputs() { return outputs_; }
 
+  // Called once after the net is constructed and its weights are loaded,
+  // before the first Run, e.g. to repack const weights.
+  virtual MaceStatus Init() { return MaceStatus::MACE_SUCCESS; }
+
   // Run Op asynchronously (depends on device), return a future if not nullptr.
   virtual MaceStatus Run(StatsFuture *future) = 0;
 
@@ -78,6 +82,10 @@ class OperatorBase {
   inline bool has_debug_def() const { return operator_def_ != nullptr; }
 
  protected:
+  // Returns input idx for repacking in place if it is a weight no other op
+  // reads and SetKeepUnpackedWeights(false) was called, nullptr otherwise.
+  Tensor *InPlacePackableWeight(unsigned int idx);
+
   Workspace *operator_ws_;
   std::shared_ptr<const OperatorDef> operator_def_;
   std::vector<const Tensor *> inputs_;
@@ -0,0 +1,156 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/core/runtime/cpu/cpu_features.h"
+
+#ifdef MACE_CPU_X86
+#include <cpuid.h>
+#endif
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "mace/utils/logging.h"
+
+namespace mace {
+
+namespace {
+
+#ifdef MACE_CPU_X86
+uint64_t ReadXCR0() {
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+#endif
+
+CPUFeatures DetectCPUFeatures() {
+  CPUFeatures features = {};
+#ifdef MACE_CPU_X86
+  uint32_t eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return features;
+  }
+  features.sse4_1 = (ecx >> 19) & 1;
+  const bool osxsave = (ecx >> 27) & 1;
+  const bool avx = (ecx >> 28) & 1;
+  const bool fma = (ecx >> 12) & 1;
+  const bool f16c = (ecx >> 29) & 1;
+
+  // The OS has to save the ymm/zmm states on context switch, otherwise
+  // the instructions are usable but the registers get corrupted.
+  const uint64_t xcr0 = osxsave ? ReadXCR0() : 0;
+  const bool os_ymm = (xcr0 & 0x6) == 0x6;
+  const bool os_zmm = os_ymm && (xcr0 & 0xe0) == 0xe0;
+
+  if (!avx || !os_ymm) {
+    return features;
+  }
+  features.fma = fma;
+  features.f16c = f16c;
+  if (__get_cpuid_max(0, nullptr) >= 7) {
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    features.avx2 = (ebx >> 5) & 1;
+    if (os_zmm) {
+      features.avx512f = (ebx >> 16) & 1;
+      features.avx512bw = (ebx >> 30) & 1;
+      features.avx512vl = (ebx >> 31) & 1;
+      features.avx512_vnni = (ecx >> 11) & 1;
+    }
+  }
+#endif
+  return features;
+}
+
+CPUISA DetectCPUISA() {
+  const CPUFeatures &features = GetCPUFeatures();
+  CPUISA isa = CPU_ISA_GENERIC;
+  if (features.sse4_1) {
+    isa = CPU_ISA_SSE41;
+    if (features.avx2 && features.fma && features.f16c) {
+      isa = CPU_ISA_AVX2;
+      if (features.avx512f && features.avx512bw && features.avx512vl) {
+        isa = CPU_ISA_AVX512;
+      }
+    }
+  }
+
+  const char *forced = getenv("MACE_CPU_ISA");
+  if (forced != nullptr && forced[0] != '\0') {
+    CPUISA forced_isa;
+    if (!StringToCPUISA(forced, &forced_isa)) {
+      LOG(WARNING) << "Unknown MACE_CPU_ISA=" << forced << ", use "
+                   << CPUISAToString(isa) << " instead.";
+    } else if (forced_isa > isa) {
+      LOG(WARNING) << "MACE_CPU_ISA=" << forced << " is not supported by this"
+                   << " CPU, use " << CPUISAToString(isa) << " instead.";
+    } else {
+      isa = forced_isa;
+    }
+  }
+  VLOG(1) << "CPU ISA: " << CPUISAToString(isa)
+          << ", sse4_1: " << features.sse4_1
+          << ", avx2: " << features.avx2
+          << ", fma: " << features.fma
+          << ", f16c: " << features.f16c
+          << ", avx512f: " << features.avx512f
+          << ", avx512_vnni: " << features.avx512_vnni;
+  return isa;
+}
+
+}  // namespace
+
+const CPUFeatures &GetCPUFeatures() {
+  static const CPUFeatures features = DetectCPUFeatures();
+  return features;
+}
+
+CPUISA GetCPUISA() {
+  static const CPUISA isa = DetectCPUISA();
+  return isa;
+}
+
+bool StringToCPUISA(const std::string &isa, CPUISA *result) {
+  if (isa == "generic") {
+    *result = CPU_ISA_GENERIC;
+  } else if (isa == "sse4_1") {
+    *result = CPU_ISA_SSE41;
+  } else if (isa == "avx2") {
+    *result = CPU_ISA_AVX2;
+  } else if (isa == "avx512") {
+    *result = CPU_ISA_AVX512;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string CPUISAToString(CPUISA isa) {
+  switch (isa) {
+    case CPU_ISA_GENERIC:
+      return "generic";
+    case CPU_ISA_SSE41:
+      return "sse4_1";
+    case CPU_ISA_AVX2:
+      return "avx2";
+    case CPU_ISA_AVX512:
+      return "avx512";
+    default:
+      LOG(FATAL) << "Unknown CPU ISA: " << static_cast<int>(isa);
+  }
+  return "";
+}
+
+}  // namespace mace
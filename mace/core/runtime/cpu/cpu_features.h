@@ -0,0 +1,62 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_CORE_RUNTIME_CPU_CPU_FEATURES_H_
+#define MACE_CORE_RUNTIME_CPU_CPU_FEATURES_H_
+
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MACE_CPU_X86
+#endif
+
+namespace mace {
+
+// Instruction set levels kernels can be specialized for, ordered so that a
+// higher level implies all the lower ones.
+enum CPUISA {
+  CPU_ISA_GENERIC = 0,
+  CPU_ISA_SSE41 = 1,
+  CPU_ISA_AVX2 = 2,    // AVX2 + FMA + F16C
+  CPU_ISA_AVX512 = 3,  // AVX512F + AVX512BW + AVX512VL
+};
+
+struct CPUFeatures {
+  bool sse4_1;
+  bool avx2;
+  bool fma;
+  bool f16c;
+  bool avx512f;
+  bool avx512bw;
+  bool avx512vl;
+  bool avx512_vnni;
+};
+
+// Detected once per process, always false on non-x86 targets.
+const CPUFeatures &GetCPUFeatures();
+
+// Highest ISA level supported by both the CPU and the OS. The environment
+// variable MACE_CPU_ISA (generic/sse4_1/avx2/avx512) lowers it, e.g. to
+// test the fallback kernels on a machine supporting AVX2. Unknown values
+// are ignored with a warning.
+CPUISA GetCPUISA();
+
+// Returns false and leaves result untouched for an unknown name.
+bool StringToCPUISA(const std::string &isa, CPUISA *result);
+
+std::string CPUISAToString(CPUISA isa);
+
+}  // namespace mace
+
+#endif  // MACE_CORE_RUNTIME_CPU_CPU_FEATURES_H_
@@ -96,7 +96,16 @@ inline std::ostream &operator<<(std::ostream &os, unsigned char c) {
 }
 }  // namespace numerical_chars
 
-enum DataFormat { NHWC = 0, NCHW = 1, HWOI = 2, OIHW = 3, HWIO = 4 };
+enum DataFormat {
+  NHWC = 0,
+  NCHW = 1,
+  HWOI = 2,
+  OIHW = 3,
+  HWIO = 4,
+  // NCHW with channels split into blocks of 4/8: [N, C/c, H, W, c]
+  NCHW4C = 5,
+  NCHW8C = 6
+};
 
 class Tensor {
  public:
@@ -105,18 +114,24 @@ class Tensor {
         dtype_(type),
         buffer_(nullptr),
         is_buffer_owner_(true),
+        is_view_(false),
+        is_weight_(false),
         name_("") {}
 
   Tensor(BufferBase *buffer, DataType dtype)
     : dtype_(dtype),
       buffer_(buffer),
       is_buffer_owner_(false),
+      is_view_(false),
+      is_weight_(false),
       name_("") {}
 
   Tensor(const BufferSlice &buffer_slice, DataType dtype)
       : dtype_(dtype),
         buffer_slice_(buffer_slice),
         is_buffer_owner_(false),
+        is_view_(false),
+        is_weight_(false),
         name_("") {
     buffer_ = &buffer_slice_;
   }
@@ -133,6 +148,18 @@ class Tensor {
 
   inline void SetDtype(DataType dtype) { dtype_ = dtype; }
 
+  // Whether the tensor manages its own buffer, i.e. it is neither a block
+  // preallocated by the memory optimizer nor a const weight of the model.
+  inline bool is_buffer_owner() const { return is_buffer_owner_; }
+
+  // Whether the tensor is a view into another tensor's buffer.
+  inline bool is_view() const { return is_view_; }
+
+  // Whether the tensor is a const weight of the model.
+  inline bool is_weight() const { return is_weight_; }
+
+  inline void SetIsWeight(bool is_weight) { is_weight_ = is_weight; }
+
   inline const std::vector<index_t> &shape() const { return shape_; }
 
   inline index_t dim_size() const { return shape_.size(); }
@@ -208,6 +235,12 @@ class Tensor {
   inline MaceStatus Resize(const std::vector<index_t> &shape) {
     shape_ = shape;
     image_shape_.clear();
+    if (is_view_) {
+      // stop aliasing the other tensor and get a buffer of its own
+      delete buffer_;
+      buffer_ = nullptr;
+      is_view_ = false;
+    }
     if (buffer_ != nullptr) {
       MACE_CHECK(!has_opencl_image(), "Cannot resize image, use ResizeImage.");
       if (raw_size() + MACE_EXTRA_BUFFER_PAD_SIZE > buffer_->size()) {
@@ -231,12 +264,36 @@ class Tensor {
       delete buffer_;
     }
     is_buffer_owner_ = false;
+    is_view_ = false;
     buffer_ = other.buffer_;
     allocator_ = other.allocator_;
     dtype_ = other.dtype_;
     shape_ = other.shape_;
     image_shape_ = other.image_shape_;
   }
+  // Make this tensor a view of other's data from element offset on, with
+  // the given shape. Only buffer owning host tensors can become views, and
+  // other has to outlive the view. A later Resize drops the view.
+  inline void SliceTensorBuffer(const Tensor &other,
+                                const index_t offset,
+                                const std::vector<index_t> &shape) {
+    MACE_CHECK(is_buffer_owner_, "cannot make a view of a shared buffer");
+    MACE_CHECK(!other.has_opencl_image(), "cannot make a view of an image");
+    const index_t byte_offset = offset * other.SizeOfType();
+    BufferSlice *view = new BufferSlice(other.buffer_, byte_offset,
+                                        other.buffer_->size() - byte_offset);
+    if (buffer_ != nullptr) {
+      delete buffer_;
+    }
+    buffer_ = view;
+    is_view_ = true;
+    allocator_ = other.allocator_;
+    dtype_ = other.dtype_;
+    shape_ = shape;
+    image_shape_.clear();
+    MACE_CHECK(raw_size() <= buffer_->size());
+  }
+
 
   inline MaceStatus ResizeImage(const std::vector<index_t> &shape,
                                 const std::vector<size_t> &image_shape) {
@@ -362,6 +419,8 @@ class Tensor {
   BufferBase *buffer_;
   BufferSlice buffer_slice_;
   bool is_buffer_owner_;
+  bool is_view_;
+  bool is_weight_;
   std::string name_;
 
   MACE_DISABLE_COPY_AND_ASSIGN(Tensor);
@@ -119,9 +119,21 @@ MaceStatus Workspace::LoadModelTensor(const NetDef &net_def,
                    const_tensor.data_type()));
 
     tensor->Reshape(dims);
+    tensor->SetIsWeight(true);
     tensor_map_[const_tensor.name()] = std::move(tensor);
   }
 
+  std::map<std::string, int> weight_consumers;
+  for (auto &op : net_def.op()) {
+    for (auto &input : op.input()) {
+      auto iter = tensor_map_.find(input);
+      if (iter != tensor_map_.end() && iter->second->is_weight()
+          && ++weight_consumers[input] > 1) {
+        shared_weights_.insert(input);
+      }
+    }
+  }
+
   if (type == DeviceType::CPU || type == DeviceType::GPU) {
     MaceStatus status = CreateOutputTensorBuffer(net_def, type);
     if (status != MaceStatus::MACE_SUCCESS) return status;
@@ -199,9 +211,28 @@ MaceStatus Workspace::CreateOutputTensorBuffer(const NetDef &net_def,
         } else {
           output_type = dtype;
         }
-        std::unique_ptr<Tensor> tensor
-            (new Tensor(preallocated_allocator_.GetBuffer(mem_ids[i]),
-                        output_type));
+        // the output is a slice of a concat output planned by the memory
+        // optimizer, in units of the output type
+        const int mem_offset =
+            ProtoArgHelper::GetOptionalArg<OperatorDef, int>(
+                op, "mem_offset", -1);
+        std::unique_ptr<Tensor> tensor;
+        if (device_type == DeviceType::CPU && mem_offset >= 0
+            && count == 1 && op.output_shape_size() == 1) {
+          index_t slice_size = GetEnumTypeSize(output_type);
+          for (const int64_t dim : op.output_shape(0).dims()) {
+            slice_size *= dim;
+          }
+          tensor.reset(new Tensor(
+              BufferSlice(preallocated_allocator_.GetBuffer(mem_ids[i]),
+                          mem_offset * GetEnumTypeSize(output_type),
+                          slice_size + MACE_EXTRA_BUFFER_PAD_SIZE),
+              output_type));
+        } else {
+          tensor.reset(
+              new Tensor(preallocated_allocator_.GetBuffer(mem_ids[i]),
+                         output_type));
+        }
         tensor->SetSourceOpName(op.name());
         if (device_type == DeviceType::GPU) {
           VLOG(3) << "Tensor: " << op.name() << "(" << op.type() << ")"
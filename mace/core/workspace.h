@@ -16,6 +16,7 @@
 #define MACE_CORE_WORKSPACE_H_
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <memory>
@@ -53,6 +54,11 @@ class Workspace {
 
   ScratchBuffer *GetScratchBuffer(DeviceType device_type);
 
+  // Whether the weight is read by more than one op of the loaded net.
+  inline bool IsSharedWeight(const std::string &name) const {
+    return shared_weights_.find(name) != shared_weights_.end();
+  }
+
  private:
   MaceStatus CreateOutputTensorBuffer(const NetDef &net_def,
                                       DeviceType device_type);
@@ -61,6 +67,8 @@ class Workspace {
 
   std::unique_ptr<BufferBase> tensor_buffer_;
 
+  std::set<std::string> shared_weights_;
+
   PreallocatedPooledAllocator preallocated_allocator_;
 
   std::unique_ptr<ScratchBuffer> host_scratch_buffer_;
@@ -23,6 +23,7 @@
 #include "mace/core/future.h"
 #include "mace/core/tensor.h"
 #include "mace/core/types.h"
+#include "mace/kernels/vector_math.h"
 
 #ifdef MACE_ENABLE_OPENCL
 #include "mace/core/runtime/opencl/cl2_header.h"
@@ -59,6 +60,9 @@ inline ActivationType StringToActivationType(const std::string type) {
   return ActivationType::NOOP;
 }
 
+// Elements per thread task of the vectorized activations
+const index_t kActivationBlockSize = 4096;
+
 template <typename T>
 void DoActivation(const T *input_ptr,
                   T *output_ptr,
@@ -85,14 +89,16 @@ void DoActivation(const T *input_ptr,
       break;
     case TANH:
 #pragma omp parallel for
-      for (index_t i = 0; i < size; ++i) {
-        output_ptr[i] = std::tanh(input_ptr[i]);
+      for (index_t i = 0; i < size; i += kActivationBlockSize) {
+        VectorTanh(input_ptr + i, std::min(kActivationBlockSize, size - i),
+                   output_ptr + i);
       }
       break;
     case SIGMOID:
 #pragma omp parallel for
-      for (index_t i = 0; i < size; ++i) {
-        output_ptr[i] = 1 / (1 + std::exp(-input_ptr[i]));
+      for (index_t i = 0; i < size; i += kActivationBlockSize) {
+        VectorSigmoid(input_ptr + i, std::min(kActivationBlockSize, size - i),
+                      output_ptr + i);
       }
       break;
     default:
@@ -122,6 +128,36 @@ void PReLUActivation(const T *input_ptr,
   }
 }
 
+// PReLUActivation for the blocked NCHW4C/NCHW8C layout, input is
+// [batch, blocks, inner_size, block] and lane l of block c is channel
+// c * block + l.
+template <typename T>
+void PReLUActivationNCHWc(const T *input_ptr,
+                          const index_t batch,
+                          const index_t blocks,
+                          const index_t inner_size,
+                          const index_t block,
+                          const T *alpha_ptr,
+                          T *output_ptr) {
+#pragma omp parallel for collapse(2)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t c = 0; c < blocks; ++c) {
+      const T *alpha = alpha_ptr + c * block;
+      const index_t offset = (b * blocks + c) * inner_size * block;
+      for (index_t j = 0; j < inner_size; ++j) {
+        for (index_t l = 0; l < block; ++l) {
+          index_t idx = offset + j * block + l;
+          if (input_ptr[idx] < 0) {
+            output_ptr[idx] = input_ptr[idx] * alpha[l];
+          } else {
+            output_ptr[idx] = input_ptr[idx];
+          }
+        }
+      }
+    }
+  }
+}
+
 template <DeviceType D, typename T>
 class ActivationFunctor;
 
@@ -141,6 +177,12 @@ class ActivationFunctor<DeviceType::CPU, float> {
     if (activation_ == PRELU) {
       MACE_CHECK_NOTNULL(alpha);
       const float *alpha_ptr = alpha->data<float>();
+      if (input->dim_size() == 5) {
+        PReLUActivationNCHWc(input_ptr, input->dim(0), input->dim(1),
+                             input->dim(2) * input->dim(3), input->dim(4),
+                             alpha_ptr, output_ptr);
+        return MACE_SUCCESS;
+      }
       const index_t outer_size = output->dim(0);
       const index_t inner_size = output->dim(2) * output->dim(3);
       PReLUActivation(input_ptr, outer_size, input->dim(1), inner_size,
@@ -23,6 +23,7 @@
 
 #include "mace/core/future.h"
 #include "mace/core/tensor.h"
+#include "mace/kernels/top_k.h"
 #include "mace/public/mace.h"
 #include "mace/utils/utils.h"
 
@@ -30,7 +31,10 @@ namespace mace {
 namespace kernels {
 
 template <DeviceType D, typename T>
-struct ArgMaxFunctor {
+struct ArgMaxFunctor;
+
+template <>
+struct ArgMaxFunctor<DeviceType::CPU, float> {
   MaceStatus operator()(const Tensor *input,
                         const Tensor *axis,
                         Tensor *output,
@@ -55,7 +59,7 @@ struct ArgMaxFunctor {
 
     Tensor::MappingGuard input_guard(input);
     Tensor::MappingGuard output_guard(output);
-    auto input_data = input->data<T>();
+    auto input_data = input->data<float>();
     auto output_data = output->mutable_data<int32_t>();
 
     index_t outer_size = output->size();
@@ -63,16 +67,8 @@ struct ArgMaxFunctor {
 
 #pragma omp parallel for
     for (index_t i = 0; i < outer_size; ++i) {
-      int idx = 0;
-      T max_value = std::numeric_limits<T>::lowest();
-      const T *input_ptr = input_data + i * inner_size;
-      for (index_t j = 0; j < inner_size; ++j) {
-        if (input_ptr[j] > max_value) {
-          max_value = input_ptr[j];
-          idx = j;
-        }
-      }
-      output_data[i] = idx;
+      output_data[i] = static_cast<int32_t>(
+          ArgMaxRow(input_data + i * inner_size, inner_size));
     }
 
     return MACE_SUCCESS;
@@ -0,0 +1,169 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+
+#include "mace/kernels/arm/conv_2d_im2col.h"
+#include "mace/kernels/gemm.h"
+#include "mace/utils/utils.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Gemm works on 64x64 blocks, keep tiles a multiple of it.
+const index_t kIm2colTileAlign = 64;
+const index_t kIm2colMaxColSize = 256 * 1024;  // floats
+
+// Gather the input pixels under filter element k for output pixels
+// [pixel_begin, pixel_end) of one image into one row of the column buffer.
+// Pixels falling into the padding are written as zeros, so the input is
+// never padded in memory.
+void Im2colTile(const float *input,
+                const index_t *in_shape,
+                const index_t *out_shape,
+                const index_t *filter_shape,
+                const int *stride_hw,
+                const int *dilation_hw,
+                const int *pad_hw,
+                const index_t pixel_begin,
+                const index_t pixel_end,
+                float *col_buffer) {
+  const index_t in_height = in_shape[2];
+  const index_t in_width = in_shape[3];
+  const index_t out_width = out_shape[3];
+  const index_t filter_h = filter_shape[2];
+  const index_t filter_w = filter_shape[3];
+  const index_t col_size = filter_shape[1] * filter_h * filter_w;
+  const index_t tile_size = pixel_end - pixel_begin;
+  const index_t stride_h = stride_hw[0];
+  const index_t stride_w = stride_hw[1];
+
+#pragma omp parallel for
+  for (index_t k = 0; k < col_size; ++k) {
+    const index_t c = k / (filter_h * filter_w);
+    const index_t kh = (k / filter_w) % filter_h;
+    const index_t kw = k % filter_w;
+    const index_t h_offset = kh * dilation_hw[0] - pad_hw[0];
+    const index_t w_offset = kw * dilation_hw[1] - pad_hw[1];
+    const float *in_base = input + c * in_height * in_width;
+    float *col_ptr = col_buffer + k * tile_size;
+
+    index_t p = pixel_begin;
+    while (p < pixel_end) {
+      const index_t h = p / out_width;
+      const index_t w = p % out_width;
+      const index_t count = std::min(out_width - w, pixel_end - p);
+      const index_t ih = h * stride_h + h_offset;
+      if (ih < 0 || ih >= in_height) {
+        std::fill(col_ptr, col_ptr + count, 0.f);
+        col_ptr += count;
+        p += count;
+        continue;
+      }
+      // pixels [begin, end) of the run read inside the input row
+      const index_t iw = w * stride_w + w_offset;
+      const index_t begin =
+          iw >= 0 ? 0 : std::min(count, RoundUpDiv(-iw, stride_w));
+      const index_t end = std::max(
+          begin, std::min(count, in_width > iw
+                                 ? RoundUpDiv(in_width - iw, stride_w)
+                                 : 0));
+      const float *in_ptr = in_base + ih * in_width + iw;
+      std::fill(col_ptr, col_ptr + begin, 0.f);
+      if (stride_w == 1) {
+        memcpy(col_ptr + begin, in_ptr + begin,
+               (end - begin) * sizeof(float));
+      } else {
+        for (index_t i = begin; i < end; ++i) {
+          col_ptr[i] = in_ptr[i * stride_w];
+        }
+      }
+      std::fill(col_ptr + end, col_ptr + count, 0.f);
+      col_ptr += count;
+      p += count;
+    }
+  }
+}
+
+}  // namespace
+
+index_t Conv2dIm2colTileSize(const index_t *out_shape,
+                             const index_t *filter_shape) {
+  const index_t out_image_size = out_shape[2] * out_shape[3];
+  const index_t col_size = filter_shape[1] * filter_shape[2] * filter_shape[3];
+  const index_t tile_size = std::max<index_t>(
+      kIm2colTileAlign,
+      kIm2colMaxColSize / col_size / kIm2colTileAlign * kIm2colTileAlign);
+  return std::min(tile_size, out_image_size);
+}
+
+void Conv2dIm2col(const float *input,
+                  const float *filter,
+                  const index_t *in_shape,
+                  const index_t *out_shape,
+                  const index_t *filter_shape,
+                  const int *stride_hw,
+                  const int *dilation_hw,
+                  const int *pad_hw,
+                  const index_t tile_size,
+                  float *col_buffer,
+                  float *tile_output,
+                  const Epilogue *epilogue,
+                  float *output) {
+  const index_t batch = in_shape[0];
+  const index_t in_batch_size = in_shape[1] * in_shape[2] * in_shape[3];
+  const index_t out_channels = out_shape[1];
+  const index_t out_image_size = out_shape[2] * out_shape[3];
+  const index_t col_size = filter_shape[1] * filter_shape[2] * filter_shape[3];
+
+  for (index_t b = 0; b < batch; ++b) {
+    const float *in_ptr = input + b * in_batch_size;
+    float *out_ptr = output + b * out_channels * out_image_size;
+    for (index_t p = 0; p < out_image_size; p += tile_size) {
+      const index_t pixel_end = std::min(p + tile_size, out_image_size);
+      const index_t pixel_count = pixel_end - p;
+      Im2colTile(in_ptr, in_shape, out_shape, filter_shape, stride_hw,
+                 dilation_hw, pad_hw, p, pixel_end, col_buffer);
+      // Rows of the tile are pixel_count apart, their residuals are
+      // out_image_size apart.
+      Epilogue tile_epilogue;
+      if (epilogue != nullptr) {
+        tile_epilogue =
+            epilogue->Offset(b * out_channels * out_image_size + p);
+        tile_epilogue.residual_stride = out_image_size;
+      }
+      const Epilogue *tile_epilogue_ptr =
+          epilogue == nullptr ? nullptr : &tile_epilogue;
+      if (pixel_count == out_image_size) {
+        Gemm(filter, col_buffer, 1, out_channels, col_size, pixel_count,
+             out_ptr, false, false, tile_epilogue_ptr);
+        continue;
+      }
+      Gemm(filter, col_buffer, 1, out_channels, col_size, pixel_count,
+           tile_output, false, false, tile_epilogue_ptr);
+#pragma omp parallel for
+      for (index_t m = 0; m < out_channels; ++m) {
+        memcpy(out_ptr + m * out_image_size + p,
+               tile_output + m * pixel_count,
+               pixel_count * sizeof(float));
+      }
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,56 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_ARM_CONV_2D_IM2COL_H_
+#define MACE_KERNELS_ARM_CONV_2D_IM2COL_H_
+
+#include "mace/core/types.h"
+#include "mace/kernels/epilogue.h"
+
+namespace mace {
+namespace kernels {
+
+// Number of output pixels Conv2dIm2col computes at a time. The column buffer
+// (filter_c * filter_h * filter_w x tile_size) stays around 1MB however big
+// the feature map is.
+index_t Conv2dIm2colTileSize(const index_t *out_shape,
+                             const index_t *filter_shape);
+
+// Convolution with arbitrary kernel size, stride and dilation done as
+// filter[out_c, in_c * kh * kw] x column[in_c * kh * kw, tile_size] Gemm
+// for each tile of output pixels. The input is padded virtually, with
+// pad_hw zeros at the top and left and as many as the output needs at the
+// bottom and right. col_buffer needs filter_c * filter_h * filter_w *
+// tile_size floats and tile_output needs out_c * tile_size floats,
+// tile_output is unused if a whole image fits into one tile. The output is
+// overwritten, the epilogue (may be null) is applied to each tile right after
+// it is computed; its residual is laid out like the output.
+void Conv2dIm2col(const float *input,
+                  const float *filter,
+                  const index_t *in_shape,
+                  const index_t *out_shape,
+                  const index_t *filter_shape,
+                  const int *stride_hw,
+                  const int *dilation_hw,
+                  const int *pad_hw,
+                  const index_t tile_size,
+                  float *col_buffer,
+                  float *tile_output,
+                  const Epilogue *epilogue,
+                  float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_ARM_CONV_2D_IM2COL_H_
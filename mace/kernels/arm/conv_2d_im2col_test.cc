@@ -0,0 +1,166 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mace/core/types.h"
+#include "mace/kernels/arm/conv_2d_im2col.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+void TestConv2dIm2col(const index_t batch,
+                      const index_t in_channels,
+                      const index_t out_channels,
+                      const index_t out_height,
+                      const index_t out_width,
+                      const index_t kernel_h,
+                      const index_t kernel_w,
+                      const int stride,
+                      const int dilation,
+                      const index_t tile_size,
+                      const bool fuse_epilogue = false,
+                      const int pad = 0) {
+  const index_t in_height =
+      (out_height - 1) * stride + (kernel_h - 1) * dilation + 1 - 2 * pad;
+  const index_t in_width =
+      (out_width - 1) * stride + (kernel_w - 1) * dilation + 1 - 2 * pad;
+  const index_t in_shape[4] = {batch, in_channels, in_height, in_width};
+  const index_t out_shape[4] = {batch, out_channels, out_height, out_width};
+  const index_t filter_shape[4] = {out_channels, in_channels, kernel_h,
+                                   kernel_w};
+  const int strides[2] = {stride, stride};
+  const int dilations[2] = {dilation, dilation};
+  const int paddings[2] = {pad, pad};
+
+  std::vector<float> input(batch * in_channels * in_height * in_width);
+  std::vector<float> filter(out_channels * in_channels * kernel_h * kernel_w);
+  std::vector<float> output(batch * out_channels * out_height * out_width);
+  std::vector<float> output_ref(output.size(), 0);
+  std::vector<float> col_buffer(in_channels * kernel_h * kernel_w * tile_size);
+  std::vector<float> tile_output(out_channels * tile_size);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+  std::generate(input.begin(), input.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(filter.begin(), filter.end(), [&gen, &nd] { return nd(gen); });
+
+  std::vector<float> bias(out_channels, 0);
+  std::vector<float> residual(output.size(), 0);
+  Epilogue epilogue;
+  if (fuse_epilogue) {
+    std::generate(bias.begin(), bias.end(), [&gen, &nd] { return nd(gen); });
+    std::generate(residual.begin(), residual.end(),
+                  [&gen, &nd] { return nd(gen); });
+    epilogue.bias = bias.data();
+    epilogue.residual = residual.data();
+    epilogue.residual_stride = out_height * out_width;
+    epilogue.activation = RELU;
+  }
+
+  Conv2dIm2col(input.data(), filter.data(), in_shape, out_shape, filter_shape,
+               strides, dilations, paddings, tile_size, col_buffer.data(),
+               tile_output.data(), fuse_epilogue ? &epilogue : nullptr,
+               output.data());
+
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t m = 0; m < out_channels; ++m) {
+      for (index_t h = 0; h < out_height; ++h) {
+        for (index_t w = 0; w < out_width; ++w) {
+          float sum = 0;
+          for (index_t c = 0; c < in_channels; ++c) {
+            for (index_t kh = 0; kh < kernel_h; ++kh) {
+              for (index_t kw = 0; kw < kernel_w; ++kw) {
+                index_t ih = h * stride + kh * dilation - pad;
+                index_t iw = w * stride + kw * dilation - pad;
+                if (ih < 0 || ih >= in_height || iw < 0 || iw >= in_width) {
+                  continue;
+                }
+                sum += input[((b * in_channels + c) * in_height + ih)
+                    * in_width + iw]
+                    * filter[((m * in_channels + c) * kernel_h + kh)
+                        * kernel_w + kw];
+              }
+            }
+          }
+          const index_t idx =
+              ((b * out_channels + m) * out_height + h) * out_width + w;
+          if (fuse_epilogue) {
+            sum = std::max(sum + bias[m] + residual[idx], 0.f);
+          }
+          output_ref[idx] = sum;
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output_ref[i], output[i], 1e-3) << "with index " << i;
+  }
+}
+
+}  // namespace
+
+TEST(Conv2dIm2colTest, WholeImage) {
+  TestConv2dIm2col(1, 3, 5, 7, 9, 3, 3, 1, 1, 7 * 9);
+  TestConv2dIm2col(2, 8, 16, 5, 13, 3, 5, 2, 1, 5 * 13);
+  TestConv2dIm2col(1, 4, 6, 6, 6, 1, 1, 2, 1, 6 * 6);
+}
+
+TEST(Conv2dIm2colTest, Tiled) {
+  // tiles end in the middle of output rows
+  TestConv2dIm2col(1, 3, 5, 7, 9, 3, 3, 1, 1, 10);
+  TestConv2dIm2col(2, 8, 16, 5, 13, 3, 5, 2, 1, 64);
+  TestConv2dIm2col(1, 5, 7, 11, 11, 2, 2, 3, 1, 32);
+}
+
+TEST(Conv2dIm2colTest, Dilation) {
+  TestConv2dIm2col(1, 4, 9, 9, 10, 3, 3, 1, 2, 16);
+  TestConv2dIm2col(2, 6, 4, 6, 7, 3, 3, 2, 4, 6 * 7);
+}
+
+TEST(Conv2dIm2colTest, Epilogue) {
+  TestConv2dIm2col(2, 3, 5, 7, 9, 3, 3, 1, 1, 7 * 9, true);
+  TestConv2dIm2col(2, 8, 16, 5, 13, 3, 5, 2, 1, 64, true);
+  TestConv2dIm2col(2, 4, 70, 9, 10, 3, 3, 1, 2, 16, true);
+  TestConv2dIm2col(2, 6, 4, 1, 1, 3, 3, 2, 1, 1, true);
+}
+
+TEST(Conv2dIm2colTest, Padding) {
+  TestConv2dIm2col(1, 3, 5, 7, 9, 3, 3, 1, 1, 7 * 9, false, 1);
+  TestConv2dIm2col(2, 8, 16, 5, 13, 3, 5, 2, 1, 16, false, 1);
+  TestConv2dIm2col(1, 4, 9, 9, 10, 3, 3, 1, 2, 32, true, 2);
+  // whole rows and runs in the padding
+  TestConv2dIm2col(1, 5, 7, 6, 6, 5, 5, 3, 1, 20, false, 4);
+}
+
+TEST(Conv2dIm2colTest, TileSize) {
+  const index_t out_shape[4] = {1, 64, 100, 100};
+  const index_t filter_shape[4] = {64, 256, 3, 3};
+  index_t tile_size = Conv2dIm2colTileSize(out_shape, filter_shape);
+  EXPECT_EQ(0, tile_size % 64);
+  EXPECT_LE(256 * 3 * 3 * tile_size, 256 * 1024);
+
+  const index_t small_out_shape[4] = {1, 64, 5, 5};
+  EXPECT_EQ(25, Conv2dIm2colTileSize(small_out_shape, filter_shape));
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -16,6 +16,7 @@
 #define MACE_KERNELS_ARM_CONV_2D_NEON_H_
 
 #include "mace/core/types.h"
+#include "mace/kernels/epilogue.h"
 
 namespace mace {
 namespace kernels {
@@ -27,6 +28,7 @@ void Conv2dNeonK1x1S1(const float *input,
                       const index_t width,
                       const index_t in_channels,
                       const index_t out_channels,
+                      const Epilogue *epilogue,
                       float *output);
 
 void Conv2dNeonK3x3S1(const float *input,
@@ -29,11 +29,17 @@ void Conv2dNeonK1x1S1(const float *input,
                       const index_t width,
                       const index_t in_channels,
                       const index_t out_channels,
+                      const Epilogue *epilogue,
                       float *output) {
+  const index_t image_size = height * width;
   for (index_t b = 0; b < batch; ++b) {
-    Gemm(filter, input + b * in_channels * height * width, 1, out_channels,
-         in_channels, height * width,
-         output + b * out_channels * height * width);
+    Epilogue batch_epilogue;
+    if (epilogue != nullptr) {
+      batch_epilogue = epilogue->Offset(b * out_channels * image_size);
+    }
+    Gemm(filter, input + b * in_channels * image_size, 1, out_channels,
+         in_channels, image_size, output + b * out_channels * image_size,
+         false, false, epilogue == nullptr ? nullptr : &batch_epilogue);
   }
 }
 
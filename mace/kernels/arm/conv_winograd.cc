@@ -24,12 +24,91 @@ namespace mace {
 namespace kernels {
 
 namespace {
+// A dilated conv is done as dilation x dilation phases, the outputs of each
+// phase are dilation apart and tiled densely. Returns the first output row
+// (column) of the tile at pos of extent tiled rows (columns), pos and
+// extent being in units of tiled outputs.
+inline index_t TileOrigin(const index_t pos,
+                          const index_t extent,
+                          const int dilation) {
+  const index_t phase_extent = extent / dilation;
+  return pos / phase_extent + pos % phase_extent * dilation;
+}
+
+// Copy the size x size input window at (h, w) with elements dilation_hw
+// apart, which may cross the image border, into tile with zeros outside of
+// the image.
+void LoadTile(const float *input,
+              const index_t in_height,
+              const index_t in_width,
+              const index_t h,
+              const index_t w,
+              const index_t size,
+              const int *dilation_hw,
+              float *tile) {
+  const index_t dilation_h = dilation_hw[0];
+  const index_t dilation_w = dilation_hw[1];
+  // columns [begin, end) of the tile are inside the image
+  const index_t begin =
+      w >= 0 ? 0 : std::min(size, RoundUpDiv(-w, dilation_w));
+  const index_t end = std::max(
+      begin, std::min(size, in_width > w
+                            ? RoundUpDiv(in_width - w, dilation_w)
+                            : 0));
+  for (index_t i = 0; i < size; ++i) {
+    float *tile_row = tile + i * size;
+    const index_t ih = h + i * dilation_h;
+    if (ih < 0 || ih >= in_height) {
+      std::fill(tile_row, tile_row + size, 0.f);
+      continue;
+    }
+    const float *in_row = input + ih * in_width + w;
+    std::fill(tile_row, tile_row + begin, 0.f);
+    if (dilation_w == 1) {
+      std::copy(in_row + begin, in_row + end, tile_row + begin);
+    } else {
+      for (index_t j = begin; j < end; ++j) {
+        tile_row[j] = in_row[j * dilation_w];
+      }
+    }
+    std::fill(tile_row + end, tile_row + size, 0.f);
+  }
+}
+
+// Input window of size x size at (h, w) of one channel, (h, w) may be
+// negative or hang over the bottom right because of padding. Interior
+// windows with contiguous rows are read in place, the others from a zero
+// padded copy in tile.
+inline const float *InputTile(const float *input,
+                              const index_t in_height,
+                              const index_t in_width,
+                              const index_t h,
+                              const index_t w,
+                              const index_t size,
+                              const int *dilation_hw,
+                              float *tile,
+                              index_t *row_stride) {
+  if (dilation_hw[1] == 1 && h >= 0 && w >= 0
+      && h + (size - 1) * dilation_hw[0] < in_height
+      && w + size <= in_width) {
+    *row_stride = dilation_hw[0] * in_width;
+    return input + h * in_width + w;
+  }
+  LoadTile(input, in_height, in_width, h, w, size, dilation_hw, tile);
+  *row_stride = size;
+  return tile;
+}
+
 // NCHW => NTCB (T: in tile pixels, B: tile indices)
 void TransformInput4x4(const float *input,
                        const index_t batch,
                        const index_t in_height,
                        const index_t in_width,
                        const index_t in_channels,
+                       const index_t out_height,
+                       const index_t out_width,
+                       const int *pad_hw,
+                       const int *dilation_hw,
                        const index_t tile_count,
                        float *output) {
   const index_t stride = in_channels * tile_count;
@@ -40,36 +119,44 @@ void TransformInput4x4(const float *input,
 #pragma omp parallel for collapse(2)
   for (index_t n = 0; n < batch; ++n) {
     for (index_t c = 0; c < in_channels; ++c) {
+      const float *in_channel_ptr =
+          input + n * input_batch_size + c * in_height_width;
       index_t tile_index = 0;
-      for (index_t h = 0; h < in_height - 2; h += 2) {
-        for (index_t w = 0; w < in_width - 2; w += 2) {
+      float tile[16];
+      for (index_t th = 0; th < out_height; th += 2) {
+        const index_t h = TileOrigin(th, out_height, dilation_hw[0]);
+        for (index_t tw = 0; tw < out_width; tw += 2) {
+          const index_t w = TileOrigin(tw, out_width, dilation_hw[1]);
           float d0, d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11, d12, d13, d14,
               d15;
           float s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10, s11, s12, s13, s14,
               s15;
 
           // load tile data
-          const float *input_ptr = input + n * input_batch_size +
-                                   c * in_height_width + h * in_width + w;
+          index_t row_stride;
+          const float *input_ptr =
+              InputTile(in_channel_ptr, in_height, in_width, h - pad_hw[0],
+                        w - pad_hw[1], 4, dilation_hw, tile,
+                        &row_stride);
           d0 = input_ptr[0];
           d1 = input_ptr[1];
           d2 = input_ptr[2];
           d3 = input_ptr[3];
 
-          d4 = input_ptr[in_width];
-          d5 = input_ptr[in_width + 1];
-          d6 = input_ptr[in_width + 2];
-          d7 = input_ptr[in_width + 3];
+          d4 = input_ptr[row_stride];
+          d5 = input_ptr[row_stride + 1];
+          d6 = input_ptr[row_stride + 2];
+          d7 = input_ptr[row_stride + 3];
 
-          d8 = input_ptr[2 * in_width];
-          d9 = input_ptr[2 * in_width + 1];
-          d10 = input_ptr[2 * in_width + 2];
-          d11 = input_ptr[2 * in_width + 3];
+          d8 = input_ptr[2 * row_stride];
+          d9 = input_ptr[2 * row_stride + 1];
+          d10 = input_ptr[2 * row_stride + 2];
+          d11 = input_ptr[2 * row_stride + 3];
 
-          d12 = input_ptr[3 * in_width];
-          d13 = input_ptr[3 * in_width + 1];
-          d14 = input_ptr[3 * in_width + 2];
-          d15 = input_ptr[3 * in_width + 3];
+          d12 = input_ptr[3 * row_stride];
+          d13 = input_ptr[3 * row_stride + 1];
+          d14 = input_ptr[3 * row_stride + 2];
+          d15 = input_ptr[3 * row_stride + 3];
 
           // s = BT * d * B
           s0 = (d0 - d8) - (d2 - d10);
@@ -143,6 +230,10 @@ void TransformInput4x4(const float *input,
  * @param in_height
  * @param in_width
  * @param in_channels
+ * @param out_height
+ * @param out_width
+ * @param pad_hw
+ * @param dilation_hw
  * @param tile_count
  * @param output
  */
@@ -151,6 +242,10 @@ void TransformInput8x8(const float *input,
                        const index_t in_height,
                        const index_t in_width,
                        const index_t in_channels,
+                       const index_t out_height,
+                       const index_t out_width,
+                       const int *pad_hw,
+                       const int *dilation_hw,
                        const index_t tile_count,
                        float *output) {
   const index_t stride = in_channels * tile_count;
@@ -161,12 +256,20 @@ void TransformInput8x8(const float *input,
 #pragma omp parallel for collapse(2)
   for (index_t n = 0; n < batch; ++n) {
     for (index_t c = 0; c < in_channels; ++c) {
+      const float *in_channel_ptr =
+          input + n * input_batch_size + c * in_height_width;
       index_t tile_index = 0;
       float s[8][8];
-      for (index_t h = 0; h < in_height - 2; h += 6) {
-        for (index_t w = 0; w < in_width - 2; w += 6) {
-          const float *input_ptr = input + n * input_batch_size +
-                                   c * in_height_width + h * in_width + w;
+      float tile[64];
+      for (index_t th = 0; th < out_height; th += 6) {
+        const index_t h = TileOrigin(th, out_height, dilation_hw[0]);
+        for (index_t tw = 0; tw < out_width; tw += 6) {
+          const index_t w = TileOrigin(tw, out_width, dilation_hw[1]);
+          index_t row_stride;
+          const float *input_ptr =
+              InputTile(in_channel_ptr, in_height, in_width, h - pad_hw[0],
+                        w - pad_hw[1], 8, dilation_hw, tile,
+                        &row_stride);
 
           for (int i = 0; i < 8; ++i) {
             float d0, d1, d2, d3, d4, d5, d6, d7;
@@ -197,7 +300,7 @@ void TransformInput8x8(const float *input,
             s[i][5] = u + v;
             s[i][6] = u - v;
 
-            input_ptr += in_width;
+            input_ptr += row_stride;
           }
 
           float *output_ptr =
@@ -280,9 +383,12 @@ void TransformOutput4x4(const float *input,
                         index_t out_height,
                         index_t out_width,
                         index_t out_channels,
+                        const int *dilation_hw,
                         index_t tile_count,
                         float *output) {
   const index_t stride = out_channels * tile_count;
+  const index_t row_step = dilation_hw[0] * out_width;
+  const index_t col_step = dilation_hw[1];
   const index_t input_batch_size = 16 * stride;
   const index_t out_image_size = out_height * out_width;
   const index_t output_batch_size = out_channels * out_image_size;
@@ -291,8 +397,10 @@ void TransformOutput4x4(const float *input,
   for (index_t n = 0; n < batch; ++n) {
     for (index_t m = 0; m < out_channels; ++m) {
       index_t tile_offset = 0;
-      for (index_t h = 0; h < out_height; h += 2) {
-        for (index_t w = 0; w < out_width; w += 2) {
+      for (index_t th = 0; th < out_height; th += 2) {
+        const index_t h = TileOrigin(th, out_height, dilation_hw[0]);
+        for (index_t tw = 0; tw < out_width; tw += 2) {
+          const index_t w = TileOrigin(tw, out_width, dilation_hw[1]);
           float d0, d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11, d12, d13, d14,
               d15;
           float s0, s1, s2, s3, s4, s5, s6, s7;
@@ -337,9 +445,9 @@ void TransformOutput4x4(const float *input,
           float *output_ptr = output + n * output_batch_size +
                               m * out_image_size + h * out_width + w;
           output_ptr[0] = v0;
-          output_ptr[1] = v1;
-          output_ptr[out_width] = v2;
-          output_ptr[out_width + 1] = v3;
+          output_ptr[col_step] = v1;
+          output_ptr[row_step] = v2;
+          output_ptr[row_step + col_step] = v3;
 
           ++tile_offset;
         }
@@ -368,6 +476,7 @@ void TransformOutput4x4(const float *input,
  * @param out_height
  * @param out_width
  * @param out_channels
+ * @param dilation_hw
  * @param tile_count
  * @param output
  */
@@ -376,9 +485,12 @@ void TransformOutput8x8(const float *input,
                         index_t out_height,
                         index_t out_width,
                         index_t out_channels,
+                        const int *dilation_hw,
                         index_t tile_count,
                         float *output) {
   const index_t stride = out_channels * tile_count;
+  const index_t row_step = dilation_hw[0] * out_width;
+  const index_t col_step = dilation_hw[1];
   const index_t input_batch_size = 64 * stride;
   const index_t out_image_size = out_height * out_width;
   const index_t output_batch_size = out_channels * out_image_size;
@@ -388,8 +500,10 @@ void TransformOutput8x8(const float *input,
     for (index_t m = 0; m < out_channels; ++m) {
       index_t tile_offset = 0;
       float s[8][6];
-      for (index_t h = 0; h < out_height; h += 6) {
-        for (index_t w = 0; w < out_width; w += 6) {
+      for (index_t th = 0; th < out_height; th += 6) {
+        const index_t h = TileOrigin(th, out_height, dilation_hw[0]);
+        for (index_t tw = 0; tw < out_width; tw += 6) {
+          const index_t w = TileOrigin(tw, out_width, dilation_hw[1]);
           const float *input_ptr =
               input + n * input_batch_size + m * tile_count + tile_offset;
           for (int i = 0; i < 8; ++i) {
@@ -442,12 +556,13 @@ void TransformOutput8x8(const float *input,
             float y = d5 + d6;
             float z = d5 - d6;
 
-            output_ptr[i] = d0 + u + w + y * 32;
-            output_ptr[1 * out_width + i] = v + x + x + z * 16;
-            output_ptr[2 * out_width + i] = u + w * 4 + y * 8;
-            output_ptr[3 * out_width + i] = v + x * 8 + z * 4;
-            output_ptr[4 * out_width + i] = u + w * 16 + y + y;
-            output_ptr[5 * out_width + i] = v + x * 32 + z + d7;
+            float *out_col = output_ptr + i * col_step;
+            out_col[0] = d0 + u + w + y * 32;
+            out_col[1 * row_step] = v + x + x + z * 16;
+            out_col[2 * row_step] = u + w * 4 + y * 8;
+            out_col[3 * row_step] = v + x * 8 + z * 4;
+            out_col[4 * row_step] = u + w * 16 + y + y;
+            out_col[5 * row_step] = v + x * 32 + z + d7;
           }
 
           ++tile_offset;
@@ -610,12 +725,14 @@ void WinoGradConv3x3s1(const float *input,
                        const index_t in_width,
                        const index_t in_channels,
                        const index_t out_channels,
+                       const index_t out_height,
+                       const index_t out_width,
+                       const int *pad_hw,
+                       const int *dilation_hw,
                        const int out_tile_size,
                        float *transformed_input,
                        float *transformed_output,
                        float *output) {
-  index_t out_height = in_height - 2;
-  index_t out_width = in_width - 2;
   index_t tile_height_count =
       RoundUpDiv(out_height, static_cast<index_t>(out_tile_size));
   index_t tile_width_count =
@@ -625,10 +742,12 @@ void WinoGradConv3x3s1(const float *input,
   switch (out_tile_size) {
     case 2:
       TransformInput4x4(input, batch, in_height, in_width, in_channels,
+                        out_height, out_width, pad_hw, dilation_hw,
                         tile_count, transformed_input);
       break;
     case 6:
       TransformInput8x8(input, batch, in_height, in_width, in_channels,
+                        out_height, out_width, pad_hw, dilation_hw,
                         tile_count, transformed_input);
       break;
     default:
@@ -641,11 +760,11 @@ void WinoGradConv3x3s1(const float *input,
   switch (out_tile_size) {
     case 2:
       TransformOutput4x4(transformed_output, batch, out_height, out_width,
-                         out_channels, tile_count, output);
+                         out_channels, dilation_hw, tile_count, output);
       break;
     case 6:
       TransformOutput8x8(transformed_output, batch, out_height, out_width,
-                         out_channels, tile_count, output);
+                         out_channels, dilation_hw, tile_count, output);
       break;
     default:
       MACE_NOT_IMPLEMENTED;
@@ -690,8 +809,11 @@ void WinoGradConv3x3s1(const float *input,
       MACE_NOT_IMPLEMENTED;
   }
 
+  const int pad_hw[2] = {0, 0};
+  const int dilation_hw[2] = {1, 1};
   WinoGradConv3x3s1(input, transformed_filter, batch, in_height, in_width,
-                    in_channels, out_channels, out_tile_size, transformed_input,
+                    in_channels, out_channels, out_height, out_width, pad_hw,
+                    dilation_hw, out_tile_size, transformed_input,
                     transformed_output, output);
 
   delete[] transformed_input;
@@ -44,6 +44,11 @@ void WinoGradConv3x3s1(const float *input,
                        const int out_tile_size,
                        float *output);
 
+// in_height x in_width input padded with zeros by pad_hw at the top and
+// left, and as far as the output needs at the bottom and right. With
+// dilation, each of the dilation_h x dilation_w phases of the output is
+// tiled on its own, so out_height (out_width) must be a multiple of
+// out_tile_size * dilation_h (dilation_w).
 void WinoGradConv3x3s1(const float *input,
                        const float *transformed_filter,
                        const index_t batch,
@@ -51,6 +56,10 @@ void WinoGradConv3x3s1(const float *input,
                        const index_t in_width,
                        const index_t in_channels,
                        const index_t out_channels,
+                       const index_t out_height,
+                       const index_t out_width,
+                       const int *pad_hw,
+                       const int *dilation_hw,
                        const int out_tile_size,
                        float *transformed_input,
                        float *transformed_output,
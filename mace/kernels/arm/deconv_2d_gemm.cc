@@ -0,0 +1,338 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+#include <algorithm>
+#include <cstring>
+
+#include "mace/kernels/arm/deconv_2d_gemm.h"
+#include "mace/kernels/gemm.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/x86/deconv_2d_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Gemm works on 64x64 blocks, keep tiles at least that wide.
+const index_t kDeconvTileMinPixels = 64;
+const index_t kDeconvMaxColSize = 256 * 1024;  // floats
+
+typedef void (*Deconv2dS2RowFunc)(const float *col,
+                                  const index_t col_stride,
+                                  const index_t count,
+                                  float *output);
+
+// Divisions rounding towards -inf/+inf for a positive divisor.
+inline index_t FloorDiv(const index_t a, const index_t b) {
+  return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+inline index_t CeilDiv(const index_t a, const index_t b) {
+  return -FloorDiv(-a, b);
+}
+
+// Scatter-adds the columns of input rows [ih_begin, ih_begin + rows) into
+// the output of one image for any filter size and stride.
+void Col2imTile(const float *col_buffer,
+                const index_t ih_begin,
+                const index_t rows,
+                const index_t *in_shape,
+                const index_t *out_shape,
+                const index_t *filter_shape,
+                const int *strides,
+                const index_t *offset_hw,
+                float *output) {
+  const index_t in_width = in_shape[3];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+  const index_t filter_h = filter_shape[2];
+  const index_t filter_w = filter_shape[3];
+  const index_t tile_pixels = rows * in_width;
+  const int stride_h = strides[0];
+  const int stride_w = strides[1];
+
+#pragma omp parallel for
+  for (index_t m = 0; m < out_shape[1]; ++m) {
+    float *out_base = output + m * out_height * out_width;
+    for (index_t kh = 0; kh < filter_h; ++kh) {
+      for (index_t kw = 0; kw < filter_w; ++kw) {
+        const float *col_ptr =
+            col_buffer + ((m * filter_h + kh) * filter_w + kw) * tile_pixels;
+        // ow = iw * stride_w + kw - offset_w must be in [0, out_width)
+        const index_t iw_begin =
+            std::max<index_t>(0, CeilDiv(offset_hw[1] - kw, stride_w));
+        const index_t iw_end = std::min<index_t>(
+            in_width,
+            FloorDiv(out_width - 1 + offset_hw[1] - kw, stride_w) + 1);
+        for (index_t r = 0; r < rows; ++r) {
+          const index_t oh = (ih_begin + r) * stride_h + kh - offset_hw[0];
+          if (oh < 0 || oh >= out_height) continue;
+          const float *in_row = col_ptr + r * in_width;
+          float *out_row = out_base + oh * out_width + kw - offset_hw[1];
+          if (stride_w == 1) {
+            for (index_t iw = iw_begin; iw < iw_end; ++iw) {
+              out_row[iw] += in_row[iw];
+            }
+          } else {
+            for (index_t iw = iw_begin; iw < iw_end; ++iw) {
+              out_row[iw * stride_w] += in_row[iw];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// One output row of a stride 2 KxK (K = 2 or 4) filter for one filter row:
+// output[2 * j + r - offset_w] += sum over t of col[r + 2t][j - t]. The
+// border pixels, whose taps partly fall outside the input or the output,
+// are done one by one, the rest by the vectorized row_func.
+template <int K>
+void Deconv2dS2Row(const float *col,
+                   const index_t col_stride,
+                   const index_t in_width,
+                   const index_t out_width,
+                   const index_t offset_w,
+                   const Deconv2dS2RowFunc row_func,
+                   float *output) {
+  const index_t half_k = K / 2;
+  const index_t j_count = in_width + half_k - 1;
+  const index_t j_begin =
+      std::min(j_count, std::max(half_k - 1, CeilDiv(offset_w, 2)));
+  const index_t j_end = std::max(
+      j_begin,
+      std::min(in_width, FloorDiv(out_width - 2 + offset_w, 2) + 1));
+
+  auto border = [=](const index_t j) {
+    for (index_t r = 0; r < 2; ++r) {
+      const index_t ow = 2 * j + r - offset_w;
+      if (ow < 0 || ow >= out_width) continue;
+      float sum = 0;
+      for (index_t t = 0; t < half_k; ++t) {
+        if (j - t >= 0 && j - t < in_width) {
+          sum += col[(r + 2 * t) * col_stride + j - t];
+        }
+      }
+      output[ow] += sum;
+    }
+  };
+
+  for (index_t j = 0; j < j_begin; ++j) {
+    border(j);
+  }
+  if (j_end > j_begin) {
+    row_func(col + j_begin, col_stride, j_end - j_begin,
+             output + 2 * j_begin - offset_w);
+  }
+  for (index_t j = j_end; j < j_count; ++j) {
+    border(j);
+  }
+}
+
+template <int K>
+void Deconv2dS2Tile(const float *col_buffer,
+                    const index_t ih_begin,
+                    const index_t rows,
+                    const index_t *in_shape,
+                    const index_t *out_shape,
+                    const index_t *offset_hw,
+                    const Deconv2dS2RowFunc row_func,
+                    float *output) {
+  const index_t in_width = in_shape[3];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+  const index_t tile_pixels = rows * in_width;
+
+#pragma omp parallel for
+  for (index_t m = 0; m < out_shape[1]; ++m) {
+    float *out_base = output + m * out_height * out_width;
+    for (index_t r = 0; r < rows; ++r) {
+      for (index_t kh = 0; kh < K; ++kh) {
+        const index_t oh = (ih_begin + r) * 2 + kh - offset_hw[0];
+        if (oh < 0 || oh >= out_height) continue;
+        const float *col_ptr =
+            col_buffer + (m * K + kh) * K * tile_pixels + r * in_width;
+        Deconv2dS2Row<K>(col_ptr, tile_pixels, in_width, out_width,
+                         offset_hw[1], row_func, out_base + oh * out_width);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+index_t Deconv2dGemmTileRows(const index_t *in_shape,
+                             const index_t *filter_shape) {
+  const index_t in_height = in_shape[2];
+  const index_t in_width = in_shape[3];
+  const index_t col_size = filter_shape[0] * filter_shape[2] * filter_shape[3];
+  const index_t tile_pixels =
+      std::max(kDeconvTileMinPixels, kDeconvMaxColSize / col_size);
+  return std::min(in_height, std::max<index_t>(1, tile_pixels / in_width));
+}
+
+void Deconv2dPackFilter(const float *filter,
+                        const index_t *filter_shape,
+                        float *packed_filter) {
+  const index_t out_channels = filter_shape[0];
+  const index_t in_channels = filter_shape[1];
+  const index_t filter_size = filter_shape[2] * filter_shape[3];
+
+#pragma omp parallel for
+  for (index_t m = 0; m < out_channels; ++m) {
+    for (index_t c = 0; c < in_channels; ++c) {
+      const float *in_ptr = filter + (m * in_channels + c) * filter_size;
+      float *out_ptr = packed_filter + m * filter_size * in_channels + c;
+      for (index_t k = 0; k < filter_size; ++k) {
+        out_ptr[k * in_channels] = in_ptr[k];
+      }
+    }
+  }
+}
+
+void Deconv2dGemm(const float *input,
+                  const float *packed_filter,
+                  const float *bias,
+                  const index_t *in_shape,
+                  const index_t *out_shape,
+                  const index_t *filter_shape,
+                  const int *strides,
+                  const int *padding,
+                  const index_t tile_rows,
+                  float *col_buffer,
+                  float *tile_input,
+                  float *output) {
+  const index_t batch = in_shape[0];
+  const index_t in_channels = in_shape[1];
+  const index_t in_height = in_shape[2];
+  const index_t in_width = in_shape[3];
+  const index_t in_image_size = in_height * in_width;
+  const index_t out_channels = out_shape[1];
+  const index_t out_image_size = out_shape[2] * out_shape[3];
+  const index_t filter_h = filter_shape[2];
+  const index_t filter_w = filter_shape[3];
+  const index_t col_rows = out_channels * filter_h * filter_w;
+  // output pixel = input pixel * stride + filter pixel - offset
+  const index_t offset_hw[2] = {filter_h - 1 - padding[0],
+                                filter_w - 1 - padding[1]};
+
+  Deconv2dS2RowFunc row_func = nullptr;
+  if (strides[0] == 2 && strides[1] == 2 && filter_h == filter_w) {
+    if (filter_h == 2) {
+      static const Deconv2dS2RowFunc k2_func =
+          KernelDispatcher<Deconv2dS2RowFunc>(Deconv2dNeonS2K2Row)
+              .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(Deconv2dAvx2S2K2Row))
+              .Select();
+      row_func = k2_func;
+    } else if (filter_h == 4) {
+      static const Deconv2dS2RowFunc k4_func =
+          KernelDispatcher<Deconv2dS2RowFunc>(Deconv2dNeonS2K4Row)
+              .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(Deconv2dAvx2S2K4Row))
+              .Select();
+      row_func = k4_func;
+    }
+  }
+
+  for (index_t b = 0; b < batch; ++b) {
+    const float *in_ptr = input + b * in_channels * in_image_size;
+    float *out_ptr = output + b * out_channels * out_image_size;
+#pragma omp parallel for
+    for (index_t m = 0; m < out_channels; ++m) {
+      std::fill_n(out_ptr + m * out_image_size, out_image_size,
+                  bias == nullptr ? 0.f : bias[m]);
+    }
+
+    for (index_t h = 0; h < in_height; h += tile_rows) {
+      const index_t rows = std::min(tile_rows, in_height - h);
+      const index_t tile_pixels = rows * in_width;
+      const float *tile_ptr = in_ptr;
+      if (rows != in_height) {
+#pragma omp parallel for
+        for (index_t c = 0; c < in_channels; ++c) {
+          memcpy(tile_input + c * tile_pixels,
+                 in_ptr + c * in_image_size + h * in_width,
+                 tile_pixels * sizeof(float));
+        }
+        tile_ptr = tile_input;
+      }
+      Gemm(packed_filter, tile_ptr, 1, col_rows, in_channels, tile_pixels,
+           col_buffer);
+
+      if (row_func != nullptr && filter_h == 2) {
+        Deconv2dS2Tile<2>(col_buffer, h, rows, in_shape, out_shape, offset_hw,
+                          row_func, out_ptr);
+      } else if (row_func != nullptr) {
+        Deconv2dS2Tile<4>(col_buffer, h, rows, in_shape, out_shape, offset_hw,
+                          row_func, out_ptr);
+      } else {
+        Col2imTile(col_buffer, h, rows, in_shape, out_shape, filter_shape,
+                   strides, offset_hw, out_ptr);
+      }
+    }
+  }
+}
+
+void Deconv2dNeonS2K2Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output) {
+  const float *col0 = col;
+  const float *col1 = col + col_stride;
+  index_t j = 0;
+#if defined(MACE_ENABLE_NEON)
+  for (; j + 4 <= count; j += 4) {
+    float32x4x2_t v = vzipq_f32(vld1q_f32(col0 + j), vld1q_f32(col1 + j));
+    float *out_ptr = output + 2 * j;
+    vst1q_f32(out_ptr, vaddq_f32(vld1q_f32(out_ptr), v.val[0]));
+    vst1q_f32(out_ptr + 4, vaddq_f32(vld1q_f32(out_ptr + 4), v.val[1]));
+  }
+#endif
+  for (; j < count; ++j) {
+    output[2 * j] += col0[j];
+    output[2 * j + 1] += col1[j];
+  }
+}
+
+void Deconv2dNeonS2K4Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output) {
+  const float *col0 = col;
+  const float *col1 = col + col_stride;
+  const float *col2 = col + 2 * col_stride - 1;
+  const float *col3 = col + 3 * col_stride - 1;
+  index_t j = 0;
+#if defined(MACE_ENABLE_NEON)
+  for (; j + 4 <= count; j += 4) {
+    float32x4_t even = vaddq_f32(vld1q_f32(col0 + j), vld1q_f32(col2 + j));
+    float32x4_t odd = vaddq_f32(vld1q_f32(col1 + j), vld1q_f32(col3 + j));
+    float32x4x2_t v = vzipq_f32(even, odd);
+    float *out_ptr = output + 2 * j;
+    vst1q_f32(out_ptr, vaddq_f32(vld1q_f32(out_ptr), v.val[0]));
+    vst1q_f32(out_ptr + 4, vaddq_f32(vld1q_f32(out_ptr + 4), v.val[1]));
+  }
+#endif
+  for (; j < count; ++j) {
+    output[2 * j] += col0[j] + col2[j];
+    output[2 * j + 1] += col1[j] + col3[j];
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
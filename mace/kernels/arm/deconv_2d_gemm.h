@@ -0,0 +1,78 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_ARM_DECONV_2D_GEMM_H_
+#define MACE_KERNELS_ARM_DECONV_2D_GEMM_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// Number of input rows Deconv2dGemm multiplies at a time. The column buffer
+// (out_c * filter_h * filter_w x tile_rows * in_width) stays around 1MB
+// however big the feature map is.
+index_t Deconv2dGemmTileRows(const index_t *in_shape,
+                             const index_t *filter_shape);
+
+// Reorders an OIHW filter into the [out_c * filter_h * filter_w, in_c]
+// matrix Deconv2dGemm multiplies the input by.
+void Deconv2dPackFilter(const float *filter,
+                        const index_t *filter_shape,
+                        float *packed_filter);
+
+// Transposed convolution done as packed_filter x input[in_c, pixels] Gemm
+// for each tile of input rows, whose columns are then scatter-added into
+// the output (col2im): input pixel (ih, iw) times filter element (kh, kw)
+// lands on output pixel (ih * stride_h + kh - filter_h + 1 + padding[0],
+// iw * stride_w + kw - filter_w + 1 + padding[1]), and is dropped if that
+// falls outside the output. Stride 2 with 2x2 or 4x4 filters scatters two
+// output pixels at a time with a vectorized kernel.
+// col_buffer needs out_c * filter_h * filter_w * tile_rows * in_width
+// floats and tile_input needs in_c * tile_rows * in_width floats,
+// tile_input is unused if a whole image fits into one tile. The output is
+// overwritten with the bias (may be null) plus the scattered products.
+void Deconv2dGemm(const float *input,
+                  const float *packed_filter,
+                  const float *bias,
+                  const index_t *in_shape,
+                  const index_t *out_shape,
+                  const index_t *filter_shape,
+                  const int *strides,
+                  const int *padding,
+                  const index_t tile_rows,
+                  float *col_buffer,
+                  float *tile_input,
+                  float *output);
+
+// output[2 * j + r] += col[r * col_stride + j] for j in [0, count) and
+// r in {0, 1}, i.e. one output row of a stride 2 2x2 filter.
+void Deconv2dNeonS2K2Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output);
+
+// output[2 * j + r] += col[r * col_stride + j]
+//                      + col[(r + 2) * col_stride + j - 1]
+// for j in [0, count) and r in {0, 1}, i.e. one output row of a stride 2
+// 4x4 filter away from the borders.
+void Deconv2dNeonS2K4Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_ARM_DECONV_2D_GEMM_H_
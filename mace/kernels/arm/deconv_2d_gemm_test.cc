@@ -0,0 +1,115 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mace/kernels/arm/deconv_2d_gemm.h"
+#include "mace/kernels/deconv_2d.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Compares Deconv2dGemm with the gather loop, out_height/out_width other
+// than (in - 1) * stride + kernel - 2 * padding crop or extend the output.
+void TestDeconv2dGemm(const index_t batch,
+                      const index_t in_channels,
+                      const index_t out_channels,
+                      const index_t in_height,
+                      const index_t in_width,
+                      const index_t kernel_h,
+                      const index_t kernel_w,
+                      const int stride,
+                      const int padding,
+                      const index_t out_height,
+                      const index_t out_width,
+                      const index_t tile_rows) {
+  const index_t in_shape[4] = {batch, in_channels, in_height, in_width};
+  const index_t out_shape[4] = {batch, out_channels, out_height, out_width};
+  const index_t filter_shape[4] = {out_channels, in_channels, kernel_h,
+                                   kernel_w};
+  const index_t kernel_hw[2] = {kernel_h, kernel_w};
+  const int strides[2] = {stride, stride};
+  const int paddings[2] = {padding, padding};
+
+  std::vector<float> input(batch * in_channels * in_height * in_width);
+  std::vector<float> filter(out_channels * in_channels * kernel_h * kernel_w);
+  std::vector<float> bias(out_channels);
+  std::vector<float> packed_filter(filter.size());
+  std::vector<float> output(batch * out_channels * out_height * out_width);
+  std::vector<float> output_ref(output.size());
+  std::vector<float> col_buffer(
+      out_channels * kernel_h * kernel_w * tile_rows * in_width);
+  std::vector<float> tile_input(in_channels * tile_rows * in_width);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+  std::generate(input.begin(), input.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(filter.begin(), filter.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(bias.begin(), bias.end(), [&gen, &nd] { return nd(gen); });
+
+  Deconv2dPackFilter(filter.data(), filter_shape, packed_filter.data());
+  Deconv2dGemm(input.data(), packed_filter.data(), bias.data(), in_shape,
+               out_shape, filter_shape, strides, paddings, tile_rows,
+               col_buffer.data(), tile_input.data(), output.data());
+  deconv::Deconv2dNCHW(input.data(), filter.data(), bias.data(), in_shape,
+                       out_shape, kernel_hw, strides, paddings,
+                       output_ref.data());
+
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output_ref[i], output[i], 1e-3) << "with index " << i;
+  }
+}
+
+}  // namespace
+
+TEST(Deconv2dGemmTest, WholeImage) {
+  TestDeconv2dGemm(1, 3, 5, 7, 9, 3, 3, 1, 1, 7, 9, 7);
+  TestDeconv2dGemm(2, 8, 4, 5, 13, 3, 5, 2, 0, 11, 29, 5);
+  TestDeconv2dGemm(1, 4, 6, 6, 6, 1, 1, 1, 0, 6, 6, 6);
+  TestDeconv2dGemm(1, 4, 6, 6, 7, 7, 7, 3, 3, 18, 21, 6);
+}
+
+TEST(Deconv2dGemmTest, Tiled) {
+  TestDeconv2dGemm(1, 3, 5, 7, 9, 3, 3, 1, 1, 7, 9, 2);
+  TestDeconv2dGemm(2, 8, 4, 5, 13, 3, 5, 2, 1, 10, 26, 3);
+  TestDeconv2dGemm(1, 5, 7, 11, 11, 2, 2, 3, 0, 33, 33, 4);
+}
+
+TEST(Deconv2dGemmTest, Stride2K2) {
+  TestDeconv2dGemm(1, 16, 8, 8, 8, 2, 2, 2, 0, 16, 16, 8);
+  TestDeconv2dGemm(2, 5, 3, 7, 37, 2, 2, 2, 0, 14, 74, 3);
+  // padded and cropped outputs
+  TestDeconv2dGemm(1, 5, 3, 9, 29, 2, 2, 2, 1, 17, 57, 4);
+  TestDeconv2dGemm(1, 5, 3, 9, 29, 2, 2, 2, 0, 19, 59, 9);
+  TestDeconv2dGemm(1, 3, 2, 3, 3, 2, 2, 2, 1, 3, 3, 1);
+}
+
+TEST(Deconv2dGemmTest, Stride2K4) {
+  TestDeconv2dGemm(1, 16, 8, 8, 8, 4, 4, 2, 1, 16, 16, 8);
+  TestDeconv2dGemm(2, 5, 3, 7, 37, 4, 4, 2, 1, 14, 74, 3);
+  TestDeconv2dGemm(1, 5, 3, 9, 29, 4, 4, 2, 0, 20, 60, 4);
+  TestDeconv2dGemm(1, 5, 3, 9, 29, 4, 4, 2, 2, 16, 56, 9);
+  TestDeconv2dGemm(1, 5, 3, 9, 29, 4, 4, 2, 3, 15, 55, 2);
+  TestDeconv2dGemm(1, 3, 2, 1, 1, 4, 4, 2, 1, 2, 2, 1);
+  TestDeconv2dGemm(1, 3, 2, 2, 19, 4, 4, 2, 1, 5, 41, 1);
+}
+
+}  // namespace kernels
+}  // namespace mace
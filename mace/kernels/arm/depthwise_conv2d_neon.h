@@ -42,6 +42,36 @@ void DepthwiseConv2dNeonK3x3S2(const float *input,
                                const index_t valid_w_stop,
                                float *output);
 
+// KxK depthwise convolution with stride 1 or 2 and any dilation. Only the
+// interior [valid_h_start, valid_h_stop) x [valid_w_start, valid_w_stop),
+// whose windows never reach into the padding, is vectorized, the border is
+// computed pixel by pixel.
+void DepthwiseConv2dNeonK3x3(const float *input,
+                             const float *filter,
+                             const index_t *in_shape,
+                             const index_t *out_shape,
+                             const int *pad_hw,
+                             const int *stride_hw,
+                             const int *dilation_hw,
+                             const index_t valid_h_start,
+                             const index_t valid_h_stop,
+                             const index_t valid_w_start,
+                             const index_t valid_w_stop,
+                             float *output);
+
+void DepthwiseConv2dNeonK5x5(const float *input,
+                             const float *filter,
+                             const index_t *in_shape,
+                             const index_t *out_shape,
+                             const int *pad_hw,
+                             const int *stride_hw,
+                             const int *dilation_hw,
+                             const index_t valid_h_start,
+                             const index_t valid_h_stop,
+                             const index_t valid_w_start,
+                             const index_t valid_w_stop,
+                             float *output);
+
 }  // namespace kernels
 }  // namespace mace
 
@@ -0,0 +1,246 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <limits>
+
+#include "mace/kernels/arm/pooling_neon.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+template <bool IS_MAX>
+inline float PoolingBorderPixel(const float *in_base,
+                                const index_t in_h_start,
+                                const index_t in_w_start,
+                                const index_t in_height,
+                                const index_t in_width,
+                                const int filter_size) {
+  float res = IS_MAX ? std::numeric_limits<float>::lowest() : 0;
+  int block_size = 0;
+  for (int i = 0; i < filter_size; ++i) {
+    for (int j = 0; j < filter_size; ++j) {
+      index_t in_h = in_h_start + i;
+      index_t in_w = in_w_start + j;
+      if (in_h >= 0 && in_h < in_height && in_w >= 0 && in_w < in_width) {
+        const float value = in_base[in_h * in_width + in_w];
+        res = IS_MAX ? std::max(res, value) : res + value;
+        ++block_size;
+      }
+    }
+  }
+  return IS_MAX ? res : res / block_size;
+}
+
+#if defined(MACE_ENABLE_NEON)
+template <int S>
+inline float32x4_t LoadStrided4(const float *ptr);
+
+template <>
+inline float32x4_t LoadStrided4<1>(const float *ptr) {
+  return vld1q_f32(ptr);
+}
+
+template <>
+inline float32x4_t LoadStrided4<2>(const float *ptr) {
+  return vld2q_f32(ptr).val[0];
+}
+#endif
+
+// Ho = 1, Wo = 4
+template <int K, int S, bool IS_MAX>
+void PoolingNeonKxKSn(const float *input,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      const int *pad_hw,
+                      float *output) {
+  const index_t in_height = in_shape[2];
+  const index_t in_width = in_shape[3];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+  const index_t in_image_size = in_height * in_width;
+  const index_t out_image_size = out_height * out_width;
+  const index_t pad_top = pad_hw[0];
+  const index_t pad_left = pad_hw[1];
+
+  // [valid_h_start, valid_h_stop) x [valid_w_start, valid_w_stop) are the
+  // outputs whose windows lie inside the input.
+  const index_t valid_h_start = std::min((pad_top + S - 1) / S, out_height);
+  const index_t valid_h_stop = in_height + pad_top < K ? valid_h_start
+      : std::max(valid_h_start,
+                 std::min((in_height + pad_top - K) / S + 1, out_height));
+  const index_t valid_w_start = std::min((pad_left + S - 1) / S, out_width);
+  const index_t valid_w_stop = in_width + pad_left < K ? valid_w_start
+      : std::max(valid_w_start,
+                 std::min((in_width + pad_left - K) / S + 1, out_width));
+
+#pragma omp parallel for
+  for (index_t i = 0; i < out_shape[0] * out_shape[1]; ++i) {
+    const float *in_base = input + i * in_image_size;
+    float *out_base = output + i * out_image_size;
+
+    for (index_t h = 0; h < out_height; ++h) {
+      const index_t in_h = h * S - pad_top;
+      float *out_row = out_base + h * out_width;
+      if (h < valid_h_start || h >= valid_h_stop) {
+        for (index_t w = 0; w < out_width; ++w) {
+          out_row[w] = PoolingBorderPixel<IS_MAX>(
+              in_base, in_h, w * S - pad_left, in_height, in_width, K);
+        }
+        continue;
+      }
+
+      for (index_t w = 0; w < valid_w_start; ++w) {
+        out_row[w] = PoolingBorderPixel<IS_MAX>(
+            in_base, in_h, w * S - pad_left, in_height, in_width, K);
+      }
+
+      const float *in_row = in_base + in_h * in_width - pad_left;
+      index_t w = valid_w_start;
+#if defined(MACE_ENABLE_NEON)
+      for (; w + 3 < valid_w_stop; w += 4) {
+        float32x4_t vo = IS_MAX ? LoadStrided4<S>(in_row + w * S)
+                                : vdupq_n_f32(0);
+        for (int kh = 0; kh < K; ++kh) {
+          for (int kw = 0; kw < K; ++kw) {
+            float32x4_t vi = LoadStrided4<S>(in_row + kh * in_width
+                                                 + w * S + kw);
+            vo = IS_MAX ? vmaxq_f32(vo, vi) : vaddq_f32(vo, vi);
+          }
+        }
+        if (!IS_MAX) {
+          vo = vmulq_n_f32(vo, 1.f / (K * K));
+        }
+        vst1q_f32(out_row + w, vo);
+      }
+#endif
+      for (; w < valid_w_stop; ++w) {
+        float res = IS_MAX ? in_row[w * S] : 0;
+        for (int kh = 0; kh < K; ++kh) {
+          for (int kw = 0; kw < K; ++kw) {
+            const float value = in_row[kh * in_width + w * S + kw];
+            res = IS_MAX ? std::max(res, value) : res + value;
+          }
+        }
+        out_row[w] = IS_MAX ? res : res * (1.f / (K * K));
+      }
+
+      for (w = valid_w_stop; w < out_width; ++w) {
+        out_row[w] = PoolingBorderPixel<IS_MAX>(
+            in_base, in_h, w * S - pad_left, in_height, in_width, K);
+      }
+    }  // h
+  }  // i
+}
+
+template <bool IS_MAX>
+void PoolingNeonGlobal(const float *input,
+                       const index_t *in_shape,
+                       float *output) {
+  const index_t image_size = in_shape[2] * in_shape[3];
+
+#pragma omp parallel for
+  for (index_t i = 0; i < in_shape[0] * in_shape[1]; ++i) {
+    const float *in_ptr = input + i * image_size;
+    float res = IS_MAX ? std::numeric_limits<float>::lowest() : 0;
+    index_t j = 0;
+#if defined(MACE_ENABLE_NEON)
+    float32x4_t vres = vdupq_n_f32(res);
+    for (; j + 3 < image_size; j += 4) {
+      float32x4_t vi = vld1q_f32(in_ptr + j);
+      vres = IS_MAX ? vmaxq_f32(vres, vi) : vaddq_f32(vres, vi);
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vres);
+    for (int l = 0; l < 4; ++l) {
+      res = IS_MAX ? std::max(res, lanes[l]) : res + lanes[l];
+    }
+#endif
+    for (; j < image_size; ++j) {
+      res = IS_MAX ? std::max(res, in_ptr[j]) : res + in_ptr[j];
+    }
+    output[i] = IS_MAX ? res : res / image_size;
+  }
+}
+
+}  // namespace
+
+void MaxPoolingNeonK2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingNeonKxKSn<2, 2, true>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void MaxPoolingNeonK3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingNeonKxKSn<3, 1, true>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void MaxPoolingNeonK3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingNeonKxKSn<3, 2, true>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void AvgPoolingNeonK2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingNeonKxKSn<2, 2, false>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void AvgPoolingNeonK3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingNeonKxKSn<3, 1, false>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void AvgPoolingNeonK3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingNeonKxKSn<3, 2, false>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void MaxPoolingNeonGlobal(const float *input,
+                          const index_t *in_shape,
+                          float *output) {
+  PoolingNeonGlobal<true>(input, in_shape, output);
+}
+
+void AvgPoolingNeonGlobal(const float *input,
+                          const index_t *in_shape,
+                          float *output) {
+  PoolingNeonGlobal<false>(input, in_shape, output);
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,76 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_ARM_POOLING_NEON_H_
+#define MACE_KERNELS_ARM_POOLING_NEON_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// KxK pooling with stride S and no dilation. Only the interior, whose
+// windows lie inside the input, is vectorized without bounds checks. Border
+// pixels skip the taps in the padding, the average is over the rest.
+// pad_hw is the top and left padding.
+
+void MaxPoolingNeonK2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void MaxPoolingNeonK3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void MaxPoolingNeonK3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void AvgPoolingNeonK2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void AvgPoolingNeonK3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void AvgPoolingNeonK3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+// Pooling over the whole of each [H, W] image into [N, C, 1, 1]
+void MaxPoolingNeonGlobal(const float *input,
+                          const index_t *in_shape,
+                          float *output);
+
+void AvgPoolingNeonGlobal(const float *input,
+                          const index_t *in_shape,
+                          float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_ARM_POOLING_NEON_H_
@@ -46,10 +46,11 @@ struct ConcatFunctor : ConcatFunctorBase {
     MACE_UNUSED(future);
     const Tensor *input0 = input_list.front();
     const size_t inputs_count = input_list.size();
+    const int32_t axis = axis_ < 0 ? axis_ + input0->dim_size() : axis_;
 
     std::vector<index_t> output_shape(input0->shape());
     index_t inner_size = 1;
-    for (int i = 0; i < axis_; ++i) {
+    for (int i = 0; i < axis; ++i) {
       inner_size *= output_shape[i];
     }
     std::vector<index_t> outer_sizes(inputs_count, 0);
@@ -59,14 +60,14 @@ struct ConcatFunctor : ConcatFunctorBase {
       MACE_CHECK(input->dim_size() == input0->dim_size(),
                  "Ranks of all input tensors must be same.");
       for (int j = 0; j < input->dim_size(); ++j) {
-        if (j == axis_) {
+        if (j == axis) {
           continue;
         }
         MACE_CHECK(input->dim(j) == input0->dim(j),
                    "Dimensions of inputs should equal except axis.");
       }
       outer_sizes[i] = input->size() / inner_size;
-      output_shape[axis_] += input->dim(axis_);
+      output_shape[axis] += input->dim(axis);
     }
     MACE_RETURN_IF_ERROR(output->Resize(output_shape));
 
@@ -76,6 +77,20 @@ struct ConcatFunctor : ConcatFunctorBase {
     for (size_t i = 0; i < inputs_count; ++i) {
       input_ptrs[i] = input_list[i]->data<T>();
     }
+
+    // The memory optimizer may have let the producers write their outputs
+    // straight into slices of the output buffer, then there is nothing to do.
+    if (inner_size == 1) {
+      bool in_place = true;
+      const T *slice_ptr = output_ptr;
+      for (size_t i = 0; i < inputs_count && in_place; ++i) {
+        in_place = input_ptrs[i] == slice_ptr;
+        slice_ptr += outer_sizes[i];
+      }
+      if (in_place) {
+        return MACE_SUCCESS;
+      }
+    }
     for (int inner_idx = 0; inner_idx < inner_size; ++inner_idx) {
       for (size_t i = 0; i < inputs_count; ++i) {
         if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
@@ -27,8 +27,15 @@
 #include "mace/core/tensor.h"
 #include "mace/kernels/activation.h"
 #include "mace/kernels/conv_pool_2d_util.h"
+#include "mace/kernels/epilogue.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/nchwc.h"
+#include "mace/kernels/packed_weight.h"
+#include "mace/kernels/sparse_gemm.h"
+#include "mace/kernels/arm/conv_2d_im2col.h"
 #include "mace/kernels/arm/conv_2d_neon.h"
 #include "mace/kernels/arm/conv_winograd.h"
+#include "mace/kernels/x86/conv_2d_avx2.h"
 #include "mace/utils/utils.h"
 
 #ifdef MACE_ENABLE_OPENCL
@@ -63,6 +70,21 @@ struct Conv2dFunctorBase {
 template<DeviceType D, typename T>
 struct Conv2dFunctor;
 
+typedef void (*Conv2dKernelFunc)(const float *input,
+                                 const float *filter,
+                                 const index_t *in_shape,
+                                 const index_t *out_shape,
+                                 float *output);
+
+// Direct convolution kernels share the NEON tiling, so the x86 variant can
+// replace the NEON (scalar on x86) one transparently.
+inline Conv2dKernelFunc SelectConv2dKernel(Conv2dKernelFunc neon_func,
+                                           Conv2dKernelFunc avx2_func) {
+  return KernelDispatcher<Conv2dKernelFunc>(neon_func)
+      .Register(CPU_ISA_AVX2, avx2_func)
+      .Select();
+}
+
 template<>
 struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
   Conv2dFunctor(const int *strides,
@@ -80,7 +102,9 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
                         activation,
                         relux_max_limit),
       is_filter_transformed_(is_filter_transformed),
-      scratch_(scratch) {}
+      scratch_(scratch),
+      sparse_row_ptr_(nullptr),
+      sparse_col_idx_(nullptr) {}
 
   void Conv2dGeneral(const float *input,
                      const float *filter,
@@ -256,15 +280,25 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
     }  // b
   }
 
+  // output = activation(conv(input, filter) + bias + residual), bias and
+  // residual may be null.
   MaceStatus operator()(const Tensor *input,
                   const Tensor *filter,
                   const Tensor *bias,
+                  const Tensor *residual,
                   Tensor *output,
                   StatsFuture *future) {
     MACE_UNUSED(future);
     MACE_CHECK_NOTNULL(input);
     MACE_CHECK_NOTNULL(filter);
     MACE_CHECK_NOTNULL(output);
+    MACE_CHECK(activation_ != PRELU, "Conv2d does not support PRELU");
+    if (input->dim_size() == 5) {
+      return ConvNCHWc(input, filter, bias, residual, output);
+    }
+    if (sparse_row_ptr_ != nullptr) {
+      return ConvSparse1x1(input, filter, bias, residual, output);
+    }
 
     std::vector<index_t> filter_shape(4);
     if (is_filter_transformed_) {
@@ -297,6 +331,10 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
                          output_shape.data());
     }
     MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+    if (residual != nullptr) {
+      MACE_CHECK(residual->shape() == output_shape,
+                 "Residual shape mismatches conv output shape");
+    }
 
     index_t batch = output->dim(0);
     index_t channels = output->dim(1);
@@ -337,18 +375,31 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
     Tensor::MappingGuard input_guard(input);
     Tensor::MappingGuard filter_guard(filter);
     Tensor::MappingGuard bias_guard(bias);
+    Tensor::MappingGuard residual_guard(residual);
     Tensor::MappingGuard output_guard(output);
 
     auto filter_data = filter->data<float>();
     auto bias_data = bias == nullptr ? nullptr : bias->data<float>();
     auto output_data = output->mutable_data<float>();
 
+    Epilogue epilogue;
+    epilogue.bias = bias_data;
+    epilogue.residual = residual == nullptr ? nullptr : residual->data<float>();
+    epilogue.residual_stride = height * width;
+    epilogue.activation = activation_;
+    epilogue.relux_max_limit = relux_max_limit_;
+
     std::function<void(const float *input, float *output)> conv_func;
 
+    // Dilated winograd gathers its tiles, below 64 channels the transforms
+    // cost more than im2col + Gemm.
+    const index_t winograd_min_channels =
+        dilation_h == 1 && dilation_w == 1 ? 8 : 64;
     bool
       use_winograd = is_filter_transformed_ || (filter_h == 3 && filter_w == 3
-      && stride_h == 1 && stride_w == 1 && dilation_h == 1 && dilation_w == 1
-      && input_channels >= 8 && channels >= 8);
+      && stride_h == 1 && stride_w == 1
+      && input_channels >= winograd_min_channels
+      && channels >= winograd_min_channels);
     bool use_neon_3x3_s1 = filter_h == 3 && filter_w == 3
       && stride_h == 1 && stride_w == 1 && dilation_h == 1 && dilation_w == 1;
     bool use_neon_3x3_s2 = filter_h == 3 && filter_w == 3
@@ -371,6 +422,18 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
         && stride_h == 1 && stride_w == 1 && dilation_h == 1 && dilation_w == 1;
     bool use_neon_15x1_s1 = filter_h == 15 && filter_w == 1
         && stride_h == 1 && stride_w == 1 && dilation_h == 1 && dilation_w == 1;
+    // Conv2dGeneral is scalar, im2col + Gemm beats it by several times even
+    // for thin convs as long as Gemm itself is vectorized.
+#if defined(MACE_ENABLE_NEON)
+    const bool is_gemm_vectorized = true;
+#else
+    const bool is_gemm_vectorized = GetCPUISA() >= CPU_ISA_AVX2;
+#endif
+    bool use_im2col = is_gemm_vectorized && !use_winograd
+        && !use_neon_3x3_s1 && !use_neon_3x3_s2 && !use_neon_1x1_s1
+        && !use_neon_5x5_s1 && !use_neon_1x7_s1 && !use_neon_7x1_s1
+        && !use_neon_7x7_s1 && !use_neon_7x7_s2 && !use_neon_7x7_s3
+        && !use_neon_1x15_s1 && !use_neon_15x1_s1;
 
     std::vector<index_t> transformed_input_shape;
     std::vector<index_t> transformed_output_shape;
@@ -378,23 +441,23 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
 
     // When size of input feature map is bigger than 16x16,
     // set winograd out tile size to 6 to get higher performance.
+    // Dilated convs are tiled per phase, 6x6 tiles pay off as soon as a
+    // phase fills one.
     index_t winograd_out_tile_size = 2;
-    if (input_height > 16 && input_width > 16) {
+    if (dilation_h == 1 && dilation_w == 1) {
+      if (input_height > 16 && input_width > 16) {
+        winograd_out_tile_size = 6;
+      }
+    } else if (RoundUpDiv(height, dilation_h) >= 6
+        && RoundUpDiv(width, dilation_w) >= 6) {
       winograd_out_tile_size = 6;
     }
 
     if (use_winograd) {
-      extra_output_height = RoundUp<index_t>(height, winograd_out_tile_size);
-      extra_input_height =
-        std::max(padded_input_height, extra_output_height + 2);
-      extra_output_width = RoundUp<index_t>(width, winograd_out_tile_size);
-      extra_input_width = std::max(padded_input_width, extra_output_width + 2);
-      if (extra_input_height != padded_input_height) {
-        pad_bottom += (extra_input_height - padded_input_height);
-      }
-      if (extra_input_width != padded_input_width) {
-        pad_right += (extra_input_width - padded_input_width);
-      }
+      extra_output_height = dilation_h * RoundUp<index_t>(
+          RoundUpDiv(height, dilation_h), winograd_out_tile_size);
+      extra_output_width = dilation_w * RoundUp<index_t>(
+          RoundUpDiv(width, dilation_w), winograd_out_tile_size);
 
       index_t tile_height_count = extra_output_height / winograd_out_tile_size;
       index_t tile_width_count = extra_output_width / winograd_out_tile_size;
@@ -412,7 +475,7 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
                                       {in_tile_area, channels, input_channels});
     } else {
       index_t tile_h, tile_w;
-      if (use_neon_1x1_s1) {
+      if (use_neon_1x1_s1 || use_im2col) {
         tile_h = 1;
         tile_w = 1;
       } else if (use_neon_3x3_s1) {
@@ -441,12 +504,21 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
       }
     }
 
+    // Winograd and im2col read zeros for the border tiles themselves, only
+    // the direct kernels need a padded copy of the input.
+    const bool is_input_padded = !use_winograd && !use_im2col
+        && (extra_input_height != input_height
+            || extra_input_width != input_width);
+
     // decide scratch size before allocate it
     index_t total_scratch_size = 0;
     index_t transformed_input_size = 0;
     index_t transformed_output_size = 0;
     index_t padded_input_size = 0;
     index_t padded_output_size = 0;
+    index_t im2col_tile_size = 0;
+    index_t col_buffer_size = 0;
+    index_t tile_output_size = 0;
     if (use_winograd) {
       transformed_input_size =
         std::accumulate(transformed_input_shape.begin(),
@@ -460,8 +532,17 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
                         std::multiplies<index_t>()) * sizeof(float);
       total_scratch_size += transformed_input_size + transformed_output_size;
     }
-    if (extra_input_height != input_height
-      || extra_input_width != input_width) {
+    if (use_im2col) {
+      im2col_tile_size =
+          Conv2dIm2colTileSize(output_shape.data(), filter_shape.data());
+      col_buffer_size = input_channels * filter_h * filter_w
+          * im2col_tile_size * sizeof(float);
+      if (im2col_tile_size != height * width) {
+        tile_output_size = channels * im2col_tile_size * sizeof(float);
+      }
+      total_scratch_size += col_buffer_size + tile_output_size;
+    }
+    if (is_input_padded) {
       padded_input_size =
         batch * input_channels * (input_height + pad_top + pad_bottom)
           * (input_width + pad_left + pad_right) * sizeof(float) +
@@ -483,10 +564,15 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
       transformed_output(scratch_->Scratch(transformed_output_size), DT_FLOAT);
     Tensor padded_input(scratch_->Scratch(padded_input_size), DT_FLOAT);
     Tensor padded_output(scratch_->Scratch(padded_output_size), DT_FLOAT);
+    Tensor col_buffer(scratch_->Scratch(col_buffer_size), DT_FLOAT);
+    Tensor tile_output(scratch_->Scratch(tile_output_size), DT_FLOAT);
     const index_t extra_input_shape[4] =
         {batch, input_channels, extra_input_height, extra_input_width};
     const index_t extra_output_shape[4] =
         {batch, channels, extra_output_height, extra_output_width};
+    const index_t input_shape[4] =
+        {batch, input_channels, input_height, input_width};
+    const int pad_hw[2] = {pad_top, pad_left};
 
     // decide which convolution function to call
     if (use_winograd) {
@@ -527,30 +613,38 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
         WinoGradConv3x3s1(pad_input,
                           transformed_filter_ptr,
                           batch,
-                          extra_input_height,
-                          extra_input_width,
+                          input_height,
+                          input_width,
                           input_channels,
                           channels,
+                          extra_output_height,
+                          extra_output_width,
+                          pad_hw,
+                          dilations_,
                           winograd_out_tile_size,
                           transformed_input_data,
                           transformed_output_data,
                           pad_output);
       };
     } else if (use_neon_3x3_s1) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK3x3S1, MACE_X86_KERNEL(Conv2dAvx2K3x3S1));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK3x3S1(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_3x3_s2) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK3x3S2, MACE_X86_KERNEL(Conv2dAvx2K3x3S2));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK3x3S2(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_1x1_s1) {
       conv_func = [=](const float *pad_input, float *pad_output) {
@@ -561,71 +655,106 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
                          extra_input_width,
                          input_channels,
                          channels,
+                         &epilogue,
                          pad_output);
       };
     } else if (use_neon_5x5_s1) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK5x5S1, MACE_X86_KERNEL(Conv2dAvx2K5x5S1));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK5x5S1(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_1x7_s1) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK1x7S1, MACE_X86_KERNEL(Conv2dAvx2K1x7S1));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK1x7S1(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_7x1_s1) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK7x1S1, MACE_X86_KERNEL(Conv2dAvx2K7x1S1));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK7x1S1(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_7x7_s1) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK7x7S1, MACE_X86_KERNEL(Conv2dAvx2K7x7S1));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK7x7S1(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_7x7_s2) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK7x7S2, MACE_X86_KERNEL(Conv2dAvx2K7x7S2));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK7x7S2(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_7x7_s3) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK7x7S3, MACE_X86_KERNEL(Conv2dAvx2K7x7S3));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK7x7S3(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_1x15_s1) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK1x15S1, MACE_X86_KERNEL(Conv2dAvx2K1x15S1));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK1x15S1(pad_input,
-                         filter_data,
-                         extra_input_shape,
-                         extra_output_shape,
-                         pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
       };
     } else if (use_neon_15x1_s1) {
+      Conv2dKernelFunc kernel = SelectConv2dKernel(
+          Conv2dNeonK15x1S1, MACE_X86_KERNEL(Conv2dAvx2K15x1S1));
       conv_func = [=](const float *pad_input, float *pad_output) {
-        Conv2dNeonK15x1S1(pad_input,
-                          filter_data,
-                          extra_input_shape,
-                          extra_output_shape,
-                          pad_output);
+        kernel(pad_input,
+               filter_data,
+               extra_input_shape,
+               extra_output_shape,
+               pad_output);
+      };
+    } else if (use_im2col) {
+      float *col_buffer_data = col_buffer.mutable_data<float>();
+      float *tile_output_data = tile_output.mutable_data<float>();
+      conv_func = [=](const float *pad_input, float *pad_output) {
+        Conv2dIm2col(pad_input,
+                     filter_data,
+                     input_shape,
+                     extra_output_shape,
+                     filter_shape.data(),
+                     strides_,
+                     dilations_,
+                     pad_hw,
+                     im2col_tile_size,
+                     col_buffer_data,
+                     tile_output_data,
+                     &epilogue,
+                     pad_output);
       };
     } else {
       conv_func = [=](const float *pad_input, float *pad_output) {
@@ -640,10 +769,9 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
       };
     }
 
-    // pad input and output
+    // pad input
     const Tensor *pad_input_ptr = input;
-    if (extra_input_height != input_height
-      || extra_input_width != input_width) {
+    if (is_input_padded) {
       MACE_RETURN_IF_ERROR(ConstructNCHWInputWithSpecificPadding(input,
                                             pad_top,
                                             pad_bottom,
@@ -653,62 +781,243 @@ struct Conv2dFunctor<DeviceType::CPU, float> : Conv2dFunctorBase {
       pad_input_ptr = &padded_input;
     }
 
-    // TODO(libin): don't need clear after bias is integrated in each conv
+    // Gemm based kernels apply the whole epilogue themselves. Direct kernels
+    // accumulate into the output, so it starts from the bias instead of zero.
+    const bool is_epilogue_fused = use_neon_1x1_s1 || use_im2col;
+    const bool is_accumulated = !use_winograd && !is_epilogue_fused;
     Tensor *pad_output_ptr = output;
     if (extra_output_height != height || extra_output_width != width) {
       padded_output.Reshape({batch, channels, extra_output_height,
                             extra_output_width});
-      padded_output.Clear();
       pad_output_ptr = &padded_output;
-    } else if (!use_neon_1x1_s1) {
-      output->Clear();
     }
 
     const float *pad_input_data = pad_input_ptr->data<float>();
     float *pad_output_data = pad_output_ptr->mutable_data<float>();
 
+    if (is_accumulated) {
+      const index_t extra_output_image_size =
+          extra_output_height * extra_output_width;
+#pragma omp parallel for collapse(2)
+      for (index_t b = 0; b < batch; ++b) {
+        for (index_t c = 0; c < channels; ++c) {
+          float *out_ptr =
+              pad_output_data + (b * channels + c) * extra_output_image_size;
+          std::fill(out_ptr, out_ptr + extra_output_image_size,
+                    bias_data == nullptr ? 0.f : bias_data[c]);
+        }
+      }
+      epilogue.bias = nullptr;
+    }
+
     conv_func(pad_input_data, pad_output_data);
 
-    // unpack output
     if (extra_output_height != height || extra_output_width != width) {
+      // unpack output and apply the rest of the epilogue in one pass
 #pragma omp parallel for collapse(2)
       for (index_t b = 0; b < batch; ++b) {
         for (index_t c = 0; c < channels; ++c) {
+          const Epilogue batch_epilogue =
+              epilogue.Offset(b * channels * height * width);
           for (index_t h = 0; h < height; ++h) {
-            memcpy(
-              output_data + b * channels * height * width + c * height * width
-                + h * width,
-              pad_output_data
-                + b * channels * extra_output_height * extra_output_width
-                + c * extra_output_height * extra_output_width
-                + h * extra_output_width,
-              sizeof(float) * width);
+            batch_epilogue.Apply(
+                pad_output_data
+                    + ((b * channels + c) * extra_output_height + h)
+                        * extra_output_width,
+                c,
+                h * width,
+                width,
+                output_data + ((b * channels + c) * height + h) * width);
           }
         }
       }
-    }
-
-    if (bias_data != nullptr) {
+    } else if (!is_epilogue_fused && !epilogue.empty()) {
 #pragma omp parallel for collapse(2)
       for (index_t b = 0; b < batch; ++b) {
         for (index_t c = 0; c < channels; ++c) {
-          for (index_t i = 0; i < height * width; ++i) {
-            output_data[(b * channels + c) * height * width + i] +=
-              bias_data[c];
-          }
+          float *out_ptr = output_data + (b * channels + c) * height * width;
+          epilogue.Offset(b * channels * height * width)
+              .Apply(out_ptr, c, 0, height * width, out_ptr);
         }
       }
     }
 
-    DoActivation(output_data, output_data, output->size(), activation_,
-                 relux_max_limit_);
+    return MACE_SUCCESS;
+  }
+
+  // Packs a const filter once for Conv2dNCHWc, see NCHWcPackConv2dFilter.
+  MaceStatus PackFilterNCHWc(const Tensor *filter,
+                             const int block,
+                             Tensor *in_place) {
+    const std::vector<index_t> filter_shape = filter->shape();
+    return packed_filter_nchwc_.Pack(filter, in_place,
+                                     [&](const float *weight, float *packed) {
+      NCHWcPackConv2dFilter(weight, filter_shape.data(), block, packed);
+    });
+  }
+
+  // input, residual and output are blocked (NCHW4C/NCHW8C), see nchwc.h.
+  MaceStatus ConvNCHWc(const Tensor *input,
+                       const Tensor *filter,
+                       const Tensor *bias,
+                       const Tensor *residual,
+                       Tensor *output) {
+    MACE_CHECK(!is_filter_transformed_,
+               "blocked conv does not take winograd filter");
+    const index_t block = input->dim(4);
+    const std::vector<index_t> &filter_shape = filter->shape();
+    MACE_CHECK(filter_shape[1] == input->dim(1) * block, filter_shape[1],
+               " != ", input->dim(1) * block);
+    MACE_CHECK(filter_shape[0] % block == 0, "output channels ",
+               filter_shape[0], " is not a multiple of block ", block);
+
+    // The NCHW shape helpers see channel blocks as channels.
+    const index_t blocked_filter_shape[4] = {
+        filter_shape[0] / block, input->dim(1), filter_shape[2],
+        filter_shape[3]};
+    std::vector<index_t> output_shape(5);
+    std::vector<int> paddings(2);
+    if (paddings_.empty()) {
+      CalcNCHWPaddingAndOutputSize(input->shape().data(),
+                                   blocked_filter_shape,
+                                   dilations_,
+                                   strides_,
+                                   padding_type_,
+                                   output_shape.data(),
+                                   paddings.data());
+    } else {
+      paddings = paddings_;
+      CalcNCHWOutputSize(input->shape().data(),
+                         blocked_filter_shape,
+                         paddings_.data(),
+                         dilations_,
+                         strides_,
+                         RoundType::FLOOR,
+                         output_shape.data());
+    }
+    output_shape[4] = block;
+    MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+    if (residual != nullptr) {
+      MACE_CHECK(residual->shape() == output_shape,
+                 "Residual shape mismatches conv output shape");
+    }
+
+    Tensor::MappingGuard input_guard(input);
+    Tensor::MappingGuard filter_guard(filter);
+    Tensor::MappingGuard bias_guard(bias);
+    Tensor::MappingGuard residual_guard(residual);
+    Tensor::MappingGuard output_guard(output);
+
+    const index_t packed_filter_size =
+        packed_filter_nchwc_.empty() ? filter->size() * sizeof(float) : 0;
+    scratch_->Rewind();
+    scratch_->GrowSize(packed_filter_size);
+    Tensor packed_filter(scratch_->Scratch(packed_filter_size), DT_FLOAT);
+    const float *packed_filter_data = packed_filter_nchwc_.data();
+    if (packed_filter_nchwc_.empty()) {
+      NCHWcPackConv2dFilter(filter->data<float>(), filter_shape.data(),
+                            block, packed_filter.mutable_data<float>());
+      packed_filter_data = packed_filter.data<float>();
+    }
+
+    Epilogue epilogue;
+    epilogue.bias = bias == nullptr ? nullptr : bias->data<float>();
+    epilogue.residual = residual == nullptr ? nullptr : residual->data<float>();
+    epilogue.activation = activation_;
+    epilogue.relux_max_limit = relux_max_limit_;
+
+    const int pad_hw[2] = {paddings[0] >> 1, paddings[1] >> 1};
+    Conv2dNCHWc(input->data<float>(),
+                packed_filter_data,
+                input->shape().data(),
+                output_shape.data(),
+                filter_shape.data() + 2,
+                strides_,
+                dilations_,
+                pad_hw,
+                epilogue,
+                output->mutable_data<float>());
+    return MACE_SUCCESS;
+  }
+
+  // Makes operator() take the filter as the values of a block sparse 1x1
+  // filter of filter_shape (OIHW), see BlockSparseMatrix: filter is
+  // [blocks, block_rows, block_cols] and row_ptr and col_idx give the blocks.
+  void SetSparseFilter(const std::vector<index_t> &filter_shape,
+                       const Tensor *row_ptr,
+                       const Tensor *col_idx) {
+    MACE_CHECK(filter_shape.size() == 4 && filter_shape[2] == 1
+                   && filter_shape[3] == 1,
+               "sparse filter must be 1x1, got ", MakeString(filter_shape));
+    sparse_filter_shape_ = filter_shape;
+    sparse_row_ptr_ = row_ptr;
+    sparse_col_idx_ = col_idx;
+  }
+
+  MaceStatus ConvSparse1x1(const Tensor *input,
+                           const Tensor *filter,
+                           const Tensor *bias,
+                           const Tensor *residual,
+                           Tensor *output) {
+    MACE_CHECK(strides_[0] == 1 && strides_[1] == 1,
+               "sparse conv only supports stride 1");
+    MACE_CHECK(paddings_.empty() || (paddings_[0] == 0 && paddings_[1] == 0),
+               "sparse conv does not support padding");
+    const index_t batch = input->dim(0);
+    const index_t in_channels = input->dim(1);
+    const index_t image_size = input->dim(2) * input->dim(3);
+    const index_t channels = sparse_filter_shape_[0];
+    MACE_CHECK(sparse_filter_shape_[1] == in_channels,
+               sparse_filter_shape_[1], " != ", in_channels);
+    MACE_CHECK(filter->dim_size() == 3
+                   && sparse_row_ptr_->size()
+                       == channels / filter->dim(1) + 1,
+               "Invalid sparse filter ", MakeString(filter->shape()));
+
+    std::vector<index_t> output_shape = {batch, channels, input->dim(2),
+                                         input->dim(3)};
+    MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+    if (residual != nullptr) {
+      MACE_CHECK(residual->shape() == output_shape,
+                 "Residual shape mismatches conv output shape");
+    }
+
+    Tensor::MappingGuard input_guard(input);
+    Tensor::MappingGuard filter_guard(filter);
+    Tensor::MappingGuard row_ptr_guard(sparse_row_ptr_);
+    Tensor::MappingGuard col_idx_guard(sparse_col_idx_);
+    Tensor::MappingGuard bias_guard(bias);
+    Tensor::MappingGuard residual_guard(residual);
+    Tensor::MappingGuard output_guard(output);
+
+    BlockSparseMatrix sparse_filter;
+    sparse_filter.rows = channels;
+    sparse_filter.cols = in_channels;
+    sparse_filter.block_rows = static_cast<int>(filter->dim(1));
+    sparse_filter.block_cols = static_cast<int>(filter->dim(2));
+    sparse_filter.row_ptr = sparse_row_ptr_->data<int32_t>();
+    sparse_filter.col_idx = sparse_col_idx_->data<int32_t>();
+    sparse_filter.values = filter->data<float>();
+
+    Epilogue epilogue;
+    epilogue.bias = bias == nullptr ? nullptr : bias->data<float>();
+    epilogue.residual = residual == nullptr ? nullptr : residual->data<float>();
+    epilogue.residual_stride = image_size;
+    epilogue.activation = activation_;
+    epilogue.relux_max_limit = relux_max_limit_;
 
+    SparseGemm(sparse_filter, input->data<float>(), batch, image_size,
+               output->mutable_data<float>(), &epilogue);
     return MACE_SUCCESS;
   }
 
   Tensor transformed_filter_;
   bool is_filter_transformed_;
   ScratchBuffer *scratch_;
+  PackedWeight packed_filter_nchwc_;
+  std::vector<index_t> sparse_filter_shape_;
+  const Tensor *sparse_row_ptr_;
+  const Tensor *sparse_col_idx_;
 };
 
 #ifdef MACE_ENABLE_OPENCL
@@ -735,6 +1044,7 @@ struct Conv2dFunctor<DeviceType::GPU, T> : Conv2dFunctorBase {
   MaceStatus operator()(const Tensor *input,
                   const Tensor *filter,
                   const Tensor *bias,
+                  const Tensor *residual,
                   Tensor *output,
                   StatsFuture *future);
 
@@ -25,7 +25,9 @@
 #include "mace/core/future.h"
 #include "mace/core/tensor.h"
 #include "mace/kernels/activation.h"
+#include "mace/kernels/arm/deconv_2d_gemm.h"
 #include "mace/kernels/conv_pool_2d_util.h"
+#include "mace/kernels/packed_weight.h"
 #include "mace/utils/utils.h"
 
 #ifdef MACE_ENABLE_OPENCL
@@ -37,6 +39,8 @@ namespace kernels {
 
 namespace deconv {
 
+// Computes each output pixel by gathering its taps, the reference for
+// Deconv2dGemm which the CPU functor runs.
 template<typename T>
 void Deconv2dNCHW(const T *input,
                   const T *filter,
@@ -218,13 +222,15 @@ struct Deconv2dFunctor : Deconv2dFunctorBase {
                   const std::vector<int> &paddings,
                   const std::vector<index_t> &output_shape,
                   const ActivationType activation,
-                  const float relux_max_limit)
+                  const float relux_max_limit,
+                  ScratchBuffer *scratch)
       : Deconv2dFunctorBase(strides,
                             padding_type,
                             paddings,
                             output_shape,
                             activation,
-                            relux_max_limit) {}
+                            relux_max_limit),
+        scratch_(scratch) {}
 
   MaceStatus operator()(const Tensor *input,   // NCHW
                   const Tensor *filter,  // OIHW
@@ -252,20 +258,16 @@ struct Deconv2dFunctor : Deconv2dFunctorBase {
           paddings_.data(), true);
       MACE_RETURN_IF_ERROR(output->Resize(output_shape));
     } else {
-      output_shape_.clear();
-      output_shape_ = std::vector<index_t>(4, 0);
       CalcDeconvOutputSize(input->shape().data(),
                            filter->shape().data(),
                            strides_,
-                           output_shape_.data(),
+                           output_shape.data(),
                            paddings_.data(), true);
-      MACE_RETURN_IF_ERROR(output->Resize(output_shape_));
+      MACE_RETURN_IF_ERROR(output->Resize(output_shape));
     }
-    index_t kernel_h = filter->dim(2);
-    index_t kernel_w = filter->dim(3);
     const index_t *in_shape = input->shape().data();
     const index_t *out_shape = output->shape().data();
-    const index_t kernel_hw[2] = {kernel_h, kernel_w};
+    const index_t *filter_shape = filter->shape().data();
 
     MACE_CHECK(filter->dim(0) == out_shape[1], filter->dim(0), " != ",
                output_shape[1]);
@@ -283,15 +285,42 @@ struct Deconv2dFunctor : Deconv2dFunctorBase {
     int padding[2];
     padding[0] = (paddings_[0] + 1) >> 1;
     padding[1] = (paddings_[1] + 1) >> 1;
-    deconv::Deconv2dNCHW(input_data,
-                         filter_data,
-                         bias_data,
-                         in_shape,
-                         out_shape,
-                         kernel_hw,
-                         strides_,
-                         padding,
-                         output_data);
+
+    // The gather loop in deconv::Deconv2dNCHW recomputes the taps for every
+    // output pixel, Gemm + col2im is several times faster even when Gemm is
+    // not vectorized.
+    const index_t tile_rows = Deconv2dGemmTileRows(in_shape, filter_shape);
+    const index_t packed_filter_size =
+        packed_filter_.empty() ? filter->size() * sizeof(float) : 0;
+    const index_t col_buffer_size = out_shape[1] * filter_shape[2]
+        * filter_shape[3] * tile_rows * in_shape[3] * sizeof(float);
+    index_t tile_input_size = 0;
+    if (tile_rows != in_shape[2]) {
+      tile_input_size = in_shape[1] * tile_rows * in_shape[3] * sizeof(float);
+    }
+    scratch_->Rewind();
+    scratch_->GrowSize(packed_filter_size + col_buffer_size + tile_input_size);
+    Tensor packed_filter(scratch_->Scratch(packed_filter_size), DT_FLOAT);
+    Tensor col_buffer(scratch_->Scratch(col_buffer_size), DT_FLOAT);
+    Tensor tile_input(scratch_->Scratch(tile_input_size), DT_FLOAT);
+    const float *packed_filter_data = packed_filter_.data();
+    if (packed_filter_.empty()) {
+      Deconv2dPackFilter(filter_data, filter_shape,
+                         packed_filter.mutable_data<float>());
+      packed_filter_data = packed_filter.data<float>();
+    }
+    Deconv2dGemm(input_data,
+                 packed_filter_data,
+                 bias_data,
+                 in_shape,
+                 out_shape,
+                 filter_shape,
+                 strides_,
+                 padding,
+                 tile_rows,
+                 col_buffer.mutable_data<float>(),
+                 tile_input.mutable_data<float>(),
+                 output_data);
 
     DoActivation(output_data,
                  output_data,
@@ -301,6 +330,18 @@ struct Deconv2dFunctor : Deconv2dFunctorBase {
 
     return MACE_SUCCESS;
   }
+
+  // Packs a const filter once for Deconv2dGemm, see Deconv2dPackFilter.
+  MaceStatus PackFilter(const Tensor *filter, Tensor *in_place) {
+    const std::vector<index_t> filter_shape = filter->shape();
+    return packed_filter_.Pack(filter, in_place,
+                               [&](const float *weight, float *packed) {
+      Deconv2dPackFilter(weight, filter_shape.data(), packed);
+    });
+  }
+
+  ScratchBuffer *scratch_;
+  PackedWeight packed_filter_;
 };
 
 #ifdef MACE_ENABLE_OPENCL
@@ -311,13 +352,16 @@ struct Deconv2dFunctor<DeviceType::GPU, T> : Deconv2dFunctorBase {
                   const std::vector<int> &paddings,
                   const std::vector<index_t> &output_shape,
                   const ActivationType activation,
-                  const float relux_max_limit)
+                  const float relux_max_limit,
+                  ScratchBuffer *scratch)
       : Deconv2dFunctorBase(strides,
                             padding_type,
                             paddings,
                             output_shape,
                             activation,
-                            relux_max_limit) {}
+                            relux_max_limit) {
+    MACE_UNUSED(scratch);
+  }
 
   MaceStatus operator()(const Tensor *input,
                   const Tensor *filter,
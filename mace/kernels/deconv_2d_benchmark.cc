@@ -0,0 +1,115 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <vector>
+
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/arm/deconv_2d_gemm.h"
+#include "mace/kernels/deconv_2d.h"
+
+namespace mace {
+namespace kernels {
+namespace test {
+
+// Compare Gemm + col2im with the gather loop it replaces
+
+namespace {
+
+struct Deconv2dArgs {
+  Deconv2dArgs(int n, int c, int h, int w, int k, int s, int oc)
+      : in_shape{n, c, h, w},
+        // SAME padding, output = input * stride
+        out_shape{n, oc, h * s, w * s},
+        filter_shape{oc, c, k, k},
+        strides{s, s},
+        padding{(k + s - 1) / 2, (k + s - 1) / 2},
+        input(n * c * h * w),
+        filter(oc * c * k * k),
+        output(n * oc * h * s * w * s) {}
+
+  index_t in_shape[4];
+  index_t out_shape[4];
+  index_t filter_shape[4];
+  int strides[2];
+  int padding[2];
+  std::vector<float> input;
+  std::vector<float> filter;
+  std::vector<float> output;
+};
+
+void Deconv2dBenchmark_Gather(int iters, const Deconv2dArgs &args) {
+  mace::testing::StopTiming();
+  std::vector<float> output(args.output.size());
+  const index_t kernel_hw[2] = {args.filter_shape[2], args.filter_shape[3]};
+  mace::testing::StartTiming();
+  while (iters--) {
+    deconv::Deconv2dNCHW(args.input.data(), args.filter.data(),
+                         static_cast<const float *>(nullptr), args.in_shape,
+                         args.out_shape, kernel_hw, args.strides,
+                         args.padding, output.data());
+  }
+}
+
+void Deconv2dBenchmark_Gemm(int iters, const Deconv2dArgs &args) {
+  mace::testing::StopTiming();
+  const index_t tile_rows =
+      Deconv2dGemmTileRows(args.in_shape, args.filter_shape);
+  std::vector<float> output(args.output.size());
+  std::vector<float> packed_filter(args.filter.size());
+  std::vector<float> col_buffer(args.out_shape[1] * args.filter_shape[2]
+      * args.filter_shape[3] * tile_rows * args.in_shape[3]);
+  std::vector<float> tile_input(args.in_shape[1] * tile_rows
+      * args.in_shape[3]);
+  mace::testing::StartTiming();
+  while (iters--) {
+    Deconv2dPackFilter(args.filter.data(), args.filter_shape,
+                       packed_filter.data());
+    Deconv2dGemm(args.input.data(), packed_filter.data(), nullptr,
+                 args.in_shape, args.out_shape, args.filter_shape,
+                 args.strides, args.padding, tile_rows, col_buffer.data(),
+                 tile_input.data(), output.data());
+  }
+}
+
+}  // namespace
+
+#define MACE_BM_DECONV_2D_FUNC(N, C, H, W, K, S, OC, FUNC)                    \
+  static void MACE_BM_DECONV_2D_##N##_##C##_##H##_##W##_##K##_##S##_##OC##_\
+##FUNC(int iters) {                                                           \
+    const int64_t macc =                                                      \
+        static_cast<int64_t>(iters) * N * C * H * W * K * K * OC;             \
+    mace::testing::MaccProcessed(macc);                                       \
+    mace::testing::BytesProcessed(                                            \
+        static_cast<int64_t>(iters) * N * C * H * W * sizeof(float));         \
+    Deconv2dBenchmark_##FUNC(iters, Deconv2dArgs(N, C, H, W, K, S, OC));      \
+  }                                                                           \
+  MACE_BENCHMARK(MACE_BM_DECONV_2D_##N##_##C##_##H##_##W##_##K##_##S##_##OC##_\
+##FUNC)
+
+#define MACE_BM_DECONV_2D(N, C, H, W, K, S, OC)        \
+  MACE_BM_DECONV_2D_FUNC(N, C, H, W, K, S, OC, Gather); \
+  MACE_BM_DECONV_2D_FUNC(N, C, H, W, K, S, OC, Gemm);
+
+// Stride 2 upsampling in segmentation / super-resolution decoders
+MACE_BM_DECONV_2D(1, 64, 64, 64, 2, 2, 32);
+MACE_BM_DECONV_2D(1, 128, 32, 32, 4, 2, 64);
+MACE_BM_DECONV_2D(1, 21, 64, 64, 4, 2, 21);
+MACE_BM_DECONV_2D(1, 64, 32, 32, 3, 2, 64);
+MACE_BM_DECONV_2D(1, 32, 60, 60, 3, 1, 32);
+MACE_BM_DECONV_2D(1, 3, 224, 224, 7, 2, 32);
+
+}  // namespace test
+}  // namespace kernels
+}  // namespace mace
@@ -26,6 +26,10 @@
 #include "mace/kernels/conv_pool_2d_util.h"
 #include "mace/kernels/activation.h"
 #include "mace/kernels/arm/depthwise_conv2d_neon.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/nchwc.h"
+#include "mace/kernels/packed_weight.h"
+#include "mace/kernels/x86/depthwise_conv2d_avx2.h"
 #include "mace/public/mace.h"
 
 #ifdef MACE_ENABLE_OPENCL
@@ -60,6 +64,26 @@ struct DepthwiseConv2dFunctorBase {
 template<DeviceType D, typename T>
 struct DepthwiseConv2dFunctor;
 
+typedef void (*DepthwiseConv2dKernelFunc)(const float *input,
+                                          const float *filter,
+                                          const index_t *in_shape,
+                                          const index_t *out_shape,
+                                          const int *pad_hw,
+                                          const int *stride_hw,
+                                          const int *dilation_hw,
+                                          const index_t valid_h_start,
+                                          const index_t valid_h_stop,
+                                          const index_t valid_w_start,
+                                          const index_t valid_w_stop,
+                                          float *output);
+
+inline DepthwiseConv2dKernelFunc SelectDepthwiseConv2dKernel(
+    DepthwiseConv2dKernelFunc neon_func, DepthwiseConv2dKernelFunc avx2_func) {
+  return KernelDispatcher<DepthwiseConv2dKernelFunc>(neon_func)
+      .Register(CPU_ISA_AVX2, avx2_func)
+      .Select();
+}
+
 template<>
 struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
   : public DepthwiseConv2dFunctorBase {
@@ -84,6 +108,10 @@ struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
                               const int *stride_hw,
                               const int *dilation_hw,
                               const int *pad_hw,
+                              const index_t valid_h_start,
+                              const index_t valid_h_stop,
+                              const index_t valid_w_start,
+                              const index_t valid_w_stop,
                               float *output) {
     const index_t multiplier = filter_shape[0] / filter_shape[1];
 #pragma omp parallel for collapse(2)
@@ -104,6 +132,25 @@ struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
             index_t c = m / multiplier;
             index_t o = m % multiplier;
             float sum = 0;
+            if (h >= valid_h_start && h < valid_h_stop && w >= valid_w_start
+                && w < valid_w_stop) {
+              // the window is inside the input, no bounds checks needed
+              const float *in_ptr = input
+                  + ((b * in_channels + c) * in_height
+                      + h * stride_hw[0] - pad_hw[0]) * in_width
+                  + w * stride_hw[1] - pad_hw[1];
+              const float *filter_ptr =
+                  filter + (o * in_channels + c) * filter_height * filter_width;
+              for (index_t kh = 0; kh < filter_height; ++kh) {
+                for (index_t kw = 0; kw < filter_width; ++kw) {
+                  sum += in_ptr[kh * dilation_hw[0] * in_width
+                      + kw * dilation_hw[1]]
+                      * filter_ptr[kh * filter_width + kw];
+                }
+              }
+              output[out_offset] = sum;
+              continue;
+            }
             for (index_t kh = 0; kh < filter_height; ++kh) {
               for (index_t kw = 0; kw < filter_width; ++kw) {
                 index_t ih = h * stride_hw[0] + kh * dilation_hw[0] - pad_hw[0];
@@ -136,6 +183,9 @@ struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
     MACE_CHECK_NOTNULL(input);
     MACE_CHECK_NOTNULL(filter);
     MACE_CHECK_NOTNULL(output);
+    if (input->dim_size() == 5) {
+      return DepthwiseConvNCHWc(input, filter, bias, output);
+    }
 
     std::vector<index_t> output_shape(4);
     std::vector<int> paddings(2);
@@ -183,9 +233,6 @@ struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
     index_t stride_h = strides_[0];
     index_t stride_w = strides_[1];
 
-    index_t dilation_h = dilations_[0];
-    index_t dilation_w = dilations_[1];
-
     MACE_CHECK(batch == input_batch, "Input/Output batch size mismatch");
 
     int pad_top = paddings[0] >> 1;
@@ -217,33 +264,33 @@ struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
     const index_t input_shape[4] =
         {batch, input_channels, input_height, input_width};
 
-    if (filter_h == 3 && filter_w == 3 && stride_h == 1 && stride_w == 1
-      && dilation_h == 1 && dilation_w == 1) {
-      conv_func = [=](const float *input, float *output) {
-        DepthwiseConv2dNeonK3x3S1(input,
-                                  filter_data,
-                                  input_shape,
-                                  output_shape.data(),
-                                  pad_hw,
-                                  valid_h_start,
-                                  valid_h_stop,
-                                  valid_w_start,
-                                  valid_w_stop,
-                                  output);
-      };
-    } else if (filter_h == 3 && filter_w == 3 && stride_h == 2 && stride_w == 2
-      && dilation_h == 1 && dilation_w == 1) {
+    bool use_kxk_s12 = filter_h == filter_w && stride_h == stride_w
+        && (stride_h == 1 || stride_h == 2);
+    DepthwiseConv2dKernelFunc kernel = nullptr;
+    if (use_kxk_s12 && filter_h == 3) {
+      kernel = SelectDepthwiseConv2dKernel(
+          DepthwiseConv2dNeonK3x3, MACE_X86_KERNEL(DepthwiseConv2dAvx2K3x3));
+    } else if (use_kxk_s12 && filter_h == 5) {
+      kernel = SelectDepthwiseConv2dKernel(
+          DepthwiseConv2dNeonK5x5, MACE_X86_KERNEL(DepthwiseConv2dAvx2K5x5));
+    }
+
+    if (kernel != nullptr) {
+      MACE_CHECK(strides_[0] == strides_[1] && strides_[0] <= 2,
+                 "Unsupported stride: ", strides_[0], "x", strides_[1]);
       conv_func = [=](const float *input, float *output) {
-        DepthwiseConv2dNeonK3x3S2(input,
-                                  filter_data,
-                                  input_shape,
-                                  output_shape.data(),
-                                  pad_hw,
-                                  valid_h_start,
-                                  valid_h_stop,
-                                  valid_w_start,
-                                  valid_w_stop,
-                                  output);
+        kernel(input,
+               filter_data,
+               input_shape,
+               output_shape.data(),
+               pad_hw,
+               strides_,
+               dilations_,
+               valid_h_start,
+               valid_h_stop,
+               valid_w_start,
+               valid_w_stop,
+               output);
       };
     } else {
       conv_func = [=](const float *input, float *output) {
@@ -255,6 +302,10 @@ struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
                                strides_,
                                dilations_,
                                pad_hw,
+                               valid_h_start,
+                               valid_h_stop,
+                               valid_w_start,
+                               valid_w_stop,
                                output);
       };
     }
@@ -278,6 +329,89 @@ struct DepthwiseConv2dFunctor<DeviceType::CPU, float>
 
     return MACE_SUCCESS;
   }
+
+  // Packs a const filter once for DepthwiseConv2dNCHWc, see
+  // NCHWcPackDepthwiseFilter.
+  MaceStatus PackFilterNCHWc(const Tensor *filter,
+                             const int block,
+                             Tensor *in_place) {
+    const std::vector<index_t> filter_shape = filter->shape();
+    return packed_filter_nchwc_.Pack(filter, in_place,
+                                     [&](const float *weight, float *packed) {
+      NCHWcPackDepthwiseFilter(weight, filter_shape.data(), block, packed);
+    });
+  }
+
+  // input and output are blocked (NCHW4C/NCHW8C), see nchwc.h.
+  MaceStatus DepthwiseConvNCHWc(const Tensor *input,
+                                const Tensor *filter,
+                                const Tensor *bias,
+                                Tensor *output) {
+    const index_t block = input->dim(4);
+    const std::vector<index_t> &filter_shape = filter->shape();
+    MACE_CHECK(filter_shape[0] == 1 && filter_shape[1] == input->dim(1) * block,
+               "blocked depthwise conv only supports channel multiplier 1");
+
+    // The NCHW shape helpers see channel blocks as channels.
+    const index_t blocked_filter_shape[4] = {
+        input->dim(1), input->dim(1), filter_shape[2], filter_shape[3]};
+    std::vector<index_t> output_shape(5);
+    std::vector<int> paddings(2);
+    if (paddings_.empty()) {
+      CalcNCHWPaddingAndOutputSize(input->shape().data(),
+                                   blocked_filter_shape,
+                                   dilations_,
+                                   strides_,
+                                   padding_type_,
+                                   output_shape.data(),
+                                   paddings.data());
+    } else {
+      paddings = paddings_;
+      CalcNCHWOutputSize(input->shape().data(),
+                         blocked_filter_shape,
+                         paddings_.data(),
+                         dilations_,
+                         strides_,
+                         RoundType::FLOOR,
+                         output_shape.data());
+    }
+    output_shape[4] = block;
+    MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+
+    Tensor::MappingGuard input_guard(input);
+    Tensor::MappingGuard filter_guard(filter);
+    Tensor::MappingGuard bias_guard(bias);
+    Tensor::MappingGuard output_guard(output);
+
+    std::vector<float> packed_filter;
+    const float *packed_filter_data = packed_filter_nchwc_.data();
+    if (packed_filter_nchwc_.empty()) {
+      packed_filter.resize(filter->size());
+      NCHWcPackDepthwiseFilter(filter->data<float>(), filter_shape.data(),
+                               block, packed_filter.data());
+      packed_filter_data = packed_filter.data();
+    }
+
+    Epilogue epilogue;
+    epilogue.bias = bias == nullptr ? nullptr : bias->data<float>();
+    epilogue.activation = activation_;
+    epilogue.relux_max_limit = relux_max_limit_;
+
+    const int pad_hw[2] = {paddings[0] >> 1, paddings[1] >> 1};
+    DepthwiseConv2dNCHWc(input->data<float>(),
+                         packed_filter_data,
+                         input->shape().data(),
+                         output_shape.data(),
+                         filter_shape.data() + 2,
+                         strides_,
+                         dilations_,
+                         pad_hw,
+                         epilogue,
+                         output->mutable_data<float>());
+    return MACE_SUCCESS;
+  }
+
+  PackedWeight packed_filter_nchwc_;
 };
 
 #ifdef MACE_ENABLE_OPENCL
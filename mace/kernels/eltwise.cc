@@ -0,0 +1,558 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "mace/kernels/eltwise.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/vector_math.h"
+#include "mace/kernels/x86/eltwise_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Output elements of a parallel task, longer rows are split.
+const index_t kEltwiseTileSize = 16384;
+
+static_assert(ELTWISE_ROW_AVX2_SUM == static_cast<int>(SUM) &&
+                  ELTWISE_ROW_AVX2_SUB == static_cast<int>(SUB) &&
+                  ELTWISE_ROW_AVX2_PROD == static_cast<int>(PROD) &&
+                  ELTWISE_ROW_AVX2_DIV == static_cast<int>(DIV) &&
+                  ELTWISE_ROW_AVX2_MIN == static_cast<int>(MIN) &&
+                  ELTWISE_ROW_AVX2_MAX == static_cast<int>(MAX) &&
+                  ELTWISE_ROW_AVX2_NEG == static_cast<int>(NEG) &&
+                  ELTWISE_ROW_AVX2_ABS == static_cast<int>(ABS) &&
+                  ELTWISE_ROW_AVX2_SQR_DIFF == static_cast<int>(SQR_DIFF),
+              "EltwiseRowAvx2Type must match EltwiseType");
+
+typedef void (*EltwiseRowFunc)(const int type,
+                               const float *input0,
+                               const index_t stride0,
+                               const float *input1,
+                               const index_t stride1,
+                               const float *coeff,
+                               const index_t size,
+                               float *output);
+
+// The element ops, for any scalar type and for a NEON float vector.
+
+struct SumOp {
+  template <typename T>
+  T operator()(const T a, const T b) const { return a + b; }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vaddq_f32(a, b);
+  }
+#endif
+};
+
+struct CoeffSumOp {
+  explicit CoeffSumOp(const float *coeff)
+      : coeff0(coeff[0]), coeff1(coeff[1]) {}
+  template <typename T>
+  T operator()(const T a, const T b) const {
+    return static_cast<T>(a * coeff0 + b * coeff1);
+  }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vmlaq_n_f32(vmulq_n_f32(a, coeff0), b, coeff1);
+  }
+#endif
+  const float coeff0;
+  const float coeff1;
+};
+
+struct SubOp {
+  template <typename T>
+  T operator()(const T a, const T b) const { return a - b; }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vsubq_f32(a, b);
+  }
+#endif
+};
+
+struct ProdOp {
+  template <typename T>
+  T operator()(const T a, const T b) const { return a * b; }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vmulq_f32(a, b);
+  }
+#endif
+};
+
+struct DivOp {
+  template <typename T>
+  T operator()(const T a, const T b) const { return a / b; }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return Div4(a, b);
+  }
+#endif
+};
+
+struct MinOp {
+  template <typename T>
+  T operator()(const T a, const T b) const { return std::min(a, b); }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vminq_f32(a, b);
+  }
+#endif
+};
+
+struct MaxOp {
+  template <typename T>
+  T operator()(const T a, const T b) const { return std::max(a, b); }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vmaxq_f32(a, b);
+  }
+#endif
+};
+
+struct SqrDiffOp {
+  template <typename T>
+  T operator()(const T a, const T b) const { return (a - b) * (a - b); }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    const float32x4_t diff = vsubq_f32(a, b);
+    return vmulq_f32(diff, diff);
+  }
+#endif
+};
+
+struct NegOp {
+  template <typename T>
+  T operator()(const T a, const T b) const {
+    MACE_UNUSED(b);
+    return -a;
+  }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    MACE_UNUSED(b);
+    return vnegq_f32(a);
+  }
+#endif
+};
+
+struct AbsOp {
+  template <typename T>
+  T operator()(const T a, const T b) const {
+    MACE_UNUSED(b);
+    return std::abs(a);
+  }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    MACE_UNUSED(b);
+    return vabsq_f32(a);
+  }
+#endif
+};
+
+struct PowOp {
+  template <typename T>
+  T operator()(const T a, const T b) const {
+    return static_cast<T>(std::pow(a, b));
+  }
+};
+
+struct EqualOp {
+  template <typename T>
+  bool operator()(const T a, const T b) const { return a == b; }
+};
+
+// output[i] = op(input0[i * stride0], input1[i * stride1]), the strides are
+// 0 or 1 and not both 0. The loops are simple enough to be vectorized by
+// the compiler for integer types.
+template <typename Op, typename T, typename DstType>
+void EltwiseRowScalar(const Op &op,
+                      const T *input0,
+                      const index_t stride0,
+                      const T *input1,
+                      const index_t stride1,
+                      const index_t size,
+                      DstType *output) {
+  if (stride0 == 1 && stride1 == 1) {
+    for (index_t i = 0; i < size; ++i) {
+      output[i] = op(input0[i], input1[i]);
+    }
+  } else if (stride0 == 1) {
+    const T b = input1[0];
+    for (index_t i = 0; i < size; ++i) {
+      output[i] = op(input0[i], b);
+    }
+  } else {
+    const T a = input0[0];
+    for (index_t i = 0; i < size; ++i) {
+      output[i] = op(a, input1[i]);
+    }
+  }
+}
+
+template <typename Op>
+void EltwiseRowVector(const Op &op,
+                      const float *input0,
+                      const index_t stride0,
+                      const float *input1,
+                      const index_t stride1,
+                      const index_t size,
+                      float *output) {
+  index_t i = 0;
+#if defined(MACE_ENABLE_NEON)
+  if (stride0 == 1 && stride1 == 1) {
+    for (; i + 4 <= size; i += 4) {
+      vst1q_f32(output + i, op(vld1q_f32(input0 + i), vld1q_f32(input1 + i)));
+    }
+  } else if (stride0 == 1) {
+    const float32x4_t b = vdupq_n_f32(input1[0]);
+    for (; i + 4 <= size; i += 4) {
+      vst1q_f32(output + i, op(vld1q_f32(input0 + i), b));
+    }
+  } else {
+    const float32x4_t a = vdupq_n_f32(input0[0]);
+    for (; i + 4 <= size; i += 4) {
+      vst1q_f32(output + i, op(a, vld1q_f32(input1 + i)));
+    }
+  }
+#endif
+  EltwiseRowScalar(op, input0 + i * stride0, stride0, input1 + i * stride1,
+                   stride1, size - i, output + i);
+}
+
+// The float row of every type but POW and EQUAL.
+void EltwiseRowFloat(const int type,
+                     const float *input0,
+                     const index_t stride0,
+                     const float *input1,
+                     const index_t stride1,
+                     const float *coeff,
+                     const index_t size,
+                     float *output) {
+  switch (static_cast<EltwiseType>(type)) {
+    case SUM:
+      if (coeff == nullptr) {
+        EltwiseRowVector(SumOp(), input0, stride0, input1, stride1, size,
+                         output);
+      } else {
+        EltwiseRowVector(CoeffSumOp(coeff), input0, stride0, input1, stride1,
+                         size, output);
+      }
+      break;
+    case SUB:
+      EltwiseRowVector(SubOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case PROD:
+      EltwiseRowVector(ProdOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case DIV:
+      EltwiseRowVector(DivOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case MIN:
+      EltwiseRowVector(MinOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case MAX:
+      EltwiseRowVector(MaxOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case SQR_DIFF:
+      EltwiseRowVector(SqrDiffOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case NEG:
+      EltwiseRowVector(NegOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case ABS:
+      EltwiseRowVector(AbsOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    default:
+      LOG(FATAL) << "Eltwise op not support type " << type;
+  }
+}
+
+// The row of any type for any input and output types.
+template <typename T, typename DstType>
+void EltwiseRowGeneral(const EltwiseType type,
+                       const T *input0,
+                       const index_t stride0,
+                       const T *input1,
+                       const index_t stride1,
+                       const float *coeff,
+                       const index_t size,
+                       DstType *output) {
+  switch (type) {
+    case SUM:
+      if (coeff == nullptr) {
+        EltwiseRowScalar(SumOp(), input0, stride0, input1, stride1, size,
+                         output);
+      } else {
+        EltwiseRowScalar(CoeffSumOp(coeff), input0, stride0, input1, stride1,
+                         size, output);
+      }
+      break;
+    case SUB:
+      EltwiseRowScalar(SubOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case PROD:
+      EltwiseRowScalar(ProdOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case DIV:
+      EltwiseRowScalar(DivOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case MIN:
+      EltwiseRowScalar(MinOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case MAX:
+      EltwiseRowScalar(MaxOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case SQR_DIFF:
+      EltwiseRowScalar(SqrDiffOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case NEG:
+      EltwiseRowScalar(NegOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case ABS:
+      EltwiseRowScalar(AbsOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case POW:
+      EltwiseRowScalar(PowOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    case EQUAL:
+      EltwiseRowScalar(EqualOp(), input0, stride0, input1, stride1, size,
+                       output);
+      break;
+    default:
+      LOG(FATAL) << "Eltwise op not support type " << type;
+  }
+}
+
+// Runs row(input0_row, stride0, input1_row, stride1, size, output_row) over
+// the output. Output dims of 1 are dropped and neighbouring dims in which
+// each input is either broadcast in both or in none are merged, so that
+// e.g. [N, H, W, C] + [C] is [N * H * W, C] + [1, C] and
+// [N, C, H, W] + [1, C, 1, 1] is [N, C, H * W] + [1, C, 1]. The last merged
+// dim is the row, in which each input is contiguous or a single value.
+template <typename T, typename DstType, typename RowFunc>
+void BroadcastRows(const T *input0,
+                   const std::vector<index_t> &input0_shape,
+                   const T *input1,
+                   const std::vector<index_t> &input1_shape,
+                   const std::vector<index_t> &output_shape,
+                   DstType *output,
+                   const RowFunc &row) {
+  std::vector<index_t> dims;
+  std::vector<bool> broadcast0;
+  std::vector<bool> broadcast1;
+  for (size_t i = 0; i < output_shape.size(); ++i) {
+    if (output_shape[i] == 1) continue;
+    const bool b0 = input0_shape[i] == 1;
+    const bool b1 = input1_shape[i] == 1;
+    if (!dims.empty() && broadcast0.back() == b0 && broadcast1.back() == b1) {
+      dims.back() *= output_shape[i];
+    } else {
+      dims.push_back(output_shape[i]);
+      broadcast0.push_back(b0);
+      broadcast1.push_back(b1);
+    }
+  }
+  if (dims.empty()) {
+    dims.push_back(1);
+    broadcast0.push_back(false);
+    broadcast1.push_back(false);
+  }
+
+  const int rank = static_cast<int>(dims.size());
+  std::vector<index_t> strides0(rank);
+  std::vector<index_t> strides1(rank);
+  index_t size0 = 1;
+  index_t size1 = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    strides0[i] = broadcast0[i] ? 0 : size0;
+    strides1[i] = broadcast1[i] ? 0 : size1;
+    size0 *= broadcast0[i] ? 1 : dims[i];
+    size1 *= broadcast1[i] ? 1 : dims[i];
+  }
+
+  const index_t row_size = dims.back();
+  const index_t row_stride0 = strides0.back();
+  const index_t row_stride1 = strides1.back();
+  const index_t rows =
+      std::accumulate(dims.begin(), dims.end() - 1, static_cast<index_t>(1),
+                      std::multiplies<index_t>());
+  const index_t tiles = (row_size + kEltwiseTileSize - 1) / kEltwiseTileSize;
+
+#pragma omp parallel for collapse(2)
+  for (index_t r = 0; r < rows; ++r) {
+    for (index_t t = 0; t < tiles; ++t) {
+      index_t offset0 = 0;
+      index_t offset1 = 0;
+      index_t index = r;
+      for (int i = rank - 2; i >= 0; --i) {
+        const index_t dim_index = index % dims[i];
+        index /= dims[i];
+        offset0 += dim_index * strides0[i];
+        offset1 += dim_index * strides1[i];
+      }
+      const index_t start = t * kEltwiseTileSize;
+      row(input0 + offset0 + start * row_stride0, row_stride0,
+          input1 + offset1 + start * row_stride1, row_stride1,
+          std::min(kEltwiseTileSize, row_size - start),
+          output + r * row_size + start);
+    }
+  }
+}
+
+template <typename T, typename DstType>
+void BroadcastEltwiseImpl(const EltwiseType type,
+                          const T *input0,
+                          const std::vector<index_t> &input0_shape,
+                          const T *input1,
+                          const std::vector<index_t> &input1_shape,
+                          const float *coeff,
+                          const std::vector<index_t> &output_shape,
+                          DstType *output) {
+  BroadcastRows(input0, input0_shape, input1, input1_shape, output_shape,
+                output,
+                [=](const T *in0, const index_t stride0, const T *in1,
+                    const index_t stride1, const index_t size, DstType *out) {
+                  EltwiseRowGeneral(type, in0, stride0, in1, stride1, coeff,
+                                    size, out);
+                });
+}
+
+void BroadcastEltwiseImpl(const EltwiseType type,
+                          const float *input0,
+                          const std::vector<index_t> &input0_shape,
+                          const float *input1,
+                          const std::vector<index_t> &input1_shape,
+                          const float *coeff,
+                          const std::vector<index_t> &output_shape,
+                          float *output) {
+  BroadcastRows(input0, input0_shape, input1, input1_shape, output_shape,
+                output,
+                [=](const float *in0, const index_t stride0,
+                    const float *in1, const index_t stride1,
+                    const index_t size, float *out) {
+                  EltwiseRow(type, in0, stride0, in1, stride1, coeff, size,
+                             out);
+                });
+}
+
+}  // namespace
+
+void EltwiseRow(const EltwiseType type,
+                const float *input0,
+                const index_t stride0,
+                const float *input1,
+                const index_t stride1,
+                const float *coeff,
+                const index_t size,
+                float *output) {
+  static const EltwiseRowFunc row_func =
+      KernelDispatcher<EltwiseRowFunc>(EltwiseRowFloat)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(EltwiseRowAvx2))
+          .Select();
+  if (type == EQUAL) {
+    LOG(FATAL) << "Eltwise row not support type " << type;
+  } else if (type != POW) {
+    row_func(type, input0, stride0, input1, stride1, coeff, size, output);
+  } else if (stride0 == 0 || stride1 == 1) {
+    EltwiseRowScalar(PowOp(), input0, stride0, input1, stride1, size, output);
+  } else {
+    // a single exponent, common in normalizations
+    const float exponent = input1[0];
+    if (exponent == 2.f) {
+      row_func(PROD, input0, 1, input0, 1, nullptr, size, output);
+    } else if (exponent != std::floor(exponent)) {
+      // std::pow of a negative input is NaN as well
+      VectorPow(input0, exponent, size, output);
+    } else {
+      EltwiseRowScalar(PowOp(), input0, stride0, input1, stride1, size,
+                       output);
+    }
+  }
+}
+
+template <typename T, typename DstType>
+void BroadcastEltwise(const EltwiseType type,
+                      const T *input0,
+                      const std::vector<index_t> &input0_shape,
+                      const T *input1,
+                      const std::vector<index_t> &input1_shape,
+                      const std::vector<float> &coeff,
+                      const std::vector<index_t> &output_shape,
+                      DstType *output) {
+  MACE_CHECK(coeff.empty() || coeff.size() == 2,
+             "Eltwise op needs 0 or 2 coefficients, got ", coeff.size());
+  BroadcastEltwiseImpl(type, input0, input0_shape, input1, input1_shape,
+                       coeff.empty() ? nullptr : coeff.data(), output_shape,
+                       output);
+}
+
+template void BroadcastEltwise<float, float>(
+    const EltwiseType type,
+    const float *input0,
+    const std::vector<index_t> &input0_shape,
+    const float *input1,
+    const std::vector<index_t> &input1_shape,
+    const std::vector<float> &coeff,
+    const std::vector<index_t> &output_shape,
+    float *output);
+template void BroadcastEltwise<float, int32_t>(
+    const EltwiseType type,
+    const float *input0,
+    const std::vector<index_t> &input0_shape,
+    const float *input1,
+    const std::vector<index_t> &input1_shape,
+    const std::vector<float> &coeff,
+    const std::vector<index_t> &output_shape,
+    int32_t *output);
+template void BroadcastEltwise<int32_t, int32_t>(
+    const EltwiseType type,
+    const int32_t *input0,
+    const std::vector<index_t> &input0_shape,
+    const int32_t *input1,
+    const std::vector<index_t> &input1_shape,
+    const std::vector<float> &coeff,
+    const std::vector<index_t> &output_shape,
+    int32_t *output);
+
+}  // namespace kernels
+}  // namespace mace
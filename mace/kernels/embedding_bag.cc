@@ -0,0 +1,47 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mace/kernels/embedding_bag.h"
+
+namespace mace {
+namespace kernels {
+
+void EmbeddingBag(const ReduceType type,
+                  const float *params,
+                  const index_t row_size,
+                  const int32_t *indices,
+                  const index_t index_size,
+                  const int32_t *offsets,
+                  const index_t bags,
+                  float *output) {
+  const index_t bag_size = offsets == nullptr && bags > 0
+                           ? index_size / bags : 0;
+#pragma omp parallel for schedule(dynamic, 1)
+  for (index_t b = 0; b < bags; ++b) {
+    index_t begin = b * bag_size;
+    index_t end = begin + bag_size;
+    if (offsets != nullptr) {
+      begin = offsets[b];
+      end = b + 1 < bags ? offsets[b + 1] : index_size;
+    }
+    const index_t count = end - begin;
+    PoolRows(params, indices + begin, count, row_size,
+             type == REDUCE_MEAN && count > 0 ? 1.f / count : 1.f,
+             output + b * row_size);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
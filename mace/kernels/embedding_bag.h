@@ -0,0 +1,116 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_EMBEDDING_BAG_H_
+#define MACE_KERNELS_EMBEDDING_BAG_H_
+
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "mace/core/future.h"
+#include "mace/core/tensor.h"
+#include "mace/kernels/gather.h"
+#include "mace/kernels/reduce.h"
+#include "mace/public/mace.h"
+
+namespace mace {
+namespace kernels {
+
+// output[b] = sum or mean of the rows of params, seen as
+// [vocab, row_size], that the indices of bag b pick. Bag b is
+// indices[offsets[b], offsets[b + 1]), up to index_size for the last one,
+// or with offsets nullptr, bags of index_size / bags consecutive indices.
+// Rows are accumulated straight into output, the gathered rows are never
+// stored. Empty bags are 0.
+void EmbeddingBag(const ReduceType type,
+                  const float *params,
+                  const index_t row_size,
+                  const int32_t *indices,
+                  const index_t index_size,
+                  const int32_t *offsets,
+                  const index_t bags,
+                  float *output);
+
+template <DeviceType D, typename T>
+struct EmbeddingBagFunctor;
+
+template <>
+struct EmbeddingBagFunctor<DeviceType::CPU, float> {
+  explicit EmbeddingBagFunctor(const ReduceType type) : type_(type) {}
+
+  MaceStatus operator()(const Tensor *params,
+                        const Tensor *indices,
+                        const Tensor *offsets,
+                        Tensor *output,
+                        StatsFuture *future) {
+    MACE_UNUSED(future);
+    MACE_CHECK(type_ == REDUCE_SUM || type_ == REDUCE_MEAN,
+               "EmbeddingBag only supports sum and mean, got ", type_);
+    MACE_CHECK(params->dim_size() >= 1 && params->dim(0) > 0,
+               "EmbeddingBag needs a non-empty params table");
+    const index_t index_size = indices->size();
+    index_t bags;
+    std::vector<index_t> output_shape;
+    if (offsets != nullptr) {
+      MACE_CHECK(indices->dim_size() == 1 && offsets->dim_size() == 1,
+                 "EmbeddingBag with offsets needs 1-D indices and offsets");
+      bags = offsets->dim(0);
+      output_shape.push_back(bags);
+    } else {
+      // the last axis of the indices is the bag
+      MACE_CHECK(indices->dim_size() >= 1,
+                 "EmbeddingBag without offsets needs indices of rank >= 1");
+      output_shape.assign(indices->shape().begin(),
+                          indices->shape().end() - 1);
+      bags = std::accumulate(output_shape.begin(), output_shape.end(), 1,
+                             std::multiplies<index_t>());
+    }
+    output_shape.insert(output_shape.end(), params->shape().begin() + 1,
+                        params->shape().end());
+    MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+
+    Tensor::MappingGuard params_guard(params);
+    Tensor::MappingGuard indices_guard(indices);
+    Tensor::MappingGuard output_guard(output);
+    const int32_t *indices_data = indices->data<int32_t>();
+    const int32_t *offsets_data = nullptr;
+    std::unique_ptr<Tensor::MappingGuard> offsets_guard;
+    if (offsets != nullptr) {
+      offsets_guard.reset(new Tensor::MappingGuard(offsets));
+      offsets_data = offsets->data<int32_t>();
+      for (index_t b = 0; b < bags; ++b) {
+        MACE_CHECK(offsets_data[b] >= 0 && offsets_data[b] <= index_size
+                   && (b == 0 || offsets_data[b] >= offsets_data[b - 1]),
+                   "EmbeddingBag offsets must be ascending within [0, ",
+                   index_size, "], got ", offsets_data[b], " at ", b);
+      }
+    }
+    CheckIndices(indices_data, index_size, params->dim(0));
+
+    EmbeddingBag(type_, params->data<float>(), params->size() / params->dim(0),
+                 indices_data, index_size, offsets_data, bags,
+                 output->mutable_data<float>());
+    return MACE_SUCCESS;
+  }
+
+  const ReduceType type_;
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_EMBEDDING_BAG_H_
@@ -0,0 +1,124 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+#include <algorithm>
+#include <limits>
+
+#include "mace/kernels/epilogue.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/vector_math.h"
+#include "mace/kernels/x86/epilogue_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+typedef void (*EpilogueLinearFunc)(const float *input,
+                                   const float *residual,
+                                   const float bias,
+                                   const float negative_slope,
+                                   const float max_limit,
+                                   const index_t size,
+                                   float *output);
+
+// x = input + bias + residual
+// output = min(x < 0 ? x * negative_slope : x, max_limit)
+void EpilogueLinear(const float *input,
+                    const float *residual,
+                    const float bias,
+                    const float negative_slope,
+                    const float max_limit,
+                    const index_t size,
+                    float *output) {
+  index_t i = 0;
+#if defined(MACE_ENABLE_NEON)
+  const float32x4_t vbias = vdupq_n_f32(bias);
+  const float32x4_t vslope = vdupq_n_f32(negative_slope);
+  const float32x4_t vmax = vdupq_n_f32(max_limit);
+  const float32x4_t vzero = vdupq_n_f32(0.f);
+  for (; i + 3 < size; i += 4) {
+    float32x4_t v = vaddq_f32(vld1q_f32(input + i), vbias);
+    if (residual != nullptr) {
+      v = vaddq_f32(v, vld1q_f32(residual + i));
+    }
+    const uint32x4_t negative = vcltq_f32(v, vzero);
+    v = vbslq_f32(negative, vmulq_f32(v, vslope), v);
+    vst1q_f32(output + i, vminq_f32(v, vmax));
+  }
+#endif
+  for (; i < size; ++i) {
+    float x = input[i] + bias;
+    if (residual != nullptr) {
+      x += residual[i];
+    }
+    x = x < 0 ? x * negative_slope : x;
+    output[i] = std::min(x, max_limit);
+  }
+}
+
+}  // namespace
+
+void Epilogue::Apply(const float *input,
+                     const index_t channel,
+                     const index_t offset,
+                     const index_t size,
+                     float *output) const {
+  static const EpilogueLinearFunc linear =
+      KernelDispatcher<EpilogueLinearFunc>(EpilogueLinear)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(EpilogueLinearAvx2))
+          .Select();
+
+  // Everything but tanh and sigmoid is piecewise linear.
+  float negative_slope = 1.f;
+  float max_limit = std::numeric_limits<float>::infinity();
+  switch (activation) {
+    case NOOP:
+    case TANH:
+    case SIGMOID:
+      break;
+    case RELU:
+      negative_slope = 0.f;
+      break;
+    case RELUX:
+      negative_slope = 0.f;
+      max_limit = relux_max_limit;
+      break;
+    case PRELU:
+      negative_slope = prelu_alpha[channel];
+      break;
+    default:
+      LOG(FATAL) << "Unknown activation type: " << activation;
+  }
+  linear(input,
+         residual == nullptr ? nullptr
+                             : residual + channel * residual_stride + offset,
+         bias == nullptr ? 0.f : bias[channel],
+         negative_slope,
+         max_limit,
+         size,
+         output);
+
+  if (activation == TANH) {
+    VectorTanh(output, size, output);
+  } else if (activation == SIGMOID) {
+    VectorSigmoid(output, size, output);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
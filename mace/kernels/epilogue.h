@@ -0,0 +1,75 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_EPILOGUE_H_
+#define MACE_KERNELS_EPILOGUE_H_
+
+#include "mace/core/types.h"
+#include "mace/kernels/activation.h"
+
+namespace mace {
+namespace kernels {
+
+// Element-wise work fused into the end of conv and Gemm kernels:
+//
+//   output[c][i] = activation(output[c][i] + bias[c] + residual[c][i])
+//
+// c is the output channel, i.e. the row of a Gemm output. Kernels apply it to
+// each block of output as soon as the block is final, while it is still in
+// cache, instead of making separate passes over the whole output. Every part
+// is optional.
+struct Epilogue {
+  Epilogue()
+      : bias(nullptr),
+        residual(nullptr),
+        residual_stride(0),
+        activation(NOOP),
+        relux_max_limit(0.f),
+        prelu_alpha(nullptr) {}
+
+  bool empty() const {
+    return bias == nullptr && residual == nullptr && activation == NOOP;
+  }
+
+  // A copy whose residual starts `offset` elements further, e.g. at the next
+  // image of a batch.
+  Epilogue Offset(const index_t offset) const {
+    Epilogue epilogue = *this;
+    if (residual != nullptr) {
+      epilogue.residual += offset;
+    }
+    return epilogue;
+  }
+
+  // Apply to `size` values of `channel` starting at `offset` within the
+  // channel. The residual of them starts at
+  // residual + channel * residual_stride + offset. input may be output.
+  void Apply(const float *input,
+             const index_t channel,
+             const index_t offset,
+             const index_t size,
+             float *output) const;
+
+  const float *bias;  // [channels]
+  const float *residual;
+  index_t residual_stride;
+  ActivationType activation;
+  float relux_max_limit;
+  const float *prelu_alpha;  // [channels], for PRELU only
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_EPILOGUE_H_
@@ -22,6 +22,7 @@
 #include "mace/core/tensor.h"
 #include "mace/kernels/activation.h"
 #include "mace/kernels/gemm.h"
+#include "mace/kernels/sparse_gemm.h"
 
 #ifdef MACE_ENABLE_OPENCL
 #include "mace/core/runtime/opencl/cl2_header.h"
@@ -48,7 +49,9 @@ template <>
 struct FullyConnectedFunctor<DeviceType::CPU, float>: FullyConnectedBase {
   FullyConnectedFunctor(const ActivationType activation,
                         const float relux_max_limit)
-      : FullyConnectedBase(activation, relux_max_limit) {}
+      : FullyConnectedBase(activation, relux_max_limit),
+        sparse_row_ptr_(nullptr),
+        sparse_col_idx_(nullptr) {}
 
   MaceStatus operator()(const Tensor *input,
                   const Tensor *weight,
@@ -56,6 +59,10 @@ struct FullyConnectedFunctor<DeviceType::CPU, float>: FullyConnectedBase {
                   Tensor *output,
                   StatsFuture *future) {
     MACE_UNUSED(future);
+    MACE_CHECK(activation_ != PRELU, "PRELU is not supported");
+    if (sparse_row_ptr_ != nullptr) {
+      return SparseFC(input, weight, bias, output);
+    }
     std::vector<index_t> output_shape = {input->dim(0), weight->dim(0), 1, 1};
     MACE_RETURN_IF_ERROR(output->Resize(output_shape));
     const index_t N = output->dim(0);
@@ -71,18 +78,75 @@ struct FullyConnectedFunctor<DeviceType::CPU, float>: FullyConnectedBase {
     const float *bias_ptr = bias == nullptr ? nullptr : bias->data<float>();
     float *output_ptr = output->mutable_data<float>();
 
-    Gemv(weight_ptr, input_ptr, N, input_size, output_size, output_ptr);
-    for (int i = 0; i < N; ++i) {
-      for (int j = 0; j < output_size; ++j) {
-        output_ptr[j + i * output_size] += bias_ptr[j];
-      }
-    }
+    // Weights are streamed once per kBatchedGemvTileBatch inputs, bias and
+    // activation are applied right after each block is computed. Even for
+    // large batches this measures faster than the blocked Gemm.
+    Epilogue epilogue;
+    epilogue.bias = bias_ptr;
+    epilogue.activation = activation_;
+    epilogue.relux_max_limit = relux_max_limit_;
+    BatchedGemv(weight_ptr, input_ptr, N, input_size, output_size, output_ptr,
+                &epilogue);
+
+    return MACE_SUCCESS;
+  }
+
+  // Makes operator() take the weight as the values of a block sparse weight
+  // of weight_shape (OIHW), see BlockSparseMatrix: weight is
+  // [blocks, block_rows, block_cols] and row_ptr and col_idx give the blocks.
+  void SetSparseWeight(const std::vector<index_t> &weight_shape,
+                       const Tensor *row_ptr,
+                       const Tensor *col_idx) {
+    MACE_CHECK(weight_shape.size() == 4, "Invalid sparse weight shape ",
+               MakeString(weight_shape));
+    sparse_weight_shape_ = weight_shape;
+    sparse_row_ptr_ = row_ptr;
+    sparse_col_idx_ = col_idx;
+  }
 
-    DoActivation(output_ptr, output_ptr, output->size(), activation_,
-                 relux_max_limit_);
+  MaceStatus SparseFC(const Tensor *input,
+                      const Tensor *weight,
+                      const Tensor *bias,
+                      Tensor *output) {
+    const index_t output_size = sparse_weight_shape_[0];
+    const index_t input_size = sparse_weight_shape_[1]
+        * sparse_weight_shape_[2] * sparse_weight_shape_[3];
+    MACE_CHECK(weight->dim_size() == 3
+                   && sparse_row_ptr_->size()
+                       == output_size / weight->dim(1) + 1,
+               "Invalid sparse weight ", MakeString(weight->shape()));
+    std::vector<index_t> output_shape = {input->dim(0), output_size, 1, 1};
+    MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+
+    Tensor::MappingGuard guard_input(input);
+    Tensor::MappingGuard guard_weight(weight);
+    Tensor::MappingGuard guard_row_ptr(sparse_row_ptr_);
+    Tensor::MappingGuard guard_col_idx(sparse_col_idx_);
+    Tensor::MappingGuard guard_bias(bias);
+    Tensor::MappingGuard guard_output(output);
+
+    BlockSparseMatrix sparse_weight;
+    sparse_weight.rows = output_size;
+    sparse_weight.cols = input_size;
+    sparse_weight.block_rows = static_cast<int>(weight->dim(1));
+    sparse_weight.block_cols = static_cast<int>(weight->dim(2));
+    sparse_weight.row_ptr = sparse_row_ptr_->data<int32_t>();
+    sparse_weight.col_idx = sparse_col_idx_->data<int32_t>();
+    sparse_weight.values = weight->data<float>();
+
+    Epilogue epilogue;
+    epilogue.bias = bias == nullptr ? nullptr : bias->data<float>();
+    epilogue.activation = activation_;
+    epilogue.relux_max_limit = relux_max_limit_;
+    SparseBatchedGemv(sparse_weight, input->data<float>(), input->dim(0),
+                      output->mutable_data<float>(), &epilogue);
 
     return MACE_SUCCESS;
   }
+
+  std::vector<index_t> sparse_weight_shape_;
+  const Tensor *sparse_row_ptr_;
+  const Tensor *sparse_col_idx_;
 };
 
 #ifdef MACE_ENABLE_OPENCL
@@ -0,0 +1,235 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "mace/kernels/eltwise.h"
+#include "mace/kernels/fused_elementwise.h"
+#include "mace/kernels/vector_math.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Elements of a tile, small enough to stay in L1 between the steps
+const index_t kFusedElementwiseTileSize = 1024;
+// Channels with at least this many elements are processed a channel at a
+// time with a scalar operand, smaller ones are interleaved in the tiles.
+const index_t kFusedElementwiseMinPlaneSize = 16;
+
+// output[i] = step(input[i], operand[i * operand_stride]), operand_stride is
+// 0 or 1.
+void ApplyStep(const FusedElementwiseType type,
+               const float *operand,
+               const index_t operand_stride,
+               const float *input,
+               const index_t size,
+               float *output) {
+  const float zero = 0.f;
+  switch (type) {
+    case FUSED_ADD:
+      EltwiseRow(SUM, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_SUB:
+      EltwiseRow(SUB, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_RSUB:
+      EltwiseRow(SUB, operand, operand_stride, input, 1, nullptr, size,
+                 output);
+      break;
+    case FUSED_MUL:
+      EltwiseRow(PROD, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_DIV:
+      EltwiseRow(DIV, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_RDIV:
+      EltwiseRow(DIV, operand, operand_stride, input, 1, nullptr, size,
+                 output);
+      break;
+    case FUSED_MIN:
+      EltwiseRow(MIN, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_MAX:
+      EltwiseRow(MAX, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_SQR_DIFF:
+      EltwiseRow(SQR_DIFF, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_POW:
+      EltwiseRow(POW, input, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_NEG:
+      EltwiseRow(NEG, input, 1, input, 1, nullptr, size, output);
+      break;
+    case FUSED_ABS:
+      EltwiseRow(ABS, input, 1, input, 1, nullptr, size, output);
+      break;
+    case FUSED_RELU:
+      EltwiseRow(MAX, input, 1, &zero, 0, nullptr, size, output);
+      break;
+    case FUSED_RELUX:
+      EltwiseRow(MAX, input, 1, &zero, 0, nullptr, size, output);
+      EltwiseRow(MIN, output, 1, operand, operand_stride, nullptr, size,
+                 output);
+      break;
+    case FUSED_PRELU:
+      if (operand_stride == 0) {
+        const float alpha = operand[0];
+        for (index_t i = 0; i < size; ++i) {
+          output[i] = input[i] < 0 ? input[i] * alpha : input[i];
+        }
+      } else {
+        for (index_t i = 0; i < size; ++i) {
+          output[i] = input[i] < 0 ? input[i] * operand[i] : input[i];
+        }
+      }
+      break;
+    case FUSED_TANH:
+      VectorTanh(input, size, output);
+      break;
+    case FUSED_SIGMOID:
+      VectorSigmoid(input, size, output);
+      break;
+    default:
+      LOG(FATAL) << "Unknown FusedElementwise step type: " << type;
+  }
+}
+
+// Channels of at least kFusedElementwiseMinPlaneSize elements: tiles are
+// within a channel and every operand is a scalar.
+void FusedElementwisePlanes(const std::vector<FusedElementwiseStep> &steps,
+                            const float *input,
+                            const index_t outer_size,
+                            const index_t channels,
+                            const index_t inner_size,
+                            float *output) {
+  const index_t tiles =
+      (inner_size + kFusedElementwiseTileSize - 1) / kFusedElementwiseTileSize;
+#pragma omp parallel for collapse(3)
+  for (index_t o = 0; o < outer_size; ++o) {
+    for (index_t c = 0; c < channels; ++c) {
+      for (index_t t = 0; t < tiles; ++t) {
+        const index_t start = t * kFusedElementwiseTileSize;
+        const index_t offset = (o * channels + c) * inner_size + start;
+        const index_t size =
+            std::min(kFusedElementwiseTileSize, inner_size - start);
+        const float *in = input + offset;
+        float *out = output + offset;
+        for (const FusedElementwiseStep &step : steps) {
+          ApplyStep(step.type,
+                    step.operand == nullptr ? &step.value : step.operand + c,
+                    0, in, size, out);
+          in = out;
+        }
+      }
+    }
+  }
+}
+
+// Small channels: tiles are whole groups of [channels, inner] and the
+// per channel operands are expanded to the tile layout once.
+void FusedElementwiseInterleaved(
+    const std::vector<FusedElementwiseStep> &steps,
+    const float *input,
+    const index_t outer_size,
+    const index_t channels,
+    const index_t inner_size,
+    float *output) {
+  const index_t period = channels * inner_size;
+  // a group is a whole number of periods, split into tiles if one period is
+  // larger than a tile
+  const index_t group_size =
+      period <= kFusedElementwiseTileSize
+          ? kFusedElementwiseTileSize / period * period
+          : period;
+  const index_t tile_size = std::min(group_size, kFusedElementwiseTileSize);
+  const index_t total_size = outer_size * period;
+  const index_t groups = (total_size + group_size - 1) / group_size;
+  const index_t group_tiles = (group_size + tile_size - 1) / tile_size;
+
+  std::vector<std::vector<float>> expanded(steps.size());
+  for (size_t s = 0; s < steps.size(); ++s) {
+    if (steps[s].operand == nullptr) continue;
+    expanded[s].resize(group_size);
+    float *expanded_ptr = expanded[s].data();
+    for (index_t p = 0; p < group_size; p += period) {
+      for (index_t c = 0; c < channels; ++c) {
+        std::fill_n(expanded_ptr + p + c * inner_size, inner_size,
+                    steps[s].operand[c]);
+      }
+    }
+  }
+
+#pragma omp parallel for collapse(2)
+  for (index_t g = 0; g < groups; ++g) {
+    for (index_t t = 0; t < group_tiles; ++t) {
+      const index_t group_start = g * group_size;
+      const index_t start = group_start + t * tile_size;
+      const index_t end =
+          std::min(std::min(start + tile_size, group_start + group_size),
+                   total_size);
+      if (start >= end) continue;
+      const float *in = input + start;
+      float *out = output + start;
+      for (size_t s = 0; s < steps.size(); ++s) {
+        if (steps[s].operand == nullptr) {
+          ApplyStep(steps[s].type, &steps[s].value, 0, in, end - start, out);
+        } else {
+          ApplyStep(steps[s].type, expanded[s].data() + t * tile_size, 1, in,
+                    end - start, out);
+        }
+        in = out;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void FusedElementwise(const std::vector<FusedElementwiseStep> &steps,
+                      const float *input,
+                      const index_t outer_size,
+                      const index_t channels,
+                      const index_t inner_size,
+                      float *output) {
+  if (outer_size * channels * inner_size == 0) {
+    return;
+  } else if (steps.empty()) {
+    if (input != output) {
+      memcpy(output, input, outer_size * channels * inner_size *
+                                sizeof(float));
+    }
+  } else if (inner_size >= kFusedElementwiseMinPlaneSize) {
+    FusedElementwisePlanes(steps, input, outer_size, channels, inner_size,
+                           output);
+  } else {
+    FusedElementwiseInterleaved(steps, input, outer_size, channels,
+                                inner_size, output);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,157 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_FUSED_ELEMENTWISE_H_
+#define MACE_KERNELS_FUSED_ELEMENTWISE_H_
+
+#include <vector>
+
+#include "mace/core/future.h"
+#include "mace/core/tensor.h"
+
+namespace mace {
+namespace kernels {
+
+// The steps of a FusedElementwise program, x is the running value and a the
+// operand of the step, a scalar or one value per channel.
+enum FusedElementwiseType {
+  FUSED_ADD = 0,       // x + a
+  FUSED_SUB = 1,       // x - a
+  FUSED_RSUB = 2,      // a - x
+  FUSED_MUL = 3,       // x * a
+  FUSED_DIV = 4,       // x / a
+  FUSED_RDIV = 5,      // a / x
+  FUSED_MIN = 6,       // min(x, a)
+  FUSED_MAX = 7,       // max(x, a)
+  FUSED_SQR_DIFF = 8,  // (x - a)^2
+  FUSED_POW = 9,       // x ^ a
+  FUSED_NEG = 10,      // -x
+  FUSED_ABS = 11,      // |x|
+  FUSED_RELU = 12,     // max(x, 0)
+  FUSED_RELUX = 13,    // min(max(x, 0), a)
+  FUSED_PRELU = 14,    // x < 0 ? x * a : x
+  FUSED_TANH = 15,
+  FUSED_SIGMOID = 16,
+};
+
+struct FusedElementwiseStep {
+  FusedElementwiseType type;
+  const float *operand;  // [channels], or nullptr to use value
+  float value;
+};
+
+// output = the steps applied in order to input [outer, channels, inner].
+// The tensor is processed tile by tile: the first step reads a tile of
+// input, the others run in place on the tile of output while it is in L1,
+// so a chain of element-wise ops reads and writes memory once. input may be
+// output.
+void FusedElementwise(const std::vector<FusedElementwiseStep> &steps,
+                      const float *input,
+                      const index_t outer_size,
+                      const index_t channels,
+                      const index_t inner_size,
+                      float *output);
+
+template <DeviceType D, typename T>
+struct FusedElementwiseFunctor;
+
+template <>
+struct FusedElementwiseFunctor<DeviceType::CPU, float> {
+  // step_inputs[i] is 0 if step i takes the scalar step_values[i], k if it
+  // takes operands[k - 1]
+  FusedElementwiseFunctor(const std::vector<int> &step_types,
+                          const std::vector<int> &step_inputs,
+                          const std::vector<float> &step_values,
+                          const DataFormat data_format)
+      : step_types_(step_types),
+        step_inputs_(step_inputs),
+        step_values_(step_values),
+        data_format_(data_format) {
+    MACE_CHECK(step_inputs_.size() == step_types_.size() &&
+                   step_values_.size() == step_types_.size(),
+               "FusedElementwise needs an input and a value per step");
+    for (size_t i = 0; i < step_types_.size(); ++i) {
+      MACE_CHECK(step_types_[i] >= FUSED_ADD &&
+                     step_types_[i] <= FUSED_SIGMOID,
+                 "Unknown FusedElementwise step type: ", step_types_[i]);
+    }
+  }
+
+  MaceStatus operator()(const Tensor *input,
+                        const std::vector<const Tensor *> &operands,
+                        Tensor *output,
+                        StatsFuture *future) {
+    MACE_UNUSED(future);
+    MACE_RETURN_IF_ERROR(output->ResizeLike(input));
+
+    // operands are per channel, i.e. dim 1 of NCHW and the last dim else
+    const int rank = static_cast<int>(input->dim_size());
+    const int channel_axis =
+        data_format_ == NCHW && rank == 4 ? 1 : rank - 1;
+    index_t outer_size = 1;
+    index_t channels = 1;
+    index_t inner_size = 1;
+    for (int i = 0; i < rank; ++i) {
+      if (i < channel_axis) {
+        outer_size *= input->dim(i);
+      } else if (i == channel_axis) {
+        channels = input->dim(i);
+      } else {
+        inner_size *= input->dim(i);
+      }
+    }
+
+    std::vector<FusedElementwiseStep> steps(step_types_.size());
+    bool per_channel = false;
+    for (size_t i = 0; i < steps.size(); ++i) {
+      steps[i].type = static_cast<FusedElementwiseType>(step_types_[i]);
+      steps[i].operand = nullptr;
+      steps[i].value = step_values_[i];
+      if (step_inputs_[i] > 0) {
+        MACE_CHECK(static_cast<size_t>(step_inputs_[i]) <= operands.size(),
+                   "FusedElementwise step ", i, " takes a missing input");
+        const Tensor *operand = operands[step_inputs_[i] - 1];
+        if (operand->size() == 1) {
+          steps[i].value = operand->data<float>()[0];
+        } else {
+          MACE_CHECK(operand->size() == channels,
+                     "FusedElementwise operand size ", operand->size(),
+                     " is not the channel count ", channels);
+          steps[i].operand = operand->data<float>();
+          per_channel = true;
+        }
+      }
+    }
+    if (!per_channel) {
+      inner_size *= outer_size * channels;
+      outer_size = 1;
+      channels = 1;
+    }
+
+    FusedElementwise(steps, input->data<float>(), outer_size, channels,
+                     inner_size, output->mutable_data<float>());
+
+    return MACE_SUCCESS;
+  }
+
+  std::vector<int> step_types_;
+  std::vector<int> step_inputs_;
+  std::vector<float> step_values_;
+  DataFormat data_format_;
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_FUSED_ELEMENTWISE_H_
@@ -0,0 +1,204 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "mace/kernels/gather.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/x86/gather_avx2.h"
+#include "mace/utils/utils.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Indices a gather task copies.
+const index_t kGatherBlockSize = 32;
+
+typedef void (*GatherRowsFunc)(const float *rows,
+                               const int32_t *indices,
+                               const index_t count,
+                               const index_t row_size,
+                               const float scale,
+                               float *output);
+
+void PrefetchRow(const float *row, const index_t row_size) {
+  const index_t size = std::min(row_size, kGatherPrefetchSize);
+  for (index_t j = 0; j < size; j += 16) {
+    __builtin_prefetch(row + j);
+  }
+}
+
+// output[j] = scale * input[j]
+void ScaleRow(const float *input,
+              const index_t size,
+              const float scale,
+              float *output) {
+  index_t j = 0;
+#if defined(MACE_ENABLE_NEON)
+  const float32x4_t vscale = vdupq_n_f32(scale);
+  for (; j + 7 < size; j += 8) {
+    vst1q_f32(output + j, vmulq_f32(vld1q_f32(input + j), vscale));
+    vst1q_f32(output + j + 4, vmulq_f32(vld1q_f32(input + j + 4), vscale));
+  }
+#endif
+  for (; j < size; ++j) {
+    output[j] = input[j] * scale;
+  }
+}
+
+// output[j] += input[j]
+void AddRow(const float *input, const index_t size, float *output) {
+  index_t j = 0;
+#if defined(MACE_ENABLE_NEON)
+  for (; j + 7 < size; j += 8) {
+    vst1q_f32(output + j,
+              vaddq_f32(vld1q_f32(output + j), vld1q_f32(input + j)));
+    vst1q_f32(output + j + 4,
+              vaddq_f32(vld1q_f32(output + j + 4), vld1q_f32(input + j + 4)));
+  }
+#endif
+  for (; j < size; ++j) {
+    output[j] += input[j];
+  }
+}
+
+void GatherRowsGeneric(const float *rows,
+                       const int32_t *indices,
+                       const index_t count,
+                       const index_t row_size,
+                       const float scale,
+                       float *output) {
+  for (index_t i = 0; i < std::min(count, kGatherPrefetchDistance); ++i) {
+    PrefetchRow(rows + indices[i] * row_size, row_size);
+  }
+  for (index_t i = 0; i < count; ++i) {
+    if (i + kGatherPrefetchDistance < count) {
+      PrefetchRow(rows + indices[i + kGatherPrefetchDistance] * row_size,
+                  row_size);
+    }
+    const float *src = rows + indices[i] * row_size;
+    float *dst = output + i * row_size;
+    if (scale == 1.f) {
+      memcpy(dst, src, row_size * sizeof(float));
+    } else {
+      ScaleRow(src, row_size, scale, dst);
+    }
+  }
+}
+
+void PoolRowsGeneric(const float *rows,
+                     const int32_t *indices,
+                     const index_t count,
+                     const index_t row_size,
+                     const float scale,
+                     float *output) {
+  if (count == 0) {
+    std::fill(output, output + row_size, 0.f);
+    return;
+  }
+  for (index_t i = 0; i < std::min(count, kGatherPrefetchDistance); ++i) {
+    PrefetchRow(rows + indices[i] * row_size, row_size);
+  }
+  memcpy(output, rows + indices[0] * row_size, row_size * sizeof(float));
+  for (index_t i = 1; i < count; ++i) {
+    if (i + kGatherPrefetchDistance < count) {
+      PrefetchRow(rows + indices[i + kGatherPrefetchDistance] * row_size,
+                  row_size);
+    }
+    AddRow(rows + indices[i] * row_size, row_size, output);
+  }
+  if (scale != 1.f) {
+    ScaleRow(output, row_size, scale, output);
+  }
+}
+
+}  // namespace
+
+void CheckIndices(const int32_t *indices,
+                  const index_t size,
+                  const index_t bound) {
+  // a branchless min/max pass, the slow search only runs on failure
+  int32_t min_index = 0;
+  int32_t max_index = 0;
+  for (index_t i = 0; i < size; ++i) {
+    min_index = std::min(min_index, indices[i]);
+    max_index = std::max(max_index, indices[i]);
+  }
+  if (min_index < 0 || max_index >= bound) {
+    for (index_t i = 0; i < size; ++i) {
+      MACE_CHECK(indices[i] >= 0 && indices[i] < bound, "index ", indices[i],
+                 " at ", i, " is out of range [0, ", bound, ")");
+    }
+  }
+}
+
+void GatherRows(const float *rows,
+                const int32_t *indices,
+                const index_t count,
+                const index_t row_size,
+                const float scale,
+                float *output) {
+  static const GatherRowsFunc func =
+      KernelDispatcher<GatherRowsFunc>(GatherRowsGeneric)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(GatherRowsAvx2))
+          .Select();
+  func(rows, indices, count, row_size, scale, output);
+}
+
+void PoolRows(const float *rows,
+              const int32_t *indices,
+              const index_t count,
+              const index_t row_size,
+              const float scale,
+              float *output) {
+  static const GatherRowsFunc func =
+      KernelDispatcher<GatherRowsFunc>(PoolRowsGeneric)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(PoolRowsAvx2))
+          .Select();
+  func(rows, indices, count, row_size, scale, output);
+}
+
+void Gather(const float *params,
+            const int32_t *indices,
+            const index_t lhs_size,
+            const index_t axis_dim_size,
+            const index_t rhs_size,
+            const index_t index_size,
+            const float scale,
+            float *output) {
+  const index_t blocks = RoundUpDiv(index_size, kGatherBlockSize);
+#pragma omp parallel for collapse(2)
+  for (index_t l = 0; l < lhs_size; ++l) {
+    for (index_t b = 0; b < blocks; ++b) {
+      const index_t begin = b * kGatherBlockSize;
+      GatherRows(params + l * axis_dim_size * rhs_size,
+                 indices + begin,
+                 std::min(kGatherBlockSize, index_size - begin),
+                 rhs_size,
+                 scale,
+                 output + (l * index_size + begin) * rhs_size);
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
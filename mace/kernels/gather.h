@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
 #include <vector>
 
 #include "mace/core/future.h"
@@ -26,6 +27,42 @@
 namespace mace {
 namespace kernels {
 
+// Check that 0 <= indices[i] < bound for all i < size.
+void CheckIndices(const int32_t *indices,
+                  const index_t size,
+                  const index_t bound);
+
+// output[i * row_size + j] = scale * rows[indices[i] * row_size + j] for
+// i < count, prefetching the rows a few indices ahead. Serial, with NEON or
+// AVX2 where available, the indices must be checked by the caller.
+void GatherRows(const float *rows,
+                const int32_t *indices,
+                const index_t count,
+                const index_t row_size,
+                const float scale,
+                float *output);
+
+// output[j] = scale * sum of rows[indices[i] * row_size + j] over i < count,
+// 0 if count is 0. Serial like GatherRows.
+void PoolRows(const float *rows,
+              const int32_t *indices,
+              const index_t count,
+              const index_t row_size,
+              const float scale,
+              float *output);
+
+// Gather slices of params, seen as [lhs_size, axis_dim_size, rhs_size],
+// along the middle axis into output of [lhs_size, index_size, rhs_size],
+// scaled by scale.
+void Gather(const float *params,
+            const int32_t *indices,
+            const index_t lhs_size,
+            const index_t axis_dim_size,
+            const index_t rhs_size,
+            const index_t index_size,
+            const float scale,
+            float *output);
+
 struct GatherBase {
   explicit GatherBase(int axis, float y) : axis_(axis), y_(y) {}
 
@@ -76,24 +113,9 @@ struct GatherFunctor<DeviceType::CPU, float> : GatherBase {
                         params->shape().end(), 1, std::multiplies<index_t>());
     index_t index_size = indices->size();
 
-#pragma omp parallel for collapse(2)
-    for (index_t l = 0; l < lhs_size; ++l) {
-      for (index_t idx = 0; idx < index_size; ++idx) {
-        MACE_ASSERT(indices_data[idx] < axis_dim_size, "idx out of bound: ",
-                    indices_data[idx]);
-        memcpy(
-            output_data + ((l * index_size) + idx) * rhs_size,
-            params_data + ((l * axis_dim_size) + indices_data[idx]) * rhs_size,
-            sizeof(float) * rhs_size);
-      }
-    }
-
-    if (std::fabs(y_ - 1.0) > 1e-6) {
-#pragma omp parallel for
-      for (index_t i = 0; i < output->size(); ++i) {
-        output_data[i] *= y_;
-      }
-    }
+    CheckIndices(indices_data, index_size, axis_dim_size);
+    Gather(params_data, indices_data, lhs_size, axis_dim_size, rhs_size,
+           index_size, y_, output_data);
 
     return MACE_SUCCESS;
   }
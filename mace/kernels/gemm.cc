@@ -17,6 +17,8 @@
 
 #include "mace/core/tensor.h"
 #include "mace/kernels/gemm.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/x86/gemm_avx2.h"
 
 #if defined(MACE_ENABLE_NEON)
 #include <arm_neon.h>
@@ -1245,7 +1247,14 @@ inline void GemmTile(const float *A,
     }
   }
 #else
-  GemmBlock(A, B, height, K, width, stride_a, stride_b, stride_c, C);
+  typedef void (*GemmTileFunc)(const float *, const float *, const index_t,
+                               const index_t, const index_t, const index_t,
+                               const index_t, const index_t, float *);
+  static const GemmTileFunc gemm_tile =
+      KernelDispatcher<GemmTileFunc>(GemmBlock)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(GemmTileAvx2))
+          .Select();
+  gemm_tile(A, B, height, K, width, stride_a, stride_b, stride_c, C);
 #endif  // MACE_ENABLE_NEON
 }
 
@@ -1261,65 +1270,166 @@ void Transpose(const float *src,
   }
 }
 
-}  // namespace
+// sums[r * sums_stride + b] = sum_w m[r, w] * v[b, w] for R rows of m and
+// B vectors. Every loaded segment of m is used for all B vectors.
+template <int R, int B>
+inline void BatchedGemvBlock(const float *m_ptr,
+                             const float *v_ptr,
+                             const index_t width,
+                             const index_t sums_stride,
+                             float *sums) {
+  float sum[R][B];
+  index_t w = 0;
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t vsum[R][B];
+  for (int r = 0; r < R; ++r) {
+    for (int b = 0; b < B; ++b) {
+      vsum[r][b] = vdupq_n_f32(0.f);
+    }
+  }
+  for (; w + 3 < width; w += 4) {
+    float32x4_t vm[R];
+    for (int r = 0; r < R; ++r) {
+      vm[r] = vld1q_f32(m_ptr + r * width + w);
+    }
+    for (int b = 0; b < B; ++b) {
+      const float32x4_t vv = vld1q_f32(v_ptr + b * width + w);
+      for (int r = 0; r < R; ++r) {
+        vsum[r][b] = vmlaq_f32(vsum[r][b], vm[r], vv);
+      }
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int b = 0; b < B; ++b) {
+      sum[r][b] = vaddvq_f32(vsum[r][b]);
+    }
+  }
+#else
+  for (int r = 0; r < R; ++r) {
+    for (int b = 0; b < B; ++b) {
+      sum[r][b] = 0.f;
+    }
+  }
+#endif
+  for (; w < width; ++w) {
+    for (int r = 0; r < R; ++r) {
+      for (int b = 0; b < B; ++b) {
+        sum[r][b] += m_ptr[r * width + w] * v_ptr[b * width + w];
+      }
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int b = 0; b < B; ++b) {
+      sums[r * sums_stride + b] = sum[r][b];
+    }
+  }
+}
 
-// A: height x K, B: K x width, C: height x width
-void Gemm(const float *A,
-          const float *B,
-          const index_t batch,
-          const index_t height,
-          const index_t K,
-          const index_t width,
-          float *C,
-          const bool transpose_a,
-          const bool transpose_b) {
-  if (width == 1) {
-    for (index_t b = 0; b < batch; ++b) {
-      Gemv(A + b * height * K, B + b * K, 1, K, height, C + b * height);
+// Vectors per block, 4 rows x 4 vectors of accumulators need more than the
+// 16 NEON registers of armv7.
+#if defined(__aarch64__)
+const int kBatchedGemvBlockBatch = 4;
+#else
+const int kBatchedGemvBlockBatch = 2;
+#endif
+
+template <int R>
+void BatchedGemvRows(const float *m_ptr,
+                     const float *v_ptr,
+                     const index_t batch,
+                     const index_t width,
+                     const index_t sums_stride,
+                     float *sums) {
+  const int kB = kBatchedGemvBlockBatch;
+  index_t b = 0;
+  for (; b + kB <= batch; b += kB) {
+    BatchedGemvBlock<R, kB>(m_ptr, v_ptr + b * width, width, sums_stride,
+                            sums + b);
+  }
+  switch (batch - b) {
+    case 3:
+      BatchedGemvBlock<R, 3>(m_ptr, v_ptr + b * width, width, sums_stride,
+                             sums + b);
+      break;
+    case 2:
+      BatchedGemvBlock<R, 2>(m_ptr, v_ptr + b * width, width, sums_stride,
+                             sums + b);
+      break;
+    case 1:
+      BatchedGemvBlock<R, 1>(m_ptr, v_ptr + b * width, width, sums_stride,
+                             sums + b);
+      break;
+    default:
+      break;
+  }
+}
+
+// See BatchedGemvTileAvx2
+void BatchedGemvTile(const float *m_ptr,
+                     const float *v_ptr,
+                     const index_t rows,
+                     const index_t batch,
+                     const index_t width,
+                     const index_t sums_stride,
+                     float *sums) {
+  if (rows == 4) {
+    BatchedGemvRows<4>(m_ptr, v_ptr, batch, width, sums_stride, sums);
+  } else {
+    for (index_t r = 0; r < rows; ++r) {
+      BatchedGemvRows<1>(m_ptr + r * width, v_ptr, batch, width, sums_stride,
+                         sums + r * sums_stride);
     }
-    return;
   }
+}
+
+}  // namespace
+
+namespace {
+
+// It is better to use large block size if it fits for fast cache.
+// Assume l1 cache size is 32k, we load three blocks at a time (A, B, C),
+// the block size should be sqrt(32k / sizeof(T) / 3).
+// As number of input channels of convolution is normally power of 2, and
+// we have not optimized tiling remains, we use the following magic number
+const index_t kGemmBlockSize = 64;
+
+inline index_t GemmBlockEnd(const index_t begin, const index_t size) {
+  return std::min(begin + kGemmBlockSize, size);
+}
+
+void GemmBlocked(const float *A,
+                 const float *B,
+                 const index_t batch,
+                 const index_t height,
+                 const index_t K,
+                 const index_t width,
+                 float *C,
+                 const GemmLayout a_layout,
+                 const GemmLayout b_layout,
+                 const Epilogue *epilogue) {
   memset(C, 0, sizeof(float) * batch * height * width);
 
-  // It is better to use large block size if it fits for fast cache.
-  // Assume l1 cache size is 32k, we load three blocks at a time (A, B, C),
-  // the block size should be sqrt(32k / sizeof(T) / 3).
-  // As number of input channels of convolution is normally power of 2, and
-  // we have not optimized tiling remains, we use the following magic number
-  const index_t block_size = 64;
+  const index_t block_size = kGemmBlockSize;
   const index_t block_tile_height = RoundUpDiv(height, block_size);
   const index_t block_tile_width = RoundUpDiv(width, block_size);
   const index_t block_tile_k = RoundUpDiv(K, block_size);
-  const index_t block_tile[3] = {block_tile_height, block_tile_width,
-                                 block_tile_k};
-  const index_t remain_height = height % block_size;
-  const index_t remain_width = width % block_size;
-  const index_t remain_k = K % block_size;
-  const index_t remain[3] = {remain_height, remain_width, remain_k};
 
 #pragma omp parallel for collapse(3)
   for (index_t n = 0; n < batch; ++n) {
-    for (index_t bh = 0; bh < block_tile[0]; ++bh) {
-      for (index_t bw = 0; bw < block_tile[1]; ++bw) {
+    for (index_t bh = 0; bh < block_tile_height; ++bh) {
+      for (index_t bw = 0; bw < block_tile_width; ++bw) {
         const float *a_base = A + n * height * K;
         const float *b_base = B + n * K * width;
         float *c_base = C + n * height * width;
 
         const index_t ih_begin = bh * block_size;
-        const index_t ih_end =
-            bh * block_size +
-            (bh == block_tile[0] - 1 && remain[0] > 0 ? remain[0] : block_size);
+        const index_t ih_end = GemmBlockEnd(ih_begin, height);
         const index_t iw_begin = bw * block_size;
-        const index_t iw_end =
-            bw * block_size +
-            (bw == block_tile[1] - 1 && remain[1] > 0 ? remain[1] : block_size);
+        const index_t iw_end = GemmBlockEnd(iw_begin, width);
 
-        for (index_t bk = 0; bk < block_tile[2]; ++bk) {
+        for (index_t bk = 0; bk < block_tile_k; ++bk) {
           const index_t ik_begin = bk * block_size;
-          const index_t ik_end =
-              bk * block_size + (bk == block_tile[2] - 1 && remain[2] > 0
-                                     ? remain[2]
-                                     : block_size);
+          const index_t ik_end = GemmBlockEnd(ik_begin, K);
 
           Tensor trans_a;
           Tensor trans_b;
@@ -1330,7 +1440,7 @@ void Gemm(const float *A,
           index_t stride_b;
           index_t stride_c = width;
 
-          if (transpose_a) {
+          if (a_layout == TRANSPOSED) {
             trans_a.Resize({block_size, block_size});
             float *trans_a_data = trans_a.mutable_data<float>();
             // A[K, H] -> A[H, K]
@@ -1339,12 +1449,15 @@ void Gemm(const float *A,
                       trans_a_data);
             real_a = trans_a_data;
             stride_a = ik_end - ik_begin;
+          } else if (a_layout == PACKED) {
+            real_a = a_base + (ih_begin * K + ik_begin * (ih_end - ih_begin));
+            stride_a = ik_end - ik_begin;
           } else {
             real_a = a_base + (ih_begin * K + ik_begin);
             stride_a = K;
           }
 
-          if (transpose_b) {
+          if (b_layout == TRANSPOSED) {
             trans_b.Resize({block_size, block_size});
             float *trans_b_data = trans_b.mutable_data<float>();
             // B[W, K] -> B[K, W]
@@ -1352,6 +1465,10 @@ void Gemm(const float *A,
                       ik_end - ik_begin, K, trans_b_data);
             real_b = trans_b_data;
             stride_b = iw_end - iw_begin;
+          } else if (b_layout == PACKED) {
+            real_b =
+                b_base + (ik_begin * width + iw_begin * (ik_end - ik_begin));
+            stride_b = iw_end - iw_begin;
           } else {
             real_b = b_base + (ik_begin * width + iw_begin);
             stride_b = width;
@@ -1362,11 +1479,123 @@ void Gemm(const float *A,
           GemmTile(real_a, real_b, ih_end - ih_begin, ik_end - ik_begin,
                    iw_end - iw_begin, stride_a, stride_b, stride_c, real_c);
         }  // bk
+
+        // C[bh, bw] is final and still in cache
+        if (epilogue != nullptr) {
+          const Epilogue batch_epilogue =
+              epilogue->Offset(n * height * epilogue->residual_stride);
+          for (index_t h = ih_begin; h < ih_end; ++h) {
+            float *c_ptr = c_base + h * width + iw_begin;
+            batch_epilogue.Apply(c_ptr, h, iw_begin, iw_end - iw_begin, c_ptr);
+          }
+        }
       }    // bw
     }      // bh
   }        // n
 }
 
+}  // namespace
+
+// A: height x K, B: K x width, C: height x width
+void Gemm(const float *A,
+          const float *B,
+          const index_t batch,
+          const index_t height,
+          const index_t K,
+          const index_t width,
+          float *C,
+          const bool transpose_a,
+          const bool transpose_b,
+          const Epilogue *epilogue) {
+  if (width == 1) {
+    for (index_t b = 0; b < batch; ++b) {
+      float *c_ptr = C + b * height;
+      Gemv(A + b * height * K, B + b * K, 1, K, height, c_ptr);
+      if (epilogue != nullptr) {
+        const Epilogue batch_epilogue =
+            epilogue->Offset(b * height * epilogue->residual_stride);
+        for (index_t h = 0; h < height; ++h) {
+          batch_epilogue.Apply(c_ptr + h, h, 0, 1, c_ptr + h);
+        }
+      }
+    }
+    return;
+  }
+  GemmBlocked(A, B, batch, height, K, width, C,
+              transpose_a ? TRANSPOSED : ROW_MAJOR,
+              transpose_b ? TRANSPOSED : ROW_MAJOR, epilogue);
+}
+
+void GemmPacked(const float *A,
+                const float *B,
+                const index_t batch,
+                const index_t height,
+                const index_t K,
+                const index_t width,
+                float *C,
+                const GemmLayout a_layout,
+                const GemmLayout b_layout,
+                const Epilogue *epilogue) {
+  GemmBlocked(A, B, batch, height, K, width, C, a_layout, b_layout, epilogue);
+}
+
+void GemmPackA(const float *A,
+               const index_t batch,
+               const index_t height,
+               const index_t K,
+               const bool transpose_a,
+               float *packed_a) {
+#pragma omp parallel for collapse(2)
+  for (index_t n = 0; n < batch; ++n) {
+    for (index_t ih_begin = 0; ih_begin < height;
+         ih_begin += kGemmBlockSize) {
+      const float *a_base = A + n * height * K;
+      const index_t ih_end = GemmBlockEnd(ih_begin, height);
+      const index_t block_height = ih_end - ih_begin;
+      for (index_t ik_begin = 0; ik_begin < K; ik_begin += kGemmBlockSize) {
+        const index_t block_k = GemmBlockEnd(ik_begin, K) - ik_begin;
+        float *block = packed_a + n * height * K + ih_begin * K
+            + ik_begin * block_height;
+        for (index_t h = 0; h < block_height; ++h) {
+          for (index_t k = 0; k < block_k; ++k) {
+            block[h * block_k + k] = transpose_a
+                ? a_base[(ik_begin + k) * height + ih_begin + h]
+                : a_base[(ih_begin + h) * K + ik_begin + k];
+          }
+        }
+      }
+    }
+  }
+}
+
+void GemmPackB(const float *B,
+               const index_t batch,
+               const index_t K,
+               const index_t width,
+               const bool transpose_b,
+               float *packed_b) {
+#pragma omp parallel for collapse(2)
+  for (index_t n = 0; n < batch; ++n) {
+    for (index_t ik_begin = 0; ik_begin < K; ik_begin += kGemmBlockSize) {
+      const float *b_base = B + n * K * width;
+      const index_t block_k = GemmBlockEnd(ik_begin, K) - ik_begin;
+      for (index_t iw_begin = 0; iw_begin < width;
+           iw_begin += kGemmBlockSize) {
+        const index_t block_width = GemmBlockEnd(iw_begin, width) - iw_begin;
+        float *block = packed_b + n * K * width + ik_begin * width
+            + iw_begin * block_k;
+        for (index_t k = 0; k < block_k; ++k) {
+          for (index_t w = 0; w < block_width; ++w) {
+            block[k * block_width + w] = transpose_b
+                ? b_base[(iw_begin + w) * K + ik_begin + k]
+                : b_base[(ik_begin + k) * width + iw_begin + w];
+          }
+        }
+      }
+    }
+  }
+}
+
 // A: height x K, B: K x width, C: height x width
 void GemmRef(const float *A,
              const float *B,
@@ -1438,7 +1667,6 @@ void GemvRef(const float *m_ptr,
   }
 }
 
-// TODO(liyin): batched gemv can be transformed to gemm (w/ transpose)
 void Gemv(const float *m_ptr,
           const float *v_ptr,
           const index_t batch,
@@ -1535,5 +1763,49 @@ void Gemv(const float *m_ptr,
 #endif
 }
 
+void BatchedGemv(const float *m_ptr,
+                 const float *v_ptr,
+                 const index_t batch,
+                 const index_t width,
+                 const index_t height,
+                 float *out_ptr,
+                 const Epilogue *epilogue) {
+  typedef void (*BatchedGemvTileFunc)(const float *, const float *,
+                                      const index_t, const index_t,
+                                      const index_t, const index_t, float *);
+  static const BatchedGemvTileFunc batched_gemv_tile =
+      KernelDispatcher<BatchedGemvTileFunc>(BatchedGemvTile)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(BatchedGemvTileAvx2))
+          .Select();
+  MACE_CHECK(epilogue == nullptr || epilogue->residual == nullptr,
+             "BatchedGemv does not support residual");
+  const bool has_epilogue = epilogue != nullptr && !epilogue->empty();
+  const index_t kRows = 4;
+  const index_t kTileBatch = kBatchedGemvTileBatch;
+
+  for (index_t b = 0; b < batch; b += kTileBatch) {
+    const index_t tile_batch = std::min(kTileBatch, batch - b);
+    const float *v_tile = v_ptr + b * width;
+    float *out_tile = out_ptr + b * height;
+#pragma omp parallel for
+    for (index_t h = 0; h < height; h += kRows) {
+      const index_t rows = std::min(kRows, height - h);
+      // [rows, tile_batch], i.e. the epilogue channels are contiguous
+      float sums[kRows * kTileBatch];
+      batched_gemv_tile(m_ptr + h * width, v_tile, rows, tile_batch, width,
+                        tile_batch, sums);
+      for (index_t r = 0; r < rows; ++r) {
+        float *sum_ptr = sums + r * tile_batch;
+        if (has_epilogue) {
+          epilogue->Apply(sum_ptr, h + r, 0, tile_batch, sum_ptr);
+        }
+        for (index_t i = 0; i < tile_batch; ++i) {
+          out_tile[i * height + h + r] = sum_ptr[i];
+        }
+      }
+    }
+  }
+}
+
 }  // namespace kernels
 }  // namespace mace
@@ -20,10 +20,14 @@
 #endif
 
 #include "mace/core/types.h"
+#include "mace/kernels/epilogue.h"
 
 namespace mace {
 namespace kernels {
 
+// C = A x B, then the epilogue (if any) is applied to each block of C as
+// soon as it is final, with the row of C as the channel. The residual of
+// batch n starts at epilogue->residual + n * height * residual_stride.
 void Gemm(const float *A,
           const float *B,
           const index_t batch,
@@ -32,7 +36,44 @@ void Gemm(const float *A,
           const index_t width,
           float *C,
           const bool transpose_a = false,
-          const bool transpose_b = false);
+          const bool transpose_b = false,
+          const Epilogue *epilogue = nullptr);
+
+// How GemmPacked reads an operand: row-major as in Gemm, transposed as with
+// transpose_a / transpose_b of Gemm, or packed by GemmPackA / GemmPackB.
+enum GemmLayout { ROW_MAJOR = 0, TRANSPOSED = 1, PACKED = 2 };
+
+// Gemm with the layouts of A and B given explicitly. Each block of a packed
+// operand is stored contiguously in the order Gemm reads it, so a const
+// operand packed once is neither transposed nor read with a long stride on
+// every call.
+void GemmPacked(const float *A,
+                const float *B,
+                const index_t batch,
+                const index_t height,
+                const index_t K,
+                const index_t width,
+                float *C,
+                const GemmLayout a_layout,
+                const GemmLayout b_layout,
+                const Epilogue *epilogue = nullptr);
+
+// Packs A (height x K, or K x height with transpose_a) for GemmPacked. The
+// packed operand has the same number of elements.
+void GemmPackA(const float *A,
+               const index_t batch,
+               const index_t height,
+               const index_t K,
+               const bool transpose_a,
+               float *packed_a);
+
+// Packs B (K x width, or width x K with transpose_b) for GemmPacked.
+void GemmPackB(const float *B,
+               const index_t batch,
+               const index_t K,
+               const index_t width,
+               const bool transpose_b,
+               float *packed_b);
 
 void GemmRef(const float *A,
              const float *B,
@@ -51,6 +92,22 @@ void Gemv(const float *m_ptr,
           const index_t height,
           float *out_ptr);
 
+// Up to this many vectors share one pass over the matrix in BatchedGemv.
+const index_t kBatchedGemvTileBatch = 16;
+
+// out[b, h] = sum_w m[h, w] * v[b, w] like Gemv, but each block of rows of m
+// is multiplied with up to kBatchedGemvTileBatch vectors while it is in
+// cache, so m is streamed once per that many vectors instead of once per
+// vector. The epilogue (if any) is applied with h as the channel and must
+// not have a residual.
+void BatchedGemv(const float *m_ptr,
+                 const float *v_ptr,
+                 const index_t batch,
+                 const index_t width,
+                 const index_t height,
+                 float *out_ptr,
+                 const Epilogue *epilogue = nullptr);
+
 void GemvRef(const float *m_ptr,
              const float *v_ptr,
              const index_t batch,
@@ -72,6 +72,135 @@ void GemvTest(index_t batch, index_t N, index_t M) {
   }
 }
 
+// BatchedGemv with bias and PReLU fused versus GemvRef then the same
+// element-wise ops.
+void BatchedGemvTest(index_t batch, index_t N, index_t M) {
+  std::unique_ptr<float[]> A(new float[N * M]);
+  std::unique_ptr<float[]> B(new float[batch * M]);
+  std::unique_ptr<float[]> C(new float[batch * N]);
+  std::unique_ptr<float[]> C_ref(new float[batch * N]);
+  std::unique_ptr<float[]> bias(new float[N]);
+  std::unique_ptr<float[]> alpha(new float[N]);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+
+  std::generate(A.get(), A.get() + N * M, [&gen, &nd] { return nd(gen); });
+  std::generate(B.get(), B.get() + batch * M, [&gen, &nd] { return nd(gen); });
+  std::generate(bias.get(), bias.get() + N, [&gen, &nd] { return nd(gen); });
+  std::generate(alpha.get(), alpha.get() + N, [&gen, &nd] { return nd(gen); });
+
+  kernels::GemvRef(A.get(), B.get(), batch, M, N, C_ref.get());
+  kernels::BatchedGemv(A.get(), B.get(), batch, M, N, C.get());
+  for (int i = 0; i < batch * N; ++i) {
+    EXPECT_NEAR(C_ref[i], C[i], 0.1);
+  }
+
+  kernels::Epilogue epilogue;
+  epilogue.bias = bias.get();
+  epilogue.activation = kernels::PRELU;
+  epilogue.prelu_alpha = alpha.get();
+  kernels::BatchedGemv(A.get(), B.get(), batch, M, N, C.get(), &epilogue);
+  for (index_t i = 0; i < batch * N; ++i) {
+    const index_t n = i % N;
+    float x = C_ref[i] + bias[n];
+    x = x < 0 ? x * alpha[n] : x;
+    EXPECT_NEAR(x, C[i], 0.1);
+  }
+}
+
+// Gemm with bias, residual and PReLU fused versus GemmRef then the same
+// element-wise ops.
+void GemmEpilogueTest(index_t batch, index_t N, index_t K, index_t M) {
+  std::unique_ptr<float[]> A(new float[batch * N * K]);
+  std::unique_ptr<float[]> B(new float[batch * K * M]);
+  std::unique_ptr<float[]> C(new float[batch * N * M]);
+  std::unique_ptr<float[]> C_ref(new float[batch * N * M]);
+  std::unique_ptr<float[]> residual(new float[batch * N * M]);
+  std::unique_ptr<float[]> bias(new float[N]);
+  std::unique_ptr<float[]> alpha(new float[N]);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+
+  std::generate(A.get(), A.get() + batch * N * K,
+                [&gen, &nd] { return nd(gen); });
+  std::generate(B.get(), B.get() + batch * K * M,
+                [&gen, &nd] { return nd(gen); });
+  std::generate(residual.get(), residual.get() + batch * N * M,
+                [&gen, &nd] { return nd(gen); });
+  std::generate(bias.get(), bias.get() + N, [&gen, &nd] { return nd(gen); });
+  std::generate(alpha.get(), alpha.get() + N, [&gen, &nd] { return nd(gen); });
+
+  kernels::Epilogue epilogue;
+  epilogue.bias = bias.get();
+  epilogue.residual = residual.get();
+  epilogue.residual_stride = M;
+  epilogue.activation = kernels::PRELU;
+  epilogue.prelu_alpha = alpha.get();
+  kernels::Gemm(A.get(), B.get(), batch, N, K, M, C.get(), false, false,
+                &epilogue);
+  kernels::GemmRef(A.get(), B.get(), batch, N, K, M, C_ref.get());
+
+  for (index_t i = 0; i < batch * N * M; ++i) {
+    const index_t n = i / M % N;
+    float x = C_ref[i] + bias[n] + residual[i];
+    x = x < 0 ? x * alpha[n] : x;
+    EXPECT_NEAR(x, C[i], 0.1);
+  }
+}
+
+// GemmPacked with A and B packed (and the other operand as is) versus
+// GemmRef.
+void GemmPackedTest(index_t batch,
+                    index_t N,
+                    index_t K,
+                    index_t M,
+                    bool transpose_a,
+                    bool transpose_b) {
+  std::unique_ptr<float[]> A(new float[batch * N * K]);
+  std::unique_ptr<float[]> B(new float[batch * K * M]);
+  std::unique_ptr<float[]> packed_A(new float[batch * N * K]);
+  std::unique_ptr<float[]> packed_B(new float[batch * K * M]);
+  std::unique_ptr<float[]> C(new float[batch * N * M]);
+  std::unique_ptr<float[]> C_ref(new float[batch * N * M]);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+
+  std::generate(A.get(), A.get() + batch * N * K,
+                [&gen, &nd] { return nd(gen); });
+  std::generate(B.get(), B.get() + batch * K * M,
+                [&gen, &nd] { return nd(gen); });
+  kernels::GemmRef(A.get(), B.get(), batch, N, K, M, C_ref.get(), transpose_a,
+                   transpose_b);
+  kernels::GemmPackA(A.get(), batch, N, K, transpose_a, packed_A.get());
+  kernels::GemmPackB(B.get(), batch, K, M, transpose_b, packed_B.get());
+  const kernels::GemmLayout a_layout =
+      transpose_a ? kernels::TRANSPOSED : kernels::ROW_MAJOR;
+  const kernels::GemmLayout b_layout =
+      transpose_b ? kernels::TRANSPOSED : kernels::ROW_MAJOR;
+
+  kernels::GemmPacked(packed_A.get(), B.get(), batch, N, K, M, C.get(),
+                      kernels::PACKED, b_layout);
+  for (int i = 0; i < batch * N * M; ++i) {
+    EXPECT_NEAR(C_ref[i], C[i], 0.1);
+  }
+  kernels::GemmPacked(A.get(), packed_B.get(), batch, N, K, M, C.get(),
+                      a_layout, kernels::PACKED);
+  for (int i = 0; i < batch * N * M; ++i) {
+    EXPECT_NEAR(C_ref[i], C[i], 0.1);
+  }
+  kernels::GemmPacked(packed_A.get(), packed_B.get(), batch, N, K, M, C.get(),
+                      kernels::PACKED, kernels::PACKED);
+  for (int i = 0; i < batch * N * M; ++i) {
+    EXPECT_NEAR(C_ref[i], C[i], 0.1);
+  }
+}
+
 }  // namespace
 
 TEST(GEMMTest, AlignedWithoutBatch) {
@@ -107,9 +236,34 @@ TEST(GEMMTest, UnalignedWithBatch) {
   GemmTest(3, 17, 63, 127, true, true);
 }
 
+TEST(GEMMTest, Epilogue) {
+  GemmEpilogueTest(1, 64, 64, 128);
+  GemmEpilogueTest(3, 17, 63, 127);
+  GemmEpilogueTest(2, 70, 5, 65);
+  GemmEpilogueTest(2, 9, 31, 1);
+}
+
+TEST(GEMMTest, Packed) {
+  GemmPackedTest(1, 64, 64, 128, false, false);
+  GemmPackedTest(3, 17, 63, 127, false, true);
+  GemmPackedTest(2, 70, 130, 65, true, false);
+  GemmPackedTest(2, 129, 65, 200, true, true);
+  GemmPackedTest(1, 9, 31, 1, false, true);
+}
+
 TEST(GEMMTest, gemv) {
   GemvTest(1, 17, 63);
   GemvTest(3, 17, 63);
 }
 
+TEST(GEMMTest, BatchedGemv) {
+  // every block width and row remainder, and more than one batch tile
+  for (index_t batch = 1; batch <= 7; ++batch) {
+    BatchedGemvTest(batch, 17, 63);
+  }
+  BatchedGemvTest(16, 64, 128);
+  BatchedGemvTest(19, 30, 7);
+  BatchedGemvTest(40, 5, 300);
+}
+
 }  // namespace mace
@@ -0,0 +1,79 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_KERNEL_DISPATCH_H_
+#define MACE_KERNELS_KERNEL_DISPATCH_H_
+
+#include "mace/core/runtime/cpu/cpu_features.h"
+#include "mace/utils/logging.h"
+
+// Kernels in mace/kernels/x86 only exist in x86 builds, refer to them
+// through this so that the dispatch code compiles everywhere.
+#ifdef MACE_CPU_X86
+#define MACE_X86_KERNEL(func) (func)
+#else
+#define MACE_X86_KERNEL(func) nullptr
+#endif
+
+namespace mace {
+namespace kernels {
+
+// Holds the variants of one kernel compiled for different ISA levels, e.g.
+//
+//   static const Conv2dKernelFunc func =
+//       KernelDispatcher<Conv2dKernelFunc>(Conv2dNeonK3x3S1)
+//           .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(Conv2dAvx2K3x3S1))
+//           .Select();
+//
+// The generic variant is the portable one (NEON or scalar), the x86 variants
+// live in mace/kernels/x86 and are built with their own target flags, so they
+// must only be called after the CPU has been checked to support them.
+template <typename Func>
+class KernelDispatcher {
+ public:
+  explicit KernelDispatcher(Func generic) : funcs_() {
+    MACE_CHECK(generic != nullptr);
+    funcs_[CPU_ISA_GENERIC] = generic;
+  }
+
+  // A null func (a kernel not built for this target) is ignored.
+  KernelDispatcher &Register(CPUISA isa, Func func) {
+    if (func != nullptr) {
+      funcs_[isa] = func;
+    }
+    return *this;
+  }
+
+  // The best registered variant not exceeding the given ISA level
+  Func Select(CPUISA isa) const {
+    for (int i = isa; i > CPU_ISA_GENERIC; --i) {
+      if (funcs_[i] != nullptr) {
+        return funcs_[i];
+      }
+    }
+    return funcs_[CPU_ISA_GENERIC];
+  }
+
+  Func Select() const {
+    return Select(GetCPUISA());
+  }
+
+ private:
+  Func funcs_[CPU_ISA_AVX512 + 1];
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_KERNEL_DISPATCH_H_
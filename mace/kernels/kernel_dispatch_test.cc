@@ -0,0 +1,68 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "mace/kernels/kernel_dispatch.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+typedef int (*TestFunc)();
+
+int GenericFunc() { return CPU_ISA_GENERIC; }
+int AVX2Func() { return CPU_ISA_AVX2; }
+
+}  // namespace
+
+TEST(KernelDispatchTest, Select) {
+  KernelDispatcher<TestFunc> dispatcher(GenericFunc);
+  EXPECT_EQ(CPU_ISA_GENERIC, dispatcher.Select(CPU_ISA_AVX512)());
+
+  dispatcher.Register(CPU_ISA_AVX2, AVX2Func);
+  EXPECT_EQ(CPU_ISA_GENERIC, dispatcher.Select(CPU_ISA_GENERIC)());
+  EXPECT_EQ(CPU_ISA_GENERIC, dispatcher.Select(CPU_ISA_SSE41)());
+  EXPECT_EQ(CPU_ISA_AVX2, dispatcher.Select(CPU_ISA_AVX2)());
+  EXPECT_EQ(CPU_ISA_AVX2, dispatcher.Select(CPU_ISA_AVX512)());
+  EXPECT_LE(dispatcher.Select()(), GetCPUISA());
+}
+
+TEST(KernelDispatchTest, CPUISA) {
+  for (int i = CPU_ISA_GENERIC; i <= CPU_ISA_AVX512; ++i) {
+    CPUISA isa = static_cast<CPUISA>(i);
+    CPUISA parsed = CPU_ISA_GENERIC;
+    EXPECT_TRUE(StringToCPUISA(CPUISAToString(isa), &parsed));
+    EXPECT_EQ(isa, parsed);
+  }
+  CPUISA parsed = CPU_ISA_AVX2;
+  EXPECT_FALSE(StringToCPUISA("avx3", &parsed));
+  EXPECT_EQ(CPU_ISA_AVX2, parsed);
+
+  const CPUFeatures &features = GetCPUFeatures();
+  CPUISA isa = GetCPUISA();
+  if (isa >= CPU_ISA_SSE41) {
+    EXPECT_TRUE(features.sse4_1);
+  }
+  if (isa >= CPU_ISA_AVX2) {
+    EXPECT_TRUE(features.avx2 && features.fma && features.f16c);
+  }
+  if (isa >= CPU_ISA_AVX512) {
+    EXPECT_TRUE(features.avx512f);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,159 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+
+#include "mace/kernels/local_response_norm.h"
+#include "mace/kernels/vector_math.h"
+#include "mace/utils/utils.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// H * W elements a task slides the window over, the window sum, the scale
+// and the rows entering and leaving it stay in L1.
+const index_t kLocalResponseNormTileSize = 1024;
+// Channels a task covers, each task restarts the window sum so small
+// images still split into enough tasks.
+const index_t kLocalResponseNormChannelBlock = 64;
+
+// sum += sign * input^2
+void AccumulateSquares(const float *input,
+                       const index_t size,
+                       const float sign,
+                       float *sum) {
+  index_t i = 0;
+#if defined(MACE_ENABLE_NEON)
+  for (; i + 3 < size; i += 4) {
+    float32x4_t vi = vld1q_f32(input + i);
+    vst1q_f32(sum + i,
+              vmlaq_f32(vld1q_f32(sum + i), vmulq_n_f32(vi, sign), vi));
+  }
+#endif
+  for (; i < size; ++i) {
+    sum[i] += sign * input[i] * input[i];
+  }
+}
+
+// output = input * (bias + alpha * sum) ^ -beta, scratch holds size floats
+void NormalizeRow(const float *input,
+                  const float *sum,
+                  const index_t size,
+                  const float bias,
+                  const float alpha,
+                  const float beta,
+                  float *scratch,
+                  float *output) {
+  // the running sum may drift slightly below zero
+  for (index_t i = 0; i < size; ++i) {
+    scratch[i] = bias + alpha * std::max(sum[i], 0.f);
+  }
+  if (beta == 0.5f) {
+    VectorRsqrt(scratch, size, scratch);
+  } else if (beta == 0.75f) {
+    // x ^ -0.75 = x ^ -0.5 * x ^ -0.5 * (x ^ -0.5) ^ -0.5
+    VectorRsqrt(scratch, size, scratch);
+    VectorRsqrt(scratch, size, output);
+    for (index_t i = 0; i < size; ++i) {
+      output[i] *= scratch[i] * scratch[i];
+    }
+    scratch = output;
+  } else if (beta == 1.f) {
+    for (index_t i = 0; i < size; ++i) {
+      scratch[i] = 1.f / scratch[i];
+    }
+  } else {
+    VectorPow(scratch, -beta, size, scratch);
+  }
+
+  index_t i = 0;
+#if defined(MACE_ENABLE_NEON)
+  for (; i + 3 < size; i += 4) {
+    vst1q_f32(output + i,
+              vmulq_f32(vld1q_f32(input + i), vld1q_f32(scratch + i)));
+  }
+#endif
+  for (; i < size; ++i) {
+    output[i] = input[i] * scratch[i];
+  }
+}
+
+}  // namespace
+
+void LocalResponseNorm(const float *input,
+                       const index_t batch,
+                       const index_t channels,
+                       const index_t image_size,
+                       const int depth_radius,
+                       const float bias,
+                       const float alpha,
+                       const float beta,
+                       float *output) {
+  const index_t tiles = RoundUpDiv(image_size, kLocalResponseNormTileSize);
+  const index_t channel_blocks =
+      RoundUpDiv(channels, kLocalResponseNormChannelBlock);
+  const index_t batch_size = channels * image_size;
+
+#pragma omp parallel for collapse(3)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t block = 0; block < channel_blocks; ++block) {
+      for (index_t tile = 0; tile < tiles; ++tile) {
+        const index_t c_begin = block * kLocalResponseNormChannelBlock;
+        const index_t c_end =
+            std::min(channels, c_begin + kLocalResponseNormChannelBlock);
+        const index_t hw_begin = tile * kLocalResponseNormTileSize;
+        const index_t size =
+            std::min(image_size - hw_begin, kLocalResponseNormTileSize);
+        const float *in_ptr = input + b * batch_size + hw_begin;
+        float *out_ptr = output + b * batch_size + hw_begin;
+
+        float sum[kLocalResponseNormTileSize];
+        float scratch[kLocalResponseNormTileSize];
+        std::fill(sum, sum + size, 0.f);
+        const index_t window_begin =
+            std::max<index_t>(0, c_begin - depth_radius);
+        const index_t window_end =
+            std::min<index_t>(channels, c_begin + depth_radius + 1);
+        for (index_t c = window_begin; c < window_end; ++c) {
+          AccumulateSquares(in_ptr + c * image_size, size, 1.f, sum);
+        }
+
+        for (index_t c = c_begin; c < c_end; ++c) {
+          NormalizeRow(in_ptr + c * image_size, sum, size, bias, alpha, beta,
+                       scratch, out_ptr + c * image_size);
+          if (c + 1 == c_end) break;
+          // slide the window from [c - r, c + r] to [c + 1 - r, c + 1 + r]
+          if (c + depth_radius + 1 < channels) {
+            AccumulateSquares(in_ptr + (c + depth_radius + 1) * image_size,
+                              size, 1.f, sum);
+          }
+          if (c - depth_radius >= 0) {
+            AccumulateSquares(in_ptr + (c - depth_radius) * image_size, size,
+                              -1.f, sum);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -15,7 +15,6 @@
 #ifndef MACE_KERNELS_LOCAL_RESPONSE_NORM_H_
 #define MACE_KERNELS_LOCAL_RESPONSE_NORM_H_
 
-#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -30,6 +29,19 @@
 namespace mace {
 namespace kernels {
 
+// output = input * (bias + alpha * sum of input^2 over the channels within
+// depth_radius) ^ -beta for NCHW input. The window sum slides across the
+// channels of contiguous H * W tiles and beta 0.5 and 0.75 avoid the pow.
+void LocalResponseNorm(const float *input,
+                       const index_t batch,
+                       const index_t channels,
+                       const index_t image_size,
+                       const int depth_radius,
+                       const float bias,
+                       const float alpha,
+                       const float beta,
+                       float *output);
+
 template<DeviceType D, typename T>
 struct LocalResponseNormFunctor;
 
@@ -48,32 +60,9 @@ struct LocalResponseNormFunctor<DeviceType::CPU, float> {
     const index_t height = input->dim(2);
     const index_t width = input->dim(3);
 
-    const float *input_ptr = input->data<float>();
-    float *output_ptr = output->mutable_data<float>();
-
-    index_t image_size = height * width;
-    index_t batch_size = channels * image_size;
-
-#pragma omp parallel for collapse(2)
-    for (index_t b = 0; b < batch; ++b) {
-      for (index_t c = 0; c < channels; ++c) {
-        const int begin_input_c = std::max(static_cast<index_t>(0),
-                                           c - depth_radius);
-        const int end_input_c = std::min(channels, c + depth_radius + 1);
-
-        index_t pos = b * batch_size;
-        for (index_t hw = 0; hw < height * width; ++hw, ++pos) {
-          float accum = 0.f;
-          for (int input_c = begin_input_c; input_c < end_input_c; ++input_c) {
-            const float input_val = input_ptr[pos + input_c * image_size];
-            accum += input_val * input_val;
-          }
-          const float multiplier = std::pow(bias + alpha * accum, -beta);
-          output_ptr[pos + c * image_size] =
-            input_ptr[pos + c * image_size] * multiplier;
-        }
-      }
-    }
+    LocalResponseNorm(input->data<float>(), batch, channels, height * width,
+                      depth_radius, bias, alpha, beta,
+                      output->mutable_data<float>());
 
     return MACE_SUCCESS;
   }
@@ -29,6 +29,7 @@
 #include "mace/core/future.h"
 #include "mace/core/tensor.h"
 #include "mace/kernels/gemm.h"
+#include "mace/kernels/packed_weight.h"
 #include "mace/utils/utils.h"
 
 #ifdef MACE_ENABLE_OPENCL
@@ -85,11 +86,59 @@ struct MatMulFunctor {
     // the block size should be sqrt(32k / sizeof(T) / 3).
     memset(c_ptr_base, 0, batch * height * width * sizeof(T));
 
-    Gemm(a_ptr_base, b_ptr_base, batch, height, K, width, c_ptr_base,
-         transpose_a, transpose_b);
+    if (packed_a_.empty() && packed_b_.empty()) {
+      Gemm(a_ptr_base, b_ptr_base, batch, height, K, width, c_ptr_base,
+           transpose_a, transpose_b);
+    } else {
+      GemmLayout a_layout = transpose_a ? TRANSPOSED : ROW_MAJOR;
+      GemmLayout b_layout = transpose_b ? TRANSPOSED : ROW_MAJOR;
+      if (!packed_a_.empty()) {
+        a_ptr_base = packed_a_.data();
+        a_layout = PACKED;
+      }
+      if (!packed_b_.empty()) {
+        b_ptr_base = packed_b_.data();
+        b_layout = PACKED;
+      }
+      GemmPacked(a_ptr_base, b_ptr_base, batch, height, K, width, c_ptr_base,
+                 a_layout, b_layout);
+    }
 
     return MACE_SUCCESS;
   }
+
+  // Packs a const A or B once for GemmPacked, so that Gemm neither
+  // transposes it block by block nor reads it with a long stride on every
+  // run.
+  MaceStatus PackA(const Tensor *A, bool transpose_a, Tensor *in_place) {
+    const index_t rank = A->dim_size();
+    index_t height = A->dim(rank - 2);
+    index_t K = A->dim(rank - 1);
+    if (transpose_a) {
+      std::swap(height, K);
+    }
+    const index_t batch = A->size() / (height * K);
+    return packed_a_.Pack(A, in_place, [=](const float *src, float *dst) {
+      GemmPackA(src, batch, height, K, transpose_a, dst);
+    });
+  }
+
+  MaceStatus PackB(const Tensor *B, bool transpose_b, Tensor *in_place) {
+    const index_t rank = B->dim_size();
+    index_t K = B->dim(rank - 2);
+    index_t width = B->dim(rank - 1);
+    if (transpose_b) {
+      std::swap(K, width);
+    }
+    const index_t batch = B->size() / (K * width);
+    return packed_b_.Pack(B, in_place, [=](const float *src, float *dst) {
+      GemmPackB(src, batch, K, width, transpose_b, dst);
+    });
+  }
+
+ private:
+  PackedWeight packed_a_;
+  PackedWeight packed_b_;
 };
 
 #ifdef MACE_ENABLE_OPENCL
@@ -0,0 +1,674 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mace/kernels/nchwc.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/vector_math.h"
+#include "mace/kernels/x86/nchwc_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Output pixels computed together by the conv kernels, their accumulators
+// (kTile vectors of c channels) stay in registers.
+constexpr int kTile = 4;
+
+// Output columns in [*begin, *end) read no horizontal padding, the others
+// have to check the input bounds.
+void CalcValidColumns(const index_t in_width,
+                      const index_t out_width,
+                      const index_t filter_w,
+                      const int stride_w,
+                      const int dilation_w,
+                      const int pad_left,
+                      index_t *begin,
+                      index_t *end) {
+  *begin = std::min<index_t>(out_width, (pad_left + stride_w - 1) / stride_w);
+  const index_t last = in_width - 1 + pad_left - (filter_w - 1) * dilation_w;
+  *end = last < 0 ? *begin
+                  : std::max(*begin, std::min<index_t>(out_width,
+                                                       last / stride_w + 1));
+}
+
+template <int B>
+void NCHWToNCHWcImpl(const float *input,
+                     const index_t *in_shape,
+                     float *output) {
+  const index_t batch = in_shape[0];
+  const index_t channels = in_shape[1];
+  const index_t image_size = in_shape[2] * in_shape[3];
+  const index_t blocks = channels / B;
+
+#pragma omp parallel for collapse(2)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t cb = 0; cb < blocks; ++cb) {
+      const float *in = input + (b * channels + cb * B) * image_size;
+      float *out = output + (b * blocks + cb) * image_size * B;
+      for (index_t i = 0; i < image_size; ++i) {
+        for (int l = 0; l < B; ++l) {
+          out[i * B + l] = in[l * image_size + i];
+        }
+      }
+    }
+  }
+}
+
+template <int B>
+void NCHWcToNCHWImpl(const float *input,
+                     const index_t *in_shape,
+                     float *output) {
+  const index_t batch = in_shape[0];
+  const index_t blocks = in_shape[1];
+  const index_t image_size = in_shape[2] * in_shape[3];
+  const index_t channels = blocks * B;
+
+#pragma omp parallel for collapse(2)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t cb = 0; cb < blocks; ++cb) {
+      const float *in = input + (b * blocks + cb) * image_size * B;
+      float *out = output + (b * channels + cb * B) * image_size;
+      for (int l = 0; l < B; ++l) {
+        for (index_t i = 0; i < image_size; ++i) {
+          out[l * image_size + i] = in[i * B + l];
+        }
+      }
+    }
+  }
+}
+
+// Applies epilogue in place to `pixels` pixels of channel block `block`.
+// residual, if any, points at the residual of the first of them.
+template <int B>
+void ApplyEpilogue(const Epilogue &epilogue,
+                   const index_t block,
+                   const float *residual,
+                   const index_t pixels,
+                   float *output) {
+  if (epilogue.empty()) {
+    return;
+  }
+
+  float bias[B];
+  float negative_slope[B];
+  for (int l = 0; l < B; ++l) {
+    bias[l] = epilogue.bias == nullptr ? 0.f : epilogue.bias[block * B + l];
+    negative_slope[l] = 1.f;
+  }
+  float max_limit = std::numeric_limits<float>::infinity();
+  switch (epilogue.activation) {
+    case NOOP:
+    case TANH:
+    case SIGMOID:
+      break;
+    case RELU:
+      std::fill(negative_slope, negative_slope + B, 0.f);
+      break;
+    case RELUX:
+      std::fill(negative_slope, negative_slope + B, 0.f);
+      max_limit = epilogue.relux_max_limit;
+      break;
+    case PRELU:
+      std::copy(epilogue.prelu_alpha + block * B,
+                epilogue.prelu_alpha + (block + 1) * B, negative_slope);
+      break;
+    default:
+      LOG(FATAL) << "Unknown activation type: " << epilogue.activation;
+  }
+
+  for (index_t i = 0; i < pixels; ++i) {
+    const float *res = residual == nullptr ? nullptr : residual + i * B;
+    float *out = output + i * B;
+    for (int l = 0; l < B; ++l) {
+      float x = out[l] + bias[l];
+      if (res != nullptr) {
+        x += res[l];
+      }
+      x = x < 0 ? x * negative_slope[l] : x;
+      out[l] = std::min(x, max_limit);
+    }
+  }
+
+  if (epilogue.activation == TANH) {
+    VectorTanh(output, pixels * B, output);
+  } else if (epilogue.activation == SIGMOID) {
+    VectorSigmoid(output, pixels * B, output);
+  }
+}
+
+// T output pixels of one output channel block, the first reading the input
+// from (ih_base, iw_base) onwards. input and filter point at the first input
+// channel block. With kCheckWidth, taps outside the input width are skipped.
+template <int B, int T, bool kCheckWidth>
+inline void Conv2dNCHWcPixels(const float *input,
+                              const float *filter,
+                              const NCHWcConvGeometry &g,
+                              const index_t ih_base,
+                              const index_t iw_base,
+                              float *output) {
+  float acc[T][B];
+  for (int t = 0; t < T; ++t) {
+    for (int co = 0; co < B; ++co) {
+      acc[t][co] = 0.f;
+    }
+  }
+
+  const index_t in_image_size = g.in_height * g.in_width * B;
+  const index_t filter_block_size = g.filter_h * g.filter_w * B * B;
+  const index_t pixel_stride = g.stride_w * B;
+  for (index_t icb = 0; icb < g.in_blocks; ++icb) {
+    const float *in_image = input + icb * in_image_size;
+    const float *filter_block = filter + icb * filter_block_size;
+    for (index_t kh = 0; kh < g.filter_h; ++kh) {
+      const index_t ih = ih_base + kh * g.dilation_h;
+      if (ih < 0 || ih >= g.in_height) {
+        continue;
+      }
+      const float *in_row = in_image + ih * g.in_width * B;
+      const float *filter_row = filter_block + kh * g.filter_w * B * B;
+      for (index_t kw = 0; kw < g.filter_w; ++kw) {
+        const index_t iw = iw_base + kw * g.dilation_w;
+        if (kCheckWidth && (iw < 0 || iw >= g.in_width)) {
+          continue;
+        }
+        const float *in_pixel = in_row + iw * B;
+        const float *w = filter_row + kw * B * B;
+        for (int ci = 0; ci < B; ++ci) {
+          for (int t = 0; t < T; ++t) {
+            const float x = in_pixel[t * pixel_stride + ci];
+            for (int co = 0; co < B; ++co) {
+              acc[t][co] += x * w[ci * B + co];
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int t = 0; t < T; ++t) {
+    for (int co = 0; co < B; ++co) {
+      output[t * B + co] = acc[t][co];
+    }
+  }
+}
+
+template <int B>
+void Conv2dNCHWcRow(const float *input,
+                    const float *filter,
+                    const NCHWcConvGeometry &g,
+                    const index_t ih_base,
+                    const index_t iw_base,
+                    const index_t count,
+                    float *output) {
+  index_t i = 0;
+  for (; i + kTile <= count; i += kTile) {
+    Conv2dNCHWcPixels<B, kTile, false>(input, filter, g, ih_base,
+                                       iw_base + i * g.stride_w,
+                                       output + i * B);
+  }
+  for (; i < count; ++i) {
+    Conv2dNCHWcPixels<B, 1, false>(input, filter, g, ih_base,
+                                   iw_base + i * g.stride_w, output + i * B);
+  }
+}
+
+template <int B>
+NCHWcConvRowFunc SelectConv2dRow() {
+  return Conv2dNCHWcRow<B>;
+}
+
+template <>
+NCHWcConvRowFunc SelectConv2dRow<8>() {
+  return KernelDispatcher<NCHWcConvRowFunc>(Conv2dNCHWcRow<8>)
+      .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(Conv2dNCHW8cRowAvx2))
+      .Select();
+}
+
+template <int B>
+void Conv2dNCHWcImpl(const float *input,
+                     const float *filter,
+                     const index_t *in_shape,
+                     const index_t *out_shape,
+                     const index_t *filter_hw,
+                     const int *stride_hw,
+                     const int *dilation_hw,
+                     const int *pad_hw,
+                     const Epilogue &epilogue,
+                     float *output) {
+  const NCHWcConvGeometry g = {in_shape[1], in_shape[2], in_shape[3],
+                          filter_hw[0], filter_hw[1], stride_hw[1],
+                          dilation_hw[0], dilation_hw[1]};
+  const index_t batch = out_shape[0];
+  const index_t out_blocks = out_shape[1];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+  const index_t in_batch_size = g.in_blocks * g.in_height * g.in_width * B;
+  const index_t out_image_size = out_height * out_width * B;
+  const index_t filter_block_size =
+      g.in_blocks * g.filter_h * g.filter_w * B * B;
+
+  index_t ow_begin, ow_end;
+  CalcValidColumns(g.in_width, out_width, g.filter_w, g.stride_w,
+                   g.dilation_w, pad_hw[1], &ow_begin, &ow_end);
+  static const NCHWcConvRowFunc conv_row = SelectConv2dRow<B>();
+
+#pragma omp parallel for collapse(3)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t ocb = 0; ocb < out_blocks; ++ocb) {
+      for (index_t oh = 0; oh < out_height; ++oh) {
+        const float *in = input + b * in_batch_size;
+        const float *w = filter + ocb * filter_block_size;
+        const index_t out_offset =
+            (b * out_blocks + ocb) * out_image_size + oh * out_width * B;
+        float *out_row = output + out_offset;
+        const index_t ih_base = oh * stride_hw[0] - pad_hw[0];
+        const index_t iw_base = -pad_hw[1];
+
+        index_t ow = 0;
+        for (; ow < ow_begin; ++ow) {
+          Conv2dNCHWcPixels<B, 1, true>(in, w, g, ih_base,
+                                        iw_base + ow * g.stride_w,
+                                        out_row + ow * B);
+        }
+        conv_row(in, w, g, ih_base, iw_base + ow * g.stride_w, ow_end - ow,
+                 out_row + ow * B);
+        ow = ow_end;
+        for (; ow < out_width; ++ow) {
+          Conv2dNCHWcPixels<B, 1, true>(in, w, g, ih_base,
+                                        iw_base + ow * g.stride_w,
+                                        out_row + ow * B);
+        }
+
+        ApplyEpilogue<B>(epilogue, ocb,
+                         epilogue.residual == nullptr
+                             ? nullptr : epilogue.residual + out_offset,
+                         out_width, out_row);
+      }
+    }
+  }
+}
+
+// Like Conv2dNCHWcPixels for depthwise conv, input and filter point at the
+// channel block.
+template <int B, int T, bool kCheckWidth>
+inline void DepthwiseConv2dNCHWcPixels(const float *input,
+                                       const float *filter,
+                                       const NCHWcConvGeometry &g,
+                                       const index_t ih_base,
+                                       const index_t iw_base,
+                                       float *output) {
+  float acc[T][B];
+  for (int t = 0; t < T; ++t) {
+    for (int l = 0; l < B; ++l) {
+      acc[t][l] = 0.f;
+    }
+  }
+
+  const index_t pixel_stride = g.stride_w * B;
+  for (index_t kh = 0; kh < g.filter_h; ++kh) {
+    const index_t ih = ih_base + kh * g.dilation_h;
+    if (ih < 0 || ih >= g.in_height) {
+      continue;
+    }
+    const float *in_row = input + ih * g.in_width * B;
+    const float *filter_row = filter + kh * g.filter_w * B;
+    for (index_t kw = 0; kw < g.filter_w; ++kw) {
+      const index_t iw = iw_base + kw * g.dilation_w;
+      if (kCheckWidth && (iw < 0 || iw >= g.in_width)) {
+        continue;
+      }
+      const float *in_pixel = in_row + iw * B;
+      const float *w = filter_row + kw * B;
+      for (int t = 0; t < T; ++t) {
+        for (int l = 0; l < B; ++l) {
+          acc[t][l] += in_pixel[t * pixel_stride + l] * w[l];
+        }
+      }
+    }
+  }
+
+  for (int t = 0; t < T; ++t) {
+    for (int l = 0; l < B; ++l) {
+      output[t * B + l] = acc[t][l];
+    }
+  }
+}
+
+template <int B>
+void DepthwiseConv2dNCHWcRow(const float *input,
+                             const float *filter,
+                             const NCHWcConvGeometry &g,
+                             const index_t ih_base,
+                             const index_t iw_base,
+                             const index_t count,
+                             float *output) {
+  index_t i = 0;
+  for (; i + kTile <= count; i += kTile) {
+    DepthwiseConv2dNCHWcPixels<B, kTile, false>(input, filter, g, ih_base,
+                                                iw_base + i * g.stride_w,
+                                                output + i * B);
+  }
+  for (; i < count; ++i) {
+    DepthwiseConv2dNCHWcPixels<B, 1, false>(input, filter, g, ih_base,
+                                            iw_base + i * g.stride_w,
+                                            output + i * B);
+  }
+}
+
+template <int B>
+NCHWcConvRowFunc SelectDepthwiseConv2dRow() {
+  return DepthwiseConv2dNCHWcRow<B>;
+}
+
+template <>
+NCHWcConvRowFunc SelectDepthwiseConv2dRow<8>() {
+  return KernelDispatcher<NCHWcConvRowFunc>(DepthwiseConv2dNCHWcRow<8>)
+      .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(DepthwiseConv2dNCHW8cRowAvx2))
+      .Select();
+}
+
+template <int B>
+void DepthwiseConv2dNCHWcImpl(const float *input,
+                              const float *filter,
+                              const index_t *in_shape,
+                              const index_t *out_shape,
+                              const index_t *filter_hw,
+                              const int *stride_hw,
+                              const int *dilation_hw,
+                              const int *pad_hw,
+                              const Epilogue &epilogue,
+                              float *output) {
+  const NCHWcConvGeometry g = {in_shape[1], in_shape[2], in_shape[3],
+                          filter_hw[0], filter_hw[1], stride_hw[1],
+                          dilation_hw[0], dilation_hw[1]};
+  const index_t batch = out_shape[0];
+  const index_t blocks = out_shape[1];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+  const index_t in_image_size = g.in_height * g.in_width * B;
+  const index_t out_image_size = out_height * out_width * B;
+  const index_t filter_block_size = g.filter_h * g.filter_w * B;
+
+  index_t ow_begin, ow_end;
+  CalcValidColumns(g.in_width, out_width, g.filter_w, g.stride_w,
+                   g.dilation_w, pad_hw[1], &ow_begin, &ow_end);
+  static const NCHWcConvRowFunc conv_row = SelectDepthwiseConv2dRow<B>();
+
+#pragma omp parallel for collapse(3)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t cb = 0; cb < blocks; ++cb) {
+      for (index_t oh = 0; oh < out_height; ++oh) {
+        const float *in = input + (b * blocks + cb) * in_image_size;
+        const float *w = filter + cb * filter_block_size;
+        const index_t out_offset =
+            (b * blocks + cb) * out_image_size + oh * out_width * B;
+        float *out_row = output + out_offset;
+        const index_t ih_base = oh * stride_hw[0] - pad_hw[0];
+        const index_t iw_base = -pad_hw[1];
+
+        index_t ow = 0;
+        for (; ow < ow_begin; ++ow) {
+          DepthwiseConv2dNCHWcPixels<B, 1, true>(in, w, g, ih_base,
+                                                 iw_base + ow * g.stride_w,
+                                                 out_row + ow * B);
+        }
+        conv_row(in, w, g, ih_base, iw_base + ow * g.stride_w, ow_end - ow,
+                 out_row + ow * B);
+        ow = ow_end;
+        for (; ow < out_width; ++ow) {
+          DepthwiseConv2dNCHWcPixels<B, 1, true>(in, w, g, ih_base,
+                                                 iw_base + ow * g.stride_w,
+                                                 out_row + ow * B);
+        }
+
+        ApplyEpilogue<B>(epilogue, cb,
+                         epilogue.residual == nullptr
+                             ? nullptr : epilogue.residual + out_offset,
+                         out_width, out_row);
+      }
+    }
+  }
+}
+
+template <int B, bool kIsMax>
+void PoolingNCHWcImpl(const float *input,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      const int *filter_hw,
+                      const int *stride_hw,
+                      const int *dilation_hw,
+                      const int *pad_hw,
+                      float *output) {
+  const index_t batch = out_shape[0];
+  const index_t blocks = out_shape[1];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+  const index_t in_height = in_shape[2];
+  const index_t in_width = in_shape[3];
+  const index_t in_image_size = in_height * in_width * B;
+  const index_t out_image_size = out_height * out_width * B;
+
+#pragma omp parallel for collapse(3)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t cb = 0; cb < blocks; ++cb) {
+      for (index_t oh = 0; oh < out_height; ++oh) {
+        const float *in = input + (b * blocks + cb) * in_image_size;
+        float *out_row =
+            output + (b * blocks + cb) * out_image_size + oh * out_width * B;
+        for (index_t ow = 0; ow < out_width; ++ow) {
+          float acc[B];
+          for (int l = 0; l < B; ++l) {
+            acc[l] = kIsMax ? std::numeric_limits<float>::lowest() : 0.f;
+          }
+          int count = 0;
+          for (int kh = 0; kh < filter_hw[0]; ++kh) {
+            const index_t ih = oh * stride_hw[0] + kh * dilation_hw[0]
+                - pad_hw[0];
+            if (ih < 0 || ih >= in_height) {
+              continue;
+            }
+            for (int kw = 0; kw < filter_hw[1]; ++kw) {
+              const index_t iw = ow * stride_hw[1] + kw * dilation_hw[1]
+                  - pad_hw[1];
+              if (iw < 0 || iw >= in_width) {
+                continue;
+              }
+              const float *in_pixel = in + (ih * in_width + iw) * B;
+              for (int l = 0; l < B; ++l) {
+                acc[l] = kIsMax ? std::max(acc[l], in_pixel[l])
+                                : acc[l] + in_pixel[l];
+              }
+              ++count;
+            }
+          }
+          float *out_pixel = out_row + ow * B;
+          for (int l = 0; l < B; ++l) {
+            out_pixel[l] = kIsMax ? acc[l] : acc[l] / count;
+          }
+        }
+      }
+    }
+  }
+}
+
+template <int B>
+void MaxPoolingNCHWcImpl(const float *input,
+                         const index_t *in_shape,
+                         const index_t *out_shape,
+                         const int *filter_hw,
+                         const int *stride_hw,
+                         const int *dilation_hw,
+                         const int *pad_hw,
+                         float *output) {
+  PoolingNCHWcImpl<B, true>(input, in_shape, out_shape, filter_hw, stride_hw,
+                            dilation_hw, pad_hw, output);
+}
+
+template <int B>
+void AvgPoolingNCHWcImpl(const float *input,
+                         const index_t *in_shape,
+                         const index_t *out_shape,
+                         const int *filter_hw,
+                         const int *stride_hw,
+                         const int *dilation_hw,
+                         const int *pad_hw,
+                         float *output) {
+  PoolingNCHWcImpl<B, false>(input, in_shape, out_shape, filter_hw, stride_hw,
+                             dilation_hw, pad_hw, output);
+}
+
+}  // namespace
+
+#define MACE_NCHWC_DISPATCH(block, func, ...)                 \
+  switch (block) {                                             \
+    case 4:                                                    \
+      func<4>(__VA_ARGS__);                                    \
+      break;                                                   \
+    case 8:                                                    \
+      func<8>(__VA_ARGS__);                                    \
+      break;                                                   \
+    default:                                                   \
+      LOG(FATAL) << "Unsupported NCHWc block size: " << block; \
+  }
+
+void NCHWToNCHWc(const float *input,
+                 const index_t *in_shape,
+                 const int block,
+                 float *output) {
+  MACE_CHECK(in_shape[1] % block == 0, "channels ", in_shape[1],
+             " is not a multiple of block ", block);
+  MACE_NCHWC_DISPATCH(block, NCHWToNCHWcImpl, input, in_shape, output);
+}
+
+void NCHWcToNCHW(const float *input,
+                 const index_t *in_shape,
+                 float *output) {
+  MACE_NCHWC_DISPATCH(in_shape[4], NCHWcToNCHWImpl, input, in_shape, output);
+}
+
+void NCHWcPackConv2dFilter(const float *filter,
+                           const index_t *filter_shape,
+                           const int block,
+                           float *packed) {
+  const index_t out_channels = filter_shape[0];
+  const index_t in_channels = filter_shape[1];
+  const index_t filter_size = filter_shape[2] * filter_shape[3];
+  MACE_CHECK(out_channels % block == 0 && in_channels % block == 0,
+             "channels are not multiples of block ", block);
+  const index_t in_blocks = in_channels / block;
+
+  for (index_t ocb = 0; ocb < out_channels / block; ++ocb) {
+    for (index_t icb = 0; icb < in_blocks; ++icb) {
+      for (index_t k = 0; k < filter_size; ++k) {
+        float *out = packed
+            + ((ocb * in_blocks + icb) * filter_size + k) * block * block;
+        for (int ci = 0; ci < block; ++ci) {
+          for (int co = 0; co < block; ++co) {
+            const index_t oc = ocb * block + co;
+            const index_t ic = icb * block + ci;
+            out[ci * block + co] =
+                filter[(oc * in_channels + ic) * filter_size + k];
+          }
+        }
+      }
+    }
+  }
+}
+
+void NCHWcPackDepthwiseFilter(const float *filter,
+                              const index_t *filter_shape,
+                              const int block,
+                              float *packed) {
+  MACE_CHECK(filter_shape[0] == 1, "only support channel multiplier 1");
+  const index_t channels = filter_shape[1];
+  const index_t filter_size = filter_shape[2] * filter_shape[3];
+  MACE_CHECK(channels % block == 0, "channels ", channels,
+             " is not a multiple of block ", block);
+
+  for (index_t cb = 0; cb < channels / block; ++cb) {
+    for (index_t k = 0; k < filter_size; ++k) {
+      for (int l = 0; l < block; ++l) {
+        packed[(cb * filter_size + k) * block + l] =
+            filter[(cb * block + l) * filter_size + k];
+      }
+    }
+  }
+}
+
+void Conv2dNCHWc(const float *input,
+                 const float *filter,
+                 const index_t *in_shape,
+                 const index_t *out_shape,
+                 const index_t *filter_hw,
+                 const int *stride_hw,
+                 const int *dilation_hw,
+                 const int *pad_hw,
+                 const Epilogue &epilogue,
+                 float *output) {
+  MACE_NCHWC_DISPATCH(in_shape[4], Conv2dNCHWcImpl, input, filter, in_shape,
+                      out_shape, filter_hw, stride_hw, dilation_hw, pad_hw,
+                      epilogue, output);
+}
+
+void DepthwiseConv2dNCHWc(const float *input,
+                          const float *filter,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const index_t *filter_hw,
+                          const int *stride_hw,
+                          const int *dilation_hw,
+                          const int *pad_hw,
+                          const Epilogue &epilogue,
+                          float *output) {
+  MACE_NCHWC_DISPATCH(in_shape[4], DepthwiseConv2dNCHWcImpl, input, filter,
+                      in_shape, out_shape, filter_hw, stride_hw, dilation_hw,
+                      pad_hw, epilogue, output);
+}
+
+void MaxPoolingNCHWc(const float *input,
+                     const index_t *in_shape,
+                     const index_t *out_shape,
+                     const int *filter_hw,
+                     const int *stride_hw,
+                     const int *dilation_hw,
+                     const int *pad_hw,
+                     float *output) {
+  MACE_NCHWC_DISPATCH(in_shape[4], MaxPoolingNCHWcImpl, input, in_shape,
+                      out_shape, filter_hw, stride_hw, dilation_hw, pad_hw,
+                      output);
+}
+
+void AvgPoolingNCHWc(const float *input,
+                     const index_t *in_shape,
+                     const index_t *out_shape,
+                     const int *filter_hw,
+                     const int *stride_hw,
+                     const int *dilation_hw,
+                     const int *pad_hw,
+                     float *output) {
+  MACE_NCHWC_DISPATCH(in_shape[4], AvgPoolingNCHWcImpl, input, in_shape,
+                      out_shape, filter_hw, stride_hw, dilation_hw, pad_hw,
+                      output);
+}
+
+#undef MACE_NCHWC_DISPATCH
+
+}  // namespace kernels
+}  // namespace mace
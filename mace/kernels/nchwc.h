@@ -0,0 +1,135 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_NCHWC_H_
+#define MACE_KERNELS_NCHWC_H_
+
+#include "mace/core/tensor.h"
+#include "mace/core/types.h"
+#include "mace/kernels/epilogue.h"
+#include "mace/kernels/x86/nchwc_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+// Kernels for the blocked NCHWc layout (NCHW4C/NCHW8C). The channels of an
+// NCHW tensor are split into blocks of c, giving a 5-D tensor
+//
+//   [batch, channels / c, height, width, c]
+//
+// so the c channels of a pixel are contiguous and every kernel below works
+// on a whole vector of channels instead of striding over height * width.
+// channels must be a multiple of c, the converter only blocks such tensors.
+// Shapes passed to the kernels are the 5-D ones.
+
+inline int NCHWcBlockSize(const DataFormat data_format) {
+  switch (data_format) {
+    case NCHW4C:
+      return 4;
+    case NCHW8C:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Computes `count` consecutive output pixels of one output channel block that
+// read no horizontal padding, the first reading the input from (ih_base,
+// iw_base) onwards. input points at the first input channel block of the
+// image (at the channel block itself for depthwise conv), filter at the
+// packed filter of the output channel block. The ISA specific variants live
+// in mace/kernels/x86.
+// NCHWcConvGeometry is declared in x86/nchwc_avx2.h, which the AVX2 kernels
+// can include without the rest of this header.
+typedef void (*NCHWcConvRowFunc)(const float *input,
+                                 const float *filter,
+                                 const NCHWcConvGeometry &geometry,
+                                 const index_t ih_base,
+                                 const index_t iw_base,
+                                 const index_t count,
+                                 float *output);
+
+// in_shape is NCHW, output is [N, C / block, H, W, block].
+void NCHWToNCHWc(const float *input,
+                 const index_t *in_shape,
+                 const int block,
+                 float *output);
+
+// in_shape is the blocked one, output is NCHW.
+void NCHWcToNCHW(const float *input,
+                 const index_t *in_shape,
+                 float *output);
+
+// OIHW -> [O / block][I / block][H][W][block of I][block of O]
+void NCHWcPackConv2dFilter(const float *filter,
+                           const index_t *filter_shape,
+                           const int block,
+                           float *packed);
+
+// [1, C, H, W] -> [C / block][H][W][block]
+void NCHWcPackDepthwiseFilter(const float *filter,
+                              const index_t *filter_shape,
+                              const int block,
+                              float *packed);
+
+// output = epilogue(conv(input, filter)), filter packed by
+// NCHWcPackConv2dFilter. epilogue.residual, if any, is blocked like output.
+void Conv2dNCHWc(const float *input,
+                 const float *filter,
+                 const index_t *in_shape,
+                 const index_t *out_shape,
+                 const index_t *filter_hw,
+                 const int *stride_hw,
+                 const int *dilation_hw,
+                 const int *pad_hw,
+                 const Epilogue &epilogue,
+                 float *output);
+
+// Depthwise conv with channel multiplier 1, filter packed by
+// NCHWcPackDepthwiseFilter.
+void DepthwiseConv2dNCHWc(const float *input,
+                          const float *filter,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const index_t *filter_hw,
+                          const int *stride_hw,
+                          const int *dilation_hw,
+                          const int *pad_hw,
+                          const Epilogue &epilogue,
+                          float *output);
+
+void MaxPoolingNCHWc(const float *input,
+                     const index_t *in_shape,
+                     const index_t *out_shape,
+                     const int *filter_hw,
+                     const int *stride_hw,
+                     const int *dilation_hw,
+                     const int *pad_hw,
+                     float *output);
+
+// Averages over the window elements inside the input only, like AvgPooling.
+void AvgPoolingNCHWc(const float *input,
+                     const index_t *in_shape,
+                     const index_t *out_shape,
+                     const int *filter_hw,
+                     const int *stride_hw,
+                     const int *dilation_hw,
+                     const int *pad_hw,
+                     float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_NCHWC_H_
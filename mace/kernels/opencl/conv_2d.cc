@@ -70,8 +70,11 @@ template <typename T>
 MaceStatus Conv2dFunctor<DeviceType::GPU, T>::operator()(const Tensor *input,
                                                          const Tensor *filter,
                                                          const Tensor *bias,
+                                                         const Tensor *residual,
                                                          Tensor *output,
                                                          StatsFuture *future) {
+  MACE_CHECK(residual == nullptr,
+             "OpenCL conv2d does not support fused residual");
   typedef MaceStatus (*Conv2dOpenclFunction)(
       cl::Kernel * kernel, const Tensor *input, const Tensor *filter,
       const Tensor *bias, const int stride, const int *padding,
@@ -0,0 +1,45 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mace/kernels/packed_weight.h"
+
+#include <vector>
+
+namespace mace {
+namespace kernels {
+
+MaceStatus PackedWeight::Pack(const Tensor *weight,
+                              Tensor *in_place,
+                              const PackFunc &pack_func) {
+  MACE_CHECK(in_place == nullptr || in_place == weight,
+             "only the weight itself can be packed in place");
+  if (in_place != nullptr) {
+    std::vector<float> packed(weight->size());
+    {
+      Tensor::MappingGuard weight_guard(weight);
+      pack_func(weight->data<float>(), packed.data());
+    }
+    in_place->Copy(packed.data(), weight->size());
+    data_ = in_place->data<float>();
+  } else {
+    Tensor::MappingGuard weight_guard(weight);
+    MACE_RETURN_IF_ERROR(packed_.Resize({weight->size()}));
+    pack_func(weight->data<float>(), packed_.mutable_data<float>());
+    data_ = packed_.data<float>();
+  }
+  return MaceStatus::MACE_SUCCESS;
+}
+
+}  // namespace kernels
+}  // namespace mace
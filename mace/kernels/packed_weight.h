@@ -0,0 +1,54 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_PACKED_WEIGHT_H_
+#define MACE_KERNELS_PACKED_WEIGHT_H_
+
+#include <functional>
+
+#include "mace/core/tensor.h"
+#include "mace/public/mace.h"
+
+namespace mace {
+namespace kernels {
+
+// A const weight repacked once at init into the layout its kernel consumes,
+// so that the kernel does not redo the packing on every run.
+class PackedWeight {
+ public:
+  typedef std::function<void(const float *weight, float *packed)> PackFunc;
+
+  PackedWeight() : data_(nullptr) {}
+
+  inline bool empty() const { return data_ == nullptr; }
+
+  inline const float *data() const { return data_; }
+
+  // pack_func writes the packed layout of weight, which has the same number
+  // of elements. If in_place is not null (it is weight itself, see
+  // OperatorBase::InPlacePackableWeight) the packed layout overwrites it
+  // instead of a copy kept here.
+  MaceStatus Pack(const Tensor *weight,
+                  Tensor *in_place,
+                  const PackFunc &pack_func);
+
+ private:
+  Tensor packed_;
+  const float *data_;
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_PACKED_WEIGHT_H_
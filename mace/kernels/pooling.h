@@ -22,7 +22,11 @@
 
 #include "mace/core/future.h"
 #include "mace/core/tensor.h"
+#include "mace/kernels/arm/pooling_neon.h"
 #include "mace/kernels/conv_pool_2d_util.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/nchwc.h"
+#include "mace/kernels/x86/pooling_avx2.h"
 
 #ifdef MACE_ENABLE_OPENCL
 #include "mace/core/runtime/opencl/cl2_header.h"
@@ -62,6 +66,23 @@ struct PoolingFunctorBase {
 template <DeviceType D, typename T>
 struct PoolingFunctor;
 
+typedef void (*PoolingKernelFunc)(const float *input,
+                                  const index_t *in_shape,
+                                  const index_t *out_shape,
+                                  const int *pad_hw,
+                                  float *output);
+
+typedef void (*GlobalPoolingKernelFunc)(const float *input,
+                                        const index_t *in_shape,
+                                        float *output);
+
+template <typename Func>
+inline Func SelectPoolingKernel(Func neon_func, Func avx2_func) {
+  return KernelDispatcher<Func>(neon_func)
+      .Register(CPU_ISA_AVX2, avx2_func)
+      .Select();
+}
+
 template <>
 struct PoolingFunctor<DeviceType::CPU, float>: PoolingFunctorBase {
   PoolingFunctor(const PoolingType pooling_type,
@@ -171,7 +192,10 @@ struct PoolingFunctor<DeviceType::CPU, float>: PoolingFunctorBase {
                   Tensor *output_tensor,
                   StatsFuture *future) {
     MACE_UNUSED(future);
-    std::vector<index_t> output_shape(4);
+    // For blocked input (NCHW4C/NCHW8C) the shape helpers see channel
+    // blocks as channels.
+    const bool is_blocked = input_tensor->dim_size() == 5;
+    std::vector<index_t> output_shape(is_blocked ? 5 : 4);
     std::vector<index_t> filter_shape = {
       input_tensor->dim(1), input_tensor->dim(1), kernels_[0], kernels_[1]};
 
@@ -190,6 +214,9 @@ struct PoolingFunctor<DeviceType::CPU, float>: PoolingFunctorBase {
                          RoundType::CEIL,
                          output_shape.data());
     }
+    if (is_blocked) {
+      output_shape[4] = input_tensor->dim(4);
+    }
     MACE_RETURN_IF_ERROR(output_tensor->Resize(output_shape));
 
     Tensor::MappingGuard input_guard(input_tensor);
@@ -199,6 +226,61 @@ struct PoolingFunctor<DeviceType::CPU, float>: PoolingFunctorBase {
     const index_t *input_shape = input_tensor->shape().data();
     int pad_hw[2] = {paddings[0] / 2, paddings[1] / 2};
 
+    const bool is_max = pooling_type_ == PoolingType::MAX;
+    if (is_blocked) {
+      if (pooling_type_ == PoolingType::MAX) {
+        MaxPoolingNCHWc(input, input_shape, output_shape.data(), kernels_,
+                        strides_, dilations_, pad_hw, output);
+      } else if (pooling_type_ == PoolingType::AVG) {
+        AvgPoolingNCHWc(input, input_shape, output_shape.data(), kernels_,
+                        strides_, dilations_, pad_hw, output);
+      } else {
+        MACE_NOT_IMPLEMENTED;
+      }
+      return MACE_SUCCESS;
+    }
+    if (output_shape[2] == 1 && output_shape[3] == 1
+        && kernels_[0] == input_shape[2] && kernels_[1] == input_shape[3]
+        && pad_hw[0] == 0 && pad_hw[1] == 0) {
+      GlobalPoolingKernelFunc kernel = is_max
+          ? SelectPoolingKernel<GlobalPoolingKernelFunc>(
+                MaxPoolingNeonGlobal, MACE_X86_KERNEL(MaxPoolingAvx2Global))
+          : SelectPoolingKernel<GlobalPoolingKernelFunc>(
+                AvgPoolingNeonGlobal, MACE_X86_KERNEL(AvgPoolingAvx2Global));
+      kernel(input, input_shape, output);
+      return MACE_SUCCESS;
+    }
+
+    PoolingKernelFunc kernel = nullptr;
+    if (kernels_[0] == kernels_[1] && strides_[0] == strides_[1]
+        && dilations_[0] == 1 && dilations_[1] == 1) {
+      const int k = kernels_[0];
+      const int s = strides_[0];
+      if (k == 2 && s == 2) {
+        kernel = is_max
+            ? SelectPoolingKernel<PoolingKernelFunc>(
+                  MaxPoolingNeonK2x2S2, MACE_X86_KERNEL(MaxPoolingAvx2K2x2S2))
+            : SelectPoolingKernel<PoolingKernelFunc>(
+                  AvgPoolingNeonK2x2S2, MACE_X86_KERNEL(AvgPoolingAvx2K2x2S2));
+      } else if (k == 3 && s == 1) {
+        kernel = is_max
+            ? SelectPoolingKernel<PoolingKernelFunc>(
+                  MaxPoolingNeonK3x3S1, MACE_X86_KERNEL(MaxPoolingAvx2K3x3S1))
+            : SelectPoolingKernel<PoolingKernelFunc>(
+                  AvgPoolingNeonK3x3S1, MACE_X86_KERNEL(AvgPoolingAvx2K3x3S1));
+      } else if (k == 3 && s == 2) {
+        kernel = is_max
+            ? SelectPoolingKernel<PoolingKernelFunc>(
+                  MaxPoolingNeonK3x3S2, MACE_X86_KERNEL(MaxPoolingAvx2K3x3S2))
+            : SelectPoolingKernel<PoolingKernelFunc>(
+                  AvgPoolingNeonK3x3S2, MACE_X86_KERNEL(AvgPoolingAvx2K3x3S2));
+      }
+    }
+    if (kernel != nullptr) {
+      kernel(input, input_shape, output_shape.data(), pad_hw, output);
+      return MACE_SUCCESS;
+    }
+
     if (pooling_type_ == PoolingType::MAX) {
       MaxPooling(input,
                  input_shape,
@@ -0,0 +1,165 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/proposal.h"
+#include "mace/kernels/x86/proposal_avx2.h"
+#include "mace/utils/utils.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+const index_t kNMSBlockSize = 64;
+
+typedef uint64_t (*NMSMaskFunc)(const float *, const float *, const float *,
+                                const float *, const float *, const index_t,
+                                const index_t, const index_t, const float);
+
+// IoU >= thresh is tested as inter >= thresh * union, so no division is
+// needed in the vector lanes.
+uint64_t NMSMaskGeneric(const float *x1,
+                        const float *y1,
+                        const float *x2,
+                        const float *y2,
+                        const float *area,
+                        const index_t i,
+                        const index_t begin,
+                        const index_t count,
+                        const float thresh) {
+  uint64_t mask = 0;
+  index_t j = 0;
+#if defined(MACE_ENABLE_NEON)
+  const float32x4_t ix1 = vdupq_n_f32(x1[i]);
+  const float32x4_t iy1 = vdupq_n_f32(y1[i]);
+  const float32x4_t ix2 = vdupq_n_f32(x2[i]);
+  const float32x4_t iy2 = vdupq_n_f32(y2[i]);
+  const float32x4_t iarea = vdupq_n_f32(area[i]);
+  const float32x4_t one = vdupq_n_f32(1.f);
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  const uint32_t lane_bits[4] = {1, 2, 4, 8};
+  const uint32x4_t vlane_bits = vld1q_u32(lane_bits);
+  for (; j + 3 < count; j += 4) {
+    const index_t b = begin + j;
+    float32x4_t w = vsubq_f32(vminq_f32(ix2, vld1q_f32(x2 + b)),
+                              vmaxq_f32(ix1, vld1q_f32(x1 + b)));
+    float32x4_t h = vsubq_f32(vminq_f32(iy2, vld1q_f32(y2 + b)),
+                              vmaxq_f32(iy1, vld1q_f32(y1 + b)));
+    w = vmaxq_f32(vaddq_f32(w, one), zero);
+    h = vmaxq_f32(vaddq_f32(h, one), zero);
+    const float32x4_t inter = vmulq_f32(w, h);
+    const float32x4_t uni =
+        vsubq_f32(vaddq_f32(iarea, vld1q_f32(area + b)), inter);
+    const uint32x4_t bits = vandq_u32(
+        vcgeq_f32(inter, vmulq_n_f32(uni, thresh)), vlane_bits);
+    const uint32x2_t pair =
+        vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    mask |= static_cast<uint64_t>(vget_lane_u32(pair, 0) +
+                                  vget_lane_u32(pair, 1)) << j;
+  }
+#endif
+  for (; j < count; ++j) {
+    const index_t b = begin + j;
+    const float w =
+        std::max(0.f, std::min(x2[i], x2[b]) - std::max(x1[i], x1[b]) + 1);
+    const float h =
+        std::max(0.f, std::min(y2[i], y2[b]) - std::max(y1[i], y1[b]) + 1);
+    const float inter = w * h;
+    if (inter >= thresh * (area[i] + area[b] - inter)) {
+      mask |= static_cast<uint64_t>(1) << j;
+    }
+  }
+  return mask;
+}
+
+}  // namespace
+
+std::vector<int> NMS(const float *bboxes,
+                     const index_t num_bboxes,
+                     const float thresh,
+                     const int max_keep) {
+  static const NMSMaskFunc mask_func =
+      KernelDispatcher<NMSMaskFunc>(NMSMaskGeneric)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(NMSMaskAvx2))
+          .Select();
+
+  std::vector<int> keep;
+  if (num_bboxes <= 0 || max_keep <= 0) {
+    return keep;
+  }
+  keep.reserve(std::min<index_t>(max_keep, num_bboxes));
+
+  // structure of arrays, so one box is tested against a row of boxes
+  std::vector<float> x1(num_bboxes), y1(num_bboxes), x2(num_bboxes),
+      y2(num_bboxes), area(num_bboxes);
+  for (index_t i = 0; i < num_bboxes; ++i) {
+    const float *box = bboxes + i * 4;
+    x1[i] = box[0];
+    y1[i] = box[1];
+    x2[i] = box[2];
+    y2[i] = box[3];
+    area[i] = (box[2] - box[0] + 1) * (box[3] - box[1] + 1);
+  }
+
+  const index_t blocks = RoundUpDiv(num_bboxes, kNMSBlockSize);
+  // bit j of removed[b] marks box b * 64 + j as suppressed
+  std::vector<uint64_t> removed(blocks, 0);
+  std::vector<index_t> block_keep;
+  block_keep.reserve(kNMSBlockSize);
+  for (index_t b = 0; b < blocks; ++b) {
+    const index_t begin = b * kNMSBlockSize;
+    const index_t count = std::min(kNMSBlockSize, num_bboxes - begin);
+    block_keep.clear();
+    for (index_t j = 0; j < count; ++j) {
+      if ((removed[b] >> j) & 1) continue;
+      const index_t i = begin + j;
+      keep.push_back(static_cast<int>(i));
+      if (static_cast<int>(keep.size()) >= max_keep) {
+        return keep;
+      }
+      block_keep.push_back(i);
+      if (j + 1 < count) {
+        removed[b] |= mask_func(x1.data(), y1.data(), x2.data(), y2.data(),
+                                area.data(), i, i + 1, count - j - 1,
+                                thresh) << (j + 1);
+      }
+    }
+
+#pragma omp parallel for
+    for (index_t cb = b + 1; cb < blocks; ++cb) {
+      const index_t cbegin = cb * kNMSBlockSize;
+      const index_t ccount = std::min(kNMSBlockSize, num_bboxes - cbegin);
+      uint64_t bits = 0;
+      for (const index_t i : block_keep) {
+        bits |= mask_func(x1.data(), y1.data(), x2.data(), y2.data(),
+                          area.data(), i, cbegin, ccount, thresh);
+      }
+      removed[cb] |= bits;
+    }
+  }
+  return keep;
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -75,49 +75,15 @@ inline std::vector<std::vector<float>> GenerateAnchors(
   return anchors;
 }
 
-inline std::vector<int> nms(const float *bboxes_ptr,
-                            const index_t num_bboxes,
-                            const float thresh,
-                            const int post_nms_top_n) {
-  std::vector<int> keep;
-  std::vector<int> suppressed(num_bboxes, 0);
-
-  std::vector<float> areas(num_bboxes, 0);
-  for (index_t i = 0; i < num_bboxes; ++i) {
-    const index_t idx = (i << 2);
-    areas[i] = (bboxes_ptr[idx + 2] - bboxes_ptr[idx] + 1) *
-        (bboxes_ptr[idx + 3] - bboxes_ptr[idx + 1] + 1);
-  }
-
-  for (int i = 0; i < num_bboxes; ++i) {
-    if (suppressed[i] == 1) continue;
-    keep.push_back(i);
-    if (keep.size() >= static_cast<size_t>(post_nms_top_n)) break;
-    int coord_idx = i << 2;
-    const float x1 = bboxes_ptr[coord_idx];
-    const float y1 = bboxes_ptr[coord_idx + 1];
-    const float x2 = bboxes_ptr[coord_idx + 2];
-    const float y2 = bboxes_ptr[coord_idx + 3];
-    const float area1 = areas[i];
-    for (int j = i + 1; j < num_bboxes; ++j) {
-      if (suppressed[j] == 1) continue;
-
-      coord_idx = j << 2;
-      const float iou =
-          std::max<float>(0.0,
-              std::min(x2, bboxes_ptr[coord_idx + 2]) -
-              std::max(x1, bboxes_ptr[coord_idx]) + 1)
-          * std::max<float>(0.0,
-              std::min(y2, bboxes_ptr[coord_idx + 3]) -
-              std::max(y1, bboxes_ptr[coord_idx + 1]) + 1);
-      if ((iou / (area1 + areas[j] - iou)) >= thresh) {
-        suppressed[j] = 1;
-      }
-    }
-  }
-  return keep;
-}
-
+// Greedy non-maximum suppression of boxes [x1, y1, x2, y2] sorted by
+// descending score: returns the indices of at most max_keep boxes, each
+// suppressing the later boxes it overlaps with IoU >= thresh. Boxes are
+// swept 64 at a time, the boxes kept in a block then build bitmasks of
+// what they suppress in every later block in parallel.
+std::vector<int> NMS(const float *bboxes,
+                     const index_t num_bboxes,
+                     const float thresh,
+                     const int max_keep);
 
 template<DeviceType D, typename T>
 struct ProposalFunctor {
@@ -238,12 +204,21 @@ struct ProposalFunctor {
       return (idx / anchors_size) * scores_chan +
           (idx % anchors_size) + anchors_size;
     };
-    std::sort(keep.begin(), keep.end(), [&](int left, int right) -> bool{
-      return scores[score_idx_func(left)] >
-          scores[score_idx_func(right)];
-    });
-
+    // only the top pre_nms_top_n need to be in order, ties are broken by
+    // index to keep the selection deterministic
+    auto score_greater = [&](int left, int right) -> bool {
+      const float left_score = scores[score_idx_func(left)];
+      const float right_score = scores[score_idx_func(right)];
+      return left_score > right_score ||
+          (left_score == right_score && left < right);
+    };
     int size = std::min<int>(pre_nms_top_n_, keep.size());
+    if (size < static_cast<int>(keep.size())) {
+      std::nth_element(keep.begin(), keep.begin() + size, keep.end(),
+                       score_greater);
+    }
+    std::sort(keep.begin(), keep.begin() + size, score_greater);
+
     std::vector<float> nms_scores(size, 0);
     std::vector<float> nms_proposals((size << 2), 0);
 #pragma omp parallel for
@@ -258,7 +233,7 @@ struct ProposalFunctor {
     /* 6. apply nms (e.g. threshold = 0.7)
        7. take after_nms_topN (e.g. 300)
        8. return the top proposals (-> RoIs top) */
-    auto nms_result = nms(nms_proposals.data(),
+    auto nms_result = NMS(nms_proposals.data(),
                           nms_scores.size(),
                           thresh_,
                           post_nms_top_n_);
@@ -0,0 +1,367 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "mace/kernels/eltwise.h"
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/reduce.h"
+#include "mace/kernels/x86/reduce_avx2.h"
+#include "mace/utils/utils.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Inner elements a task accumulates, the partial row stays in L1.
+const index_t kReduceTileSize = 1024;
+// Fewer tasks than this split the reduced axis into chunks whose partial
+// results are combined afterwards.
+const index_t kReduceMinTasks = 16;
+// Elements of input a reduce chunk covers at least.
+const index_t kReduceMinChunkSize = 4096;
+
+static_assert(REDUCE_ROW_AVX2_MEAN == static_cast<int>(REDUCE_MEAN) &&
+                  REDUCE_ROW_AVX2_SUM == static_cast<int>(REDUCE_SUM) &&
+                  REDUCE_ROW_AVX2_MAX == static_cast<int>(REDUCE_MAX) &&
+                  REDUCE_ROW_AVX2_MIN == static_cast<int>(REDUCE_MIN) &&
+                  REDUCE_ROW_AVX2_PROD == static_cast<int>(REDUCE_PROD),
+              "ReduceRowAvx2Type must match ReduceType");
+
+typedef float (*ReduceRowFunc)(const int type,
+                               const float *input,
+                               const index_t size);
+
+struct SumOp {
+  float operator()(const float a, const float b) const { return a + b; }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vaddq_f32(a, b);
+  }
+#endif
+};
+
+struct MaxOp {
+  float operator()(const float a, const float b) const {
+    return std::max(a, b);
+  }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vmaxq_f32(a, b);
+  }
+#endif
+};
+
+struct MinOp {
+  float operator()(const float a, const float b) const {
+    return std::min(a, b);
+  }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vminq_f32(a, b);
+  }
+#endif
+};
+
+struct ProdOp {
+  float operator()(const float a, const float b) const { return a * b; }
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t operator()(const float32x4_t a, const float32x4_t b) const {
+    return vmulq_f32(a, b);
+  }
+#endif
+};
+
+template <typename Op>
+float ReduceRowWith(Op op, const float *input, const index_t size) {
+  index_t i = 1;
+  float result = input[0];
+  if (size >= 8) {
+    // independent accumulators hide the latency of the dependent ops
+#if defined(MACE_ENABLE_NEON)
+    float32x4_t acc0 = vld1q_f32(input);
+    float32x4_t acc1 = vld1q_f32(input + 4);
+    for (i = 8; i + 7 < size; i += 8) {
+      acc0 = op(acc0, vld1q_f32(input + i));
+      acc1 = op(acc1, vld1q_f32(input + i + 4));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, op(acc0, acc1));
+#else
+    float lanes[4] = {input[0], input[1], input[2], input[3]};
+    for (i = 4; i + 3 < size; i += 4) {
+      lanes[0] = op(lanes[0], input[i]);
+      lanes[1] = op(lanes[1], input[i + 1]);
+      lanes[2] = op(lanes[2], input[i + 2]);
+      lanes[3] = op(lanes[3], input[i + 3]);
+    }
+#endif
+    result = op(op(lanes[0], lanes[1]), op(lanes[2], lanes[3]));
+  }
+  for (; i < size; ++i) {
+    result = op(result, input[i]);
+  }
+  return result;
+}
+
+float ReduceRowGeneric(const int type,
+                       const float *input,
+                       const index_t size) {
+  switch (static_cast<ReduceType>(type)) {
+    case REDUCE_MEAN:
+    case REDUCE_SUM:
+      return ReduceRowWith(SumOp(), input, size);
+    case REDUCE_MAX:
+      return ReduceRowWith(MaxOp(), input, size);
+    case REDUCE_MIN:
+      return ReduceRowWith(MinOp(), input, size);
+    case REDUCE_PROD:
+      return ReduceRowWith(ProdOp(), input, size);
+    default:
+      LOG(FATAL) << "Reduce not support type " << type;
+      return 0;
+  }
+}
+
+EltwiseType ReduceEltwiseType(const ReduceType type) {
+  switch (type) {
+    case REDUCE_MAX:
+      return MAX;
+    case REDUCE_MIN:
+      return MIN;
+    case REDUCE_PROD:
+      return PROD;
+    default:
+      return SUM;
+  }
+}
+
+template <typename Op>
+void AccumulateRowWith(Op op,
+                       const float *input,
+                       const index_t size,
+                       float *output) {
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = op(output[i], input[i]);
+  }
+}
+
+// output[i] = output[i] <type> input[i], short rows stay inline
+void AccumulateRow(const EltwiseType type,
+                   const float *input,
+                   const index_t size,
+                   float *output) {
+  if (size >= 64) {
+    EltwiseRow(type, output, 1, input, 1, nullptr, size, output);
+    return;
+  }
+  switch (type) {
+    case MAX:
+      AccumulateRowWith(MaxOp(), input, size, output);
+      break;
+    case MIN:
+      AccumulateRowWith(MinOp(), input, size, output);
+      break;
+    case PROD:
+      AccumulateRowWith(ProdOp(), input, size, output);
+      break;
+    default:
+      AccumulateRowWith(SumOp(), input, size, output);
+      break;
+  }
+}
+
+// output[o * inner + i] = reduce of input[(o * reduce + r) * inner + i]
+// over r, MEAN is left as the sum.
+void ReduceAxis(const ReduceType type,
+                const float *input,
+                const index_t outer,
+                const index_t reduce,
+                const index_t inner,
+                float *output) {
+  const EltwiseType eltwise_type = ReduceEltwiseType(type);
+
+  if (inner == 1) {
+    // reduce contiguous rows, in parallel over the rows if there are
+    // enough of them, otherwise over chunks of each row
+    const index_t chunk_size = RoundUpDiv(
+        reduce,
+        outer >= kReduceMinTasks
+        ? 1
+        : std::max<index_t>(1, std::min(RoundUpDiv(kReduceMinTasks, outer),
+                                        reduce / kReduceMinChunkSize)));
+    const index_t chunks = RoundUpDiv(reduce, chunk_size);
+    if (chunks == 1) {
+#pragma omp parallel for
+      for (index_t o = 0; o < outer; ++o) {
+        output[o] = ReduceRow(type, input + o * reduce, reduce);
+      }
+      return;
+    }
+    std::vector<float> partial(outer * chunks);
+#pragma omp parallel for collapse(2)
+    for (index_t o = 0; o < outer; ++o) {
+      for (index_t k = 0; k < chunks; ++k) {
+        const index_t begin = k * chunk_size;
+        partial[o * chunks + k] =
+            ReduceRow(type, input + o * reduce + begin,
+                      std::min(chunk_size, reduce - begin));
+      }
+    }
+    for (index_t o = 0; o < outer; ++o) {
+      output[o] = ReduceRow(type, partial.data() + o * chunks, chunks);
+    }
+    return;
+  }
+
+  // accumulate rows of inner elements, in parallel over (outer, inner
+  // tile) and, if that is too few tasks, over chunks of the reduced axis
+  const index_t tiles = RoundUpDiv(inner, kReduceTileSize);
+  const index_t tasks = outer * tiles;
+  const index_t chunk_rows = RoundUpDiv(
+      reduce,
+      tasks >= kReduceMinTasks
+      ? 1
+      : std::max<index_t>(1, std::min(RoundUpDiv(kReduceMinTasks, tasks),
+                                      reduce * inner / kReduceMinChunkSize)));
+  const index_t chunks = RoundUpDiv(reduce, chunk_rows);
+  std::vector<float> partial(chunks > 1 ? chunks * outer * inner : 0);
+  float *dst_base = chunks > 1 ? partial.data() : output;
+
+#pragma omp parallel for collapse(3)
+  for (index_t k = 0; k < chunks; ++k) {
+    for (index_t o = 0; o < outer; ++o) {
+      for (index_t t = 0; t < tiles; ++t) {
+        const index_t r_begin = k * chunk_rows;
+        const index_t r_end = std::min(reduce, r_begin + chunk_rows);
+        const index_t i_begin = t * kReduceTileSize;
+        const index_t size = std::min(kReduceTileSize, inner - i_begin);
+        const float *src = input + o * reduce * inner + i_begin;
+        float *dst = dst_base + (k * outer + o) * inner + i_begin;
+        memcpy(dst, src + r_begin * inner, size * sizeof(float));
+        for (index_t r = r_begin + 1; r < r_end; ++r) {
+          AccumulateRow(eltwise_type, src + r * inner, size, dst);
+        }
+      }
+    }
+  }
+
+  if (chunks > 1) {
+#pragma omp parallel for collapse(2)
+    for (index_t o = 0; o < outer; ++o) {
+      for (index_t t = 0; t < tiles; ++t) {
+        const index_t i_begin = t * kReduceTileSize;
+        const index_t size = std::min(kReduceTileSize, inner - i_begin);
+        float *dst = output + o * inner + i_begin;
+        memcpy(dst, partial.data() + o * inner + i_begin,
+               size * sizeof(float));
+        for (index_t k = 1; k < chunks; ++k) {
+          AccumulateRow(eltwise_type,
+                        partial.data() + (k * outer + o) * inner + i_begin,
+                        size, dst);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+float ReduceRow(const ReduceType type, const float *input,
+                const index_t size) {
+  static const ReduceRowFunc row_func =
+      KernelDispatcher<ReduceRowFunc>(ReduceRowGeneric)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(ReduceRowAvx2))
+          .Select();
+  return row_func(type, input, size);
+}
+
+void Reduce(const ReduceType type,
+            const float *input,
+            const std::vector<index_t> &input_shape,
+            const std::vector<bool> &reduce_axes,
+            float *output) {
+  MACE_CHECK(input_shape.size() == reduce_axes.size());
+  index_t output_size = 1;
+  index_t reduce_size = 1;
+  // merged runs of kept or reduced axes, unit axes dropped
+  std::vector<index_t> shape;
+  std::vector<bool> reduced;
+  for (size_t i = 0; i < input_shape.size(); ++i) {
+    if (reduce_axes[i]) {
+      reduce_size *= input_shape[i];
+    } else {
+      output_size *= input_shape[i];
+    }
+    if (input_shape[i] == 1) continue;
+    if (!shape.empty() && reduced.back() == reduce_axes[i]) {
+      shape.back() *= input_shape[i];
+    } else {
+      shape.push_back(input_shape[i]);
+      reduced.push_back(reduce_axes[i]);
+    }
+  }
+  if (output_size == 0) {
+    return;
+  } else if (reduce_size == 0) {
+    MACE_CHECK(type == REDUCE_SUM || type == REDUCE_PROD,
+               "Reduce of an empty axis");
+    std::fill(output, output + output_size, type == REDUCE_SUM ? 0.f : 1.f);
+    return;
+  }
+
+  // reduce the runs from the innermost one, ping-ponging between buffers
+  std::vector<float> buffers[2];
+  const float *src = input;
+  int passes = static_cast<int>(std::count(reduced.begin(), reduced.end(),
+                                           true));
+  if (passes == 0) {
+    memcpy(output, input, output_size * sizeof(float));
+    return;
+  }
+  for (int j = static_cast<int>(shape.size()) - 1; j >= 0; --j) {
+    if (!reduced[j]) continue;
+    index_t outer = 1;
+    index_t inner = 1;
+    for (int i = 0; i < j; ++i) outer *= shape[i];
+    for (size_t i = j + 1; i < shape.size(); ++i) inner *= shape[i];
+    float *dst = output;
+    if (--passes > 0) {
+      buffers[passes % 2].resize(outer * inner);
+      dst = buffers[passes % 2].data();
+    }
+    ReduceAxis(type, src, outer, shape[j], inner, dst);
+    src = dst;
+    shape[j] = 1;
+  }
+
+  if (type == REDUCE_MEAN) {
+    const float scale = 1.f / reduce_size;
+#pragma omp parallel for
+    for (index_t i = 0; i < output_size; ++i) {
+      output[i] *= scale;
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,97 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_REDUCE_H_
+#define MACE_KERNELS_REDUCE_H_
+
+#include <vector>
+
+#include "mace/core/future.h"
+#include "mace/core/tensor.h"
+#include "mace/public/mace.h"
+
+namespace mace {
+namespace kernels {
+
+enum ReduceType {
+  REDUCE_MEAN = 0,
+  REDUCE_SUM = 1,
+  REDUCE_MAX = 2,
+  REDUCE_MIN = 3,
+  REDUCE_PROD = 4,
+};
+
+// Reduce input over the axes with reduce_axes[i] set, output has the shape
+// of input without them. Unit axes are dropped and runs of kept or reduced
+// axes merged, each reduced run is then one (outer, reduce, inner) pass
+// accumulating contiguous rows with SIMD.
+void Reduce(const ReduceType type,
+            const float *input,
+            const std::vector<index_t> &input_shape,
+            const std::vector<bool> &reduce_axes,
+            float *output);
+
+// Reduce a contiguous row of size >= 1, MEAN returns the sum. Serial, with
+// NEON or AVX2 where available.
+float ReduceRow(const ReduceType type, const float *input, const index_t size);
+
+template <DeviceType D, typename T>
+struct ReduceFunctor;
+
+template <>
+struct ReduceFunctor<DeviceType::CPU, float> {
+  ReduceFunctor(const ReduceType type,
+                const std::vector<int> &axis,
+                const bool keep_dims)
+      : type_(type), axis_(axis), keep_dims_(keep_dims) {}
+
+  MaceStatus operator()(const Tensor *input,
+                        Tensor *output,
+                        StatsFuture *future) {
+    MACE_UNUSED(future);
+    const int rank = static_cast<int>(input->dim_size());
+    // no axis reduces all of them
+    std::vector<bool> reduce_axes(rank, axis_.empty());
+    for (int axis : axis_) {
+      MACE_CHECK(axis >= -rank && axis < rank, "Reduce axis ", axis,
+                 " is out of range for rank ", rank);
+      reduce_axes[axis < 0 ? axis + rank : axis] = true;
+    }
+    std::vector<index_t> output_shape;
+    for (int i = 0; i < rank; ++i) {
+      if (!reduce_axes[i]) {
+        output_shape.push_back(input->dim(i));
+      } else if (keep_dims_) {
+        output_shape.push_back(1);
+      }
+    }
+    MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+
+    Tensor::MappingGuard input_guard(input);
+    Tensor::MappingGuard output_guard(output);
+    Reduce(type_, input->data<float>(), input->shape(), reduce_axes,
+           output->mutable_data<float>());
+    return MACE_SUCCESS;
+  }
+
+  const ReduceType type_;
+  const std::vector<int> axis_;
+  const bool keep_dims_;
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_REDUCE_H_
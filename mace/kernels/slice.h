@@ -60,9 +60,23 @@ struct SliceFunctor : SliceFunctorBase {
                                                output_shape.end(),
                                                1,
                                                std::multiplies<index_t>());
-    for (size_t i= 0; i < outputs_count; ++i) {
-      MACE_RETURN_IF_ERROR(output_list[i]->Resize(output_shape));
-      output_ptrs[i] = output_list[i]->mutable_data<T>();
+
+    // with outer size 1 each output is a contiguous range of the input, the
+    // outputs owning their buffers then just become views of it
+    const bool contiguous = outer_size == 1;
+    size_t copies = 0;
+    for (size_t i = 0; i < outputs_count; ++i) {
+      if (contiguous && output_list[i]->is_buffer_owner()) {
+        output_list[i]->SliceTensorBuffer(
+            *input, i * output_channels * inner_size, output_shape);
+      } else {
+        MACE_RETURN_IF_ERROR(output_list[i]->Resize(output_shape));
+        output_ptrs[i] = output_list[i]->mutable_data<T>();
+        ++copies;
+      }
+    }
+    if (copies == 0) {
+      return MACE_SUCCESS;
     }
     const T *input_ptr = input->data<T>();
 
@@ -71,6 +85,10 @@ struct SliceFunctor : SliceFunctorBase {
       int input_idx = outer_idx * input_channels * inner_size;
       int output_idx = outer_idx * output_channels * inner_size;
       for (size_t i = 0; i < outputs_count; ++i) {
+        if (output_ptrs[i] == nullptr) {
+          input_idx += output_channels * inner_size;
+          continue;
+        }
         if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
           memcpy(output_ptrs[i]+output_idx, input_ptr+input_idx,
                  output_channels * inner_size * sizeof(T));
@@ -0,0 +1,108 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+#include <algorithm>
+#include <limits>
+
+#include "mace/kernels/softmax.h"
+#include "mace/kernels/vector_math.h"
+
+namespace mace {
+namespace kernels {
+
+index_t SoftmaxTileSize(const index_t class_count) {
+  // Keep the tile of input and output in L1/L2 across the three passes.
+  const index_t tile_size = kSoftmaxTileElements / class_count / 8 * 8;
+  return std::max<index_t>(16, std::min(kSoftmaxMaxTileSize, tile_size));
+}
+
+void SoftmaxTile(const float *input,
+                 const index_t class_count,
+                 const index_t class_stride,
+                 const index_t tile_size,
+                 float *output) {
+  MACE_CHECK(tile_size <= kSoftmaxMaxTileSize);
+  float max_val[kSoftmaxMaxTileSize];
+  float sum[kSoftmaxMaxTileSize];
+
+  // max over classes
+  std::copy(input, input + tile_size, max_val);
+  for (index_t c = 1; c < class_count; ++c) {
+    const float *in_ptr = input + c * class_stride;
+    index_t k = 0;
+#if defined(MACE_ENABLE_NEON)
+    for (; k + 3 < tile_size; k += 4) {
+      vst1q_f32(max_val + k, vmaxq_f32(vld1q_f32(max_val + k),
+                                       vld1q_f32(in_ptr + k)));
+    }
+#endif
+    for (; k < tile_size; ++k) {
+      max_val[k] = std::max(max_val[k], in_ptr[k]);
+    }
+  }
+
+  // exp(x - max) and its sum over classes
+  std::fill(sum, sum + tile_size, 0.f);
+  for (index_t c = 0; c < class_count; ++c) {
+    const float *in_ptr = input + c * class_stride;
+    float *out_ptr = output + c * class_stride;
+    index_t k = 0;
+#if defined(MACE_ENABLE_NEON)
+    for (; k + 3 < tile_size; k += 4) {
+      vst1q_f32(out_ptr + k, vsubq_f32(vld1q_f32(in_ptr + k),
+                                       vld1q_f32(max_val + k)));
+    }
+#endif
+    for (; k < tile_size; ++k) {
+      out_ptr[k] = in_ptr[k] - max_val[k];
+    }
+
+    VectorExp(out_ptr, tile_size, out_ptr);
+
+    k = 0;
+#if defined(MACE_ENABLE_NEON)
+    for (; k + 3 < tile_size; k += 4) {
+      vst1q_f32(sum + k, vaddq_f32(vld1q_f32(sum + k),
+                                   vld1q_f32(out_ptr + k)));
+    }
+#endif
+    for (; k < tile_size; ++k) {
+      sum[k] += out_ptr[k];
+    }
+  }
+
+  // normalize, sum is reused as its reciprocal
+  for (index_t k = 0; k < tile_size; ++k) {
+    sum[k] = 1.f / std::max(sum[k], std::numeric_limits<float>::min());
+  }
+  for (index_t c = 0; c < class_count; ++c) {
+    float *out_ptr = output + c * class_stride;
+    index_t k = 0;
+#if defined(MACE_ENABLE_NEON)
+    for (; k + 3 < tile_size; k += 4) {
+      vst1q_f32(out_ptr + k, vmulq_f32(vld1q_f32(out_ptr + k),
+                                       vld1q_f32(sum + k)));
+    }
+#endif
+    for (; k < tile_size; ++k) {
+      out_ptr[k] *= sum[k];
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
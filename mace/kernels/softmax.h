@@ -23,6 +23,7 @@
 
 #include "mace/core/future.h"
 #include "mace/core/tensor.h"
+#include "mace/kernels/vector_math.h"
 #include "mace/public/mace.h"
 #include "mace/utils/utils.h"
 
@@ -33,6 +34,23 @@
 namespace mace {
 namespace kernels {
 
+// NCHW softmax works on tiles of pixels across all the classes, so that
+// every pass loads contiguous pixels of a class instead of striding across
+// classes per pixel.
+const index_t kSoftmaxTileElements = 4096;
+const index_t kSoftmaxMaxTileSize = 256;
+
+// Pixels per tile for class_count classes
+index_t SoftmaxTileSize(const index_t class_count);
+
+// Softmax over class_count classes of tile_size pixels, class c of pixel k
+// is at input[c * class_stride + k].
+void SoftmaxTile(const float *input,
+                 const index_t class_count,
+                 const index_t class_stride,
+                 const index_t tile_size,
+                 float *output);
+
 template<DeviceType D, typename T>
 struct SoftmaxFunctor;
 
@@ -54,38 +72,20 @@ struct SoftmaxFunctor<DeviceType::CPU, float> {
       const index_t class_size = input->dim(2) * input->dim(3);
       const index_t batch_size = class_count * class_size;
 
+      const index_t tile_size = SoftmaxTileSize(class_count);
+      const index_t tile_count = RoundUpDiv(class_size, tile_size);
+
+#pragma omp parallel for collapse(2)
       for (index_t b = 0; b < batch; ++b) {
-#pragma omp parallel for
-        for (index_t k = 0; k < class_size; ++k) {
-          const float *input_ptr = input_data + b * batch_size + k;
-          float *output_ptr = output_data + b * batch_size + k;
-
-          float max_val = std::numeric_limits<float>::lowest();
-          index_t channel_offset = 0;
-          for (index_t c = 0; c < class_count; ++c) {
-            float data = input_ptr[channel_offset];
-            if (data > max_val) {
-              max_val = data;
-            }
-            channel_offset += class_size;
-          }
-
-          channel_offset = 0;
-          float sum = 0;
-          for (index_t c = 0; c < class_count; ++c) {
-            float exp_value = ::exp(input_ptr[channel_offset] - max_val);
-            sum += exp_value;
-            output_ptr[channel_offset] = exp_value;
-            channel_offset += class_size;
-          }
-
-          sum = std::max(sum, std::numeric_limits<float>::min());
-          channel_offset = 0;
-          for (index_t c = 0; c < class_count; ++c) {
-            output_ptr[channel_offset] /= sum;
-            channel_offset += class_size;
-          }
-        }  // k
+        for (index_t t = 0; t < tile_count; ++t) {
+          const index_t k = t * tile_size;
+          const index_t offset = b * batch_size + k;
+          SoftmaxTile(input_data + offset,
+                      class_count,
+                      class_size,
+                      std::min(tile_size, class_size - k),
+                      output_data + offset);
+        }  // t
       }  // b
     } else if (input->dim_size() == 2) {  // normal 2d softmax
       const index_t class_size = input->dim(0);
@@ -100,11 +100,14 @@ struct SoftmaxFunctor<DeviceType::CPU, float> {
           max_val = std::max(max_val, input_ptr[c]);
         }
 
+        for (index_t c = 0; c < class_count; ++c) {
+          output_ptr[c] = input_ptr[c] - max_val;
+        }
+        VectorExp(output_ptr, class_count, output_ptr);
+
         float sum = 0;
         for (index_t c = 0; c < class_count; ++c) {
-          float exp_value = ::exp(input_ptr[c] - max_val);
-          sum += exp_value;
-          output_ptr[c] = exp_value;
+          sum += output_ptr[c];
         }
 
         sum = std::max(sum, std::numeric_limits<float>::min());
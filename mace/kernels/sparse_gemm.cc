@@ -0,0 +1,445 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+#include <algorithm>
+
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/sparse_gemm.h"
+#include "mace/kernels/x86/sparse_gemm_avx2.h"
+#include "mace/utils/logging.h"
+
+#if defined(MACE_ENABLE_NEON) && !defined(__aarch64__)
+#define vaddvq_f32(v) ((v)[0] + (v)[1] + (v)[2] + (v)[3])
+#endif
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Columns of C per step, their sums stay in registers over all the blocks of
+// the block row.
+const index_t kSparseGemmCols = 8;
+
+const int kMaxSparseBlockRows = 8;
+const index_t kSparseGemvTileBatch = 16;
+
+// C[BR, width] = the BR rows of A with the given blocks x B[K, width]
+template <int BR, int BC>
+void SparseGemmRows(const int32_t *col_idx,
+                    const float *values,
+                    const index_t blocks,
+                    const float *B,
+                    const index_t width,
+                    float *C) {
+  index_t w = 0;
+  for (; w + kSparseGemmCols <= width; w += kSparseGemmCols) {
+#if defined(MACE_ENABLE_NEON)
+    float32x4_t sum[BR][2];
+    for (int r = 0; r < BR; ++r) {
+      sum[r][0] = vdupq_n_f32(0.f);
+      sum[r][1] = vdupq_n_f32(0.f);
+    }
+    for (index_t i = 0; i < blocks; ++i) {
+      const float *b_ptr = B + col_idx[i] * width + w;
+      const float *v_ptr = values + i * BR * BC;
+      for (int c = 0; c < BC; ++c) {
+        const float32x4_t b0 = vld1q_f32(b_ptr + c * width);
+        const float32x4_t b1 = vld1q_f32(b_ptr + c * width + 4);
+        for (int r = 0; r < BR; ++r) {
+          sum[r][0] = vmlaq_n_f32(sum[r][0], b0, v_ptr[r * BC + c]);
+          sum[r][1] = vmlaq_n_f32(sum[r][1], b1, v_ptr[r * BC + c]);
+        }
+      }
+    }
+    for (int r = 0; r < BR; ++r) {
+      vst1q_f32(C + r * width + w, sum[r][0]);
+      vst1q_f32(C + r * width + w + 4, sum[r][1]);
+    }
+#else
+    float sum[BR][kSparseGemmCols] = {{0.f}};
+    for (index_t i = 0; i < blocks; ++i) {
+      const float *b_ptr = B + col_idx[i] * width + w;
+      const float *v_ptr = values + i * BR * BC;
+      for (int c = 0; c < BC; ++c) {
+        for (int r = 0; r < BR; ++r) {
+          const float v = v_ptr[r * BC + c];
+          for (index_t j = 0; j < kSparseGemmCols; ++j) {
+            sum[r][j] += v * b_ptr[c * width + j];
+          }
+        }
+      }
+    }
+    for (int r = 0; r < BR; ++r) {
+      std::copy(sum[r], sum[r] + kSparseGemmCols, C + r * width + w);
+    }
+#endif
+  }
+  for (; w < width; ++w) {
+    float sum[BR] = {0.f};
+    for (index_t i = 0; i < blocks; ++i) {
+      const float *b_ptr = B + col_idx[i] * width + w;
+      const float *v_ptr = values + i * BR * BC;
+      for (int c = 0; c < BC; ++c) {
+        for (int r = 0; r < BR; ++r) {
+          sum[r] += v_ptr[r * BC + c] * b_ptr[c * width];
+        }
+      }
+    }
+    for (int r = 0; r < BR; ++r) {
+      C[r * width + w] = sum[r];
+    }
+  }
+}
+
+// Any other block shape
+void SparseGemmRowsGeneral(const int32_t *col_idx,
+                           const float *values,
+                           const index_t blocks,
+                           const int block_rows,
+                           const int block_cols,
+                           const float *B,
+                           const index_t width,
+                           float *C) {
+  std::fill(C, C + block_rows * width, 0.f);
+  for (index_t i = 0; i < blocks; ++i) {
+    const float *v_ptr = values + i * block_rows * block_cols;
+    for (int r = 0; r < block_rows; ++r) {
+      for (int c = 0; c < block_cols; ++c) {
+        const float v = v_ptr[r * block_cols + c];
+        const float *b_ptr = B + (col_idx[i] + c) * width;
+        float *c_ptr = C + r * width;
+        for (index_t w = 0; w < width; ++w) {
+          c_ptr[w] += v * b_ptr[w];
+        }
+      }
+    }
+  }
+}
+
+// See SparseGemmBlockRowAvx2
+void SparseGemmBlockRow(const int32_t *col_idx,
+                        const float *values,
+                        const index_t blocks,
+                        const int block_rows,
+                        const int block_cols,
+                        const float *B,
+                        const index_t width,
+                        float *C) {
+  if (block_rows == 4 && block_cols == 1) {
+    SparseGemmRows<4, 1>(col_idx, values, blocks, B, width, C);
+  } else if (block_rows == 1 && block_cols == 4) {
+    SparseGemmRows<1, 4>(col_idx, values, blocks, B, width, C);
+  } else if (block_rows == 1 && block_cols == 1) {
+    SparseGemmRows<1, 1>(col_idx, values, blocks, B, width, C);
+  } else {
+    SparseGemmRowsGeneral(col_idx, values, blocks, block_rows, block_cols, B,
+                          width, C);
+  }
+}
+
+// Vectors per step of the sparse gemv, they share each load of the blocks.
+const int kSparseGemvBatch = 4;
+
+// sums[r * sums_stride + b] for the 4 rows of a block row of m with 4x1
+// blocks and NB vectors v[b, width]
+template <int NB>
+void SparseGemv4x1(const int32_t *col_idx,
+                   const float *values,
+                   const index_t blocks,
+                   const float *v_ptr,
+                   const index_t width,
+                   const index_t sums_stride,
+                   float *sums) {
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t vsum[NB];
+  for (int b = 0; b < NB; ++b) {
+    vsum[b] = vdupq_n_f32(0.f);
+  }
+  for (index_t i = 0; i < blocks; ++i) {
+    const float32x4_t m = vld1q_f32(values + i * 4);
+    for (int b = 0; b < NB; ++b) {
+      vsum[b] = vmlaq_n_f32(vsum[b], m, v_ptr[b * width + col_idx[i]]);
+    }
+  }
+  for (int b = 0; b < NB; ++b) {
+    float sum[4];
+    vst1q_f32(sum, vsum[b]);
+    for (int r = 0; r < 4; ++r) {
+      sums[r * sums_stride + b] = sum[r];
+    }
+  }
+#else
+  float sum[NB][4] = {{0.f}};
+  for (index_t i = 0; i < blocks; ++i) {
+    for (int b = 0; b < NB; ++b) {
+      const float v = v_ptr[b * width + col_idx[i]];
+      for (int r = 0; r < 4; ++r) {
+        sum[b][r] += values[i * 4 + r] * v;
+      }
+    }
+  }
+  for (int b = 0; b < NB; ++b) {
+    for (int r = 0; r < 4; ++r) {
+      sums[r * sums_stride + b] = sum[b][r];
+    }
+  }
+#endif
+}
+
+// sums[b] for the row of a block row of m with 1x4 blocks and NB vectors
+// v[b, width]
+template <int NB>
+void SparseGemv1x4(const int32_t *col_idx,
+                   const float *values,
+                   const index_t blocks,
+                   const float *v_ptr,
+                   const index_t width,
+                   float *sums) {
+#if defined(MACE_ENABLE_NEON)
+  float32x4_t vsum[NB];
+  for (int b = 0; b < NB; ++b) {
+    vsum[b] = vdupq_n_f32(0.f);
+  }
+  for (index_t i = 0; i < blocks; ++i) {
+    const float32x4_t m = vld1q_f32(values + i * 4);
+    for (int b = 0; b < NB; ++b) {
+      vsum[b] = vmlaq_f32(vsum[b], m, vld1q_f32(v_ptr + b * width
+                                                    + col_idx[i]));
+    }
+  }
+  for (int b = 0; b < NB; ++b) {
+    sums[b] = vaddvq_f32(vsum[b]);
+  }
+#else
+  float sum[NB][4] = {{0.f}};
+  for (index_t i = 0; i < blocks; ++i) {
+    for (int b = 0; b < NB; ++b) {
+      const float *vec = v_ptr + b * width + col_idx[i];
+      for (int c = 0; c < 4; ++c) {
+        sum[b][c] += values[i * 4 + c] * vec[c];
+      }
+    }
+  }
+  for (int b = 0; b < NB; ++b) {
+    sums[b] = sum[b][0] + sum[b][1] + sum[b][2] + sum[b][3];
+  }
+#endif
+}
+
+void SparseGemvRowsGeneral(const int32_t *col_idx,
+                           const float *values,
+                           const index_t blocks,
+                           const int block_rows,
+                           const int block_cols,
+                           const float *v_ptr,
+                           const index_t batch,
+                           const index_t width,
+                           const index_t sums_stride,
+                           float *sums) {
+  for (int r = 0; r < block_rows; ++r) {
+    for (index_t b = 0; b < batch; ++b) {
+      const float *vec = v_ptr + b * width;
+      float sum = 0.f;
+      for (index_t i = 0; i < blocks; ++i) {
+        const float *m_ptr = values + (i * block_rows + r) * block_cols;
+        for (int c = 0; c < block_cols; ++c) {
+          sum += m_ptr[c] * vec[col_idx[i] + c];
+        }
+      }
+      sums[r * sums_stride + b] = sum;
+    }
+  }
+}
+
+// See SparseGemvBlockRowAvx2
+void SparseGemvBlockRow(const int32_t *col_idx,
+                        const float *values,
+                        const index_t blocks,
+                        const int block_rows,
+                        const int block_cols,
+                        const float *v_ptr,
+                        const index_t batch,
+                        const index_t width,
+                        const index_t sums_stride,
+                        float *sums) {
+  const int kB = kSparseGemvBatch;
+  if (block_rows == 4 && block_cols == 1) {
+    index_t b = 0;
+    for (; b + kB <= batch; b += kB) {
+      SparseGemv4x1<kB>(col_idx, values, blocks, v_ptr + b * width, width,
+                        sums_stride, sums + b);
+    }
+    for (; b < batch; ++b) {
+      SparseGemv4x1<1>(col_idx, values, blocks, v_ptr + b * width, width,
+                       sums_stride, sums + b);
+    }
+  } else if (block_rows == 1 && block_cols == 4) {
+    index_t b = 0;
+    for (; b + kB <= batch; b += kB) {
+      SparseGemv1x4<kB>(col_idx, values, blocks, v_ptr + b * width, width,
+                        sums + b);
+    }
+    for (; b < batch; ++b) {
+      SparseGemv1x4<1>(col_idx, values, blocks, v_ptr + b * width, width,
+                       sums + b);
+    }
+  } else {
+    SparseGemvRowsGeneral(col_idx, values, blocks, block_rows, block_cols,
+                          v_ptr, batch, width, sums_stride, sums);
+  }
+}
+
+void CheckBlockSparseMatrix(const BlockSparseMatrix &m) {
+  MACE_CHECK(m.block_rows > 0 && m.block_rows <= kMaxSparseBlockRows
+                 && m.block_cols > 0
+                 && m.rows % m.block_rows == 0 && m.cols % m.block_cols == 0,
+             "Invalid block sparse matrix ", m.rows, "x", m.cols,
+             " with blocks ", m.block_rows, "x", m.block_cols);
+}
+
+}  // namespace
+
+void SparseGemm(const BlockSparseMatrix &A,
+                const float *B,
+                const index_t batch,
+                const index_t width,
+                float *C,
+                const Epilogue *epilogue) {
+  typedef void (*SparseGemmBlockRowFunc)(const int32_t *, const float *,
+                                         const index_t, const int, const int,
+                                         const float *, const index_t,
+                                         float *);
+  static const SparseGemmBlockRowFunc sparse_gemm_block_row =
+      KernelDispatcher<SparseGemmBlockRowFunc>(SparseGemmBlockRow)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(SparseGemmBlockRowAvx2))
+          .Select();
+  CheckBlockSparseMatrix(A);
+  const bool has_epilogue = epilogue != nullptr && !epilogue->empty();
+  const index_t height = A.rows;
+  const index_t K = A.cols;
+  const index_t block_rows = A.block_rows;
+  const index_t row_blocks = height / block_rows;
+
+#pragma omp parallel for collapse(2)
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t rb = 0; rb < row_blocks; ++rb) {
+      const int32_t begin = A.row_ptr[rb];
+      float *c_ptr = C + (b * height + rb * block_rows) * width;
+      sparse_gemm_block_row(
+          A.col_idx + begin, A.values + begin * block_rows * A.block_cols,
+          A.row_ptr[rb + 1] - begin, A.block_rows, A.block_cols,
+          B + b * K * width, width, c_ptr);
+      if (has_epilogue) {
+        const Epilogue batch_epilogue =
+            epilogue->Offset(b * height * epilogue->residual_stride);
+        for (index_t r = 0; r < block_rows; ++r) {
+          batch_epilogue.Apply(c_ptr + r * width, rb * block_rows + r, 0,
+                               width, c_ptr + r * width);
+        }
+      }
+    }
+  }
+}
+
+void SparseBatchedGemv(const BlockSparseMatrix &m,
+                       const float *v_ptr,
+                       const index_t batch,
+                       float *out_ptr,
+                       const Epilogue *epilogue) {
+  typedef void (*SparseGemvBlockRowFunc)(const int32_t *, const float *,
+                                         const index_t, const int, const int,
+                                         const float *, const index_t,
+                                         const index_t, const index_t,
+                                         float *);
+  static const SparseGemvBlockRowFunc sparse_gemv_block_row =
+      KernelDispatcher<SparseGemvBlockRowFunc>(SparseGemvBlockRow)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(SparseGemvBlockRowAvx2))
+          .Select();
+  CheckBlockSparseMatrix(m);
+  MACE_CHECK(epilogue == nullptr || epilogue->residual == nullptr,
+             "SparseBatchedGemv does not support residual");
+  const bool has_epilogue = epilogue != nullptr && !epilogue->empty();
+  const index_t height = m.rows;
+  const index_t width = m.cols;
+  const index_t block_rows = m.block_rows;
+  const index_t row_blocks = height / block_rows;
+  const index_t kTileBatch = kSparseGemvTileBatch;
+
+  for (index_t b = 0; b < batch; b += kTileBatch) {
+    const index_t tile_batch = std::min(kTileBatch, batch - b);
+    const float *v_tile = v_ptr + b * width;
+    float *out_tile = out_ptr + b * height;
+#pragma omp parallel for
+    for (index_t rb = 0; rb < row_blocks; ++rb) {
+      const int32_t begin = m.row_ptr[rb];
+      // [block_rows, tile_batch], i.e. the epilogue channels are contiguous
+      float sums[kMaxSparseBlockRows * kSparseGemvTileBatch];
+      sparse_gemv_block_row(
+          m.col_idx + begin, m.values + begin * block_rows * m.block_cols,
+          m.row_ptr[rb + 1] - begin, m.block_rows, m.block_cols, v_tile,
+          tile_batch, width, tile_batch, sums);
+      for (index_t r = 0; r < block_rows; ++r) {
+        float *sum_ptr = sums + r * tile_batch;
+        const index_t h = rb * block_rows + r;
+        if (has_epilogue) {
+          epilogue->Apply(sum_ptr, h, 0, tile_batch, sum_ptr);
+        }
+        for (index_t i = 0; i < tile_batch; ++i) {
+          out_tile[i * height + h] = sum_ptr[i];
+        }
+      }
+    }
+  }
+}
+
+void BlockSparseEncode(const float *dense,
+                       const index_t rows,
+                       const index_t cols,
+                       const int block_rows,
+                       const int block_cols,
+                       std::vector<int32_t> *row_ptr,
+                       std::vector<int32_t> *col_idx,
+                       std::vector<float> *values) {
+  MACE_CHECK(rows % block_rows == 0 && cols % block_cols == 0);
+  row_ptr->assign(1, 0);
+  col_idx->clear();
+  values->clear();
+  for (index_t r = 0; r < rows; r += block_rows) {
+    for (index_t c = 0; c < cols; c += block_cols) {
+      bool non_zero = false;
+      for (int i = 0; i < block_rows && !non_zero; ++i) {
+        for (int j = 0; j < block_cols && !non_zero; ++j) {
+          non_zero = dense[(r + i) * cols + c + j] != 0.f;
+        }
+      }
+      if (!non_zero) {
+        continue;
+      }
+      col_idx->push_back(static_cast<int32_t>(c));
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          values->push_back(dense[(r + i) * cols + c + j]);
+        }
+      }
+    }
+    row_ptr->push_back(static_cast<int32_t>(col_idx->size()));
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,78 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_SPARSE_GEMM_H_
+#define MACE_KERNELS_SPARSE_GEMM_H_
+
+#include <vector>
+
+#include "mace/core/types.h"
+#include "mace/kernels/epilogue.h"
+
+namespace mace {
+namespace kernels {
+
+// A rows x cols matrix in block-CSR format. It is cut into
+// block_rows x block_cols blocks, only the blocks with a non-zero are
+// stored: those of block row r are blocks [row_ptr[r], row_ptr[r + 1]),
+// block i starts at column col_idx[i] and its values are the block_rows x
+// block_cols floats (row-major) at values + i * block_rows * block_cols.
+// rows and cols are multiples of block_rows and block_cols, block_rows is at
+// most 8.
+struct BlockSparseMatrix {
+  index_t rows;
+  index_t cols;
+  int block_rows;
+  int block_cols;
+  const int32_t *row_ptr;  // [rows / block_rows + 1]
+  const int32_t *col_idx;  // [row_ptr[rows / block_rows]]
+  const float *values;
+};
+
+// C = A x B for a block sparse A (height x K) and B (K x width), i.e. a 1x1
+// convolution with a pruned filter. The epilogue (if any) is applied to each
+// row of C, the residual of batch n starts at
+// epilogue->residual + n * height * residual_stride like Gemm.
+void SparseGemm(const BlockSparseMatrix &A,
+                const float *B,
+                const index_t batch,
+                const index_t width,
+                float *C,
+                const Epilogue *epilogue = nullptr);
+
+// out[b, h] = sum_w m[h, w] * v[b, w] like BatchedGemv for a block sparse m
+// (height x width), i.e. a fully connected layer with pruned weights. The
+// epilogue (if any) must not have a residual.
+void SparseBatchedGemv(const BlockSparseMatrix &m,
+                       const float *v_ptr,
+                       const index_t batch,
+                       float *out_ptr,
+                       const Epilogue *epilogue = nullptr);
+
+// Encodes a dense rows x cols matrix, keeping the blocks with a non-zero.
+// The converter encodes model weights the same way, this is for tests and
+// benchmarks.
+void BlockSparseEncode(const float *dense,
+                       const index_t rows,
+                       const index_t cols,
+                       const int block_rows,
+                       const int block_cols,
+                       std::vector<int32_t> *row_ptr,
+                       std::vector<int32_t> *col_idx,
+                       std::vector<float> *values);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_SPARSE_GEMM_H_
@@ -0,0 +1,186 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "mace/core/types.h"
+#include "mace/kernels/gemm.h"
+#include "mace/kernels/sparse_gemm.h"
+
+namespace mace {
+
+namespace {
+
+// A random N x K matrix with about `sparsity` of its block_rows x block_cols
+// blocks zero.
+void RandomBlockSparse(index_t N,
+                       index_t K,
+                       int block_rows,
+                       int block_cols,
+                       float sparsity,
+                       float *A) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+  std::uniform_real_distribution<float> ud(0, 1);
+
+  for (index_t r = 0; r < N; r += block_rows) {
+    for (index_t c = 0; c < K; c += block_cols) {
+      const bool zero = ud(gen) < sparsity;
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          A[(r + i) * K + c + j] = zero ? 0.f : nd(gen);
+        }
+      }
+    }
+  }
+}
+
+// SparseGemm with bias, residual and PReLU fused versus GemmRef with the
+// dense A then the same element-wise ops.
+void SparseGemmTest(index_t batch,
+                    index_t N,
+                    index_t K,
+                    index_t M,
+                    int block_rows,
+                    int block_cols,
+                    float sparsity) {
+  std::unique_ptr<float[]> A(new float[N * K]);
+  std::unique_ptr<float[]> B(new float[batch * K * M]);
+  std::unique_ptr<float[]> C(new float[batch * N * M]);
+  std::unique_ptr<float[]> C_ref(new float[N * M]);
+  std::unique_ptr<float[]> residual(new float[batch * N * M]);
+  std::unique_ptr<float[]> bias(new float[N]);
+  std::unique_ptr<float[]> alpha(new float[N]);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+
+  RandomBlockSparse(N, K, block_rows, block_cols, sparsity, A.get());
+  std::generate(B.get(), B.get() + batch * K * M,
+                [&gen, &nd] { return nd(gen); });
+  std::generate(residual.get(), residual.get() + batch * N * M,
+                [&gen, &nd] { return nd(gen); });
+  std::generate(bias.get(), bias.get() + N, [&gen, &nd] { return nd(gen); });
+  std::generate(alpha.get(), alpha.get() + N, [&gen, &nd] { return nd(gen); });
+
+  std::vector<int32_t> row_ptr;
+  std::vector<int32_t> col_idx;
+  std::vector<float> values;
+  kernels::BlockSparseEncode(A.get(), N, K, block_rows, block_cols, &row_ptr,
+                             &col_idx, &values);
+  kernels::BlockSparseMatrix sparse_a = {N, K, block_rows, block_cols,
+                                         row_ptr.data(), col_idx.data(),
+                                         values.data()};
+
+  kernels::SparseGemm(sparse_a, B.get(), batch, M, C.get());
+  for (index_t b = 0; b < batch; ++b) {
+    kernels::GemmRef(A.get(), B.get() + b * K * M, 1, N, K, M, C_ref.get());
+    for (index_t i = 0; i < N * M; ++i) {
+      EXPECT_NEAR(C_ref[i], C[b * N * M + i], 0.1);
+    }
+  }
+
+  kernels::Epilogue epilogue;
+  epilogue.bias = bias.get();
+  epilogue.residual = residual.get();
+  epilogue.residual_stride = M;
+  epilogue.activation = kernels::PRELU;
+  epilogue.prelu_alpha = alpha.get();
+  kernels::SparseGemm(sparse_a, B.get(), batch, M, C.get(), &epilogue);
+  for (index_t b = 0; b < batch; ++b) {
+    kernels::GemmRef(A.get(), B.get() + b * K * M, 1, N, K, M, C_ref.get());
+    for (index_t i = 0; i < N * M; ++i) {
+      const index_t n = i / M;
+      float x = C_ref[i] + bias[n] + residual[b * N * M + i];
+      x = x < 0 ? x * alpha[n] : x;
+      EXPECT_NEAR(x, C[b * N * M + i], 0.1);
+    }
+  }
+}
+
+// SparseBatchedGemv with bias and PReLU fused versus GemvRef with the dense
+// matrix then the same element-wise ops.
+void SparseBatchedGemvTest(index_t batch,
+                           index_t N,
+                           index_t M,
+                           int block_rows,
+                           int block_cols,
+                           float sparsity) {
+  std::unique_ptr<float[]> A(new float[N * M]);
+  std::unique_ptr<float[]> B(new float[batch * M]);
+  std::unique_ptr<float[]> C(new float[batch * N]);
+  std::unique_ptr<float[]> C_ref(new float[batch * N]);
+  std::unique_ptr<float[]> bias(new float[N]);
+  std::unique_ptr<float[]> alpha(new float[N]);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+
+  RandomBlockSparse(N, M, block_rows, block_cols, sparsity, A.get());
+  std::generate(B.get(), B.get() + batch * M, [&gen, &nd] { return nd(gen); });
+  std::generate(bias.get(), bias.get() + N, [&gen, &nd] { return nd(gen); });
+  std::generate(alpha.get(), alpha.get() + N, [&gen, &nd] { return nd(gen); });
+
+  std::vector<int32_t> row_ptr;
+  std::vector<int32_t> col_idx;
+  std::vector<float> values;
+  kernels::BlockSparseEncode(A.get(), N, M, block_rows, block_cols, &row_ptr,
+                             &col_idx, &values);
+  kernels::BlockSparseMatrix sparse_a = {N, M, block_rows, block_cols,
+                                         row_ptr.data(), col_idx.data(),
+                                         values.data()};
+
+  kernels::GemvRef(A.get(), B.get(), batch, M, N, C_ref.get());
+  kernels::Epilogue epilogue;
+  epilogue.bias = bias.get();
+  epilogue.activation = kernels::PRELU;
+  epilogue.prelu_alpha = alpha.get();
+  kernels::SparseBatchedGemv(sparse_a, B.get(), batch, C.get(), &epilogue);
+  for (index_t i = 0; i < batch * N; ++i) {
+    const index_t n = i % N;
+    float x = C_ref[i] + bias[n];
+    x = x < 0 ? x * alpha[n] : x;
+    EXPECT_NEAR(x, C[i], 0.1);
+  }
+}
+
+}  // namespace
+
+TEST(SparseGemmTest, SparseGemm) {
+  const int kBlocks[][2] = {{4, 1}, {1, 4}, {1, 1}, {2, 2}};
+  for (auto block : kBlocks) {
+    SparseGemmTest(1, 64, 64, 128, block[0], block[1], 0.8f);
+    SparseGemmTest(2, 32, 36, 61, block[0], block[1], 0.5f);
+    SparseGemmTest(1, 8, 16, 7, block[0], block[1], 0.f);
+    SparseGemmTest(1, 16, 32, 40, block[0], block[1], 1.f);
+  }
+}
+
+TEST(SparseGemmTest, SparseBatchedGemv) {
+  const int kBlocks[][2] = {{4, 1}, {1, 4}, {1, 1}, {2, 2}};
+  for (auto block : kBlocks) {
+    SparseBatchedGemvTest(1, 64, 128, block[0], block[1], 0.8f);
+    SparseBatchedGemvTest(3, 32, 36, block[0], block[1], 0.5f);
+    SparseBatchedGemvTest(19, 8, 16, block[0], block[1], 0.f);
+    SparseBatchedGemvTest(2, 16, 32, block[0], block[1], 1.f);
+  }
+}
+
+}  // namespace mace
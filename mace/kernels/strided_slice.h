@@ -102,6 +102,7 @@ struct StridedSliceFunctor {
     }
 
     std::vector<index_t> output_shape;
+    std::vector<index_t> output_dim_lens(input->dim_size(), 0);
     std::vector<index_t> real_begin_indices(input->dim_size(), 0);
     std::vector<index_t> real_end_indices(input->dim_size(), 0);
     for (index_t d = 0; d < input->dim_size(); ++d) {
@@ -126,6 +127,7 @@ struct StridedSliceFunctor {
       int32_t out_dim_len = std::max(
           0.f, std::ceil((real_end_indices[d] - real_begin_indices[d]) /
                          static_cast<float>(strides_data[d])));
+      output_dim_lens[d] = out_dim_len;
       if (!(shrink_axis_mask_ & (1 << d))) {
         output_shape.push_back(out_dim_len);
       } else {
@@ -140,6 +142,30 @@ struct StridedSliceFunctor {
       dim_stride[d] = dim_stride[d + 1] * input->dim(d + 1);
     }
 
+    // The output is one contiguous range of the input if every dim before
+    // the first one longer than 1 is taken once and every dim after it is
+    // taken whole, then an output owning its buffer just views the input.
+    bool contiguous = D == DeviceType::CPU && output->is_buffer_owner();
+    bool leading = true;
+    index_t view_offset = 0;
+    for (index_t d = 0; d < input->dim_size() && contiguous; ++d) {
+      view_offset += real_begin_indices[d] * dim_stride[d];
+      if (leading) {
+        if (output_dim_lens[d] != 1) {
+          leading = false;
+          contiguous = output_dim_lens[d] > 0 && strides_data[d] == 1;
+        }
+      } else {
+        contiguous = output_dim_lens[d] == input->dim(d) &&
+            strides_data[d] == 1;
+      }
+    }
+    if (contiguous) {
+      output->SliceTensorBuffer(*input, view_offset, output_shape);
+      SetFutureDefaultWaitFn(future);
+      return MACE_SUCCESS;
+    }
+
     MACE_RETURN_IF_ERROR(output->Resize(output_shape));
     Tensor::MappingGuard output_guard(output);
     T *output_data = output->mutable_data<T>();
@@ -0,0 +1,189 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/top_k.h"
+#include "mace/kernels/x86/top_k_avx2.h"
+#include "mace/utils/utils.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// k at least this fraction of the row partially sorts it, the block maxima
+// would rarely let a block be skipped.
+const index_t kTopKHeapMaxRatio = 16;
+
+typedef void (*BlockMaxFunc)(const float *input,
+                             const index_t size,
+                             const index_t block_size,
+                             float *block_max);
+
+typedef std::pair<float, int32_t> Candidate;
+
+// Larger values first, equal values by their index. As the heap comparator
+// it keeps the worst candidate on top.
+struct BetterCandidate {
+  bool operator()(const Candidate &a, const Candidate &b) const {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  }
+};
+
+void BlockMaxGeneric(const float *input,
+                     const index_t size,
+                     const index_t block_size,
+                     float *block_max) {
+  for (index_t begin = 0; begin < size; begin += block_size) {
+    const float *block = input + begin;
+    const index_t count = std::min(block_size, size - begin);
+    float result = -std::numeric_limits<float>::infinity();
+    index_t j = 0;
+#if defined(MACE_ENABLE_NEON)
+    if (count >= 8) {
+      float32x4_t acc0 = vdupq_n_f32(result);
+      float32x4_t acc1 = acc0;
+      for (; j + 7 < count; j += 8) {
+        acc0 = vmaxq_f32(acc0, vld1q_f32(block + j));
+        acc1 = vmaxq_f32(acc1, vld1q_f32(block + j + 4));
+      }
+      float lanes[4];
+      vst1q_f32(lanes, vmaxq_f32(acc0, acc1));
+      result = std::max(std::max(lanes[0], lanes[1]),
+                        std::max(lanes[2], lanes[3]));
+    }
+#endif
+    for (; j < count; ++j) {
+      result = std::max(result, block[j]);
+    }
+    block_max[begin / block_size] = result;
+  }
+}
+
+index_t ArgMaxRowScalar(const float *input, const index_t size) {
+  index_t idx = 0;
+  float max_value = std::numeric_limits<float>::lowest();
+  for (index_t j = 0; j < size; ++j) {
+    if (input[j] > max_value) {
+      max_value = input[j];
+      idx = j;
+    }
+  }
+  return idx;
+}
+
+void TopKRowSort(const float *input,
+                 const index_t size,
+                 const index_t k,
+                 float *values,
+                 int32_t *indices) {
+  std::vector<int32_t> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                    [input](const int32_t a, const int32_t b) {
+                      return BetterCandidate()(Candidate(input[a], a),
+                                               Candidate(input[b], b));
+                    });
+  for (index_t i = 0; i < k; ++i) {
+    values[i] = input[order[i]];
+    indices[i] = order[i];
+  }
+}
+
+void TopKRowHeap(const float *input,
+                 const index_t size,
+                 const index_t k,
+                 float *values,
+                 int32_t *indices) {
+  std::vector<float> block_max(RoundUpDiv(size, kTopKBlockSize));
+  BlockMax(input, size, block_max.data());
+  BetterCandidate better;
+  std::vector<Candidate> heap;
+  heap.reserve(k);
+  for (index_t begin = 0; begin < size; begin += kTopKBlockSize) {
+    const bool full = static_cast<index_t>(heap.size()) == k;
+    // elements equal to the k-th largest lose to it on the index
+    if (full && !(block_max[begin / kTopKBlockSize] > heap.front().first)) {
+      continue;
+    }
+    const index_t end = std::min(size, begin + kTopKBlockSize);
+    for (index_t j = begin; j < end; ++j) {
+      if (static_cast<index_t>(heap.size()) < k) {
+        heap.emplace_back(input[j], static_cast<int32_t>(j));
+        std::push_heap(heap.begin(), heap.end(), better);
+      } else if (input[j] > heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = Candidate(input[j], static_cast<int32_t>(j));
+        std::push_heap(heap.begin(), heap.end(), better);
+      }
+    }
+  }
+  std::sort_heap(heap.begin(), heap.end(), better);
+  for (index_t i = 0; i < k; ++i) {
+    values[i] = heap[i].first;
+    indices[i] = heap[i].second;
+  }
+}
+
+}  // namespace
+
+void BlockMax(const float *input, const index_t size, float *block_max) {
+  static const BlockMaxFunc func =
+      KernelDispatcher<BlockMaxFunc>(BlockMaxGeneric)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(BlockMaxAvx2))
+          .Select();
+  func(input, size, kTopKBlockSize, block_max);
+}
+
+index_t ArgMaxRow(const float *input, const index_t size) {
+  if (size <= kTopKBlockSize) {
+    return ArgMaxRowScalar(input, size);
+  }
+  std::vector<float> block_max(RoundUpDiv(size, kTopKBlockSize));
+  BlockMax(input, size, block_max.data());
+  const index_t block = ArgMaxRowScalar(block_max.data(), block_max.size());
+  const index_t begin = block * kTopKBlockSize;
+  return begin + ArgMaxRowScalar(input + begin,
+                                 std::min(kTopKBlockSize, size - begin));
+}
+
+void TopKRow(const float *input,
+             const index_t size,
+             const index_t k,
+             float *values,
+             int32_t *indices) {
+  if (k == 0) {
+    return;
+  } else if (k == 1) {
+    indices[0] = static_cast<int32_t>(ArgMaxRow(input, size));
+    values[0] = input[indices[0]];
+  } else if (k * kTopKHeapMaxRatio >= size) {
+    TopKRowSort(input, size, k, values, indices);
+  } else {
+    TopKRowHeap(input, size, k, values, indices);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,100 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_TOP_K_H_
+#define MACE_KERNELS_TOP_K_H_
+
+#include <vector>
+
+#include "mace/core/future.h"
+#include "mace/core/tensor.h"
+#include "mace/public/mace.h"
+
+namespace mace {
+namespace kernels {
+
+// Floats a block maximum covers. TopKRow and ArgMaxRow only scan the
+// elements of blocks whose maximum beats the current k-th largest value.
+const index_t kTopKBlockSize = 64;
+
+// block_max[b] = max of input[b * kTopKBlockSize, (b + 1) * kTopKBlockSize)
+// clipped to size, -inf for a block of NaNs. Serial, with NEON or AVX2
+// where available.
+void BlockMax(const float *input, const index_t size, float *block_max);
+
+// Index of the first largest element of a row, 0 if there is none larger
+// than the lowest float. NaNs are skipped by the scalar path only, rows with
+// NaNs give unspecified results.
+index_t ArgMaxRow(const float *input, const index_t size);
+
+// The k largest elements of a row in descending order, equal values in
+// ascending index order like TF TopKV2. Small k keeps a heap of the
+// candidates, larger k partially sorts the row. k <= size, NaNs give
+// unspecified results.
+void TopKRow(const float *input,
+             const index_t size,
+             const index_t k,
+             float *values,
+             int32_t *indices);
+
+template <DeviceType D, typename T>
+struct TopKFunctor;
+
+template <>
+struct TopKFunctor<DeviceType::CPU, float> {
+  MaceStatus operator()(const Tensor *input,
+                        const Tensor *k,
+                        Tensor *values,
+                        Tensor *indices,
+                        StatsFuture *future) {
+    MACE_UNUSED(future);
+    MACE_CHECK(input->dim_size() > 0, "TopK input should not be a scalar");
+    MACE_CHECK(k->dim_size() == 0, "TopK only supports scalar k");
+    Tensor::MappingGuard k_guard(k);
+    const index_t k_value = k->data<int32_t>()[0];
+    const index_t row_size = input->dim(input->dim_size() - 1);
+    MACE_CHECK(k_value >= 0 && k_value <= row_size, "TopK k ", k_value,
+               " is out of range [0, ", row_size, "]");
+
+    std::vector<index_t> output_shape(input->shape());
+    output_shape.back() = k_value;
+    MACE_RETURN_IF_ERROR(values->Resize(output_shape));
+    MACE_RETURN_IF_ERROR(indices->Resize(output_shape));
+    if (values->size() == 0) {
+      return MACE_SUCCESS;
+    }
+
+    Tensor::MappingGuard input_guard(input);
+    Tensor::MappingGuard values_guard(values);
+    Tensor::MappingGuard indices_guard(indices);
+    const float *input_data = input->data<float>();
+    float *values_data = values->mutable_data<float>();
+    int32_t *indices_data = indices->mutable_data<int32_t>();
+    const index_t rows = row_size == 0 ? 0 : input->size() / row_size;
+
+#pragma omp parallel for
+    for (index_t i = 0; i < rows; ++i) {
+      TopKRow(input_data + i * row_size, row_size, k_value,
+              values_data + i * k_value, indices_data + i * k_value);
+    }
+
+    return MACE_SUCCESS;
+  }
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_TOP_K_H_
@@ -0,0 +1,78 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_TRANSFORM_DATA_FORMAT_H_
+#define MACE_KERNELS_TRANSFORM_DATA_FORMAT_H_
+
+#include <vector>
+
+#include "mace/core/future.h"
+#include "mace/core/tensor.h"
+#include "mace/kernels/nchwc.h"
+
+namespace mace {
+namespace kernels {
+
+template <DeviceType D, typename T>
+struct TransformDataFormatFunctor;
+
+// Converts between NCHW and the blocked NCHW4C/NCHW8C, the converter puts
+// it where a run of blocked ops starts or ends. data_format is the format of
+// the output, the one of the input follows from its rank.
+template <>
+struct TransformDataFormatFunctor<DeviceType::CPU, float> {
+  explicit TransformDataFormatFunctor(const DataFormat data_format)
+      : data_format_(data_format) {}
+
+  MaceStatus operator()(const Tensor *input,
+                        Tensor *output,
+                        StatsFuture *future) {
+    MACE_UNUSED(future);
+    const std::vector<index_t> &in_shape = input->shape();
+    std::vector<index_t> output_shape;
+    int block = 0;
+    if (data_format_ == NCHW) {
+      MACE_CHECK(input->dim_size() == 5, "input is not blocked");
+      output_shape = {in_shape[0], in_shape[1] * in_shape[4], in_shape[2],
+                      in_shape[3]};
+    } else {
+      block = NCHWcBlockSize(data_format_);
+      MACE_CHECK(block > 0, "unsupported data format ", data_format_);
+      MACE_CHECK(input->dim_size() == 4 && in_shape[1] % block == 0,
+                 "input should be NCHW with channels a multiple of ", block);
+      output_shape = {in_shape[0], in_shape[1] / block, in_shape[2],
+                      in_shape[3], block};
+    }
+    MACE_RETURN_IF_ERROR(output->Resize(output_shape));
+
+    Tensor::MappingGuard input_guard(input);
+    Tensor::MappingGuard output_guard(output);
+    const float *input_data = input->data<float>();
+    float *output_data = output->mutable_data<float>();
+    if (block == 0) {
+      NCHWcToNCHW(input_data, in_shape.data(), output_data);
+    } else {
+      NCHWToNCHWc(input_data, in_shape.data(), block, output_data);
+    }
+    return MACE_SUCCESS;
+  }
+
+  const DataFormat data_format_;
+};
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_TRANSFORM_DATA_FORMAT_H_
@@ -0,0 +1,357 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/transpose.h"
+#include "mace/kernels/x86/transpose_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Side of the square 2D tiles, 32x32 floats of input and output fit in L1.
+const index_t kTransposeTileSize = 32;
+// Elements per parallel task when whole rows are copied.
+const index_t kTransposeRowChunkSize = 16384;
+
+typedef void (*TransposeBlockFunc)(const float *src,
+                                   const index_t src_stride,
+                                   const index_t rows,
+                                   const index_t cols,
+                                   const index_t dst_stride,
+                                   float *dst);
+
+// dst[c * dst_stride + r] = src[r * src_stride + c]
+template <typename T>
+void TransposeBlock(const T *src,
+                    const index_t src_stride,
+                    const index_t rows,
+                    const index_t cols,
+                    const index_t dst_stride,
+                    T *dst) {
+  for (index_t c = 0; c < cols; ++c) {
+    for (index_t r = 0; r < rows; ++r) {
+      dst[c * dst_stride + r] = src[r * src_stride + c];
+    }
+  }
+}
+
+void TransposeBlockFloat(const float *src,
+                         const index_t src_stride,
+                         const index_t rows,
+                         const index_t cols,
+                         const index_t dst_stride,
+                         float *dst) {
+#if defined(MACE_ENABLE_NEON)
+  if (rows == 2 && dst_stride == 2) {
+    // interleave two planes, e.g. NCHW -> NHWC with C = 2
+    index_t c = 0;
+    for (; c + 3 < cols; c += 4) {
+      float32x4x2_t vi = {vld1q_f32(src + c),
+                          vld1q_f32(src + src_stride + c)};
+      vst2q_f32(dst + c * 2, vi);
+    }
+    TransposeBlock(src + c, src_stride, rows, cols - c, dst_stride,
+                   dst + c * dst_stride);
+    return;
+  }
+  if (cols == 3 && src_stride == 3) {
+    // split three interleaved planes, e.g. NHWC -> NCHW with C = 3
+    index_t r = 0;
+    for (; r + 3 < rows; r += 4) {
+      float32x4x3_t vi = vld3q_f32(src + r * 3);
+      vst1q_f32(dst + r, vi.val[0]);
+      vst1q_f32(dst + dst_stride + r, vi.val[1]);
+      vst1q_f32(dst + 2 * dst_stride + r, vi.val[2]);
+    }
+    TransposeBlock(src + r * 3, src_stride, rows - r, cols, dst_stride,
+                   dst + r);
+    return;
+  }
+
+  const index_t rows4 = rows & ~3;
+  const index_t cols4 = cols & ~3;
+  for (index_t r = 0; r < rows4; r += 4) {
+    for (index_t c = 0; c < cols4; c += 4) {
+      const float *src_ptr = src + r * src_stride + c;
+      float *dst_ptr = dst + c * dst_stride + r;
+      float32x4x2_t t01 = vtrnq_f32(vld1q_f32(src_ptr),
+                                    vld1q_f32(src_ptr + src_stride));
+      float32x4x2_t t23 = vtrnq_f32(vld1q_f32(src_ptr + 2 * src_stride),
+                                    vld1q_f32(src_ptr + 3 * src_stride));
+      vst1q_f32(dst_ptr, vcombine_f32(vget_low_f32(t01.val[0]),
+                                      vget_low_f32(t23.val[0])));
+      vst1q_f32(dst_ptr + dst_stride, vcombine_f32(vget_low_f32(t01.val[1]),
+                                                   vget_low_f32(t23.val[1])));
+      vst1q_f32(dst_ptr + 2 * dst_stride,
+                vcombine_f32(vget_high_f32(t01.val[0]),
+                             vget_high_f32(t23.val[0])));
+      vst1q_f32(dst_ptr + 3 * dst_stride,
+                vcombine_f32(vget_high_f32(t01.val[1]),
+                             vget_high_f32(t23.val[1])));
+    }
+  }
+  TransposeBlock(src + cols4, src_stride, rows, cols - cols4, dst_stride,
+                 dst + cols4 * dst_stride);
+  TransposeBlock(src + rows4 * src_stride, src_stride, rows - rows4, cols4,
+                 dst_stride, dst + rows4);
+#else
+  TransposeBlock(src, src_stride, rows, cols, dst_stride, dst);
+#endif
+}
+
+template <typename T>
+struct TransposeBlockSelector {
+  typedef void (*Func)(const T *, const index_t, const index_t, const index_t,
+                       const index_t, T *);
+  static Func Select() { return TransposeBlock<T>; }
+};
+
+template <>
+struct TransposeBlockSelector<float> {
+  typedef TransposeBlockFunc Func;
+  static Func Select() {
+    static const TransposeBlockFunc block_func =
+        KernelDispatcher<TransposeBlockFunc>(TransposeBlockFloat)
+            .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(TransposeBlockAvx2))
+            .Select();
+    return block_func;
+  }
+};
+
+// Drop unit axes and merge the input axes which stay adjacent in the
+// output, e.g. [N, H, W, C] by {0, 3, 1, 2} becomes [N, H * W, C] by
+// {0, 2, 1}.
+void SimplifyTranspose(const std::vector<index_t> &input_shape,
+                       const std::vector<int> &dims,
+                       std::vector<index_t> *shape,
+                       std::vector<int> *perm) {
+  const int rank = static_cast<int>(input_shape.size());
+  std::vector<int> kept_index(rank, -1);
+  int kept = 0;
+  for (int i = 0; i < rank; ++i) {
+    if (input_shape[i] != 1) {
+      kept_index[i] = kept++;
+    }
+  }
+  std::vector<int> kept_dims;
+  for (int i = 0; i < rank; ++i) {
+    if (kept_index[dims[i]] >= 0) {
+      kept_dims.push_back(kept_index[dims[i]]);
+    }
+  }
+
+  // groups of consecutive output axes reading consecutive input axes,
+  // group_start[g] is the first input axis of output group g
+  std::vector<int> group_start;
+  std::vector<int> group_end;
+  for (size_t i = 0; i < kept_dims.size(); ++i) {
+    if (i > 0 && kept_dims[i] == group_end.back()) {
+      ++group_end.back();
+    } else {
+      group_start.push_back(kept_dims[i]);
+      group_end.push_back(kept_dims[i] + 1);
+    }
+  }
+  std::vector<index_t> kept_shape;
+  for (int i = 0; i < rank; ++i) {
+    if (kept_index[i] >= 0) {
+      kept_shape.push_back(input_shape[i]);
+    }
+  }
+
+  const size_t groups = group_start.size();
+  std::vector<int> input_order(groups);
+  for (size_t g = 0; g < groups; ++g) {
+    input_order[g] = static_cast<int>(g);
+  }
+  std::sort(input_order.begin(), input_order.end(),
+            [&group_start](int a, int b) {
+              return group_start[a] < group_start[b];
+            });
+  shape->clear();
+  perm->assign(groups, 0);
+  for (size_t i = 0; i < groups; ++i) {
+    const int g = input_order[i];
+    index_t size = 1;
+    for (int axis = group_start[g]; axis < group_end[g]; ++axis) {
+      size *= kept_shape[axis];
+    }
+    shape->push_back(size);
+    (*perm)[g] = static_cast<int>(i);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void Transpose(const T *input,
+               const std::vector<index_t> &input_shape,
+               const std::vector<int> &dims,
+               T *output) {
+  const int input_rank = static_cast<int>(input_shape.size());
+  MACE_CHECK(static_cast<int>(dims.size()) == input_rank,
+             "Transpose dims size ", dims.size(), " != input rank ",
+             input_rank);
+  std::vector<bool> seen(input_rank, false);
+  for (int dim : dims) {
+    MACE_CHECK(dim >= 0 && dim < input_rank && !seen[dim],
+               "Transpose dims is not a permutation");
+    seen[dim] = true;
+  }
+
+  std::vector<index_t> shape;
+  std::vector<int> perm;
+  SimplifyTranspose(input_shape, dims, &shape, &perm);
+  const int rank = static_cast<int>(shape.size());
+  index_t size = 1;
+  for (index_t dim : shape) {
+    size *= dim;
+  }
+  if (size == 0) {
+    return;
+  } else if (rank <= 1) {
+    memcpy(output, input, size * sizeof(T));
+    return;
+  }
+
+  std::vector<index_t> in_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * shape[i + 1];
+  }
+  std::vector<index_t> out_shape(rank);
+  std::vector<index_t> out_strides(rank, 1);
+  for (int i = 0; i < rank; ++i) {
+    out_shape[i] = shape[perm[i]];
+  }
+  for (int i = rank - 2; i >= 0; --i) {
+    out_strides[i] = out_strides[i + 1] * out_shape[i + 1];
+  }
+
+  if (perm[rank - 1] == rank - 1) {
+    // the innermost axis stays innermost: copy whole rows, walking the
+    // output in order and the input with an odometer
+    const index_t inner = shape[rank - 1];
+    const index_t rows = size / inner;
+    const index_t chunk_rows =
+        std::max<index_t>(1, kTransposeRowChunkSize / inner);
+    const index_t chunks = (rows + chunk_rows - 1) / chunk_rows;
+    const int outer_rank = rank - 1;
+#pragma omp parallel for
+    for (index_t chunk = 0; chunk < chunks; ++chunk) {
+      const index_t begin = chunk * chunk_rows;
+      const index_t end = std::min(rows, begin + chunk_rows);
+      std::vector<index_t> index(outer_rank);
+      index_t in_offset = 0;
+      index_t remain = begin;
+      for (int i = outer_rank - 1; i >= 0; --i) {
+        index[i] = remain % out_shape[i];
+        remain /= out_shape[i];
+        in_offset += index[i] * in_strides[perm[i]];
+      }
+      for (index_t row = begin; row < end; ++row) {
+        memcpy(output + row * inner, input + in_offset, inner * sizeof(T));
+        for (int i = outer_rank - 1; i >= 0; --i) {
+          in_offset += in_strides[perm[i]];
+          if (++index[i] < out_shape[i]) break;
+          in_offset -= in_strides[perm[i]] * out_shape[i];
+          index[i] = 0;
+        }
+      }
+    }
+    return;
+  }
+
+  // The output innermost axis (rows, strided in the input) and the input
+  // innermost axis (cols, strided in the output) form 2D matrices which are
+  // transposed tile by tile, every other axis is an outer loop.
+  const int row_axis = perm[rank - 1];
+  const int col_pos = static_cast<int>(
+      std::find(perm.begin(), perm.end(), rank - 1) - perm.begin());
+  const index_t rows = shape[row_axis];
+  const index_t cols = shape[rank - 1];
+  const index_t src_stride = in_strides[row_axis];
+  const index_t dst_stride = out_strides[col_pos];
+  std::vector<index_t> outer_shape;
+  std::vector<index_t> outer_in_strides;
+  std::vector<index_t> outer_out_strides;
+  for (int i = 0; i < rank - 1; ++i) {
+    if (i != col_pos) {
+      outer_shape.push_back(out_shape[i]);
+      outer_in_strides.push_back(in_strides[perm[i]]);
+      outer_out_strides.push_back(out_strides[i]);
+    }
+  }
+  const int outer_rank = static_cast<int>(outer_shape.size());
+  const index_t outer_size = size / (rows * cols);
+
+  // narrow matrices get long tiles so every task still moves a full tile
+  const index_t tile_area = kTransposeTileSize * kTransposeTileSize;
+  index_t tile_rows = kTransposeTileSize;
+  index_t tile_cols = kTransposeTileSize;
+  if (cols < kTransposeTileSize) {
+    tile_rows = RoundUp<index_t>(tile_area / cols, 8);
+  } else if (rows < kTransposeTileSize) {
+    tile_cols = RoundUp<index_t>(tile_area / rows, 8);
+  }
+  tile_rows = std::min(tile_rows, rows);
+  tile_cols = std::min(tile_cols, cols);
+  const index_t row_tiles = RoundUpDiv(rows, tile_rows);
+  const index_t col_tiles = RoundUpDiv(cols, tile_cols);
+  const index_t tasks = outer_size * row_tiles * col_tiles;
+  const typename TransposeBlockSelector<T>::Func block_func =
+      TransposeBlockSelector<T>::Select();
+
+#pragma omp parallel for
+  for (index_t task = 0; task < tasks; ++task) {
+    const index_t col_tile = task % col_tiles;
+    const index_t row_tile = task / col_tiles % row_tiles;
+    index_t remain = task / (col_tiles * row_tiles);
+    index_t in_offset = 0;
+    index_t out_offset = 0;
+    for (int i = outer_rank - 1; i >= 0; --i) {
+      const index_t index = remain % outer_shape[i];
+      remain /= outer_shape[i];
+      in_offset += index * outer_in_strides[i];
+      out_offset += index * outer_out_strides[i];
+    }
+    const index_t r = row_tile * tile_rows;
+    const index_t c = col_tile * tile_cols;
+    block_func(input + in_offset + r * src_stride + c, src_stride,
+               std::min(tile_rows, rows - r), std::min(tile_cols, cols - c),
+               dst_stride, output + out_offset + c * dst_stride + r);
+  }
+}
+
+template void Transpose<float>(const float *input,
+                               const std::vector<index_t> &input_shape,
+                               const std::vector<int> &dims,
+                               float *output);
+template void Transpose<int32_t>(const int32_t *input,
+                                 const std::vector<index_t> &input_shape,
+                                 const std::vector<int> &dims,
+                                 int32_t *output);
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,307 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+#include <algorithm>
+#include <cmath>
+
+#include "mace/kernels/kernel_dispatch.h"
+#include "mace/kernels/vector_math.h"
+#include "mace/kernels/x86/vector_math_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+typedef void (*VectorFunc)(const float *input,
+                           const index_t size,
+                           float *output);
+typedef void (*VectorPowFunc)(const float *input,
+                              const float exponent,
+                              const index_t size,
+                              float *output);
+
+#if defined(MACE_ENABLE_NEON)
+// The polynomials are the ones of Cephes expf, logf and tanhf.
+
+inline float32x4_t Exp4(float32x4_t x) {
+  const float32x4_t max_input = vdupq_n_f32(88.7228394f);   // ln(FLT_MAX)
+  const float32x4_t min_input = vdupq_n_f32(-87.3365479f);  // ln(FLT_MIN)
+  const uint32x4_t overflow = vcgtq_f32(x, max_input);
+  const uint32x4_t underflow = vcltq_f32(x, min_input);
+  x = vminq_f32(vmaxq_f32(x, min_input), max_input);
+
+  // x = n * ln2 + r, |r| <= ln2 / 2, n = floor(x * log2(e) + 0.5)
+  const float32x4_t fx = vmlaq_f32(vdupq_n_f32(0.5f), x,
+                                   vdupq_n_f32(1.44269504088896341f));
+  float32x4_t n = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+  n = vsubq_f32(n, vbslq_f32(vcgtq_f32(n, fx), vdupq_n_f32(1.f),
+                             vdupq_n_f32(0.f)));
+  float32x4_t r = vmlsq_f32(x, n, vdupq_n_f32(0.693359375f));
+  r = vmlsq_f32(r, n, vdupq_n_f32(-2.12194440e-4f));
+
+  float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+  p = vmlaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+  p = vmlaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+  p = vmlaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+  p = vmlaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+  p = vmlaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+  p = vmlaq_f32(vaddq_f32(r, vdupq_n_f32(1.f)), p, vmulq_f32(r, r));
+
+  // 2^n in two halves as n may be 128
+  const int32x4_t ni = vcvtq_s32_f32(n);
+  const int32x4_t n1 = vshrq_n_s32(ni, 1);
+  const int32x4_t n2 = vsubq_s32(ni, n1);
+  const int32x4_t bias = vdupq_n_s32(127);
+  p = vmulq_f32(p, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n1, bias),
+                                                     23)));
+  p = vmulq_f32(p, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n2, bias),
+                                                     23)));
+
+  p = vbslq_f32(overflow, vdupq_n_f32(INFINITY), p);
+  return vbslq_f32(underflow, vdupq_n_f32(0.f), p);
+}
+
+inline float32x4_t Log4(float32x4_t x) {
+  const float32x4_t one = vdupq_n_f32(1.f);
+  // x < 0 or NaN
+  const uint32x4_t invalid = vmvnq_u32(vcgeq_f32(x, vdupq_n_f32(0.f)));
+  const uint32x4_t zero = vceqq_f32(x, vdupq_n_f32(0.f));
+  const uint32x4_t infinity = vceqq_f32(x, vdupq_n_f32(INFINITY));
+  // denormals are taken as FLT_MIN
+  const float32x4_t v = vmaxq_f32(x, vdupq_n_f32(1.17549435e-38f));
+
+  // x = m * 2^e, sqrt(1/2) <= m < sqrt(2)
+  const uint32x4_t vi = vreinterpretq_u32_f32(v);
+  float32x4_t e = vcvtq_f32_s32(vsubq_s32(
+      vreinterpretq_s32_u32(vshrq_n_u32(vi, 23)), vdupq_n_s32(126)));
+  float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(
+      vandq_u32(vi, vdupq_n_u32(0x807fffff)),
+      vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+  const uint32x4_t small =
+      vcltq_f32(m, vdupq_n_f32(0.707106781186547524f));
+  e = vsubq_f32(e, vbslq_f32(small, one, vdupq_n_f32(0.f)));
+  m = vaddq_f32(vsubq_f32(m, one), vbslq_f32(small, m, vdupq_n_f32(0.f)));
+
+  const float32x4_t z = vmulq_f32(m, m);
+  float32x4_t p = vdupq_n_f32(7.0376836292e-2f);
+  p = vmlaq_f32(vdupq_n_f32(-1.1514610310e-1f), p, m);
+  p = vmlaq_f32(vdupq_n_f32(1.1676998740e-1f), p, m);
+  p = vmlaq_f32(vdupq_n_f32(-1.2420140846e-1f), p, m);
+  p = vmlaq_f32(vdupq_n_f32(1.4249322787e-1f), p, m);
+  p = vmlaq_f32(vdupq_n_f32(-1.6668057665e-1f), p, m);
+  p = vmlaq_f32(vdupq_n_f32(2.0000714765e-1f), p, m);
+  p = vmlaq_f32(vdupq_n_f32(-2.4999993993e-1f), p, m);
+  p = vmlaq_f32(vdupq_n_f32(3.3333331174e-1f), p, m);
+  float32x4_t y = vmulq_f32(vmulq_f32(p, m), z);
+  y = vmlaq_f32(y, e, vdupq_n_f32(-2.12194440e-4f));
+  y = vmlsq_f32(y, z, vdupq_n_f32(0.5f));
+  y = vaddq_f32(m, y);
+  y = vmlaq_f32(y, e, vdupq_n_f32(0.693359375f));
+
+  y = vbslq_f32(zero, vdupq_n_f32(-INFINITY), y);
+  y = vbslq_f32(infinity, x, y);
+  return vbslq_f32(invalid, vdupq_n_f32(NAN), y);
+}
+
+inline float32x4_t Tanh4(float32x4_t x) {
+  const float32x4_t abs_x = vabsq_f32(x);
+
+  // |x| < 0.625: x + x^3 * P(x^2)
+  const float32x4_t z = vmulq_f32(x, x);
+  float32x4_t p = vdupq_n_f32(-5.70498872745e-3f);
+  p = vmlaq_f32(vdupq_n_f32(2.06390887954e-2f), p, z);
+  p = vmlaq_f32(vdupq_n_f32(-5.37397155531e-2f), p, z);
+  p = vmlaq_f32(vdupq_n_f32(1.33314422036e-1f), p, z);
+  p = vmlaq_f32(vdupq_n_f32(-3.33332819422e-1f), p, z);
+  const float32x4_t small_y = vmlaq_f32(x, vmulq_f32(p, z), x);
+
+  // otherwise: 1 - 2 / (exp(2|x|) + 1)
+  const float32x4_t one = vdupq_n_f32(1.f);
+  const float32x4_t e = Exp4(vaddq_f32(abs_x, abs_x));
+  float32x4_t y = vsubq_f32(one, Div4(vdupq_n_f32(2.f), vaddq_f32(e, one)));
+  // sign of x
+  y = vbslq_f32(vdupq_n_u32(0x80000000), x, y);
+
+  return vbslq_f32(vcltq_f32(abs_x, vdupq_n_f32(0.625f)), small_y, y);
+}
+
+inline float32x4_t Sigmoid4(float32x4_t x) {
+  const float32x4_t one = vdupq_n_f32(1.f);
+  return Div4(one, vaddq_f32(one, Exp4(vnegq_f32(x))));
+}
+
+inline float32x4_t Rsqrt4(float32x4_t x) {
+#if defined(__aarch64__)
+  return vdivq_f32(vdupq_n_f32(1.f), vsqrtq_f32(x));
+#else
+  float32x4_t r = vrsqrteq_f32(x);
+  for (int i = 0; i < 3; ++i) {
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+  }
+  // the Newton steps turn 1 / sqrt(0) = inf and 1 / sqrt(inf) = 0 into NaN
+  r = vbslq_f32(vceqq_f32(x, vdupq_n_f32(0.f)), vdupq_n_f32(INFINITY), r);
+  return vbslq_f32(vceqq_f32(x, vdupq_n_f32(INFINITY)), vdupq_n_f32(0.f), r);
+#endif
+}
+
+// Run func 4 at a time, the tail goes through a padded copy so that every
+// element is computed the same way.
+template <typename Func>
+inline void Map4(const float *input,
+                 const index_t size,
+                 float *output,
+                 Func func) {
+  index_t i = 0;
+  for (; i + 3 < size; i += 4) {
+    vst1q_f32(output + i, func(vld1q_f32(input + i)));
+  }
+  if (i < size) {
+    float buffer[4] = {0};
+    std::copy(input + i, input + size, buffer);
+    vst1q_f32(buffer, func(vld1q_f32(buffer)));
+    std::copy(buffer, buffer + (size - i), output + i);
+  }
+}
+#endif  // MACE_ENABLE_NEON
+
+void Exp(const float *input, const index_t size, float *output) {
+#if defined(MACE_ENABLE_NEON)
+  Map4(input, size, output, Exp4);
+#else
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::exp(input[i]);
+  }
+#endif
+}
+
+void Log(const float *input, const index_t size, float *output) {
+#if defined(MACE_ENABLE_NEON)
+  Map4(input, size, output, Log4);
+#else
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::log(input[i]);
+  }
+#endif
+}
+
+void Tanh(const float *input, const index_t size, float *output) {
+#if defined(MACE_ENABLE_NEON)
+  Map4(input, size, output, Tanh4);
+#else
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::tanh(input[i]);
+  }
+#endif
+}
+
+void Sigmoid(const float *input, const index_t size, float *output) {
+#if defined(MACE_ENABLE_NEON)
+  Map4(input, size, output, Sigmoid4);
+#else
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = 1 / (1 + std::exp(-input[i]));
+  }
+#endif
+}
+
+void Pow(const float *input,
+         const float exponent,
+         const index_t size,
+         float *output) {
+#if defined(MACE_ENABLE_NEON)
+  const float32x4_t vexponent = vdupq_n_f32(exponent);
+  Map4(input, size, output, [vexponent](float32x4_t x) {
+    return Exp4(vmulq_f32(vexponent, Log4(x)));
+  });
+#else
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::pow(input[i], exponent);
+  }
+#endif
+}
+
+void Rsqrt(const float *input, const index_t size, float *output) {
+#if defined(MACE_ENABLE_NEON)
+  Map4(input, size, output, Rsqrt4);
+#else
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = 1 / std::sqrt(input[i]);
+  }
+#endif
+}
+
+}  // namespace
+
+void VectorExp(const float *input, const index_t size, float *output) {
+  static const VectorFunc func =
+      KernelDispatcher<VectorFunc>(Exp)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(VectorExpAvx2))
+          .Select();
+  func(input, size, output);
+}
+
+void VectorLog(const float *input, const index_t size, float *output) {
+  static const VectorFunc func =
+      KernelDispatcher<VectorFunc>(Log)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(VectorLogAvx2))
+          .Select();
+  func(input, size, output);
+}
+
+void VectorTanh(const float *input, const index_t size, float *output) {
+  static const VectorFunc func =
+      KernelDispatcher<VectorFunc>(Tanh)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(VectorTanhAvx2))
+          .Select();
+  func(input, size, output);
+}
+
+void VectorSigmoid(const float *input, const index_t size, float *output) {
+  static const VectorFunc func =
+      KernelDispatcher<VectorFunc>(Sigmoid)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(VectorSigmoidAvx2))
+          .Select();
+  func(input, size, output);
+}
+
+void VectorPow(const float *input,
+               const float exponent,
+               const index_t size,
+               float *output) {
+  // 0 ^ 0 would be exp(0 * -inf)
+  if (exponent == 0.f) {
+    std::fill(output, output + size, 1.f);
+    return;
+  }
+  static const VectorPowFunc func =
+      KernelDispatcher<VectorPowFunc>(Pow)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(VectorPowAvx2))
+          .Select();
+  func(input, exponent, size, output);
+}
+
+void VectorRsqrt(const float *input, const index_t size, float *output) {
+  static const VectorFunc func =
+      KernelDispatcher<VectorFunc>(Rsqrt)
+          .Register(CPU_ISA_AVX2, MACE_X86_KERNEL(VectorRsqrtAvx2))
+          .Select();
+  func(input, size, output);
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,82 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_VECTOR_MATH_H_
+#define MACE_KERNELS_VECTOR_MATH_H_
+
+#if defined(MACE_ENABLE_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// Element-wise transcendental functions over float arrays, computed with
+// NEON or AVX2 polynomial approximations (Cephes) where available and libm
+// otherwise. They are serial, callers split the work between threads.
+// input may be output.
+//
+// Max error against the exact result, in ULP, as checked by
+// vector_math_test:
+//
+//   VectorExp      2   results below FLT_MIN may flush to 0
+//   VectorLog      1   denormal inputs may be taken as FLT_MIN
+//   VectorTanh     3
+//   VectorSigmoid  3
+//   VectorPow      2 + 1.5 * |exponent * log(input)|, for input >= 0
+//   VectorRsqrt    2
+//
+// Inf and NaN are handled like libm, except that the vectorized VectorPow
+// does not special case negative inputs with an integer exponent, they are
+// all NaN.
+
+void VectorExp(const float *input, const index_t size, float *output);
+
+void VectorLog(const float *input, const index_t size, float *output);
+
+void VectorTanh(const float *input, const index_t size, float *output);
+
+// 1 / (1 + exp(-x))
+void VectorSigmoid(const float *input, const index_t size, float *output);
+
+// input ^ exponent
+void VectorPow(const float *input,
+               const float exponent,
+               const index_t size,
+               float *output);
+
+// 1 / sqrt(x)
+void VectorRsqrt(const float *input, const index_t size, float *output);
+
+#if defined(MACE_ENABLE_NEON)
+// a / b, refined from the reciprocal estimate on armv7, which has no vector
+// divide.
+inline float32x4_t Div4(float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+  return vdivq_f32(a, b);
+#else
+  float32x4_t r = vrecpeq_f32(b);
+  r = vmulq_f32(r, vrecpsq_f32(b, r));
+  r = vmulq_f32(r, vrecpsq_f32(b, r));
+  return vmulq_f32(a, r);
+#endif
+}
+#endif
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_VECTOR_MATH_H_
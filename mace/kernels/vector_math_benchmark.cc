@@ -0,0 +1,119 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <vector>
+
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/vector_math.h"
+
+namespace mace {
+namespace kernels {
+namespace test {
+
+// Compare the vectorized math functions with the libm loops they replace,
+// elements/s are reported as MACC.
+
+namespace {
+
+void Exp_Libm(const float *input, const index_t size, float *output) {
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::exp(input[i]);
+  }
+}
+
+void Log_Libm(const float *input, const index_t size, float *output) {
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::log(input[i]);
+  }
+}
+
+void Tanh_Libm(const float *input, const index_t size, float *output) {
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::tanh(input[i]);
+  }
+}
+
+void Sigmoid_Libm(const float *input, const index_t size, float *output) {
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = 1 / (1 + std::exp(-input[i]));
+  }
+}
+
+void Pow_Libm(const float *input, const index_t size, float *output) {
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = std::pow(input[i], -0.75f);
+  }
+}
+
+void Pow_Vector(const float *input, const index_t size, float *output) {
+  VectorPow(input, -0.75f, size, output);
+}
+
+void Rsqrt_Libm(const float *input, const index_t size, float *output) {
+  for (index_t i = 0; i < size; ++i) {
+    output[i] = 1 / std::sqrt(input[i]);
+  }
+}
+
+void VectorMathBenchmark(int iters,
+                         void (*func)(const float *, const index_t, float *),
+                         const index_t size) {
+  mace::testing::StopTiming();
+  // positive for log, pow and rsqrt
+  std::vector<float> input(size);
+  for (index_t i = 0; i < size; ++i) {
+    input[i] = 0.5f + 4.f * i / size;
+  }
+  std::vector<float> output(size);
+  // warm up
+  func(input.data(), size, output.data());
+  mace::testing::StartTiming();
+  while (iters--) {
+    func(input.data(), size, output.data());
+  }
+}
+
+}  // namespace
+
+#define MACE_BM_VECTOR_MATH_FUNC(NAME, SIZE, IMPL, FUNC)                     \
+  static void MACE_BM_VECTOR_MATH_##NAME##_##SIZE##_##IMPL(int iters) {      \
+    const int64_t tot = static_cast<int64_t>(iters) * SIZE;                  \
+    mace::testing::MaccProcessed(tot);                                       \
+    mace::testing::BytesProcessed(tot * 2 * sizeof(float));                  \
+    VectorMathBenchmark(iters, FUNC, SIZE);                                  \
+  }                                                                          \
+  MACE_BENCHMARK(MACE_BM_VECTOR_MATH_##NAME##_##SIZE##_##IMPL)
+
+#define MACE_BM_VECTOR_MATH(NAME, SIZE)                               \
+  MACE_BM_VECTOR_MATH_FUNC(NAME, SIZE, Libm, NAME##_Libm);            \
+  MACE_BM_VECTOR_MATH_FUNC(NAME, SIZE, Vector, Vector##NAME)
+
+#define MACE_BM_POW(SIZE)                                 \
+  MACE_BM_VECTOR_MATH_FUNC(Pow, SIZE, Libm, Pow_Libm);    \
+  MACE_BM_VECTOR_MATH_FUNC(Pow, SIZE, Vector, Pow_Vector)
+
+MACE_BM_VECTOR_MATH(Exp, 4096);
+MACE_BM_VECTOR_MATH(Exp, 1048576);
+MACE_BM_VECTOR_MATH(Log, 4096);
+MACE_BM_VECTOR_MATH(Tanh, 4096);
+MACE_BM_VECTOR_MATH(Tanh, 1048576);
+MACE_BM_VECTOR_MATH(Sigmoid, 4096);
+MACE_BM_VECTOR_MATH(Sigmoid, 1048576);
+MACE_BM_POW(4096);
+MACE_BM_VECTOR_MATH(Rsqrt, 4096);
+
+}  // namespace test
+}  // namespace kernels
+}  // namespace mace
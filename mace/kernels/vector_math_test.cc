@@ -0,0 +1,196 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "mace/kernels/vector_math.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Error of result in units of the last place of the float nearest to
+// expected.
+double UlpError(float result, double expected) {
+  if (std::isnan(expected)) {
+    return std::isnan(result) ? 0 : std::numeric_limits<double>::infinity();
+  }
+  if (std::isinf(expected) || std::isinf(result)) {
+    return result == static_cast<float>(expected)
+           ? 0 : std::numeric_limits<double>::infinity();
+  }
+  const float rounded = std::fabs(static_cast<float>(expected));
+  const double ulp =
+      std::nextafter(rounded, std::numeric_limits<float>::infinity())
+          - rounded;
+  return std::fabs(result - expected) / ulp;
+}
+
+// size evenly spaced points in [begin, end]
+std::vector<float> Points(float begin, float end, index_t size) {
+  std::vector<float> points(size);
+  for (index_t i = 0; i < size; ++i) {
+    points[i] = begin + (end - begin) * i / (size - 1);
+  }
+  return points;
+}
+
+double MaxUlpError(const std::vector<float> &input,
+                   const std::vector<float> &output,
+                   std::function<double(double)> reference,
+                   double min_result = 0) {
+  double max_error = 0;
+  for (size_t i = 0; i < input.size(); ++i) {
+    const double expected = reference(input[i]);
+    if (std::fabs(expected) < min_result) {
+      continue;
+    }
+    max_error = std::max(max_error, UlpError(output[i], expected));
+  }
+  return max_error;
+}
+
+void TestVectorFunc(void (*func)(const float *, const index_t, float *),
+                    std::function<double(double)> reference,
+                    float begin,
+                    float end,
+                    double max_ulp,
+                    double min_result = 0) {
+  // odd size for the tail
+  std::vector<float> input = Points(begin, end, 100003);
+  std::vector<float> output(input.size());
+  func(input.data(), input.size(), output.data());
+  EXPECT_LE(MaxUlpError(input, output, reference, min_result), max_ulp);
+
+  // in place
+  func(input.data(), input.size(), input.data());
+  EXPECT_EQ(output, input);
+}
+
+}  // namespace
+
+TEST(VectorMathTest, Exp) {
+  auto exp = [](double x) { return std::exp(x); };
+  TestVectorFunc(VectorExp, exp, -1, 1, 2);
+  TestVectorFunc(VectorExp, exp, -87.3f, 88.7f, 2);
+  TestVectorFunc(VectorExp, exp, -20, 20, 2);
+
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> input = {-inf, -1000, -88, 0, 89, 1000, inf, NAN};
+  std::vector<float> output(input.size());
+  VectorExp(input.data(), input.size(), output.data());
+  EXPECT_EQ(0, output[0]);
+  EXPECT_EQ(0, output[1]);
+  EXPECT_GT(1.2e-38, output[2]);
+  EXPECT_EQ(1, output[3]);
+  EXPECT_EQ(inf, output[4]);
+  EXPECT_EQ(inf, output[5]);
+  EXPECT_EQ(inf, output[6]);
+  EXPECT_TRUE(std::isnan(output[7]));
+}
+
+TEST(VectorMathTest, Log) {
+  auto log = [](double x) { return std::log(x); };
+  // log(1) = 0 so the ULP is relative to the absolute error near 1
+  TestVectorFunc(VectorLog, log, 1e-6f, 1e-3f, 1);
+  TestVectorFunc(VectorLog, log, 0.5f, 0.99f, 1);
+  TestVectorFunc(VectorLog, log, 1.01f, 2, 1);
+  TestVectorFunc(VectorLog, log, 2, 1e6f, 1);
+  TestVectorFunc(VectorLog, log, 1e30f, 3e38f, 1);
+
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> input = {-1, 0, 1, inf, NAN};
+  std::vector<float> output(input.size());
+  VectorLog(input.data(), input.size(), output.data());
+  EXPECT_TRUE(std::isnan(output[0]));
+  EXPECT_EQ(-inf, output[1]);
+  EXPECT_EQ(0, output[2]);
+  EXPECT_EQ(inf, output[3]);
+  EXPECT_TRUE(std::isnan(output[4]));
+}
+
+TEST(VectorMathTest, Tanh) {
+  auto tanh = [](double x) { return std::tanh(x); };
+  TestVectorFunc(VectorTanh, tanh, -1, 1, 3);
+  TestVectorFunc(VectorTanh, tanh, -10, 10, 3);
+  TestVectorFunc(VectorTanh, tanh, -100, 100, 3);
+  TestVectorFunc(VectorTanh, tanh, 1e-30f, 1e-3f, 3);
+}
+
+TEST(VectorMathTest, Sigmoid) {
+  auto sigmoid = [](double x) { return 1 / (1 + std::exp(-x)); };
+  TestVectorFunc(VectorSigmoid, sigmoid, -1, 1, 3);
+  TestVectorFunc(VectorSigmoid, sigmoid, -20, 20, 3);
+  TestVectorFunc(VectorSigmoid, sigmoid, -87, 100, 3);
+  // below FLT_MIN the result flushes to 0
+  TestVectorFunc(VectorSigmoid, sigmoid, -200, -80, 3, 1.2e-38);
+}
+
+TEST(VectorMathTest, Pow) {
+  for (float exponent : {-0.75f, -0.5f, 0.5f, 1.f, 2.f, 3.5f}) {
+    auto pow = [exponent](double x) { return std::pow(x, exponent); };
+    auto vector_pow = [exponent](const float *input, const index_t size,
+                                 float *output) {
+      VectorPow(input, exponent, size, output);
+    };
+    for (auto range : {std::make_pair(1e-3f, 1.f),
+                       std::make_pair(1.f, 1e3f)}) {
+      std::vector<float> input = Points(range.first, range.second, 100003);
+      std::vector<float> output(input.size());
+      vector_pow(input.data(), input.size(), output.data());
+      // the bound in vector_math.h
+      const double max_ulp = 2 + 1.5 * std::fabs(exponent) * std::log(1e3);
+      EXPECT_LE(MaxUlpError(input, output, pow), max_ulp);
+    }
+  }
+
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> input = {0, 1, inf, -1};
+  std::vector<float> output(input.size());
+  VectorPow(input.data(), 2, input.size(), output.data());
+  EXPECT_EQ(0, output[0]);
+  EXPECT_EQ(1, output[1]);
+  EXPECT_EQ(inf, output[2]);
+  VectorPow(input.data(), -0.5f, input.size(), output.data());
+  EXPECT_EQ(inf, output[0]);
+  EXPECT_EQ(1, output[1]);
+  EXPECT_EQ(0, output[2]);
+  EXPECT_TRUE(std::isnan(output[3]));
+  VectorPow(input.data(), 0, input.size(), output.data());
+  EXPECT_EQ(std::vector<float>(input.size(), 1), output);
+}
+
+TEST(VectorMathTest, Rsqrt) {
+  auto rsqrt = [](double x) { return 1 / std::sqrt(x); };
+  TestVectorFunc(VectorRsqrt, rsqrt, 1e-30f, 1e-3f, 2);
+  TestVectorFunc(VectorRsqrt, rsqrt, 1e-3f, 1e3f, 2);
+  TestVectorFunc(VectorRsqrt, rsqrt, 1e3f, 1e30f, 2);
+
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> input = {0, inf, -1};
+  std::vector<float> output(input.size());
+  VectorRsqrt(input.data(), input.size(), output.data());
+  EXPECT_EQ(inf, output[0]);
+  EXPECT_EQ(0, output[1]);
+  EXPECT_TRUE(std::isnan(output[2]));
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,284 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+
+#include "mace/kernels/x86/conv_2d_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Load input[0], input[S], ..., input[7 * S] without touching anything past
+// the last element, as the input may be exactly as wide as the conv needs.
+template <int S>
+inline __m256 LoadStrided8(const float *ptr);
+
+template <>
+inline __m256 LoadStrided8<1>(const float *ptr) {
+  return _mm256_loadu_ps(ptr);
+}
+
+template <>
+inline __m256 LoadStrided8<2>(const float *ptr) {
+  __m256 v0 = _mm256_loadu_ps(ptr);
+  __m256 v1 = _mm256_loadu_ps(ptr + 7);
+  // [0 2 8 10 | 4 6 12 14] -> [0 2 4 6 | 8 10 12 14]
+  __m256 v = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 2, 0));
+  return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v),
+                                                _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+template <>
+inline __m256 LoadStrided8<3>(const float *ptr) {
+  const __m256i index = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  return _mm256_i32gather_ps(ptr, index, 4);
+}
+
+template <int S>
+inline __m128 LoadStrided4(const float *ptr);
+
+template <>
+inline __m128 LoadStrided4<1>(const float *ptr) {
+  return _mm_loadu_ps(ptr);
+}
+
+template <>
+inline __m128 LoadStrided4<2>(const float *ptr) {
+  __m128 v0 = _mm_loadu_ps(ptr);
+  __m128 v1 = _mm_loadu_ps(ptr + 3);
+  return _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template <>
+inline __m128 LoadStrided4<3>(const float *ptr) {
+  const __m128i index = _mm_setr_epi32(0, 3, 6, 9);
+  return _mm_i32gather_ps(ptr, index, 4);
+}
+
+// Accumulate one input channel into one output row of CO output channels,
+// 8 (then 4, then 1) output pixels at a time.
+template <int KH, int KW, int S, int CO>
+inline void Conv2dAvx2Row(const float *in_ptr,
+                          const index_t in_width,
+                          const float *const *filter_ptr,
+                          const index_t out_width,
+                          float *const *out_ptr) {
+  index_t w = 0;
+  for (; w + 7 < out_width; w += 8) {
+    __m256 vo[CO];
+    for (int o = 0; o < CO; ++o) {
+      vo[o] = _mm256_loadu_ps(out_ptr[o] + w);
+    }
+    for (int kh = 0; kh < KH; ++kh) {
+      const float *in_row = in_ptr + kh * in_width + w * S;
+      for (int kw = 0; kw < KW; ++kw) {
+        __m256 vi = LoadStrided8<S>(in_row + kw);
+        for (int o = 0; o < CO; ++o) {
+          __m256 vf = _mm256_broadcast_ss(filter_ptr[o] + kh * KW + kw);
+          vo[o] = _mm256_fmadd_ps(vi, vf, vo[o]);
+        }
+      }
+    }
+    for (int o = 0; o < CO; ++o) {
+      _mm256_storeu_ps(out_ptr[o] + w, vo[o]);
+    }
+  }
+
+  for (; w + 3 < out_width; w += 4) {
+    __m128 vo[CO];
+    for (int o = 0; o < CO; ++o) {
+      vo[o] = _mm_loadu_ps(out_ptr[o] + w);
+    }
+    for (int kh = 0; kh < KH; ++kh) {
+      const float *in_row = in_ptr + kh * in_width + w * S;
+      for (int kw = 0; kw < KW; ++kw) {
+        __m128 vi = LoadStrided4<S>(in_row + kw);
+        for (int o = 0; o < CO; ++o) {
+          __m128 vf = _mm_broadcast_ss(filter_ptr[o] + kh * KW + kw);
+          vo[o] = _mm_fmadd_ps(vi, vf, vo[o]);
+        }
+      }
+    }
+    for (int o = 0; o < CO; ++o) {
+      _mm_storeu_ps(out_ptr[o] + w, vo[o]);
+    }
+  }
+
+  for (; w < out_width; ++w) {
+    for (int o = 0; o < CO; ++o) {
+      float sum = out_ptr[o][w];
+      for (int kh = 0; kh < KH; ++kh) {
+        for (int kw = 0; kw < KW; ++kw) {
+          sum += in_ptr[kh * in_width + w * S + kw]
+              * filter_ptr[o][kh * KW + kw];
+        }
+      }
+      out_ptr[o][w] = sum;
+    }
+  }
+}
+
+// Ho = 1, Wo = 8, Co = 4
+template <int KH, int KW, int S>
+void Conv2dAvx2KHxKWSn(const float *input,
+                       const float *filter,
+                       const index_t *in_shape,
+                       const index_t *out_shape,
+                       float *output) {
+  const index_t in_image_size = in_shape[2] * in_shape[3];
+  const index_t out_image_size = out_shape[2] * out_shape[3];
+  const index_t in_batch_size = in_shape[1] * in_image_size;
+  const index_t out_batch_size = out_shape[1] * out_image_size;
+  const index_t filter_size = KH * KW;
+
+#pragma omp parallel for collapse(2)
+  for (index_t b = 0; b < out_shape[0]; ++b) {
+    for (index_t m = 0; m < out_shape[1]; m += 4) {
+      const index_t out_channels = out_shape[1];
+      const index_t out_height = out_shape[2];
+      const index_t out_width = out_shape[3];
+      const index_t in_channels = in_shape[1];
+      const index_t in_width = in_shape[3];
+      if (m + 3 < out_channels) {
+        float *out_ptr_base[4];
+        for (int o = 0; o < 4; ++o) {
+          out_ptr_base[o] =
+              output + b * out_batch_size + (m + o) * out_image_size;
+        }
+        for (index_t c = 0; c < in_channels; ++c) {
+          const float *in_ptr_base =
+              input + b * in_batch_size + c * in_image_size;
+          const float *filter_ptr[4];
+          for (int o = 0; o < 4; ++o) {
+            filter_ptr[o] =
+                filter + ((m + o) * in_channels + c) * filter_size;
+          }
+          for (index_t h = 0; h < out_height; ++h) {
+            float *out_ptr[4];
+            for (int o = 0; o < 4; ++o) {
+              out_ptr[o] = out_ptr_base[o] + h * out_width;
+            }
+            Conv2dAvx2Row<KH, KW, S, 4>(in_ptr_base + h * S * in_width,
+                                        in_width, filter_ptr, out_width,
+                                        out_ptr);
+          }  // h
+        }  // c
+      } else {
+        for (index_t mm = m; mm < out_channels; ++mm) {
+          float *out_ptr_base =
+              output + b * out_batch_size + mm * out_image_size;
+          for (index_t c = 0; c < in_channels; ++c) {
+            const float *in_ptr_base =
+                input + b * in_batch_size + c * in_image_size;
+            const float *filter_ptr =
+                filter + (mm * in_channels + c) * filter_size;
+            for (index_t h = 0; h < out_height; ++h) {
+              float *out_ptr = out_ptr_base + h * out_width;
+              Conv2dAvx2Row<KH, KW, S, 1>(in_ptr_base + h * S * in_width,
+                                          in_width, &filter_ptr, out_width,
+                                          &out_ptr);
+            }  // h
+          }  // c
+        }  // mm
+      }  // if
+    }  // m
+  }  // b
+}
+
+}  // namespace
+
+void Conv2dAvx2K3x3S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<3, 3, 1>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K3x3S2(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<3, 3, 2>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K5x5S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<5, 5, 1>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K1x7S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<1, 7, 1>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K7x1S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<7, 1, 1>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K7x7S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<7, 7, 1>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K7x7S2(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<7, 7, 2>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K7x7S3(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output) {
+  Conv2dAvx2KHxKWSn<7, 7, 3>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K1x15S1(const float *input,
+                       const float *filter,
+                       const index_t *in_shape,
+                       const index_t *out_shape,
+                       float *output) {
+  Conv2dAvx2KHxKWSn<1, 15, 1>(input, filter, in_shape, out_shape, output);
+}
+
+void Conv2dAvx2K15x1S1(const float *input,
+                       const float *filter,
+                       const index_t *in_shape,
+                       const index_t *out_shape,
+                       float *output) {
+  Conv2dAvx2KHxKWSn<15, 1, 1>(input, filter, in_shape, out_shape, output);
+}
+
+}  // namespace kernels
+}  // namespace mace
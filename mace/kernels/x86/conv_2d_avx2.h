@@ -0,0 +1,90 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_X86_CONV_2D_AVX2_H_
+#define MACE_KERNELS_X86_CONV_2D_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// AVX2 counterparts of the kernels in arm/conv_2d_neon.h. They take the same
+// padded input/output as the NEON kernels, so the caller's tile_h/tile_w
+// padding stays unchanged. Only call them when GetCPUISA() >= CPU_ISA_AVX2.
+
+void Conv2dAvx2K3x3S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K3x3S2(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K5x5S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K1x7S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K7x1S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K7x7S1(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K7x7S2(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K7x7S3(const float *input,
+                      const float *filter,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      float *output);
+
+void Conv2dAvx2K1x15S1(const float *input,
+                       const float *filter,
+                       const index_t *in_shape,
+                       const index_t *out_shape,
+                       float *output);
+
+void Conv2dAvx2K15x1S1(const float *input,
+                       const float *filter,
+                       const index_t *in_shape,
+                       const index_t *out_shape,
+                       float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_CONV_2D_AVX2_H_
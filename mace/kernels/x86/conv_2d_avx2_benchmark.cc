@@ -0,0 +1,98 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "mace/core/runtime/cpu/cpu_features.h"
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/arm/conv_2d_neon.h"
+#include "mace/kernels/x86/conv_2d_avx2.h"
+
+namespace mace {
+namespace kernels {
+namespace test {
+
+// Compare the AVX2 direct convolution kernels with the portable ones they
+// replace (scalar code without NEON). The whole op can be compared with
+// `MACE_CPU_ISA=generic` on ops conv_2d_benchmark.
+
+namespace {
+
+typedef void (*Conv2dFunc)(const float *, const float *, const index_t *,
+                           const index_t *, float *);
+
+void Conv2dKernel(int iters,
+                  Conv2dFunc func,
+                  const index_t *in_shape,
+                  const index_t *out_shape,
+                  const index_t filter_size) {
+  mace::testing::StopTiming();
+  if (func == nullptr) {
+    return;
+  }
+  std::vector<float> input(in_shape[0] * in_shape[1] * in_shape[2]
+                               * in_shape[3], 0.1f);
+  std::vector<float> filter(out_shape[1] * in_shape[1] * filter_size, 0.1f);
+  std::vector<float> output(out_shape[0] * out_shape[1] * out_shape[2]
+                                * out_shape[3]);
+  // warm up
+  func(input.data(), filter.data(), in_shape, out_shape, output.data());
+  mace::testing::StartTiming();
+  while (iters--) {
+    func(input.data(), filter.data(), in_shape, out_shape, output.data());
+  }
+}
+
+Conv2dFunc Avx2OrNull(Conv2dFunc func) {
+  return GetCPUISA() >= CPU_ISA_AVX2 ? func : nullptr;
+}
+
+}  // namespace
+
+#define MACE_BM_CONV_2D_KERNEL_FUNC(N, C, H, W, KH, KW, STRIDE, OC, NAME,  \
+                                    FUNC)                                 \
+  static void MACE_BM_CONV_2D_KERNEL_##N##_##C##_##H##_##W##_K##KH##x##KW\
+    ##S##STRIDE##_##OC##_##NAME(int iters) {                                \
+    const index_t oh = (H - KH) / STRIDE + 1;                               \
+    const index_t ow = (W - KW) / STRIDE + 1;                               \
+    const index_t in_shape[4] = {N, C, H, W};                               \
+    const index_t out_shape[4] = {N, OC, oh, ow};                           \
+    const int64_t macc =                                                    \
+        static_cast<int64_t>(iters) * N * OC * oh * ow * KH * KW * C;       \
+    mace::testing::MaccProcessed(macc);                                     \
+    Conv2dKernel(iters, FUNC, in_shape, out_shape, KH * KW);                \
+  }                                                                         \
+  MACE_BENCHMARK(MACE_BM_CONV_2D_KERNEL_##N##_##C##_##H##_##W##_K##KH##x    \
+    ##KW##S##STRIDE##_##OC##_##NAME)
+
+#define MACE_BM_CONV_2D_KERNEL(N, C, H, W, KH, KW, STRIDE, OC)            \
+  MACE_BM_CONV_2D_KERNEL_FUNC(N, C, H, W, KH, KW, STRIDE, OC, Scalar,     \
+                              Conv2dNeonK##KH##x##KW##S##STRIDE);         \
+  MACE_BM_CONV_2D_KERNEL_FUNC(N, C, H, W, KH, KW, STRIDE, OC, AVX2,       \
+                              Avx2OrNull(Conv2dAvx2K##KH##x##KW##S##STRIDE))
+
+MACE_BM_CONV_2D_KERNEL(1, 64, 34, 34, 3, 3, 1, 128);
+MACE_BM_CONV_2D_KERNEL(1, 3, 225, 225, 3, 3, 2, 32);
+MACE_BM_CONV_2D_KERNEL(1, 64, 36, 36, 5, 5, 1, 128);
+MACE_BM_CONV_2D_KERNEL(1, 192, 17, 23, 1, 7, 1, 192);
+MACE_BM_CONV_2D_KERNEL(1, 192, 23, 20, 7, 1, 1, 192);
+MACE_BM_CONV_2D_KERNEL(1, 64, 38, 38, 7, 7, 1, 128);
+MACE_BM_CONV_2D_KERNEL(1, 3, 229, 229, 7, 7, 2, 64);
+MACE_BM_CONV_2D_KERNEL(1, 64, 37, 37, 7, 7, 3, 128);
+MACE_BM_CONV_2D_KERNEL(1, 32, 256, 270, 1, 15, 1, 2);
+MACE_BM_CONV_2D_KERNEL(1, 32, 270, 256, 15, 1, 1, 2);
+
+}  // namespace test
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,117 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mace/core/runtime/cpu/cpu_features.h"
+#include "mace/kernels/arm/conv_2d_neon.h"
+#include "mace/kernels/x86/conv_2d_avx2.h"
+#include "mace/utils/logging.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+typedef void (*Conv2dFunc)(const float *, const float *, const index_t *,
+                           const index_t *, float *);
+
+void TestConv2dAvx2(Conv2dFunc func,
+                    const index_t kernel_h,
+                    const index_t kernel_w,
+                    const int stride,
+                    const index_t batch,
+                    const index_t in_channels,
+                    const index_t out_channels,
+                    const index_t out_height,
+                    const index_t out_width) {
+  const index_t in_height = (out_height - 1) * stride + kernel_h;
+  const index_t in_width = (out_width - 1) * stride + kernel_w;
+  const index_t in_shape[4] = {batch, in_channels, in_height, in_width};
+  const index_t out_shape[4] = {batch, out_channels, out_height, out_width};
+
+  std::vector<float> input(batch * in_channels * in_height * in_width);
+  std::vector<float> filter(out_channels * in_channels * kernel_h * kernel_w);
+  std::vector<float> output(batch * out_channels * out_height * out_width);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+  std::generate(input.begin(), input.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(filter.begin(), filter.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(output.begin(), output.end(), [&gen, &nd] { return nd(gen); });
+  std::vector<float> output_ref(output);
+
+  func(input.data(), filter.data(), in_shape, out_shape, output.data());
+
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t m = 0; m < out_channels; ++m) {
+      for (index_t c = 0; c < in_channels; ++c) {
+        Conv2dCPUKHxKWCalc(
+            input.data() + (b * in_channels + c) * in_height * in_width,
+            filter.data() + (m * in_channels + c) * kernel_h * kernel_w,
+            in_width, kernel_h, kernel_w, out_height, out_width,
+            output_ref.data() + (b * out_channels + m) * out_height * out_width,
+            stride);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output_ref[i], output[i], 1e-3) << "with index " << i;
+  }
+}
+
+void TestConv2dAvx2(Conv2dFunc func,
+                    const index_t kernel_h,
+                    const index_t kernel_w,
+                    const int stride) {
+  if (GetCPUISA() < CPU_ISA_AVX2) {
+    LOG(INFO) << "AVX2 is not supported, skip";
+    return;
+  }
+  TestConv2dAvx2(func, kernel_h, kernel_w, stride, 1, 3, 4, 5, 16);
+  TestConv2dAvx2(func, kernel_h, kernel_w, stride, 2, 5, 7, 3, 12);
+  TestConv2dAvx2(func, kernel_h, kernel_w, stride, 1, 8, 9, 7, 21);
+}
+
+}  // namespace
+
+TEST(Conv2dAvx2Test, K3x3) {
+  TestConv2dAvx2(Conv2dAvx2K3x3S1, 3, 3, 1);
+  TestConv2dAvx2(Conv2dAvx2K3x3S2, 3, 3, 2);
+}
+
+TEST(Conv2dAvx2Test, K5x5) {
+  TestConv2dAvx2(Conv2dAvx2K5x5S1, 5, 5, 1);
+}
+
+TEST(Conv2dAvx2Test, K7x7) {
+  TestConv2dAvx2(Conv2dAvx2K7x7S1, 7, 7, 1);
+  TestConv2dAvx2(Conv2dAvx2K7x7S2, 7, 7, 2);
+  TestConv2dAvx2(Conv2dAvx2K7x7S3, 7, 7, 3);
+}
+
+TEST(Conv2dAvx2Test, K1xN) {
+  TestConv2dAvx2(Conv2dAvx2K1x7S1, 1, 7, 1);
+  TestConv2dAvx2(Conv2dAvx2K7x1S1, 7, 1, 1);
+  TestConv2dAvx2(Conv2dAvx2K1x15S1, 1, 15, 1);
+  TestConv2dAvx2(Conv2dAvx2K15x1S1, 15, 1, 1);
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,78 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+
+#include "mace/kernels/x86/deconv_2d_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Interleaves even and odd and adds them to output[0, 16).
+inline void AddInterleaved(const __m256 even, const __m256 odd,
+                           float *output) {
+  const __m256 lo = _mm256_unpacklo_ps(even, odd);  // e0 o0 e1 o1 e4 o4 ..
+  const __m256 hi = _mm256_unpackhi_ps(even, odd);  // e2 o2 e3 o3 e6 o6 ..
+  const __m256 first = _mm256_permute2f128_ps(lo, hi, 0x20);
+  const __m256 second = _mm256_permute2f128_ps(lo, hi, 0x31);
+  _mm256_storeu_ps(output, _mm256_add_ps(_mm256_loadu_ps(output), first));
+  _mm256_storeu_ps(output + 8,
+                   _mm256_add_ps(_mm256_loadu_ps(output + 8), second));
+}
+
+}  // namespace
+
+void Deconv2dAvx2S2K2Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output) {
+  const float *col0 = col;
+  const float *col1 = col + col_stride;
+  index_t j = 0;
+  for (; j + 8 <= count; j += 8) {
+    AddInterleaved(_mm256_loadu_ps(col0 + j), _mm256_loadu_ps(col1 + j),
+                   output + 2 * j);
+  }
+  for (; j < count; ++j) {
+    output[2 * j] += col0[j];
+    output[2 * j + 1] += col1[j];
+  }
+}
+
+void Deconv2dAvx2S2K4Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output) {
+  const float *col0 = col;
+  const float *col1 = col + col_stride;
+  const float *col2 = col + 2 * col_stride - 1;
+  const float *col3 = col + 3 * col_stride - 1;
+  index_t j = 0;
+  for (; j + 8 <= count; j += 8) {
+    const __m256 even = _mm256_add_ps(_mm256_loadu_ps(col0 + j),
+                                      _mm256_loadu_ps(col2 + j));
+    const __m256 odd = _mm256_add_ps(_mm256_loadu_ps(col1 + j),
+                                     _mm256_loadu_ps(col3 + j));
+    AddInterleaved(even, odd, output + 2 * j);
+  }
+  for (; j < count; ++j) {
+    output[2 * j] += col0[j] + col2[j];
+    output[2 * j + 1] += col1[j] + col3[j];
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,39 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_X86_DECONV_2D_AVX2_H_
+#define MACE_KERNELS_X86_DECONV_2D_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// AVX2 counterparts of the row kernels in arm/deconv_2d_gemm.h. Only call
+// them when GetCPUISA() >= CPU_ISA_AVX2.
+
+void Deconv2dAvx2S2K2Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output);
+
+void Deconv2dAvx2S2K4Row(const float *col,
+                         const index_t col_stride,
+                         const index_t count,
+                         float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_DECONV_2D_AVX2_H_
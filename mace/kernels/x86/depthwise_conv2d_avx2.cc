@@ -0,0 +1,234 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+#include <algorithm>
+
+#include "mace/kernels/x86/depthwise_conv2d_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+void DepthwiseConv2dBorderPixel(const float *in_base,
+                                const float *filter,
+                                const index_t out_h,
+                                const index_t out_w,
+                                const index_t in_h_start,
+                                const index_t in_w_start,
+                                const index_t out_width,
+                                const index_t in_height,
+                                const index_t in_width,
+                                const int filter_size,
+                                const int *dilation_hw,
+                                float *out_base) {
+  float sum = 0;
+  for (int i = 0; i < filter_size; ++i) {
+    for (int j = 0; j < filter_size; ++j) {
+      index_t in_h = in_h_start + i * dilation_hw[0];
+      index_t in_w = in_w_start + j * dilation_hw[1];
+      if (in_h >= 0 && in_h < in_height && in_w >= 0 && in_w < in_width) {
+        sum += in_base[in_h * in_width + in_w] * filter[i * filter_size + j];
+      }
+    }
+  }
+  out_base[out_h * out_width + out_w] = sum;
+}
+
+// Load ptr[0], ptr[S], ..., ptr[7 * S] without reading past the last one.
+template <int S>
+inline __m256 LoadStrided8(const float *ptr);
+
+template <>
+inline __m256 LoadStrided8<1>(const float *ptr) {
+  return _mm256_loadu_ps(ptr);
+}
+
+template <>
+inline __m256 LoadStrided8<2>(const float *ptr) {
+  __m256 v0 = _mm256_loadu_ps(ptr);
+  __m256 v1 = _mm256_loadu_ps(ptr + 7);
+  // [0 2 8 10 | 4 6 12 14] -> [0 2 4 6 | 8 10 12 14]
+  __m256 v = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 2, 0));
+  return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v),
+                                                _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+// Ho = 1, Wo = 16 (then 8), Co = 1
+template <int K, int S>
+void DepthwiseConv2dAvx2KxKSn(const float *input,
+                              const float *filter,
+                              const index_t *in_shape,
+                              const index_t *out_shape,
+                              const int *pad_hw,
+                              const int *dilation_hw,
+                              const index_t valid_h_start,
+                              const index_t valid_h_stop,
+                              const index_t valid_w_start,
+                              const index_t valid_w_stop,
+                              float *output) {
+  const index_t multiplier = out_shape[1] / in_shape[1];
+  const index_t in_image_size = in_shape[2] * in_shape[3];
+  const index_t out_image_size = out_shape[2] * out_shape[3];
+  const index_t in_batch_size = in_shape[1] * in_image_size;
+  const index_t out_batch_size = out_shape[1] * out_image_size;
+
+#pragma omp parallel for collapse(2)
+  for (index_t b = 0; b < in_shape[0]; ++b) {
+    for (index_t m = 0; m < out_shape[1]; ++m) {
+      index_t c = m / multiplier;
+      index_t multi_index = m % multiplier;
+      const float *in_base = input + b * in_batch_size + c * in_image_size;
+      const float *filter_ptr =
+          filter + (multi_index * in_shape[1] + c) * K * K;
+      float *out_base = output + b * out_batch_size + m * out_image_size;
+      const index_t pad_top = pad_hw[0];
+      const index_t pad_left = pad_hw[1];
+      const index_t dilation_h = dilation_hw[0];
+      const index_t dilation_w = dilation_hw[1];
+      const index_t out_height = out_shape[2];
+      const index_t out_width = out_shape[3];
+      const index_t in_height = in_shape[2];
+      const index_t in_width = in_shape[3];
+
+      __m256 vf[K * K];
+      for (int i = 0; i < K * K; ++i) {
+        vf[i] = _mm256_set1_ps(filter_ptr[i]);
+      }
+
+      for (index_t h = 0; h < out_height; ++h) {
+        const index_t in_h = h * S - pad_top;
+        if (h < valid_h_start || h >= valid_h_stop) {
+          for (index_t w = 0; w < out_width; ++w) {
+            DepthwiseConv2dBorderPixel(in_base, filter_ptr, h, w, in_h,
+                                       w * S - pad_left, out_width, in_height,
+                                       in_width, K, dilation_hw, out_base);
+          }
+          continue;
+        }
+
+        // left
+        const index_t left_stop = std::min(valid_w_start, out_width);
+        for (index_t w = 0; w < left_stop; ++w) {
+          DepthwiseConv2dBorderPixel(in_base, filter_ptr, h, w, in_h,
+                                     w * S - pad_left, out_width, in_height,
+                                     in_width, K, dilation_hw, out_base);
+        }
+
+        float *out_row = out_base + h * out_width;
+        index_t w = left_stop;
+        for (; w + 15 < valid_w_stop; w += 16) {
+          __m256 vo0 = _mm256_setzero_ps();
+          __m256 vo1 = _mm256_setzero_ps();
+          for (int kh = 0; kh < K; ++kh) {
+            const float *in_ptr = in_base
+                + (in_h + kh * dilation_h) * in_width + w * S - pad_left;
+            for (int kw = 0; kw < K; ++kw) {
+              __m256 vi0 = LoadStrided8<S>(in_ptr + kw * dilation_w);
+              __m256 vi1 = LoadStrided8<S>(in_ptr + kw * dilation_w + 8 * S);
+              vo0 = _mm256_fmadd_ps(vi0, vf[kh * K + kw], vo0);
+              vo1 = _mm256_fmadd_ps(vi1, vf[kh * K + kw], vo1);
+            }
+          }
+          _mm256_storeu_ps(out_row + w, vo0);
+          _mm256_storeu_ps(out_row + w + 8, vo1);
+        }  // w
+
+        for (; w + 7 < valid_w_stop; w += 8) {
+          __m256 vo = _mm256_setzero_ps();
+          for (int kh = 0; kh < K; ++kh) {
+            const float *in_ptr = in_base
+                + (in_h + kh * dilation_h) * in_width + w * S - pad_left;
+            for (int kw = 0; kw < K; ++kw) {
+              __m256 vi = LoadStrided8<S>(in_ptr + kw * dilation_w);
+              vo = _mm256_fmadd_ps(vi, vf[kh * K + kw], vo);
+            }
+          }
+          _mm256_storeu_ps(out_row + w, vo);
+        }
+
+        for (; w < valid_w_stop; ++w) {
+          float sum = 0;
+          for (int kh = 0; kh < K; ++kh) {
+            const float *in_ptr = in_base
+                + (in_h + kh * dilation_h) * in_width + w * S - pad_left;
+            for (int kw = 0; kw < K; ++kw) {
+              sum += in_ptr[kw * dilation_w] * filter_ptr[kh * K + kw];
+            }
+          }
+          out_row[w] = sum;
+        }
+
+        // right
+        for (; w < out_width; ++w) {
+          DepthwiseConv2dBorderPixel(in_base, filter_ptr, h, w, in_h,
+                                     w * S - pad_left, out_width, in_height,
+                                     in_width, K, dilation_hw, out_base);
+        }
+      }  // h
+    }  // m
+  }  // b
+}
+
+}  // namespace
+
+void DepthwiseConv2dAvx2K3x3(const float *input,
+                             const float *filter,
+                             const index_t *in_shape,
+                             const index_t *out_shape,
+                             const int *pad_hw,
+                             const int *stride_hw,
+                             const int *dilation_hw,
+                             const index_t valid_h_start,
+                             const index_t valid_h_stop,
+                             const index_t valid_w_start,
+                             const index_t valid_w_stop,
+                             float *output) {
+  if (stride_hw[0] == 1) {
+    DepthwiseConv2dAvx2KxKSn<3, 1>(input, filter, in_shape, out_shape, pad_hw,
+                                   dilation_hw, valid_h_start, valid_h_stop,
+                                   valid_w_start, valid_w_stop, output);
+  } else {
+    DepthwiseConv2dAvx2KxKSn<3, 2>(input, filter, in_shape, out_shape, pad_hw,
+                                   dilation_hw, valid_h_start, valid_h_stop,
+                                   valid_w_start, valid_w_stop, output);
+  }
+}
+
+void DepthwiseConv2dAvx2K5x5(const float *input,
+                             const float *filter,
+                             const index_t *in_shape,
+                             const index_t *out_shape,
+                             const int *pad_hw,
+                             const int *stride_hw,
+                             const int *dilation_hw,
+                             const index_t valid_h_start,
+                             const index_t valid_h_stop,
+                             const index_t valid_w_start,
+                             const index_t valid_w_stop,
+                             float *output) {
+  if (stride_hw[0] == 1) {
+    DepthwiseConv2dAvx2KxKSn<5, 1>(input, filter, in_shape, out_shape, pad_hw,
+                                   dilation_hw, valid_h_start, valid_h_stop,
+                                   valid_w_start, valid_w_stop, output);
+  } else {
+    DepthwiseConv2dAvx2KxKSn<5, 2>(input, filter, in_shape, out_shape, pad_hw,
+                                   dilation_hw, valid_h_start, valid_h_stop,
+                                   valid_w_start, valid_w_stop, output);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,126 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mace/core/runtime/cpu/cpu_features.h"
+#include "mace/kernels/arm/depthwise_conv2d_neon.h"
+#include "mace/kernels/x86/depthwise_conv2d_avx2.h"
+#include "mace/utils/logging.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+typedef void (*DepthwiseConv2dFunc)(const float *, const float *,
+                                    const index_t *, const index_t *,
+                                    const int *, const int *, const int *,
+                                    const index_t, const index_t,
+                                    const index_t, const index_t, float *);
+
+// Compare with the portable kernel, SAME padding
+void TestDepthwiseConv2dAvx2(DepthwiseConv2dFunc func,
+                             DepthwiseConv2dFunc ref_func,
+                             const int kernel,
+                             const int stride,
+                             const int dilation,
+                             const index_t multiplier,
+                             const index_t in_height,
+                             const index_t in_width) {
+  const index_t batch = 2;
+  const index_t channels = 3;
+  const index_t out_height = (in_height - 1) / stride + 1;
+  const index_t out_width = (in_width - 1) / stride + 1;
+  const index_t extent = (kernel - 1) * dilation + 1;
+  const int pad_h = static_cast<int>(std::max<index_t>(
+      0, (out_height - 1) * stride + extent - in_height));
+  const int pad_w = static_cast<int>(std::max<index_t>(
+      0, (out_width - 1) * stride + extent - in_width));
+  const int pad_hw[2] = {pad_h >> 1, pad_w >> 1};
+  const int stride_hw[2] = {stride, stride};
+  const int dilation_hw[2] = {dilation, dilation};
+  const index_t in_shape[4] = {batch, channels, in_height, in_width};
+  const index_t out_shape[4] = {batch, channels * multiplier, out_height,
+                                out_width};
+  const int pad_bottom = pad_h - pad_hw[0];
+  const int pad_right = pad_w - pad_hw[1];
+  const index_t valid_h_start = (pad_hw[0] + stride - 1) / stride;
+  const index_t valid_h_stop = out_height - (pad_bottom + stride - 1) / stride;
+  const index_t valid_w_start = (pad_hw[1] + stride - 1) / stride;
+  const index_t valid_w_stop = out_width - (pad_right + stride - 1) / stride;
+
+  std::vector<float> input(batch * channels * in_height * in_width);
+  std::vector<float> filter(multiplier * channels * kernel * kernel);
+  std::vector<float> output(
+      batch * channels * multiplier * out_height * out_width, 0);
+  std::vector<float> output_ref(output);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+  std::generate(input.begin(), input.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(filter.begin(), filter.end(), [&gen, &nd] { return nd(gen); });
+
+  func(input.data(), filter.data(), in_shape, out_shape, pad_hw, stride_hw,
+       dilation_hw, valid_h_start, valid_h_stop, valid_w_start, valid_w_stop,
+       output.data());
+  ref_func(input.data(), filter.data(), in_shape, out_shape, pad_hw,
+           stride_hw, dilation_hw, valid_h_start, valid_h_stop, valid_w_start,
+           valid_w_stop, output_ref.data());
+
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output_ref[i], output[i], 1e-3) << "with index " << i;
+  }
+}
+
+}  // namespace
+
+TEST(DepthwiseConv2dAvx2Test, K3x3) {
+  if (GetCPUISA() < CPU_ISA_AVX2) {
+    LOG(INFO) << "AVX2 is not supported, skip";
+    return;
+  }
+  for (int stride : {1, 2}) {
+    TestDepthwiseConv2dAvx2(DepthwiseConv2dAvx2K3x3, DepthwiseConv2dNeonK3x3,
+                            3, stride, 1, 1, 31, 37);
+    TestDepthwiseConv2dAvx2(DepthwiseConv2dAvx2K3x3, DepthwiseConv2dNeonK3x3,
+                            3, stride, 1, 2, 9, 70);
+  }
+  TestDepthwiseConv2dAvx2(DepthwiseConv2dAvx2K3x3, DepthwiseConv2dNeonK3x3,
+                          3, 1, 2, 1, 31, 37);
+  TestDepthwiseConv2dAvx2(DepthwiseConv2dAvx2K3x3, DepthwiseConv2dNeonK3x3,
+                          3, 1, 6, 1, 15, 41);
+}
+
+TEST(DepthwiseConv2dAvx2Test, K5x5) {
+  if (GetCPUISA() < CPU_ISA_AVX2) {
+    LOG(INFO) << "AVX2 is not supported, skip";
+    return;
+  }
+  for (int stride : {1, 2}) {
+    TestDepthwiseConv2dAvx2(DepthwiseConv2dAvx2K5x5, DepthwiseConv2dNeonK5x5,
+                            5, stride, 1, 1, 31, 37);
+    TestDepthwiseConv2dAvx2(DepthwiseConv2dAvx2K5x5, DepthwiseConv2dNeonK5x5,
+                            5, stride, 1, 3, 11, 66);
+  }
+  TestDepthwiseConv2dAvx2(DepthwiseConv2dAvx2K5x5, DepthwiseConv2dNeonK5x5,
+                          5, 1, 2, 1, 31, 37);
+}
+
+}  // namespace kernels
+}  // namespace mace
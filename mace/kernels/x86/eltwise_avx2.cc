@@ -0,0 +1,208 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+
+#include "mace/core/macros.h"
+#include "mace/kernels/x86/eltwise_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+struct SumOp {
+  float operator()(const float a, const float b) const { return a + b; }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_add_ps(a, b);
+  }
+};
+
+struct CoeffSumOp {
+  explicit CoeffSumOp(const float *coeff)
+      : coeff0(coeff[0]), coeff1(coeff[1]),
+        coeff0_vec(_mm256_set1_ps(coeff[0])),
+        coeff1_vec(_mm256_set1_ps(coeff[1])) {}
+  float operator()(const float a, const float b) const {
+    return a * coeff0 + b * coeff1;
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_fmadd_ps(a, coeff0_vec, _mm256_mul_ps(b, coeff1_vec));
+  }
+  const float coeff0;
+  const float coeff1;
+  const __m256 coeff0_vec;
+  const __m256 coeff1_vec;
+};
+
+struct SubOp {
+  float operator()(const float a, const float b) const { return a - b; }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_sub_ps(a, b);
+  }
+};
+
+struct ProdOp {
+  float operator()(const float a, const float b) const { return a * b; }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_mul_ps(a, b);
+  }
+};
+
+struct DivOp {
+  float operator()(const float a, const float b) const { return a / b; }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_div_ps(a, b);
+  }
+};
+
+struct MinOp {
+  float operator()(const float a, const float b) const {
+    return std::min(a, b);
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_min_ps(a, b);
+  }
+};
+
+struct MaxOp {
+  float operator()(const float a, const float b) const {
+    return std::max(a, b);
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_max_ps(a, b);
+  }
+};
+
+struct SqrDiffOp {
+  float operator()(const float a, const float b) const {
+    return (a - b) * (a - b);
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    const __m256 diff = _mm256_sub_ps(a, b);
+    return _mm256_mul_ps(diff, diff);
+  }
+};
+
+struct NegOp {
+  float operator()(const float a, const float b) const {
+    MACE_UNUSED(b);
+    return -a;
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    MACE_UNUSED(b);
+    return _mm256_xor_ps(a, _mm256_set1_ps(-0.f));
+  }
+};
+
+struct AbsOp {
+  float operator()(const float a, const float b) const {
+    MACE_UNUSED(b);
+    return std::fabs(a);
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    MACE_UNUSED(b);
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a);
+  }
+};
+
+template <typename Op>
+void EltwiseRow(const Op &op,
+                const float *input0,
+                const index_t stride0,
+                const float *input1,
+                const index_t stride1,
+                const index_t size,
+                float *output) {
+  index_t i = 0;
+  if (stride0 == 1 && stride1 == 1) {
+    for (; i + 8 <= size; i += 8) {
+      _mm256_storeu_ps(output + i, op(_mm256_loadu_ps(input0 + i),
+                                      _mm256_loadu_ps(input1 + i)));
+    }
+    for (; i < size; ++i) {
+      output[i] = op(input0[i], input1[i]);
+    }
+  } else if (stride0 == 1) {
+    const __m256 b = _mm256_set1_ps(input1[0]);
+    for (; i + 8 <= size; i += 8) {
+      _mm256_storeu_ps(output + i, op(_mm256_loadu_ps(input0 + i), b));
+    }
+    for (; i < size; ++i) {
+      output[i] = op(input0[i], input1[0]);
+    }
+  } else {
+    const __m256 a = _mm256_set1_ps(input0[0]);
+    for (; i + 8 <= size; i += 8) {
+      _mm256_storeu_ps(output + i, op(a, _mm256_loadu_ps(input1 + i)));
+    }
+    for (; i < size; ++i) {
+      output[i] = op(input0[0], input1[i]);
+    }
+  }
+}
+
+}  // namespace
+
+void EltwiseRowAvx2(const int type,
+                    const float *input0,
+                    const index_t stride0,
+                    const float *input1,
+                    const index_t stride1,
+                    const float *coeff,
+                    const index_t size,
+                    float *output) {
+  switch (type) {
+    case ELTWISE_ROW_AVX2_SUM:
+      if (coeff == nullptr) {
+        EltwiseRow(SumOp(), input0, stride0, input1, stride1, size, output);
+      } else {
+        EltwiseRow(CoeffSumOp(coeff), input0, stride0, input1, stride1, size,
+                   output);
+      }
+      break;
+    case ELTWISE_ROW_AVX2_SUB:
+      EltwiseRow(SubOp(), input0, stride0, input1, stride1, size, output);
+      break;
+    case ELTWISE_ROW_AVX2_PROD:
+      EltwiseRow(ProdOp(), input0, stride0, input1, stride1, size, output);
+      break;
+    case ELTWISE_ROW_AVX2_DIV:
+      EltwiseRow(DivOp(), input0, stride0, input1, stride1, size, output);
+      break;
+    case ELTWISE_ROW_AVX2_MIN:
+      EltwiseRow(MinOp(), input0, stride0, input1, stride1, size, output);
+      break;
+    case ELTWISE_ROW_AVX2_MAX:
+      EltwiseRow(MaxOp(), input0, stride0, input1, stride1, size, output);
+      break;
+    case ELTWISE_ROW_AVX2_SQR_DIFF:
+      EltwiseRow(SqrDiffOp(), input0, stride0, input1, stride1, size,
+                 output);
+      break;
+    case ELTWISE_ROW_AVX2_NEG:
+      EltwiseRow(NegOp(), input0, stride0, input1, stride1, size, output);
+      break;
+    case ELTWISE_ROW_AVX2_ABS:
+      EltwiseRow(AbsOp(), input0, stride0, input1, stride1, size, output);
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,53 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_X86_ELTWISE_AVX2_H_
+#define MACE_KERNELS_X86_ELTWISE_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// The EltwiseType values EltwiseRowAvx2 handles, equal to those in eltwise.h,
+// which this library can not include.
+enum EltwiseRowAvx2Type {
+  ELTWISE_ROW_AVX2_SUM = 0,
+  ELTWISE_ROW_AVX2_SUB = 1,
+  ELTWISE_ROW_AVX2_PROD = 2,
+  ELTWISE_ROW_AVX2_DIV = 3,
+  ELTWISE_ROW_AVX2_MIN = 4,
+  ELTWISE_ROW_AVX2_MAX = 5,
+  ELTWISE_ROW_AVX2_NEG = 6,
+  ELTWISE_ROW_AVX2_ABS = 7,
+  ELTWISE_ROW_AVX2_SQR_DIFF = 8,
+};
+
+// output[i] = input0[i * stride0] <type> input1[i * stride1], the strides
+// are 0 or 1. coeff is nullptr or the two SUM coefficients. The row step of
+// BroadcastEltwise for the EltwiseRowAvx2Type types, only call it when
+// GetCPUISA() >= CPU_ISA_AVX2.
+void EltwiseRowAvx2(const int type,
+                    const float *input0,
+                    const index_t stride0,
+                    const float *input1,
+                    const index_t stride1,
+                    const float *coeff,
+                    const index_t size,
+                    float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_ELTWISE_AVX2_H_
@@ -0,0 +1,55 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+#include <algorithm>
+
+#include "mace/kernels/x86/epilogue_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+void EpilogueLinearAvx2(const float *input,
+                        const float *residual,
+                        const float bias,
+                        const float negative_slope,
+                        const float max_limit,
+                        const index_t size,
+                        float *output) {
+  const __m256 vbias = _mm256_set1_ps(bias);
+  const __m256 vslope = _mm256_set1_ps(negative_slope);
+  const __m256 vmax = _mm256_set1_ps(max_limit);
+  const __m256 vzero = _mm256_setzero_ps();
+  index_t i = 0;
+  for (; i + 7 < size; i += 8) {
+    __m256 v = _mm256_add_ps(_mm256_loadu_ps(input + i), vbias);
+    if (residual != nullptr) {
+      v = _mm256_add_ps(v, _mm256_loadu_ps(residual + i));
+    }
+    const __m256 negative = _mm256_cmp_ps(v, vzero, _CMP_LT_OQ);
+    v = _mm256_blendv_ps(v, _mm256_mul_ps(v, vslope), negative);
+    _mm256_storeu_ps(output + i, _mm256_min_ps(v, vmax));
+  }
+  for (; i < size; ++i) {
+    float x = input[i] + bias;
+    if (residual != nullptr) {
+      x += residual[i];
+    }
+    x = x < 0 ? x * negative_slope : x;
+    output[i] = std::min(x, max_limit);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,38 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_X86_EPILOGUE_AVX2_H_
+#define MACE_KERNELS_X86_EPILOGUE_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// AVX2 version of the piecewise linear part of Epilogue::Apply:
+//   x = input + bias + residual (residual may be null)
+//   output = min(x < 0 ? x * negative_slope : x, max_limit)
+// Only call it when GetCPUISA() >= CPU_ISA_AVX2.
+void EpilogueLinearAvx2(const float *input,
+                        const float *residual,
+                        const float bias,
+                        const float negative_slope,
+                        const float max_limit,
+                        const index_t size,
+                        float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_EPILOGUE_AVX2_H_
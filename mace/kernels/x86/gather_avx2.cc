@@ -0,0 +1,133 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <immintrin.h>
+#include <algorithm>
+
+#include "mace/kernels/x86/gather_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+void PrefetchRow(const float *row, const index_t row_size) {
+  const index_t size = std::min(row_size, kGatherPrefetchSize);
+  for (index_t j = 0; j < size; j += 16) {
+    _mm_prefetch(reinterpret_cast<const char *>(row + j), _MM_HINT_T0);
+  }
+}
+
+// output[j] = scale * input[j]
+void ScaleRow(const float *input,
+              const index_t size,
+              const float scale,
+              float *output) {
+  const __m256 vscale = _mm256_set1_ps(scale);
+  index_t j = 0;
+  for (; j + 31 < size; j += 32) {
+    __m256 v0 = _mm256_loadu_ps(input + j);
+    __m256 v1 = _mm256_loadu_ps(input + j + 8);
+    __m256 v2 = _mm256_loadu_ps(input + j + 16);
+    __m256 v3 = _mm256_loadu_ps(input + j + 24);
+    _mm256_storeu_ps(output + j, _mm256_mul_ps(v0, vscale));
+    _mm256_storeu_ps(output + j + 8, _mm256_mul_ps(v1, vscale));
+    _mm256_storeu_ps(output + j + 16, _mm256_mul_ps(v2, vscale));
+    _mm256_storeu_ps(output + j + 24, _mm256_mul_ps(v3, vscale));
+  }
+  for (; j + 7 < size; j += 8) {
+    _mm256_storeu_ps(output + j,
+                     _mm256_mul_ps(_mm256_loadu_ps(input + j), vscale));
+  }
+  for (; j < size; ++j) {
+    output[j] = input[j] * scale;
+  }
+}
+
+// output[j] += input[j]
+void AddRow(const float *input, const index_t size, float *output) {
+  index_t j = 0;
+  for (; j + 31 < size; j += 32) {
+    __m256 v0 = _mm256_add_ps(_mm256_loadu_ps(output + j),
+                              _mm256_loadu_ps(input + j));
+    __m256 v1 = _mm256_add_ps(_mm256_loadu_ps(output + j + 8),
+                              _mm256_loadu_ps(input + j + 8));
+    __m256 v2 = _mm256_add_ps(_mm256_loadu_ps(output + j + 16),
+                              _mm256_loadu_ps(input + j + 16));
+    __m256 v3 = _mm256_add_ps(_mm256_loadu_ps(output + j + 24),
+                              _mm256_loadu_ps(input + j + 24));
+    _mm256_storeu_ps(output + j, v0);
+    _mm256_storeu_ps(output + j + 8, v1);
+    _mm256_storeu_ps(output + j + 16, v2);
+    _mm256_storeu_ps(output + j + 24, v3);
+  }
+  for (; j + 7 < size; j += 8) {
+    _mm256_storeu_ps(output + j, _mm256_add_ps(_mm256_loadu_ps(output + j),
+                                               _mm256_loadu_ps(input + j)));
+  }
+  for (; j < size; ++j) {
+    output[j] += input[j];
+  }
+}
+
+}  // namespace
+
+void GatherRowsAvx2(const float *rows,
+                    const int32_t *indices,
+                    const index_t count,
+                    const index_t row_size,
+                    const float scale,
+                    float *output) {
+  for (index_t i = 0; i < std::min(count, kGatherPrefetchDistance); ++i) {
+    PrefetchRow(rows + indices[i] * row_size, row_size);
+  }
+  for (index_t i = 0; i < count; ++i) {
+    if (i + kGatherPrefetchDistance < count) {
+      PrefetchRow(rows + indices[i + kGatherPrefetchDistance] * row_size,
+                  row_size);
+    }
+    ScaleRow(rows + indices[i] * row_size, row_size, scale,
+             output + i * row_size);
+  }
+}
+
+void PoolRowsAvx2(const float *rows,
+                  const int32_t *indices,
+                  const index_t count,
+                  const index_t row_size,
+                  const float scale,
+                  float *output) {
+  if (count == 0) {
+    std::fill(output, output + row_size, 0.f);
+    return;
+  }
+  for (index_t i = 0; i < std::min(count, kGatherPrefetchDistance); ++i) {
+    PrefetchRow(rows + indices[i] * row_size, row_size);
+  }
+  ScaleRow(rows + indices[0] * row_size, row_size, 1.f, output);
+  for (index_t i = 1; i < count; ++i) {
+    if (i + kGatherPrefetchDistance < count) {
+      PrefetchRow(rows + indices[i + kGatherPrefetchDistance] * row_size,
+                  row_size);
+    }
+    AddRow(rows + indices[i] * row_size, row_size, output);
+  }
+  if (scale != 1.f) {
+    ScaleRow(output, row_size, scale, output);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
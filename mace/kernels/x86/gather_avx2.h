@@ -0,0 +1,51 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+
+#ifndef MACE_KERNELS_X86_GATHER_AVX2_H_
+#define MACE_KERNELS_X86_GATHER_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// Rows ahead GatherRows and PoolRows prefetch, and the floats of a row they
+// prefetch at most, the hardware prefetcher streams in the rest. Shared by
+// the generic and the AVX2 kernels.
+const index_t kGatherPrefetchDistance = 8;
+const index_t kGatherPrefetchSize = 256;
+
+// GatherRows and PoolRows, only call them when
+// GetCPUISA() >= CPU_ISA_AVX2.
+
+void GatherRowsAvx2(const float *rows,
+                    const int32_t *indices,
+                    const index_t count,
+                    const index_t row_size,
+                    const float scale,
+                    float *output);
+
+void PoolRowsAvx2(const float *rows,
+                  const int32_t *indices,
+                  const index_t count,
+                  const index_t row_size,
+                  const float scale,
+                  float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_GATHER_AVX2_H_
@@ -0,0 +1,242 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+
+#include "mace/kernels/x86/gemm_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// Lanes [0, n) of a 8-lane mask, n in [0, 8]
+inline __m256i RemainMask(const index_t n) {
+  const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), lane);
+}
+
+// R rows of C, 16 (then 8, then masked) columns at a time. Each step of k
+// broadcasts one element of every row of A and multiplies it with a row
+// segment of B.
+template <int R>
+inline void GemmRows(const float *A,
+                     const float *B,
+                     const index_t K,
+                     const index_t width,
+                     const index_t stride_a,
+                     const index_t stride_b,
+                     const index_t stride_c,
+                     float *C) {
+  index_t w = 0;
+  for (; w + 15 < width; w += 16) {
+    __m256 c0[R], c1[R];
+    for (int r = 0; r < R; ++r) {
+      c0[r] = _mm256_loadu_ps(C + r * stride_c + w);
+      c1[r] = _mm256_loadu_ps(C + r * stride_c + w + 8);
+    }
+    const float *b_ptr = B + w;
+    for (index_t k = 0; k < K; ++k) {
+      __m256 b0 = _mm256_loadu_ps(b_ptr);
+      __m256 b1 = _mm256_loadu_ps(b_ptr + 8);
+      for (int r = 0; r < R; ++r) {
+        __m256 a = _mm256_broadcast_ss(A + r * stride_a + k);
+        c0[r] = _mm256_fmadd_ps(a, b0, c0[r]);
+        c1[r] = _mm256_fmadd_ps(a, b1, c1[r]);
+      }
+      b_ptr += stride_b;
+    }
+    for (int r = 0; r < R; ++r) {
+      _mm256_storeu_ps(C + r * stride_c + w, c0[r]);
+      _mm256_storeu_ps(C + r * stride_c + w + 8, c1[r]);
+    }
+  }
+
+  for (; w + 7 < width; w += 8) {
+    __m256 c0[R];
+    for (int r = 0; r < R; ++r) {
+      c0[r] = _mm256_loadu_ps(C + r * stride_c + w);
+    }
+    const float *b_ptr = B + w;
+    for (index_t k = 0; k < K; ++k) {
+      __m256 b0 = _mm256_loadu_ps(b_ptr);
+      for (int r = 0; r < R; ++r) {
+        __m256 a = _mm256_broadcast_ss(A + r * stride_a + k);
+        c0[r] = _mm256_fmadd_ps(a, b0, c0[r]);
+      }
+      b_ptr += stride_b;
+    }
+    for (int r = 0; r < R; ++r) {
+      _mm256_storeu_ps(C + r * stride_c + w, c0[r]);
+    }
+  }
+
+  if (w < width) {
+    // masked loads never touch the columns past width
+    const __m256i mask = RemainMask(width - w);
+    __m256 c0[R];
+    for (int r = 0; r < R; ++r) {
+      c0[r] = _mm256_maskload_ps(C + r * stride_c + w, mask);
+    }
+    const float *b_ptr = B + w;
+    for (index_t k = 0; k < K; ++k) {
+      __m256 b0 = _mm256_maskload_ps(b_ptr, mask);
+      for (int r = 0; r < R; ++r) {
+        __m256 a = _mm256_broadcast_ss(A + r * stride_a + k);
+        c0[r] = _mm256_fmadd_ps(a, b0, c0[r]);
+      }
+      b_ptr += stride_b;
+    }
+    for (int r = 0; r < R; ++r) {
+      _mm256_maskstore_ps(C + r * stride_c + w, mask, c0[r]);
+    }
+  }
+}
+
+// sums[r * sums_stride + b] = sum_w m[r, w] * v[b, w] for R rows of m and
+// B vectors. Every loaded segment of m is used for all B vectors, 4 x 3
+// accumulators and 4 segments of m take all 16 registers.
+template <int R, int B>
+inline void BatchedGemvBlock(const float *m_ptr,
+                             const float *v_ptr,
+                             const index_t width,
+                             const index_t sums_stride,
+                             float *sums) {
+  __m256 vsum[R][B];
+  for (int r = 0; r < R; ++r) {
+    for (int b = 0; b < B; ++b) {
+      vsum[r][b] = _mm256_setzero_ps();
+    }
+  }
+  index_t w = 0;
+  for (; w + 7 < width; w += 8) {
+    __m256 vm[R];
+    for (int r = 0; r < R; ++r) {
+      vm[r] = _mm256_loadu_ps(m_ptr + r * width + w);
+    }
+    for (int b = 0; b < B; ++b) {
+      const __m256 vv = _mm256_loadu_ps(v_ptr + b * width + w);
+      for (int r = 0; r < R; ++r) {
+        vsum[r][b] = _mm256_fmadd_ps(vm[r], vv, vsum[r][b]);
+      }
+    }
+  }
+  if (w < width) {
+    const __m256i mask = RemainMask(width - w);
+    __m256 vm[R];
+    for (int r = 0; r < R; ++r) {
+      vm[r] = _mm256_maskload_ps(m_ptr + r * width + w, mask);
+    }
+    for (int b = 0; b < B; ++b) {
+      const __m256 vv = _mm256_maskload_ps(v_ptr + b * width + w, mask);
+      for (int r = 0; r < R; ++r) {
+        vsum[r][b] = _mm256_fmadd_ps(vm[r], vv, vsum[r][b]);
+      }
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int b = 0; b < B; ++b) {
+      __m128 v = _mm_add_ps(_mm256_castps256_ps128(vsum[r][b]),
+                            _mm256_extractf128_ps(vsum[r][b], 1));
+      v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+      v = _mm_add_ss(v, _mm_movehdup_ps(v));
+      sums[r * sums_stride + b] = _mm_cvtss_f32(v);
+    }
+  }
+}
+
+template <int R>
+void BatchedGemvRows(const float *m_ptr,
+                     const float *v_ptr,
+                     const index_t batch,
+                     const index_t width,
+                     const index_t sums_stride,
+                     float *sums) {
+  index_t b = 0;
+  for (; b + 2 < batch; b += 3) {
+    BatchedGemvBlock<R, 3>(m_ptr, v_ptr + b * width, width, sums_stride,
+                           sums + b);
+  }
+  switch (batch - b) {
+    case 2:
+      BatchedGemvBlock<R, 2>(m_ptr, v_ptr + b * width, width, sums_stride,
+                             sums + b);
+      break;
+    case 1:
+      BatchedGemvBlock<R, 1>(m_ptr, v_ptr + b * width, width, sums_stride,
+                             sums + b);
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace
+
+void GemmTileAvx2(const float *A,
+                  const float *B,
+                  const index_t height,
+                  const index_t K,
+                  const index_t width,
+                  const index_t stride_a,
+                  const index_t stride_b,
+                  const index_t stride_c,
+                  float *C) {
+  index_t h = 0;
+  for (; h + 5 < height; h += 6) {
+    GemmRows<6>(A + h * stride_a, B, K, width, stride_a, stride_b, stride_c,
+                C + h * stride_c);
+  }
+  const float *a_ptr = A + h * stride_a;
+  float *c_ptr = C + h * stride_c;
+  switch (height - h) {
+    case 0:
+      break;
+    case 1:
+      GemmRows<1>(a_ptr, B, K, width, stride_a, stride_b, stride_c, c_ptr);
+      break;
+    case 2:
+      GemmRows<2>(a_ptr, B, K, width, stride_a, stride_b, stride_c, c_ptr);
+      break;
+    case 3:
+      GemmRows<3>(a_ptr, B, K, width, stride_a, stride_b, stride_c, c_ptr);
+      break;
+    case 4:
+      GemmRows<4>(a_ptr, B, K, width, stride_a, stride_b, stride_c, c_ptr);
+      break;
+    default:
+      GemmRows<5>(a_ptr, B, K, width, stride_a, stride_b, stride_c, c_ptr);
+      break;
+  }
+}
+
+void BatchedGemvTileAvx2(const float *m_ptr,
+                         const float *v_ptr,
+                         const index_t rows,
+                         const index_t batch,
+                         const index_t width,
+                         const index_t sums_stride,
+                         float *sums) {
+  if (rows == 4) {
+    BatchedGemvRows<4>(m_ptr, v_ptr, batch, width, sums_stride, sums);
+  } else {
+    for (index_t r = 0; r < rows; ++r) {
+      BatchedGemvRows<1>(m_ptr + r * width, v_ptr, batch, width, sums_stride,
+                         sums + r * sums_stride);
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
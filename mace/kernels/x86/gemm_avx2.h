@@ -0,0 +1,50 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_X86_GEMM_AVX2_H_
+#define MACE_KERNELS_X86_GEMM_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// C[height, width] += A[height, K] * B[K, width], all row major with the
+// given row strides. This is the inner block of Gemm (see gemm.cc), only
+// call it when GetCPUISA() >= CPU_ISA_AVX2.
+void GemmTileAvx2(const float *A,
+                  const float *B,
+                  const index_t height,
+                  const index_t K,
+                  const index_t width,
+                  const index_t stride_a,
+                  const index_t stride_b,
+                  const index_t stride_c,
+                  float *C);
+
+// sums[r * sums_stride + b] = sum_w m[r, w] * v[b, w] for r in [0, rows) and
+// b in [0, batch), rows <= 4. The block of BatchedGemv (see gemm.cc), only
+// call it when GetCPUISA() >= CPU_ISA_AVX2.
+void BatchedGemvTileAvx2(const float *m_ptr,
+                         const float *v_ptr,
+                         const index_t rows,
+                         const index_t batch,
+                         const index_t width,
+                         const index_t sums_stride,
+                         float *sums);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_GEMM_AVX2_H_
@@ -0,0 +1,82 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mace/core/runtime/cpu/cpu_features.h"
+#include "mace/kernels/x86/gemm_avx2.h"
+#include "mace/utils/logging.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+void TestGemmTileAvx2(const index_t height,
+                      const index_t K,
+                      const index_t width) {
+  // strides wider than the block, as Gemm calls it on 64x64 sub-blocks
+  const index_t stride_a = K + 3;
+  const index_t stride_b = width + 5;
+  const index_t stride_c = width + 7;
+  std::vector<float> A(height * stride_a);
+  std::vector<float> B(K * stride_b);
+  std::vector<float> C(height * stride_c);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::normal_distribution<float> nd(0, 1);
+  std::generate(A.begin(), A.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(B.begin(), B.end(), [&gen, &nd] { return nd(gen); });
+  std::generate(C.begin(), C.end(), [&gen, &nd] { return nd(gen); });
+  std::vector<float> C_ref(C);
+
+  GemmTileAvx2(A.data(), B.data(), height, K, width, stride_a, stride_b,
+               stride_c, C.data());
+
+  for (index_t i = 0; i < height; ++i) {
+    for (index_t j = 0; j < width; ++j) {
+      for (index_t k = 0; k < K; ++k) {
+        C_ref[i * stride_c + j] += A[i * stride_a + k] * B[k * stride_b + j];
+      }
+    }
+  }
+
+  // columns between width and stride_c must stay untouched
+  for (size_t i = 0; i < C.size(); ++i) {
+    EXPECT_NEAR(C_ref[i], C[i], 1e-3) << "with index " << i;
+  }
+}
+
+}  // namespace
+
+TEST(GemmAvx2Test, GemmTile) {
+  if (GetCPUISA() < CPU_ISA_AVX2) {
+    LOG(INFO) << "AVX2 is not supported, skip";
+    return;
+  }
+  TestGemmTileAvx2(64, 64, 64);
+  TestGemmTileAvx2(6, 17, 16);
+  for (index_t height = 1; height <= 13; ++height) {
+    for (index_t width = 1; width <= 25; width += 3) {
+      TestGemmTileAvx2(height, 7, width);
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,157 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <immintrin.h>
+
+#include "mace/kernels/x86/nchwc_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// T output pixels, their accumulators stay in registers. Each tap loads one
+// row of 8 output channels of the filter per input channel and reuses it for
+// all T pixels.
+template <int T>
+inline void Conv2dNCHW8cPixelsAvx2(const float *input,
+                                   const float *filter,
+                                   const NCHWcConvGeometry &g,
+                                   const index_t ih_base,
+                                   const index_t iw_base,
+                                   float *output) {
+  __m256 acc[T];
+  for (int t = 0; t < T; ++t) {
+    acc[t] = _mm256_setzero_ps();
+  }
+
+  const index_t in_image_size = g.in_height * g.in_width * 8;
+  const index_t filter_block_size = g.filter_h * g.filter_w * 64;
+  const index_t pixel_stride = g.stride_w * 8;
+  for (index_t icb = 0; icb < g.in_blocks; ++icb) {
+    const float *in_image = input + icb * in_image_size;
+    const float *filter_block = filter + icb * filter_block_size;
+    for (index_t kh = 0; kh < g.filter_h; ++kh) {
+      const index_t ih = ih_base + kh * g.dilation_h;
+      if (ih < 0 || ih >= g.in_height) {
+        continue;
+      }
+      const float *in_row = in_image + ih * g.in_width * 8;
+      const float *filter_row = filter_block + kh * g.filter_w * 64;
+      for (index_t kw = 0; kw < g.filter_w; ++kw) {
+        const float *in_pixel = in_row + (iw_base + kw * g.dilation_w) * 8;
+        const float *w = filter_row + kw * 64;
+        for (int ci = 0; ci < 8; ++ci) {
+          const __m256 vw = _mm256_loadu_ps(w + ci * 8);
+          for (int t = 0; t < T; ++t) {
+            acc[t] = _mm256_fmadd_ps(
+                _mm256_broadcast_ss(in_pixel + t * pixel_stride + ci), vw,
+                acc[t]);
+          }
+        }
+      }
+    }
+  }
+
+  for (int t = 0; t < T; ++t) {
+    _mm256_storeu_ps(output + t * 8, acc[t]);
+  }
+}
+
+template <int T>
+inline void DepthwiseConv2dNCHW8cPixelsAvx2(const float *input,
+                                            const float *filter,
+                                            const NCHWcConvGeometry &g,
+                                            const index_t ih_base,
+                                            const index_t iw_base,
+                                            float *output) {
+  __m256 acc[T];
+  for (int t = 0; t < T; ++t) {
+    acc[t] = _mm256_setzero_ps();
+  }
+
+  const index_t pixel_stride = g.stride_w * 8;
+  for (index_t kh = 0; kh < g.filter_h; ++kh) {
+    const index_t ih = ih_base + kh * g.dilation_h;
+    if (ih < 0 || ih >= g.in_height) {
+      continue;
+    }
+    const float *in_row = input + ih * g.in_width * 8;
+    const float *filter_row = filter + kh * g.filter_w * 8;
+    for (index_t kw = 0; kw < g.filter_w; ++kw) {
+      const float *in_pixel = in_row + (iw_base + kw * g.dilation_w) * 8;
+      const __m256 vw = _mm256_loadu_ps(filter_row + kw * 8);
+      for (int t = 0; t < T; ++t) {
+        acc[t] = _mm256_fmadd_ps(
+            _mm256_loadu_ps(in_pixel + t * pixel_stride), vw, acc[t]);
+      }
+    }
+  }
+
+  for (int t = 0; t < T; ++t) {
+    _mm256_storeu_ps(output + t * 8, acc[t]);
+  }
+}
+
+}  // namespace
+
+void Conv2dNCHW8cRowAvx2(const float *input,
+                         const float *filter,
+                         const NCHWcConvGeometry &geometry,
+                         const index_t ih_base,
+                         const index_t iw_base,
+                         const index_t count,
+                         float *output) {
+  const int stride_w = geometry.stride_w;
+  index_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    Conv2dNCHW8cPixelsAvx2<8>(input, filter, geometry, ih_base,
+                              iw_base + i * stride_w, output + i * 8);
+  }
+  for (; i + 4 <= count; i += 4) {
+    Conv2dNCHW8cPixelsAvx2<4>(input, filter, geometry, ih_base,
+                              iw_base + i * stride_w, output + i * 8);
+  }
+  for (; i < count; ++i) {
+    Conv2dNCHW8cPixelsAvx2<1>(input, filter, geometry, ih_base,
+                              iw_base + i * stride_w, output + i * 8);
+  }
+}
+
+void DepthwiseConv2dNCHW8cRowAvx2(const float *input,
+                                  const float *filter,
+                                  const NCHWcConvGeometry &geometry,
+                                  const index_t ih_base,
+                                  const index_t iw_base,
+                                  const index_t count,
+                                  float *output) {
+  const int stride_w = geometry.stride_w;
+  index_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    DepthwiseConv2dNCHW8cPixelsAvx2<8>(input, filter, geometry, ih_base,
+                                       iw_base + i * stride_w, output + i * 8);
+  }
+  for (; i + 4 <= count; i += 4) {
+    DepthwiseConv2dNCHW8cPixelsAvx2<4>(input, filter, geometry, ih_base,
+                                       iw_base + i * stride_w, output + i * 8);
+  }
+  for (; i < count; ++i) {
+    DepthwiseConv2dNCHW8cPixelsAvx2<1>(input, filter, geometry, ih_base,
+                                       iw_base + i * stride_w, output + i * 8);
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
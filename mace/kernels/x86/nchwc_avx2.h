@@ -0,0 +1,60 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_X86_NCHWC_AVX2_H_
+#define MACE_KERNELS_X86_NCHWC_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// Geometry of a blocked conv or depthwise conv as seen by its row kernels,
+// generic (nchwc.h) and AVX2 alike.
+struct NCHWcConvGeometry {
+  index_t in_blocks;  // unused by depthwise conv
+  index_t in_height;
+  index_t in_width;
+  index_t filter_h;
+  index_t filter_w;
+  int stride_w;
+  int dilation_h;
+  int dilation_w;
+};
+
+// AVX2 row kernels (see NCHWcConvRowFunc in nchwc.h) of the NCHW8C conv and
+// depthwise conv, a block of 8 channels is one __m256. Only call them when
+// GetCPUISA() >= CPU_ISA_AVX2.
+
+void Conv2dNCHW8cRowAvx2(const float *input,
+                         const float *filter,
+                         const NCHWcConvGeometry &geometry,
+                         const index_t ih_base,
+                         const index_t iw_base,
+                         const index_t count,
+                         float *output);
+
+void DepthwiseConv2dNCHW8cRowAvx2(const float *input,
+                                  const float *filter,
+                                  const NCHWcConvGeometry &geometry,
+                                  const index_t ih_base,
+                                  const index_t iw_base,
+                                  const index_t count,
+                                  float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_NCHWC_AVX2_H_
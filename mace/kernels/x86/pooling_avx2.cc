@@ -0,0 +1,242 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+#include <algorithm>
+#include <limits>
+
+#include "mace/kernels/x86/pooling_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+template <bool IS_MAX>
+inline float PoolingBorderPixel(const float *in_base,
+                                const index_t in_h_start,
+                                const index_t in_w_start,
+                                const index_t in_height,
+                                const index_t in_width,
+                                const int filter_size) {
+  float res = IS_MAX ? std::numeric_limits<float>::lowest() : 0;
+  int block_size = 0;
+  for (int i = 0; i < filter_size; ++i) {
+    for (int j = 0; j < filter_size; ++j) {
+      index_t in_h = in_h_start + i;
+      index_t in_w = in_w_start + j;
+      if (in_h >= 0 && in_h < in_height && in_w >= 0 && in_w < in_width) {
+        const float value = in_base[in_h * in_width + in_w];
+        res = IS_MAX ? std::max(res, value) : res + value;
+        ++block_size;
+      }
+    }
+  }
+  return IS_MAX ? res : res / block_size;
+}
+
+// Load ptr[0], ptr[S], ..., ptr[7 * S] without reading past the last one.
+template <int S>
+inline __m256 LoadStrided8(const float *ptr);
+
+template <>
+inline __m256 LoadStrided8<1>(const float *ptr) {
+  return _mm256_loadu_ps(ptr);
+}
+
+template <>
+inline __m256 LoadStrided8<2>(const float *ptr) {
+  __m256 v0 = _mm256_loadu_ps(ptr);
+  __m256 v1 = _mm256_loadu_ps(ptr + 7);
+  // [0 2 8 10 | 4 6 12 14] -> [0 2 4 6 | 8 10 12 14]
+  __m256 v = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 2, 0));
+  return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v),
+                                                _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+// Ho = 1, Wo = 8
+template <int K, int S, bool IS_MAX>
+void PoolingAvx2KxKSn(const float *input,
+                      const index_t *in_shape,
+                      const index_t *out_shape,
+                      const int *pad_hw,
+                      float *output) {
+  const index_t in_height = in_shape[2];
+  const index_t in_width = in_shape[3];
+  const index_t out_height = out_shape[2];
+  const index_t out_width = out_shape[3];
+  const index_t in_image_size = in_height * in_width;
+  const index_t out_image_size = out_height * out_width;
+  const index_t pad_top = pad_hw[0];
+  const index_t pad_left = pad_hw[1];
+
+  // [valid_h_start, valid_h_stop) x [valid_w_start, valid_w_stop) are the
+  // outputs whose windows lie inside the input.
+  const index_t valid_h_start = std::min((pad_top + S - 1) / S, out_height);
+  const index_t valid_h_stop = in_height + pad_top < K ? valid_h_start
+      : std::max(valid_h_start,
+                 std::min((in_height + pad_top - K) / S + 1, out_height));
+  const index_t valid_w_start = std::min((pad_left + S - 1) / S, out_width);
+  const index_t valid_w_stop = in_width + pad_left < K ? valid_w_start
+      : std::max(valid_w_start,
+                 std::min((in_width + pad_left - K) / S + 1, out_width));
+
+#pragma omp parallel for
+  for (index_t i = 0; i < out_shape[0] * out_shape[1]; ++i) {
+    const float *in_base = input + i * in_image_size;
+    float *out_base = output + i * out_image_size;
+
+    for (index_t h = 0; h < out_height; ++h) {
+      const index_t in_h = h * S - pad_top;
+      float *out_row = out_base + h * out_width;
+      if (h < valid_h_start || h >= valid_h_stop) {
+        for (index_t w = 0; w < out_width; ++w) {
+          out_row[w] = PoolingBorderPixel<IS_MAX>(
+              in_base, in_h, w * S - pad_left, in_height, in_width, K);
+        }
+        continue;
+      }
+
+      for (index_t w = 0; w < valid_w_start; ++w) {
+        out_row[w] = PoolingBorderPixel<IS_MAX>(
+            in_base, in_h, w * S - pad_left, in_height, in_width, K);
+      }
+
+      const float *in_row = in_base + in_h * in_width - pad_left;
+      index_t w = valid_w_start;
+      for (; w + 7 < valid_w_stop; w += 8) {
+        __m256 vo = IS_MAX ? LoadStrided8<S>(in_row + w * S)
+                           : _mm256_setzero_ps();
+        for (int kh = 0; kh < K; ++kh) {
+          for (int kw = 0; kw < K; ++kw) {
+            __m256 vi = LoadStrided8<S>(in_row + kh * in_width + w * S + kw);
+            vo = IS_MAX ? _mm256_max_ps(vo, vi) : _mm256_add_ps(vo, vi);
+          }
+        }
+        if (!IS_MAX) {
+          vo = _mm256_mul_ps(vo, _mm256_set1_ps(1.f / (K * K)));
+        }
+        _mm256_storeu_ps(out_row + w, vo);
+      }
+      for (; w < valid_w_stop; ++w) {
+        float res = IS_MAX ? in_row[w * S] : 0;
+        for (int kh = 0; kh < K; ++kh) {
+          for (int kw = 0; kw < K; ++kw) {
+            const float value = in_row[kh * in_width + w * S + kw];
+            res = IS_MAX ? std::max(res, value) : res + value;
+          }
+        }
+        out_row[w] = IS_MAX ? res : res * (1.f / (K * K));
+      }
+
+      for (w = valid_w_stop; w < out_width; ++w) {
+        out_row[w] = PoolingBorderPixel<IS_MAX>(
+            in_base, in_h, w * S - pad_left, in_height, in_width, K);
+      }
+    }  // h
+  }  // i
+}
+
+template <bool IS_MAX>
+void PoolingAvx2Global(const float *input,
+                       const index_t *in_shape,
+                       float *output) {
+  const index_t image_size = in_shape[2] * in_shape[3];
+
+#pragma omp parallel for
+  for (index_t i = 0; i < in_shape[0] * in_shape[1]; ++i) {
+    const float *in_ptr = input + i * image_size;
+    float res = IS_MAX ? std::numeric_limits<float>::lowest() : 0;
+    __m256 vres = _mm256_set1_ps(res);
+    index_t j = 0;
+    for (; j + 7 < image_size; j += 8) {
+      __m256 vi = _mm256_loadu_ps(in_ptr + j);
+      vres = IS_MAX ? _mm256_max_ps(vres, vi) : _mm256_add_ps(vres, vi);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, vres);
+    for (int l = 0; l < 8; ++l) {
+      res = IS_MAX ? std::max(res, lanes[l]) : res + lanes[l];
+    }
+    for (; j < image_size; ++j) {
+      res = IS_MAX ? std::max(res, in_ptr[j]) : res + in_ptr[j];
+    }
+    output[i] = IS_MAX ? res : res / image_size;
+  }
+}
+
+}  // namespace
+
+void MaxPoolingAvx2K2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingAvx2KxKSn<2, 2, true>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void MaxPoolingAvx2K3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingAvx2KxKSn<3, 1, true>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void MaxPoolingAvx2K3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingAvx2KxKSn<3, 2, true>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void AvgPoolingAvx2K2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingAvx2KxKSn<2, 2, false>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void AvgPoolingAvx2K3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingAvx2KxKSn<3, 1, false>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void AvgPoolingAvx2K3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output) {
+  PoolingAvx2KxKSn<3, 2, false>(input, in_shape, out_shape, pad_hw, output);
+}
+
+void MaxPoolingAvx2Global(const float *input,
+                          const index_t *in_shape,
+                          float *output) {
+  PoolingAvx2Global<true>(input, in_shape, output);
+}
+
+void AvgPoolingAvx2Global(const float *input,
+                          const index_t *in_shape,
+                          float *output) {
+  PoolingAvx2Global<false>(input, in_shape, output);
+}
+
+}  // namespace kernels
+}  // namespace mace
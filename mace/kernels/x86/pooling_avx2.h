@@ -0,0 +1,73 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_X86_POOLING_AVX2_H_
+#define MACE_KERNELS_X86_POOLING_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// AVX2 counterparts of the kernels in arm/pooling_neon.h. Only call them
+// when GetCPUISA() >= CPU_ISA_AVX2.
+
+void MaxPoolingAvx2K2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void MaxPoolingAvx2K3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void MaxPoolingAvx2K3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void AvgPoolingAvx2K2x2S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void AvgPoolingAvx2K3x3S1(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void AvgPoolingAvx2K3x3S2(const float *input,
+                          const index_t *in_shape,
+                          const index_t *out_shape,
+                          const int *pad_hw,
+                          float *output);
+
+void MaxPoolingAvx2Global(const float *input,
+                          const index_t *in_shape,
+                          float *output);
+
+void AvgPoolingAvx2Global(const float *input,
+                          const index_t *in_shape,
+                          float *output);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_POOLING_AVX2_H_
@@ -0,0 +1,74 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <immintrin.h>
+#include <algorithm>
+
+#include "mace/kernels/x86/proposal_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+uint64_t NMSMaskAvx2(const float *x1,
+                     const float *y1,
+                     const float *x2,
+                     const float *y2,
+                     const float *area,
+                     const index_t i,
+                     const index_t begin,
+                     const index_t count,
+                     const float thresh) {
+  const __m256 ix1 = _mm256_set1_ps(x1[i]);
+  const __m256 iy1 = _mm256_set1_ps(y1[i]);
+  const __m256 ix2 = _mm256_set1_ps(x2[i]);
+  const __m256 iy2 = _mm256_set1_ps(y2[i]);
+  const __m256 iarea = _mm256_set1_ps(area[i]);
+  const __m256 vthresh = _mm256_set1_ps(thresh);
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 zero = _mm256_setzero_ps();
+
+  uint64_t mask = 0;
+  index_t j = 0;
+  for (; j + 7 < count; j += 8) {
+    const index_t b = begin + j;
+    __m256 w = _mm256_sub_ps(_mm256_min_ps(ix2, _mm256_loadu_ps(x2 + b)),
+                             _mm256_max_ps(ix1, _mm256_loadu_ps(x1 + b)));
+    __m256 h = _mm256_sub_ps(_mm256_min_ps(iy2, _mm256_loadu_ps(y2 + b)),
+                             _mm256_max_ps(iy1, _mm256_loadu_ps(y1 + b)));
+    w = _mm256_max_ps(_mm256_add_ps(w, one), zero);
+    h = _mm256_max_ps(_mm256_add_ps(h, one), zero);
+    const __m256 inter = _mm256_mul_ps(w, h);
+    const __m256 uni = _mm256_sub_ps(
+        _mm256_add_ps(iarea, _mm256_loadu_ps(area + b)), inter);
+    const __m256 ge = _mm256_cmp_ps(inter, _mm256_mul_ps(vthresh, uni),
+                                    _CMP_GE_OQ);
+    mask |= static_cast<uint64_t>(_mm256_movemask_ps(ge)) << j;
+  }
+  for (; j < count; ++j) {
+    const index_t b = begin + j;
+    const float w =
+        std::max(0.f, std::min(x2[i], x2[b]) - std::max(x1[i], x1[b]) + 1);
+    const float h =
+        std::max(0.f, std::min(y2[i], y2[b]) - std::max(y1[i], y1[b]) + 1);
+    const float inter = w * h;
+    if (inter >= thresh * (area[i] + area[b] - inter)) {
+      mask |= static_cast<uint64_t>(1) << j;
+    }
+  }
+  return mask;
+}
+
+}  // namespace kernels
+}  // namespace mace
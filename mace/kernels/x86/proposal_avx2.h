@@ -0,0 +1,41 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_X86_PROPOSAL_AVX2_H_
+#define MACE_KERNELS_X86_PROPOSAL_AVX2_H_
+
+#include <cstdint>
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// Bit j set iff box i overlaps box begin + j (j < count <= 64) with
+// IoU >= thresh, only call it when GetCPUISA() >= CPU_ISA_AVX2.
+uint64_t NMSMaskAvx2(const float *x1,
+                     const float *y1,
+                     const float *x2,
+                     const float *y2,
+                     const float *area,
+                     const index_t i,
+                     const index_t begin,
+                     const index_t count,
+                     const float thresh);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_PROPOSAL_AVX2_H_
@@ -0,0 +1,107 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <immintrin.h>
+#include <algorithm>
+
+#include "mace/kernels/x86/reduce_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+struct SumOp {
+  float operator()(const float a, const float b) const { return a + b; }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_add_ps(a, b);
+  }
+};
+
+struct MaxOp {
+  float operator()(const float a, const float b) const {
+    return std::max(a, b);
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_max_ps(a, b);
+  }
+};
+
+struct MinOp {
+  float operator()(const float a, const float b) const {
+    return std::min(a, b);
+  }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_min_ps(a, b);
+  }
+};
+
+struct ProdOp {
+  float operator()(const float a, const float b) const { return a * b; }
+  __m256 operator()(const __m256 a, const __m256 b) const {
+    return _mm256_mul_ps(a, b);
+  }
+};
+
+template <typename Op>
+float ReduceRowWith(Op op, const float *input, const index_t size) {
+  index_t i = 0;
+  float result = input[0];
+  if (size >= 16) {
+    // two accumulators hide the latency of the dependent adds
+    __m256 acc0 = _mm256_loadu_ps(input);
+    __m256 acc1 = _mm256_loadu_ps(input + 8);
+    for (i = 16; i + 15 < size; i += 16) {
+      acc0 = op(acc0, _mm256_loadu_ps(input + i));
+      acc1 = op(acc1, _mm256_loadu_ps(input + i + 8));
+    }
+    for (; i + 7 < size; i += 8) {
+      acc0 = op(acc0, _mm256_loadu_ps(input + i));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, op(acc0, acc1));
+    result = op(op(op(lanes[0], lanes[1]), op(lanes[2], lanes[3])),
+                op(op(lanes[4], lanes[5]), op(lanes[6], lanes[7])));
+  } else {
+    i = 1;
+  }
+  for (; i < size; ++i) {
+    result = op(result, input[i]);
+  }
+  return result;
+}
+
+}  // namespace
+
+float ReduceRowAvx2(const int type,
+                    const float *input,
+                    const index_t size) {
+  switch (type) {
+    case REDUCE_ROW_AVX2_MEAN:
+    case REDUCE_ROW_AVX2_SUM:
+      return ReduceRowWith(SumOp(), input, size);
+    case REDUCE_ROW_AVX2_MAX:
+      return ReduceRowWith(MaxOp(), input, size);
+    case REDUCE_ROW_AVX2_MIN:
+      return ReduceRowWith(MinOp(), input, size);
+    case REDUCE_ROW_AVX2_PROD:
+      return ReduceRowWith(ProdOp(), input, size);
+    default:
+      return 0;
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,42 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_X86_REDUCE_AVX2_H_
+#define MACE_KERNELS_X86_REDUCE_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// The ReduceType values, equal to those in reduce.h, which this library can
+// not include.
+enum ReduceRowAvx2Type {
+  REDUCE_ROW_AVX2_MEAN = 0,
+  REDUCE_ROW_AVX2_SUM = 1,
+  REDUCE_ROW_AVX2_MAX = 2,
+  REDUCE_ROW_AVX2_MIN = 3,
+  REDUCE_ROW_AVX2_PROD = 4,
+};
+
+// ReduceRow, only call it when GetCPUISA() >= CPU_ISA_AVX2.
+float ReduceRowAvx2(const int type,
+                    const float *input,
+                    const index_t size);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_REDUCE_AVX2_H_
@@ -0,0 +1,259 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "mace/kernels/x86/sparse_gemm_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// V x 8 columns of the BR rows of C, whose sums stay in registers over all
+// the blocks of the block row.
+template <int BR, int BC, int V>
+inline void SparseGemmColumns(const int32_t *col_idx,
+                              const float *values,
+                              const index_t blocks,
+                              const float *B,
+                              const index_t width,
+                              float *C) {
+  __m256 sum[BR][V];
+  for (int r = 0; r < BR; ++r) {
+    for (int v = 0; v < V; ++v) {
+      sum[r][v] = _mm256_setzero_ps();
+    }
+  }
+  for (index_t i = 0; i < blocks; ++i) {
+    const float *b_ptr = B + col_idx[i] * width;
+    const float *v_ptr = values + i * BR * BC;
+    for (int c = 0; c < BC; ++c) {
+      __m256 b[V];
+      for (int v = 0; v < V; ++v) {
+        b[v] = _mm256_loadu_ps(b_ptr + c * width + v * 8);
+      }
+      for (int r = 0; r < BR; ++r) {
+        const __m256 weight = _mm256_broadcast_ss(v_ptr + r * BC + c);
+        for (int v = 0; v < V; ++v) {
+          sum[r][v] = _mm256_fmadd_ps(weight, b[v], sum[r][v]);
+        }
+      }
+    }
+  }
+  for (int r = 0; r < BR; ++r) {
+    for (int v = 0; v < V; ++v) {
+      _mm256_storeu_ps(C + r * width + v * 8, sum[r][v]);
+    }
+  }
+}
+
+template <int BR, int BC, int V>
+void SparseGemmRows(const int32_t *col_idx,
+                    const float *values,
+                    const index_t blocks,
+                    const float *B,
+                    const index_t width,
+                    float *C) {
+  index_t w = 0;
+  for (; w + V * 8 <= width; w += V * 8) {
+    SparseGemmColumns<BR, BC, V>(col_idx, values, blocks, B + w, width,
+                                 C + w);
+  }
+  for (; w + 8 <= width; w += 8) {
+    SparseGemmColumns<BR, BC, 1>(col_idx, values, blocks, B + w, width,
+                                 C + w);
+  }
+  for (; w < width; ++w) {
+    float sum[BR] = {0.f};
+    for (index_t i = 0; i < blocks; ++i) {
+      const float *b_ptr = B + col_idx[i] * width + w;
+      const float *v_ptr = values + i * BR * BC;
+      for (int c = 0; c < BC; ++c) {
+        for (int r = 0; r < BR; ++r) {
+          sum[r] += v_ptr[r * BC + c] * b_ptr[c * width];
+        }
+      }
+    }
+    for (int r = 0; r < BR; ++r) {
+      C[r * width + w] = sum[r];
+    }
+  }
+}
+
+void SparseGemmRowsGeneral(const int32_t *col_idx,
+                           const float *values,
+                           const index_t blocks,
+                           const int block_rows,
+                           const int block_cols,
+                           const float *B,
+                           const index_t width,
+                           float *C) {
+  std::fill(C, C + block_rows * width, 0.f);
+  for (index_t i = 0; i < blocks; ++i) {
+    const float *v_ptr = values + i * block_rows * block_cols;
+    for (int r = 0; r < block_rows; ++r) {
+      for (int c = 0; c < block_cols; ++c) {
+        const float *b_ptr = B + (col_idx[i] + c) * width;
+        float *c_ptr = C + r * width;
+        const __m256 weight = _mm256_broadcast_ss(v_ptr + r * block_cols + c);
+        index_t w = 0;
+        for (; w + 8 <= width; w += 8) {
+          _mm256_storeu_ps(c_ptr + w,
+                           _mm256_fmadd_ps(weight, _mm256_loadu_ps(b_ptr + w),
+                                           _mm256_loadu_ps(c_ptr + w)));
+        }
+        for (; w < width; ++w) {
+          c_ptr[w] += v_ptr[r * block_cols + c] * b_ptr[w];
+        }
+      }
+    }
+  }
+}
+
+inline float HorizontalSum(const __m128 v) {
+  const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+// Vectors per step of the sparse gemv, they share each load of the blocks.
+const int kSparseGemvBatch = 4;
+
+// See SparseGemv4x1 in sparse_gemm.cc
+template <int NB>
+void SparseGemv4x1(const int32_t *col_idx,
+                   const float *values,
+                   const index_t blocks,
+                   const float *v_ptr,
+                   const index_t width,
+                   const index_t sums_stride,
+                   float *sums) {
+  __m128 sum[NB];
+  for (int b = 0; b < NB; ++b) {
+    sum[b] = _mm_setzero_ps();
+  }
+  for (index_t i = 0; i < blocks; ++i) {
+    const __m128 m = _mm_loadu_ps(values + i * 4);
+    for (int b = 0; b < NB; ++b) {
+      sum[b] = _mm_fmadd_ps(m, _mm_set1_ps(v_ptr[b * width + col_idx[i]]),
+                            sum[b]);
+    }
+  }
+  for (int b = 0; b < NB; ++b) {
+    float sum_array[4];
+    _mm_storeu_ps(sum_array, sum[b]);
+    for (int r = 0; r < 4; ++r) {
+      sums[r * sums_stride + b] = sum_array[r];
+    }
+  }
+}
+
+// See SparseGemv1x4 in sparse_gemm.cc
+template <int NB>
+void SparseGemv1x4(const int32_t *col_idx,
+                   const float *values,
+                   const index_t blocks,
+                   const float *v_ptr,
+                   const index_t width,
+                   float *sums) {
+  __m128 sum[NB];
+  for (int b = 0; b < NB; ++b) {
+    sum[b] = _mm_setzero_ps();
+  }
+  for (index_t i = 0; i < blocks; ++i) {
+    const __m128 m = _mm_loadu_ps(values + i * 4);
+    for (int b = 0; b < NB; ++b) {
+      sum[b] = _mm_fmadd_ps(m, _mm_loadu_ps(v_ptr + b * width + col_idx[i]),
+                            sum[b]);
+    }
+  }
+  for (int b = 0; b < NB; ++b) {
+    sums[b] = HorizontalSum(sum[b]);
+  }
+}
+
+}  // namespace
+
+void SparseGemmBlockRowAvx2(const int32_t *col_idx,
+                            const float *values,
+                            const index_t blocks,
+                            const int block_rows,
+                            const int block_cols,
+                            const float *B,
+                            const index_t width,
+                            float *C) {
+  if (block_rows == 4 && block_cols == 1) {
+    SparseGemmRows<4, 1, 2>(col_idx, values, blocks, B, width, C);
+  } else if (block_rows == 1 && block_cols == 4) {
+    SparseGemmRows<1, 4, 4>(col_idx, values, blocks, B, width, C);
+  } else if (block_rows == 1 && block_cols == 1) {
+    SparseGemmRows<1, 1, 4>(col_idx, values, blocks, B, width, C);
+  } else {
+    SparseGemmRowsGeneral(col_idx, values, blocks, block_rows, block_cols, B,
+                          width, C);
+  }
+}
+
+void SparseGemvBlockRowAvx2(const int32_t *col_idx,
+                            const float *values,
+                            const index_t blocks,
+                            const int block_rows,
+                            const int block_cols,
+                            const float *v_ptr,
+                            const index_t batch,
+                            const index_t width,
+                            const index_t sums_stride,
+                            float *sums) {
+  const int kB = kSparseGemvBatch;
+  if (block_rows == 4 && block_cols == 1) {
+    index_t b = 0;
+    for (; b + kB <= batch; b += kB) {
+      SparseGemv4x1<kB>(col_idx, values, blocks, v_ptr + b * width, width,
+                        sums_stride, sums + b);
+    }
+    for (; b < batch; ++b) {
+      SparseGemv4x1<1>(col_idx, values, blocks, v_ptr + b * width, width,
+                       sums_stride, sums + b);
+    }
+  } else if (block_rows == 1 && block_cols == 4) {
+    index_t b = 0;
+    for (; b + kB <= batch; b += kB) {
+      SparseGemv1x4<kB>(col_idx, values, blocks, v_ptr + b * width, width,
+                        sums + b);
+    }
+    for (; b < batch; ++b) {
+      SparseGemv1x4<1>(col_idx, values, blocks, v_ptr + b * width, width,
+                       sums + b);
+    }
+  } else {
+    for (index_t b = 0; b < batch; ++b) {
+      const float *vec = v_ptr + b * width;
+      for (int r = 0; r < block_rows; ++r) {
+        float sum = 0.f;
+        for (index_t i = 0; i < blocks; ++i) {
+          const float *m_ptr = values + (i * block_rows + r) * block_cols;
+          for (int c = 0; c < block_cols; ++c) {
+            sum += m_ptr[c] * vec[col_idx[i] + c];
+          }
+        }
+        sums[r * sums_stride + b] = sum;
+      }
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
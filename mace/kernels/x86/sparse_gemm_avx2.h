@@ -0,0 +1,53 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_KERNELS_X86_SPARSE_GEMM_AVX2_H_
+#define MACE_KERNELS_X86_SPARSE_GEMM_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// C[block_rows, width] = the block row of a block sparse A with the given
+// blocks (see BlockSparseMatrix) x B[K, width]. The inner step of
+// SparseGemm (see sparse_gemm.cc), only call it when
+// GetCPUISA() >= CPU_ISA_AVX2.
+void SparseGemmBlockRowAvx2(const int32_t *col_idx,
+                            const float *values,
+                            const index_t blocks,
+                            const int block_rows,
+                            const int block_cols,
+                            const float *B,
+                            const index_t width,
+                            float *C);
+
+// sums[r * sums_stride + b] = the row r of the block row of a block sparse m
+// with the given blocks dot v[b, width], for b in [0, batch). The inner step
+// of SparseBatchedGemv, only call it when GetCPUISA() >= CPU_ISA_AVX2.
+void SparseGemvBlockRowAvx2(const int32_t *col_idx,
+                            const float *values,
+                            const index_t blocks,
+                            const int block_rows,
+                            const int block_cols,
+                            const float *v_ptr,
+                            const index_t batch,
+                            const index_t width,
+                            const index_t sums_stride,
+                            float *sums);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_SPARSE_GEMM_AVX2_H_
@@ -0,0 +1,58 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <immintrin.h>
+#include <algorithm>
+#include <limits>
+
+#include "mace/kernels/x86/top_k_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+void BlockMaxAvx2(const float *input,
+                  const index_t size,
+                  const index_t block_size,
+                  float *block_max) {
+  const float lowest = -std::numeric_limits<float>::infinity();
+  for (index_t begin = 0; begin < size; begin += block_size) {
+    const float *block = input + begin;
+    const index_t count = std::min(block_size, size - begin);
+    float result = lowest;
+    index_t j = 0;
+    if (count >= 16) {
+      // _mm256_max_ps returns its second operand if either is NaN
+      __m256 acc0 = _mm256_set1_ps(lowest);
+      __m256 acc1 = acc0;
+      for (; j + 15 < count; j += 16) {
+        acc0 = _mm256_max_ps(_mm256_loadu_ps(block + j), acc0);
+        acc1 = _mm256_max_ps(_mm256_loadu_ps(block + j + 8), acc1);
+      }
+      __m256 acc = _mm256_max_ps(acc0, acc1);
+      __m128 half = _mm_max_ps(_mm256_castps256_ps128(acc),
+                               _mm256_extractf128_ps(acc, 1));
+      half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+      half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+      result = _mm_cvtss_f32(half);
+    }
+    for (; j < count; ++j) {
+      result = std::max(result, block[j]);
+    }
+    block_max[begin / block_size] = result;
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
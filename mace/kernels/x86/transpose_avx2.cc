@@ -0,0 +1,131 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <immintrin.h>
+
+#include "mace/kernels/x86/transpose_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+inline void Transpose8x8(const float *src,
+                         const index_t src_stride,
+                         const index_t dst_stride,
+                         float *dst) {
+  __m256 r0 = _mm256_loadu_ps(src);
+  __m256 r1 = _mm256_loadu_ps(src + src_stride);
+  __m256 r2 = _mm256_loadu_ps(src + 2 * src_stride);
+  __m256 r3 = _mm256_loadu_ps(src + 3 * src_stride);
+  __m256 r4 = _mm256_loadu_ps(src + 4 * src_stride);
+  __m256 r5 = _mm256_loadu_ps(src + 5 * src_stride);
+  __m256 r6 = _mm256_loadu_ps(src + 6 * src_stride);
+  __m256 r7 = _mm256_loadu_ps(src + 7 * src_stride);
+
+  __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+  __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+  __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+  __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+  __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+  __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+  r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  r4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  r5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  r6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  r7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+  _mm256_storeu_ps(dst, _mm256_permute2f128_ps(r0, r4, 0x20));
+  _mm256_storeu_ps(dst + dst_stride, _mm256_permute2f128_ps(r1, r5, 0x20));
+  _mm256_storeu_ps(dst + 2 * dst_stride,
+                   _mm256_permute2f128_ps(r2, r6, 0x20));
+  _mm256_storeu_ps(dst + 3 * dst_stride,
+                   _mm256_permute2f128_ps(r3, r7, 0x20));
+  _mm256_storeu_ps(dst + 4 * dst_stride,
+                   _mm256_permute2f128_ps(r0, r4, 0x31));
+  _mm256_storeu_ps(dst + 5 * dst_stride,
+                   _mm256_permute2f128_ps(r1, r5, 0x31));
+  _mm256_storeu_ps(dst + 6 * dst_stride,
+                   _mm256_permute2f128_ps(r2, r6, 0x31));
+  _mm256_storeu_ps(dst + 7 * dst_stride,
+                   _mm256_permute2f128_ps(r3, r7, 0x31));
+}
+
+}  // namespace
+
+void TransposeBlockAvx2(const float *src,
+                        const index_t src_stride,
+                        const index_t rows,
+                        const index_t cols,
+                        const index_t dst_stride,
+                        float *dst) {
+  if (rows == 2 && dst_stride == 2) {
+    // interleave two planes, e.g. NCHW -> NHWC with C = 2
+    index_t c = 0;
+    for (; c + 7 < cols; c += 8) {
+      __m256 v0 = _mm256_loadu_ps(src + c);
+      __m256 v1 = _mm256_loadu_ps(src + src_stride + c);
+      __m256 lo = _mm256_unpacklo_ps(v0, v1);
+      __m256 hi = _mm256_unpackhi_ps(v0, v1);
+      _mm256_storeu_ps(dst + c * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+      _mm256_storeu_ps(dst + c * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    for (; c < cols; ++c) {
+      dst[c * 2] = src[c];
+      dst[c * 2 + 1] = src[src_stride + c];
+    }
+    return;
+  }
+  if (cols == 3 && src_stride == 3) {
+    // split three interleaved planes, e.g. NHWC -> NCHW with C = 3
+    float *dst0 = dst;
+    float *dst1 = dst + dst_stride;
+    float *dst2 = dst + 2 * dst_stride;
+    for (index_t r = 0; r < rows; ++r) {
+      dst0[r] = src[r * 3];
+      dst1[r] = src[r * 3 + 1];
+      dst2[r] = src[r * 3 + 2];
+    }
+    return;
+  }
+
+  const index_t rows8 = rows & ~7;
+  const index_t cols8 = cols & ~7;
+  for (index_t r = 0; r < rows8; r += 8) {
+    for (index_t c = 0; c < cols8; c += 8) {
+      Transpose8x8(src + r * src_stride + c, src_stride, dst_stride,
+                   dst + c * dst_stride + r);
+    }
+  }
+  for (index_t c = cols8; c < cols; ++c) {
+    for (index_t r = 0; r < rows; ++r) {
+      dst[c * dst_stride + r] = src[r * src_stride + c];
+    }
+  }
+  for (index_t c = 0; c < cols8; ++c) {
+    for (index_t r = rows8; r < rows; ++r) {
+      dst[c * dst_stride + r] = src[r * src_stride + c];
+    }
+  }
+}
+
+}  // namespace kernels
+}  // namespace mace
@@ -0,0 +1,37 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_KERNELS_X86_TRANSPOSE_AVX2_H_
+#define MACE_KERNELS_X86_TRANSPOSE_AVX2_H_
+
+#include "mace/core/types.h"
+
+namespace mace {
+namespace kernels {
+
+// dst[c * dst_stride + r] = src[r * src_stride + c] for r < rows and
+// c < cols, the 2D tile step of Transpose. Full 8x8 blocks are transposed
+// in registers, only call it when GetCPUISA() >= CPU_ISA_AVX2.
+void TransposeBlockAvx2(const float *src,
+                        const index_t src_stride,
+                        const index_t rows,
+                        const index_t cols,
+                        const index_t dst_stride,
+                        float *dst);
+
+}  // namespace kernels
+}  // namespace mace
+
+#endif  // MACE_KERNELS_X86_TRANSPOSE_AVX2_H_
@@ -0,0 +1,196 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+#include <algorithm>
+
+#include "mace/kernels/x86/vector_math_avx2.h"
+
+namespace mace {
+namespace kernels {
+
+namespace {
+
+// The polynomials are the ones of Cephes expf, logf and tanhf.
+
+inline __m256 Exp8(__m256 x) {
+  const __m256 max_input = _mm256_set1_ps(88.7228394f);   // ln(FLT_MAX)
+  const __m256 min_input = _mm256_set1_ps(-87.3365479f);  // ln(FLT_MIN)
+  const __m256 overflow = _mm256_cmp_ps(x, max_input, _CMP_GT_OQ);
+  const __m256 underflow = _mm256_cmp_ps(x, min_input, _CMP_LT_OQ);
+  // x as the second operand keeps NaN
+  x = _mm256_min_ps(max_input, _mm256_max_ps(min_input, x));
+
+  // x = n * ln2 + r, |r| <= ln2 / 2
+  const __m256 n = _mm256_round_ps(
+      _mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+  r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+
+  __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r),
+                      _mm256_add_ps(r, _mm256_set1_ps(1.f)));
+
+  // 2^n in two halves as n may be 128
+  const __m256i ni = _mm256_cvtps_epi32(n);
+  const __m256i n1 = _mm256_srai_epi32(ni, 1);
+  const __m256i n2 = _mm256_sub_epi32(ni, n1);
+  const __m256i bias = _mm256_set1_epi32(127);
+  p = _mm256_mul_ps(p, _mm256_castsi256_ps(
+      _mm256_slli_epi32(_mm256_add_epi32(n1, bias), 23)));
+  p = _mm256_mul_ps(p, _mm256_castsi256_ps(
+      _mm256_slli_epi32(_mm256_add_epi32(n2, bias), 23)));
+
+  p = _mm256_blendv_ps(p, _mm256_set1_ps(INFINITY), overflow);
+  return _mm256_andnot_ps(underflow, p);
+}
+
+inline __m256 Log8(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  // x < 0 or NaN
+  const __m256 invalid =
+      _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_NGE_UQ);
+  const __m256 zero = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ);
+  const __m256 infinity =
+      _mm256_cmp_ps(x, _mm256_set1_ps(INFINITY), _CMP_EQ_OQ);
+  // denormals are taken as FLT_MIN
+  const __m256 v = _mm256_max_ps(x, _mm256_set1_ps(1.17549435e-38f));
+
+  // x = m * 2^e, sqrt(1/2) <= m < sqrt(2)
+  const __m256i vi = _mm256_castps_si256(v);
+  __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(
+      _mm256_srli_epi32(vi, 23), _mm256_set1_epi32(126)));
+  __m256 m = _mm256_or_ps(
+      _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x807fffff))),
+      _mm256_set1_ps(0.5f));
+  const __m256 small =
+      _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+  e = _mm256_sub_ps(e, _mm256_and_ps(small, one));
+  m = _mm256_add_ps(_mm256_sub_ps(m, one), _mm256_and_ps(small, m));
+
+  const __m256 z = _mm256_mul_ps(m, m);
+  __m256 p = _mm256_set1_ps(7.0376836292e-2f);
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.1514610310e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.1676998740e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.2420140846e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(1.4249322787e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-1.6668057665e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(2.0000714765e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(-2.4999993993e-1f));
+  p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(3.3333331174e-1f));
+  __m256 y = _mm256_mul_ps(_mm256_mul_ps(p, m), z);
+  y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+  y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+  y = _mm256_add_ps(m, y);
+  y = _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), y);
+
+  y = _mm256_blendv_ps(y, _mm256_set1_ps(-INFINITY), zero);
+  y = _mm256_blendv_ps(y, x, infinity);
+  return _mm256_blendv_ps(y, _mm256_set1_ps(NAN), invalid);
+}
+
+inline __m256 Tanh8(__m256 x) {
+  const __m256 sign_mask = _mm256_set1_ps(-0.f);
+  const __m256 abs_x = _mm256_andnot_ps(sign_mask, x);
+
+  // |x| < 0.625: x + x^3 * P(x^2)
+  const __m256 z = _mm256_mul_ps(x, x);
+  __m256 p = _mm256_set1_ps(-5.70498872745e-3f);
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(2.06390887954e-2f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-5.37397155531e-2f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(1.33314422036e-1f));
+  p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(-3.33332819422e-1f));
+  const __m256 small_y = _mm256_fmadd_ps(_mm256_mul_ps(p, z), x, x);
+
+  // otherwise: 1 - 2 / (exp(2|x|) + 1)
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 e = Exp8(_mm256_add_ps(abs_x, abs_x));
+  __m256 y = _mm256_sub_ps(
+      one, _mm256_div_ps(_mm256_set1_ps(2.f), _mm256_add_ps(e, one)));
+  y = _mm256_or_ps(y, _mm256_and_ps(sign_mask, x));
+
+  const __m256 small =
+      _mm256_cmp_ps(abs_x, _mm256_set1_ps(0.625f), _CMP_LT_OQ);
+  return _mm256_blendv_ps(y, small_y, small);
+}
+
+inline __m256 Sigmoid8(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 e = Exp8(_mm256_sub_ps(_mm256_setzero_ps(), x));
+  return _mm256_div_ps(one, _mm256_add_ps(one, e));
+}
+
+inline __m256 Rsqrt8(__m256 x) {
+  return _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(x));
+}
+
+// Run func 8 at a time, the tail goes through a padded copy so that every
+// element is computed the same way.
+template <typename Func>
+inline void Map8(const float *input,
+                 const index_t size,
+                 float *output,
+                 Func func) {
+  index_t i = 0;
+  for (; i + 7 < size; i += 8) {
+    _mm256_storeu_ps(output + i, func(_mm256_loadu_ps(input + i)));
+  }
+  if (i < size) {
+    float buffer[8] = {0};
+    std::copy(input + i, input + size, buffer);
+    _mm256_storeu_ps(buffer, func(_mm256_loadu_ps(buffer)));
+    std::copy(buffer, buffer + (size - i), output + i);
+  }
+}
+
+}  // namespace
+
+void VectorExpAvx2(const float *input, const index_t size, float *output) {
+  Map8(input, size, output, Exp8);
+}
+
+void VectorLogAvx2(const float *input, const index_t size, float *output) {
+  Map8(input, size, output, Log8);
+}
+
+void VectorTanhAvx2(const float *input, const index_t size, float *output) {
+  Map8(input, size, output, Tanh8);
+}
+
+void VectorSigmoidAvx2(const float *input, const index_t size, float *output) {
+  Map8(input, size, output, Sigmoid8);
+}
+
+void VectorPowAvx2(const float *input,
+                   const float exponent,
+                   const index_t size,
+                   float *output) {
+  const __m256 vexponent = _mm256_set1_ps(exponent);
+  Map8(input, size, output, [vexponent](__m256 x) {
+    return Exp8(_mm256_mul_ps(vexponent, Log8(x)));
+  });
+}
+
+void VectorRsqrtAvx2(const float *input, const index_t size, float *output) {
+  Map8(input, size, output, Rsqrt8);
+}
+
+}  // namespace kernels
+}  // namespace mace
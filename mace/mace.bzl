@@ -24,6 +24,12 @@ def if_android_arm64(a):
       "//conditions:default": [],
   })
 
+def if_x86(a):
+  return select({
+      "//mace:x86_64": a,
+      "//conditions:default": [],
+  })
+
 def if_neon_enabled(a):
   return select({
       "//mace:neon_enabled": a,
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <random>
+#include <vector>
+
 #include "mace/core/operator.h"
 #include "mace/ops/ops_test_util.h"
 
@@ -63,6 +66,21 @@ TEST_F(ArgMaxOpTest, HighRank) {
                   {1, 2, 2}, {2, 2, 2, 2});
 }
 
+TEST_F(ArgMaxOpTest, LargeRows) {
+  // several blocks of the block maxima, the first maximum wins
+  const index_t rows = 3;
+  const index_t row_size = 20003;
+  std::mt19937 gen(row_size);
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+  std::vector<float> input(rows * row_size);
+  for (float &value : input) value = dist(gen) * 0.25f;
+  input[70] = input[9000] = 300.f;
+  input[row_size + row_size - 1] = 300.f;
+  input[2 * row_size + 65] = input[2 * row_size + 64] = 300.f;
+  ArgMaxTest<CPU>({rows, row_size}, input, {rows},
+                  {70, static_cast<int32_t>(row_size - 1), 64});
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -12,8 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "mace/ops/concat.h"
@@ -154,6 +157,71 @@ TEST_F(ConcatOpTest, CPURandom) {
   }
 }
 
+TEST_F(ConcatOpTest, CPUZeroCopy) {
+  // the memory optimizer placed both relu outputs in the concat output,
+  // at element offsets 0 and 24
+  const std::vector<std::vector<index_t>> shapes = {{1, 2, 3, 4},
+                                                    {1, 3, 3, 4}};
+  const std::vector<int> mem_offsets = {0, 24};
+  NetDef net_def;
+  for (int i = 0; i < 2; ++i) {
+    OperatorDef *op_def = net_def.add_op();
+    OpDefBuilder("Activation", MakeString("Relu", i))
+        .Input(MakeString("Input", i))
+        .Output(MakeString("Relu", i))
+        .AddStringArg("activation", "RELU")
+        .AddIntArg("mem_offset", mem_offsets[i])
+        .Finalize(op_def);
+    op_def->add_mem_id(0);
+    OutputShape *output_shape = op_def->add_output_shape();
+    for (const index_t dim : shapes[i]) {
+      output_shape->add_dims(dim);
+    }
+  }
+  OperatorDef *concat_def = net_def.add_op();
+  OpDefBuilder("Concat", "Concat")
+      .Input("Relu0")
+      .Input("Relu1")
+      .Output("Output")
+      .AddIntArg("axis", 1)
+      .Finalize(concat_def);
+  concat_def->add_mem_id(0);
+  MemoryBlock *mem_block = net_def.mutable_mem_arena()->add_mem_block();
+  mem_block->set_mem_id(0);
+  mem_block->set_x(60);
+  mem_block->set_y(1);
+
+  Workspace ws;
+  ASSERT_EQ(MaceStatus::MACE_SUCCESS,
+            ws.LoadModelTensor(net_def, DeviceType::CPU, nullptr));
+  std::vector<float> expected;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<float> input;
+    GenerateRandomRealTypeData(shapes[i], &input);
+    Tensor *tensor = ws.CreateTensor(MakeString("Input", i),
+                                     GetDeviceAllocator(DeviceType::CPU),
+                                     DT_FLOAT);
+    tensor->Resize(shapes[i]);
+    std::copy(input.begin(), input.end(), tensor->mutable_data<float>());
+    for (const float v : input) {
+      expected.push_back(std::max(v, 0.f));
+    }
+  }
+
+  std::shared_ptr<OperatorRegistry> op_registry(new OperatorRegistry());
+  auto net = CreateNet(op_registry, net_def, &ws, DeviceType::CPU);
+  ASSERT_EQ(MaceStatus::MACE_SUCCESS, net->Run());
+
+  const Tensor *output = ws.GetTensor("Output");
+  EXPECT_THAT(output->shape(),
+              ::testing::ContainerEq(std::vector<index_t>({1, 5, 3, 4})));
+  EXPECT_EQ(output->data<float>(), ws.GetTensor("Relu0")->data<float>());
+  EXPECT_EQ(output->data<float>() + 24, ws.GetTensor("Relu1")->data<float>());
+  for (index_t i = 0; i < output->size(); ++i) {
+    EXPECT_EQ(expected[i], output->data<float>()[i]);
+  }
+}
+
 namespace {
 template <typename T>
 void OpenclRandomTest(const std::vector<std::vector<index_t>> &shapes,
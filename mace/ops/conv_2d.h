@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mace/core/operator.h"
 #include "mace/kernels/conv_2d.h"
@@ -40,24 +41,53 @@ class Conv2dOp : public ConvPool2dOpBase<D, T> {
                  OperatorBase::GetOptionalArg<float>("max_limit", 0.0f),
                  static_cast<bool>(OperatorBase::GetOptionalArg<int>(
                      "is_filter_transformed", false)),
-                 ws->GetScratchBuffer(D)) {}
+                 ws->GetScratchBuffer(D)),
+        sparse_filter_shape_(OperatorBase::GetRepeatedArgs<index_t>(
+            "sparse_weight_shape")) {}
 
   MaceStatus Run(StatsFuture *future) override {
     const Tensor *input = this->Input(INPUT);
     const Tensor *filter = this->Input(FILTER);
     const Tensor *bias = this->InputSize() >= 3 ? this->Input(BIAS) : nullptr;
+    // A sparse filter has its row_ptr and col_idx as the last two inputs.
+    const int sparse_inputs = sparse_filter_shape_.empty() ? 0 : 2;
+    const Tensor *residual = this->InputSize() >= 4 + sparse_inputs
+                             ? this->Input(RESIDUAL) : nullptr;
     Tensor *output = this->Output(OUTPUT);
-    return functor_(input, filter, bias, output, future);
+    return functor_(input, filter, bias, residual, output, future);
   }
 
+  MaceStatus Init() override { return MaceStatus::MACE_SUCCESS; }
+
  private:
   kernels::Conv2dFunctor<D, T> functor_;
+  std::vector<index_t> sparse_filter_shape_;
 
  protected:
-  MACE_OP_INPUT_TAGS(INPUT, FILTER, BIAS);
+  MACE_OP_INPUT_TAGS(INPUT, FILTER, BIAS, RESIDUAL);
   MACE_OP_OUTPUT_TAGS(OUTPUT);
 };
 
+template <>
+inline MaceStatus Conv2dOp<DeviceType::CPU, float>::Init() {
+  const Tensor *filter = this->Input(FILTER);
+  if (!sparse_filter_shape_.empty()) {
+    MACE_CHECK(this->InputSize() >= 5, "sparse filter needs bias, row_ptr "
+               "and col_idx inputs");
+    functor_.SetSparseFilter(sparse_filter_shape_,
+                             this->Input(this->InputSize() - 2),
+                             this->Input(this->InputSize() - 1));
+    return MaceStatus::MACE_SUCCESS;
+  }
+  const int block = kernels::NCHWcBlockSize(static_cast<DataFormat>(
+      OperatorBase::GetOptionalArg<int>("data_format", NCHW)));
+  if (block == 0 || !filter->is_weight()) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+  return functor_.PackFilterNCHWc(filter, block,
+                                  this->InPlacePackableWeight(FILTER));
+}
+
 }  // namespace ops
 }  // namespace mace
 
@@ -13,9 +13,12 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <random>
+#include <vector>
 
 #include "mace/core/operator.h"
 #include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/sparse_gemm.h"
 #include "mace/ops/conv_2d.h"
 #include "mace/ops/ops_test_util.h"
 
@@ -99,6 +102,129 @@ void Conv2d(int iters,
     net.Sync();
   }
 }
+
+// CPU conv on the blocked NCHW4C/NCHW8C layout with the filter packed at
+// init, to compare with the NCHW one above.
+void Conv2dNCHWc(int iters,
+                 int batch,
+                 int channels,
+                 int height,
+                 int width,
+                 int kernel_h,
+                 int kernel_w,
+                 int stride,
+                 Padding padding,
+                 int output_channels,
+                 DataFormat data_format) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, channels, height, width});
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Filter", {output_channels, channels, kernel_h, kernel_w});
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {output_channels});
+  net.GetTensor("Filter")->SetIsWeight(true);
+
+  OpDefBuilder("TransformDataFormat", "ToNCHWc")
+      .Input("Input")
+      .Output("InputNCHWc")
+      .AddIntArg("data_format", data_format)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("InputNCHWc")
+      .Input("Filter")
+      .Input("Bias")
+      .Output("Output")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", padding)
+      .AddIntsArg("dilations", {1, 1})
+      .AddIntArg("data_format", data_format)
+      .Finalize(net.NewOperatorDef());
+  net.Setup(DeviceType::CPU);
+
+  // Warm-up
+  for (int i = 0; i < 2; ++i) {
+    net.Run();
+  }
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+}
+
+// CPU 1x1 conv with a filter of which `sparsity` percent of the blocks are
+// zero, stored as block-CSR.
+void SparseConv1x1(int iters,
+                   int batch,
+                   int channels,
+                   int height,
+                   int width,
+                   int output_channels,
+                   int block_rows,
+                   int block_cols,
+                   int sparsity) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  std::vector<float> filter(output_channels * channels);
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> ud(0, 99);
+  for (int r = 0; r < output_channels; r += block_rows) {
+    for (int c = 0; c < channels; c += block_cols) {
+      const float value = ud(gen) < sparsity ? 0.f : 1.f;
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          filter[(r + i) * channels + c + j] = value;
+        }
+      }
+    }
+  }
+  std::vector<int32_t> row_ptr;
+  std::vector<int32_t> col_idx;
+  std::vector<float> values;
+  kernels::BlockSparseEncode(filter.data(), output_channels, channels,
+                             block_rows, block_cols, &row_ptr, &col_idx,
+                             &values);
+
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, channels, height, width});
+  net.AddInputFromArray<DeviceType::CPU, float>(
+      "Filter",
+      {static_cast<index_t>(col_idx.size()), block_rows, block_cols}, values);
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {output_channels});
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "RowPtr", {static_cast<index_t>(row_ptr.size())}, row_ptr);
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "ColIdx", {static_cast<index_t>(col_idx.size())}, col_idx);
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Input("RowPtr")
+      .Input("ColIdx")
+      .Output("Output")
+      .AddIntsArg("strides", {1, 1})
+      .AddIntArg("padding", VALID)
+      .AddIntsArg("dilations", {1, 1})
+      .AddIntsArg("sparse_weight_shape", {output_channels, channels, 1, 1})
+      .Finalize(net.NewOperatorDef());
+  net.Setup(DeviceType::CPU);
+
+  // Warm-up
+  for (int i = 0; i < 2; ++i) {
+    net.Run();
+  }
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+}
 }  // namespace
 
 // In common network, there are usually more than 1 layers, this is used to
@@ -138,6 +264,29 @@ void Conv2d(int iters,
   MACE_BM_CONV_2D_MACRO(N, C, H, W, KH, KW, S, D, P, OC, half, GPU);
 
 
+#define MACE_BM_CONV_2D_NCHWC_MACRO(N, C, H, W, KH, KW, STRIDE, P, OC, FORMAT) \
+  static void                                                                 \
+      MACE_BM_CONV_2D_##N##_##C##_##H##_##W##_K##KH##x##KW##S##STRIDE##_##P##\
+        _##OC##_##FORMAT(int iters) {                                        \
+    const int64_t tot = static_cast<int64_t>(iters) * N * C * H * W;          \
+    const int64_t oh = P == SAME ? (H - 1) / STRIDE + 1                       \
+                                 : (H - KH) / STRIDE + 1;                     \
+    const int64_t ow = P == SAME ? (W - 1) / STRIDE + 1                       \
+                                 : (W - KW) / STRIDE + 1;                     \
+    const int64_t macc =                                                      \
+        static_cast<int64_t>(iters) * N * OC * oh * ow * (KH * KW * C + 1);   \
+    mace::testing::MaccProcessed(macc);                                       \
+    mace::testing::BytesProcessed(tot * sizeof(float));                       \
+    Conv2dNCHWc(iters, N, C, H, W, KH, KW, STRIDE, mace::Padding::P, OC,      \
+                FORMAT);                                                      \
+  }                                                                           \
+  MACE_BENCHMARK(                                                             \
+      MACE_BM_CONV_2D_##N##_##C##_##H##_##W##_K##KH##x##KW##S##STRIDE##_##P##\
+        _##OC##_##FORMAT)
+
+#define MACE_BM_CONV_2D_NCHWC(N, C, H, W, KH, KW, S, P, OC)               \
+  MACE_BM_CONV_2D_NCHWC_MACRO(N, C, H, W, KH, KW, S, P, OC, NCHW4C);     \
+  MACE_BM_CONV_2D_NCHWC_MACRO(N, C, H, W, KH, KW, S, P, OC, NCHW8C);
 
 // Filter sizes and data alignments
 MACE_BM_CONV_2D(1, 64, 32, 32, 1, 1, 1, 1, VALID, 128);
@@ -160,6 +309,16 @@ MACE_BM_CONV_2D(1, 3, 224, 224, 3, 3, 2, 1, VALID, 32);
 // Dilations
 MACE_BM_CONV_2D(1, 32, 256, 256, 3, 3, 1, 2, VALID, 32);
 MACE_BM_CONV_2D(1, 32, 256, 256, 3, 3, 1, 4, VALID, 32);
+MACE_BM_CONV_2D(1, 256, 33, 33, 3, 3, 1, 6, SAME, 256);
+MACE_BM_CONV_2D(1, 128, 65, 65, 3, 3, 1, 2, SAME, 128);
+MACE_BM_CONV_2D(1, 256, 65, 65, 3, 3, 1, 12, SAME, 256);
+
+// General (im2col) path
+MACE_BM_CONV_2D(1, 64, 64, 64, 5, 5, 2, 1, SAME, 128);
+MACE_BM_CONV_2D(1, 128, 32, 32, 2, 2, 2, 1, VALID, 256);
+MACE_BM_CONV_2D(1, 16, 128, 128, 3, 3, 3, 1, SAME, 32);
+MACE_BM_CONV_2D(1, 8, 64, 64, 2, 2, 1, 1, VALID, 8);
+MACE_BM_CONV_2D(1, 4, 64, 64, 2, 2, 1, 1, VALID, 4);
 
 // MobileNet
 MACE_BM_CONV_2D(1, 128, 56, 56, 1, 1, 1, 1, SAME, 128);
@@ -180,6 +339,34 @@ MACE_BM_CONV_2D(1, 3, 128, 128, 3, 3, 1, 1, SAME, 16);
 MACE_BM_CONV_2D(1, 3, 256, 256, 3, 3, 1, 1, SAME, 16);
 MACE_BM_CONV_2D(1, 3, 64, 64, 3, 3, 1, 1, SAME, 16);
 
+// Blocked layout
+MACE_BM_CONV_2D_NCHWC(1, 64, 32, 32, 1, 1, 1, VALID, 128);
+MACE_BM_CONV_2D_NCHWC(1, 64, 32, 32, 3, 3, 1, SAME, 128);
+MACE_BM_CONV_2D_NCHWC(1, 64, 64, 64, 5, 5, 2, SAME, 128);
+MACE_BM_CONV_2D_NCHWC(1, 128, 56, 56, 1, 1, 1, SAME, 128);
+MACE_BM_CONV_2D_NCHWC(1, 1024, 7, 7, 1, 1, 1, SAME, 1024);
+MACE_BM_CONV_2D_NCHWC(1, 32, 34, 34, 3, 3, 1, VALID, 32);
+
+// The MACCs are those of the dense conv, so that the rates compare with the
+// dense 1x1 ones above.
+#define MACE_BM_SPARSE_CONV_2D_1X1(N, C, H, W, OC, BR, BC, SPARSITY)          \
+  static void                                                                 \
+      MACE_BM_SPARSE_CONV_2D_##N##_##C##_##H##_##W##_K1x1_##OC##_##BR##x##BC\
+        ##_##SPARSITY(int iters) {                                            \
+    const int64_t macc = static_cast<int64_t>(iters) * N * OC * H * W * C;    \
+    mace::testing::MaccProcessed(macc);                                       \
+    SparseConv1x1(iters, N, C, H, W, OC, BR, BC, SPARSITY);                   \
+  }                                                                           \
+  MACE_BENCHMARK(                                                             \
+      MACE_BM_SPARSE_CONV_2D_##N##_##C##_##H##_##W##_K1x1_##OC##_##BR##x##BC\
+        ##_##SPARSITY)
+
+MACE_BM_CONV_2D(1, 128, 56, 56, 1, 1, 1, 1, VALID, 128);
+MACE_BM_SPARSE_CONV_2D_1X1(1, 128, 56, 56, 128, 4, 1, 70);
+MACE_BM_SPARSE_CONV_2D_1X1(1, 128, 56, 56, 128, 4, 1, 90);
+MACE_BM_SPARSE_CONV_2D_1X1(1, 128, 56, 56, 128, 1, 4, 90);
+MACE_BM_SPARSE_CONV_2D_1X1(1, 64, 32, 32, 128, 4, 1, 90);
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
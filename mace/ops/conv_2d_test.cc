@@ -13,8 +13,12 @@
 // limitations under the License.
 
 #include <fstream>
+#include <random>
+#include <string>
 #include <vector>
 
+#include "mace/kernels/eltwise.h"
+#include "mace/kernels/sparse_gemm.h"
 #include "mace/ops/conv_2d.h"
 #include "mace/ops/ops_test_util.h"
 
@@ -1069,6 +1073,450 @@ TEST_F(Conv2dOpTest, OPENCLUnalignedPad4) {
   TestArbitraryPadConvNxN<DeviceType::GPU, float>({107, 113, 5, 7}, {4, 4});
 }
 
+namespace {
+// Winograd reads zeros for the border tiles instead of padding the input
+// and tiles each phase of a dilated conv, check it against a direct
+// convolution.
+void TestWinogradPadding(const std::vector<index_t> &shape,
+                         const std::vector<int> &paddings,
+                         const int dilation = 1) {
+  const index_t batch = shape[0];
+  const index_t input_channels = shape[1];
+  const index_t output_channels = shape[2];
+  const index_t height = shape[3];
+  const index_t width = shape[4];
+  const index_t out_height = height + paddings[0] - 2 * dilation;
+  const index_t out_width = width + paddings[1] - 2 * dilation;
+  const index_t pad_top = paddings[0] / 2;
+  const index_t pad_left = paddings[1] / 2;
+
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, input_channels, height, width});
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Filter", {output_channels, input_channels, 3, 3});
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {output_channels});
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Output("Output")
+      .AddIntsArg("strides", {1, 1})
+      .AddIntsArg("padding_values", paddings)
+      .AddIntsArg("dilations", {dilation, dilation})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+
+  const float *input = net.GetOutput("Input")->data<float>();
+  const float *filter = net.GetOutput("Filter")->data<float>();
+  const float *bias = net.GetOutput("Bias")->data<float>();
+  std::vector<float> expected(
+      batch * output_channels * out_height * out_width);
+  for (index_t b = 0; b < batch; ++b) {
+    for (index_t m = 0; m < output_channels; ++m) {
+      for (index_t h = 0; h < out_height; ++h) {
+        for (index_t w = 0; w < out_width; ++w) {
+          float sum = bias[m];
+          for (index_t c = 0; c < input_channels; ++c) {
+            for (index_t kh = 0; kh < 3; ++kh) {
+              for (index_t kw = 0; kw < 3; ++kw) {
+                const index_t ih = h + kh * dilation - pad_top;
+                const index_t iw = w + kw * dilation - pad_left;
+                if (ih < 0 || ih >= height || iw < 0 || iw >= width) continue;
+                sum += input[((b * input_channels + c) * height + ih) * width
+                    + iw] * filter[((m * input_channels + c) * 3 + kh) * 3
+                    + kw];
+              }
+            }
+          }
+          expected[((b * output_channels + m) * out_height + h) * out_width
+              + w] = sum;
+        }
+      }
+    }
+  }
+  auto expected_tensor = CreateTensor<float>(
+      {batch, output_channels, out_height, out_width}, expected);
+  ExpectTensorNear<float>(*expected_tensor, *net.GetOutput("Output"), 1e-4,
+                          1e-4);
+}
+}  // namespace
+
+TEST_F(Conv2dOpTest, CPUWinogradPadding) {
+  // 2x2 output tiles below 16x16 inputs, 6x6 ones above
+  TestWinogradPadding({1, 8, 8, 9, 11}, {2, 2});
+  TestWinogradPadding({2, 16, 8, 7, 7}, {3, 1});
+  TestWinogradPadding({1, 8, 16, 31, 29}, {2, 2});
+  TestWinogradPadding({1, 8, 8, 20, 23}, {3, 4});
+  TestWinogradPadding({1, 8, 8, 19, 18}, {0, 0});
+}
+
+TEST_F(Conv2dOpTest, CPUWinogradDilation) {
+  // 6x6 tiles per phase, then 2x2 ones for phases smaller than a tile
+  TestWinogradPadding({1, 64, 64, 33, 33}, {12, 12}, 6);
+  TestWinogradPadding({1, 64, 72, 41, 39}, {4, 4}, 2);
+  TestWinogradPadding({2, 80, 64, 13, 17}, {0, 0}, 3);
+  TestWinogradPadding({1, 64, 64, 22, 19}, {7, 9}, 4);
+}
+
+namespace {
+// A dilated conv equals a plain conv with zeros inserted into the filter,
+// the latter goes through the specialized kernels while the former takes
+// the general path.
+void TestGeneralConvAsExpandedFilter(const std::vector<index_t> &shape,
+                                     const int kernel,
+                                     const int stride,
+                                     const int dilation,
+                                     Padding type) {
+  const index_t batch = shape[0];
+  const index_t input_channels = shape[1];
+  const index_t output_channels = shape[2];
+  const index_t expanded_kernel = (kernel - 1) * dilation + 1;
+
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, input_channels, shape[3], shape[4]});
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Filter", {output_channels, input_channels, kernel, kernel});
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {output_channels});
+
+  const float *filter_data = net.GetOutput("Filter")->data<float>();
+  std::vector<float> expanded_filter(
+      output_channels * input_channels * expanded_kernel * expanded_kernel, 0);
+  for (index_t i = 0; i < output_channels * input_channels; ++i) {
+    for (int h = 0; h < kernel; ++h) {
+      for (int w = 0; w < kernel; ++w) {
+        expanded_filter[(i * expanded_kernel + h * dilation) * expanded_kernel
+            + w * dilation] = filter_data[(i * kernel + h) * kernel + w];
+      }
+    }
+  }
+  net.AddInputFromArray<DeviceType::CPU, float>(
+      "ExpandedFilter",
+      {output_channels, input_channels, expanded_kernel, expanded_kernel},
+      expanded_filter);
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Output("Output")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", type)
+      .AddIntsArg("dilations", {dilation, dilation})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("ExpandedFilter")
+      .Input("Bias")
+      .Output("ExpectedOutput")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", type)
+      .AddIntsArg("dilations", {1, 1})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+
+  ExpectTensorNear<float>(*net.GetOutput("ExpectedOutput"),
+                          *net.GetOutput("Output"), 1e-4, 1e-4);
+}
+}  // namespace
+
+TEST_F(Conv2dOpTest, CPUGeneralConv) {
+  // 3x3 dilation 2 -> 5x5, 3x3 dilation 3 -> 7x7, 2x2 dilation 6 -> 7x7
+  for (Padding type : {VALID, SAME}) {
+    TestGeneralConvAsExpandedFilter({1, 16, 32, 29, 31}, 3, 1, 2, type);
+    TestGeneralConvAsExpandedFilter({2, 5, 7, 17, 13}, 3, 1, 3, type);
+    TestGeneralConvAsExpandedFilter({1, 8, 9, 23, 23}, 2, 1, 6, type);
+  }
+  // larger than one im2col tile
+  TestGeneralConvAsExpandedFilter({1, 64, 16, 70, 70}, 3, 1, 2, SAME);
+}
+
+namespace {
+// Conv2D with a residual input and fused activation versus separate
+// Conv2D, Eltwise SUM and Activation ops.
+void TestFusedResidualConv(const std::vector<index_t> &shape,
+                           const int kernel,
+                           const int stride,
+                           const int dilation,
+                           const char *activation) {
+  const index_t batch = shape[0];
+  const index_t input_channels = shape[1];
+  const index_t output_channels = shape[2];
+
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, input_channels, shape[3], shape[4]});
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Filter", {output_channels, input_channels, kernel, kernel});
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {output_channels});
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Output("ConvOutput")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", Padding::SAME)
+      .AddIntsArg("dilations", {dilation, dilation})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Residual", net.GetOutput("ConvOutput")->shape());
+
+  OpDefBuilder("Eltwise", "EltwiseTest")
+      .Input("ConvOutput")
+      .Input("Residual")
+      .Output("SumOutput")
+      .AddIntArg("type", static_cast<int>(kernels::EltwiseType::SUM))
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  std::string expected_output = "SumOutput";
+  if (std::string(activation) != "NOOP") {
+    OpDefBuilder("Activation", "ActivationTest")
+        .Input("SumOutput")
+        .Output("ActivationOutput")
+        .AddStringArg("activation", activation)
+        .AddFloatArg("max_limit", 0.5f)
+        .Finalize(net.NewOperatorDef());
+    net.RunOp();
+    expected_output = "ActivationOutput";
+  }
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Input("Residual")
+      .Output("Output")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", Padding::SAME)
+      .AddIntsArg("dilations", {dilation, dilation})
+      .AddStringArg("activation", activation)
+      .AddFloatArg("max_limit", 0.5f)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+
+  ExpectTensorNear<float>(*net.GetOutput(expected_output.c_str()),
+                          *net.GetOutput("Output"), 1e-4, 1e-4);
+}
+}  // namespace
+
+TEST_F(Conv2dOpTest, CPUFusedResidual) {
+  for (const char *activation : {"NOOP", "RELU", "RELUX", "TANH",
+                                 "SIGMOID"}) {
+    // winograd
+    TestFusedResidualConv({1, 16, 16, 19, 21}, 3, 1, 1, activation);
+    // direct kernels with and without padded output
+    TestFusedResidualConv({2, 3, 5, 13, 15}, 3, 1, 1, activation);
+    TestFusedResidualConv({1, 3, 9, 16, 16}, 3, 2, 1, activation);
+    TestFusedResidualConv({1, 5, 4, 23, 17}, 7, 3, 1, activation);
+    // Gemm
+    TestFusedResidualConv({2, 8, 70, 11, 13}, 1, 1, 1, activation);
+    TestFusedResidualConv({1, 6, 9, 15, 14}, 3, 1, 2, activation);
+  }
+}
+
+namespace {
+// Runs the conv on the input converted to data_format (NCHW4C/NCHW8C) and
+// checks it against the NCHW one.
+void TestNCHWcConv(const DataFormat data_format,
+                   const std::vector<index_t> &shape,
+                   const int kernel,
+                   const int stride,
+                   const int dilation,
+                   const Padding padding,
+                   const char *activation,
+                   const bool is_filter_weight) {
+  const index_t batch = shape[0];
+  const index_t input_channels = shape[1];
+  const index_t output_channels = shape[2];
+
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, input_channels, shape[3], shape[4]});
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Filter", {output_channels, input_channels, kernel, kernel});
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {output_channels});
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Output("Output")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", padding)
+      .AddIntsArg("dilations", {dilation, dilation})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Residual", net.GetOutput("Output")->shape());
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Input("Residual")
+      .Output("Output")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", padding)
+      .AddIntsArg("dilations", {dilation, dilation})
+      .AddStringArg("activation", activation)
+      .AddFloatArg("max_limit", 0.5f)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  Tensor expected;
+  expected.Copy(*net.GetOutput("Output"));
+
+  // Blocked
+  OpDefBuilder("TransformDataFormat", "InputToNCHWc")
+      .Input("Input")
+      .Output("InputNCHWc")
+      .AddIntArg("data_format", data_format)
+      .Finalize(net.NewOperatorDef());
+  OpDefBuilder("TransformDataFormat", "ResidualToNCHWc")
+      .Input("Residual")
+      .Output("ResidualNCHWc")
+      .AddIntArg("data_format", data_format)
+      .Finalize(net.AddNewOperatorDef());
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("InputNCHWc")
+      .Input("Filter")
+      .Input("Bias")
+      .Input("ResidualNCHWc")
+      .Output("OutputNCHWc")
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", padding)
+      .AddIntsArg("dilations", {dilation, dilation})
+      .AddStringArg("activation", activation)
+      .AddFloatArg("max_limit", 0.5f)
+      .AddIntArg("data_format", data_format)
+      .Finalize(net.AddNewOperatorDef());
+  OpDefBuilder("TransformDataFormat", "OutputToNCHW")
+      .Input("OutputNCHWc")
+      .Output("Output")
+      .AddIntArg("data_format", NCHW)
+      .Finalize(net.AddNewOperatorDef());
+  net.GetTensor("Filter")->SetIsWeight(is_filter_weight);
+  net.Setup(DeviceType::CPU);
+  net.Run();
+
+  EXPECT_EQ(5, net.GetOutput("OutputNCHWc")->dim_size());
+  ExpectTensorNear<float>(expected, *net.GetOutput("Output"), 1e-4, 1e-4);
+}
+}  // namespace
+
+TEST_F(Conv2dOpTest, CPUNCHWc) {
+  for (DataFormat data_format : {NCHW4C, NCHW8C}) {
+    for (bool is_filter_weight : {false, true}) {
+      TestNCHWcConv(data_format, {1, 8, 16, 17, 19}, 3, 1, 1, SAME, "RELU",
+                    is_filter_weight);
+      TestNCHWcConv(data_format, {2, 16, 8, 16, 16}, 1, 1, 1, VALID, "NOOP",
+                    is_filter_weight);
+    }
+    TestNCHWcConv(data_format, {1, 8, 8, 15, 13}, 3, 2, 1, SAME, "RELUX",
+                  true);
+    TestNCHWcConv(data_format, {1, 8, 16, 23, 17}, 5, 1, 2, SAME, "TANH",
+                  true);
+    TestNCHWcConv(data_format, {1, 16, 8, 9, 11}, 7, 3, 1, VALID, "SIGMOID",
+                  true);
+  }
+}
+
+namespace {
+// 1x1 conv with the filter given as block-CSR (and a residual) versus dense,
+// for a filter with about `sparsity` of its blocks zero.
+void TestSparse1x1Conv(const std::vector<index_t> &shape,
+                       const int block_rows,
+                       const int block_cols,
+                       const float sparsity) {
+  const index_t batch = shape[0];
+  const index_t input_channels = shape[1];
+  const index_t output_channels = shape[2];
+
+  std::vector<float> filter(output_channels * input_channels);
+  std::mt19937 gen(0);
+  std::normal_distribution<float> nd(0, 1);
+  std::uniform_real_distribution<float> ud(0, 1);
+  for (index_t r = 0; r < output_channels; r += block_rows) {
+    for (index_t c = 0; c < input_channels; c += block_cols) {
+      const bool zero = ud(gen) < sparsity;
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          filter[(r + i) * input_channels + c + j] = zero ? 0.f : nd(gen);
+        }
+      }
+    }
+  }
+  std::vector<int32_t> row_ptr;
+  std::vector<int32_t> col_idx;
+  std::vector<float> values;
+  kernels::BlockSparseEncode(filter.data(), output_channels, input_channels,
+                             block_rows, block_cols, &row_ptr, &col_idx,
+                             &values);
+
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, input_channels, shape[3], shape[4]});
+  net.AddInputFromArray<DeviceType::CPU, float>(
+      "Filter", {output_channels, input_channels, 1, 1}, filter);
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {output_channels});
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Residual", {batch, output_channels, shape[3], shape[4]});
+  net.AddInputFromArray<DeviceType::CPU, float>(
+      "SparseFilter",
+      {static_cast<index_t>(col_idx.size()), block_rows, block_cols}, values);
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "RowPtr", {static_cast<index_t>(row_ptr.size())}, row_ptr);
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "ColIdx", {static_cast<index_t>(col_idx.size())}, col_idx);
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Input("Residual")
+      .Output("Output")
+      .AddIntsArg("strides", {1, 1})
+      .AddIntArg("padding", VALID)
+      .AddIntsArg("dilations", {1, 1})
+      .AddStringArg("activation", "RELU")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  Tensor expected;
+  expected.Copy(*net.GetOutput("Output"));
+
+  OpDefBuilder("Conv2D", "Conv2dTest")
+      .Input("Input")
+      .Input("SparseFilter")
+      .Input("Bias")
+      .Input("Residual")
+      .Input("RowPtr")
+      .Input("ColIdx")
+      .Output("Output")
+      .AddIntsArg("strides", {1, 1})
+      .AddIntArg("padding", VALID)
+      .AddIntsArg("dilations", {1, 1})
+      .AddStringArg("activation", "RELU")
+      .AddIntsArg("sparse_weight_shape",
+                  {static_cast<int>(output_channels),
+                   static_cast<int>(input_channels), 1, 1})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  ExpectTensorNear<float>(expected, *net.GetOutput("Output"), 1e-4, 1e-4);
+}
+}  // namespace
+
+TEST_F(Conv2dOpTest, CPUSparse1x1) {
+  TestSparse1x1Conv({1, 64, 32, 15, 17}, 4, 1, 0.8f);
+  TestSparse1x1Conv({1, 64, 32, 15, 17}, 1, 4, 0.8f);
+  TestSparse1x1Conv({2, 16, 8, 7, 9}, 4, 1, 0.5f);
+  TestSparse1x1Conv({1, 32, 64, 4, 4}, 1, 4, 0.95f);
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -34,7 +34,8 @@ class Deconv2dOp : public ConvPool2dOpBase<D, T> {
                  this->paddings_,
                  OperatorBase::GetRepeatedArgs<index_t>("output_shape"),
                  kernels::ActivationType::NOOP,
-                 0.0f) {}
+                 0.0f,
+                 ws->GetScratchBuffer(D)) {}
 
   MaceStatus Run(StatsFuture *future) override {
     const Tensor *input = this->Input(INPUT);
@@ -45,6 +46,8 @@ class Deconv2dOp : public ConvPool2dOpBase<D, T> {
     return functor_(input, filter, bias, output, future);
   }
 
+  MaceStatus Init() override { return MaceStatus::MACE_SUCCESS; }
+
  private:
   kernels::Deconv2dFunctor<D, T> functor_;
 
@@ -53,6 +56,15 @@ class Deconv2dOp : public ConvPool2dOpBase<D, T> {
   MACE_OP_OUTPUT_TAGS(OUTPUT);
 };
 
+template <>
+inline MaceStatus Deconv2dOp<DeviceType::CPU, float>::Init() {
+  const Tensor *filter = this->Input(FILTER);
+  if (!filter->is_weight()) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+  return functor_.PackFilter(filter, this->InPlacePackableWeight(FILTER));
+}
+
 }  // namespace ops
 }  // namespace mace
 
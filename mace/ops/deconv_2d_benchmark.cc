@@ -114,8 +114,8 @@ static void Deconv2d(int iters,
     MACE_BM_DECONV_2D_##N##_##C##_##H##_##W##_##KH##_##KW##_##STRIDE##_##OH##_\
         ##OW##_##P##_##OC##_##TYPE##_##DEVICE)
 
-// TODO(liutuo): add cpu benchmark when optimized.
 #define MACE_BM_DECONV_2D(N, C, H, W, KH, KW, S, OH, OW, P, OC)              \
+  MACE_BM_DECONV_2D_MACRO(N, C, H, W, KH, KW, S, OH, OW, P, OC, float, CPU); \
   MACE_BM_DECONV_2D_MACRO(N, C, H, W, KH, KW, S, OH, OW, P, OC, float, GPU); \
   MACE_BM_DECONV_2D_MACRO(N, C, H, W, KH, KW, S, OH, OW, P, OC, half, GPU);
 
@@ -135,6 +135,11 @@ MACE_BM_DECONV_2D(1, 64, 33, 32, 3, 3, 2, 65, 63, SAME, 128);
 MACE_BM_DECONV_2D(1, 3, 224, 224, 3, 3, 2, 447, 447, SAME, 32);
 MACE_BM_DECONV_2D(1, 3, 224, 224, 3, 3, 2, 449, 449, VALID, 32);
 
+// Stride 2 upsampling in decoders
+MACE_BM_DECONV_2D(1, 64, 64, 64, 2, 2, 2, 128, 128, VALID, 32);
+MACE_BM_DECONV_2D(1, 128, 32, 32, 4, 4, 2, 64, 64, SAME, 64);
+MACE_BM_DECONV_2D(1, 21, 64, 64, 4, 4, 2, 128, 128, SAME, 21);
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -17,6 +17,7 @@
 
 #include "mace/ops/deconv_2d.h"
 #include "mace/ops/ops_test_util.h"
+#include "mace/public/mace_runtime.h"
 
 namespace mace {
 namespace ops {
@@ -427,6 +428,56 @@ TEST_F(Deconv2dOpTest, OPENCLUnalignedDeconvNxNMultiBatch) {
   TestComplexDeconvNxNS12<DeviceType::GPU, float>(5, {17, 13, 5, 7}, 2);
 }
 
+namespace {
+void TestPackedFilter(const bool keep_unpacked_weights) {
+  OpsTestNet net;
+
+  // Add input data
+  net.AddRandomInput<DeviceType::CPU, float>("Input", {2, 5, 9, 11});
+  net.AddRandomInput<DeviceType::CPU, float>("Filter", {6, 5, 4, 4});
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {6});
+
+  OpDefBuilder("Deconv2D", "Deconv2dTest")
+      .Input("Input")
+      .Input("Filter")
+      .Input("Bias")
+      .Output("Output")
+      .AddIntsArg("strides", {2, 2})
+      .AddIntArg("padding", Padding::VALID)
+      .AddIntsArg("padding_values", {2, 2})
+      .Finalize(net.NewOperatorDef());
+
+  // Run with the filter packed on every run
+  net.RunOp();
+  Tensor expected;
+  expected.Copy(*net.GetOutput("Output"));
+  Tensor unpacked_filter;
+  unpacked_filter.Copy(*net.GetTensor("Filter"));
+
+  // Run with the filter packed at init
+  net.GetTensor("Filter")->SetIsWeight(true);
+  SetKeepUnpackedWeights(keep_unpacked_weights);
+  net.Setup(DeviceType::CPU);
+  SetKeepUnpackedWeights(true);
+  net.Run();
+  net.Run();
+
+  // Check
+  ExpectTensorNear<float>(expected, *net.GetOutput("Output"), 1e-5);
+  if (keep_unpacked_weights) {
+    ExpectTensorNear<float>(unpacked_filter, *net.GetTensor("Filter"));
+  }
+}
+}  // namespace
+
+TEST_F(Deconv2dOpTest, CPUPackedFilter) {
+  TestPackedFilter(true);
+}
+
+TEST_F(Deconv2dOpTest, CPUPackedFilterInPlace) {
+  TestPackedFilter(false);
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
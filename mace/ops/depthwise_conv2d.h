@@ -51,6 +51,8 @@ class DepthwiseConv2dOp : public ConvPool2dOpBase<D, T> {
     return functor_(input, filter, bias, output, future);
   }
 
+  MaceStatus Init() override { return MaceStatus::MACE_SUCCESS; }
+
  private:
   kernels::DepthwiseConv2dFunctor<D, T> functor_;
 
@@ -59,6 +61,18 @@ class DepthwiseConv2dOp : public ConvPool2dOpBase<D, T> {
   MACE_OP_OUTPUT_TAGS(OUTPUT);
 };
 
+template <>
+inline MaceStatus DepthwiseConv2dOp<DeviceType::CPU, float>::Init() {
+  const Tensor *filter = this->Input(FILTER);
+  const int block = kernels::NCHWcBlockSize(static_cast<DataFormat>(
+      OperatorBase::GetOptionalArg<int>("data_format", NCHW)));
+  if (block == 0 || !filter->is_weight()) {
+    return MaceStatus::MACE_SUCCESS;
+  }
+  return functor_.PackFilterNCHWc(filter, block,
+                                  this->InPlacePackableWeight(FILTER));
+}
+
 }  // namespace ops
 }  // namespace mace
 
@@ -33,6 +33,7 @@ void DepthwiseConv2d(int iters,
                      int kernel_h,
                      int kernel_w,
                      int stride,
+                     int dilation,
                      Padding padding,
                      int multiplier) {
   mace::testing::StopTiming();
@@ -61,7 +62,7 @@ void DepthwiseConv2d(int iters,
       .Output("Output")
       .AddIntsArg("strides", {stride, stride})
       .AddIntArg("padding", padding)
-      .AddIntsArg("dilations", {1, 1})
+      .AddIntsArg("dilations", {dilation, dilation})
       .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
       .Finalize(net.NewOperatorDef());
   } else if (D == DeviceType::GPU) {
@@ -78,7 +79,7 @@ void DepthwiseConv2d(int iters,
         .Output("Output")
         .AddIntsArg("strides", {stride, stride})
         .AddIntArg("padding", padding)
-        .AddIntsArg("dilations", {1, 1})
+        .AddIntsArg("dilations", {dilation, dilation})
         .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
         .Finalize(net.NewOperatorDef());
   } else {
@@ -102,17 +103,17 @@ void DepthwiseConv2d(int iters,
 }  // namespace
 
 #define MACE_BM_DEPTHWISE_CONV_2D_MACRO(                                       \
-    N, C, H, W, KH, KW, STRIDE, P, M, TYPE, DEVICE)                            \
+    N, C, H, W, KH, KW, STRIDE, DILATION, P, M, TYPE, DEVICE)                  \
   static void                                                                  \
       MACE_BM_DEPTHWISE_CONV_2D_##N##_##C##_##H##_##W##_K##KH##x##KW##S##STRIDE\
-        ##_##P##_##M##_##TYPE##_##DEVICE(                                      \
+        ##D##DILATION##_##P##_##M##_##TYPE##_##DEVICE(                         \
           int iters) {                                                         \
-    const int64_t dilation = 1;                                                \
+    const int64_t dilation = DILATION;                                         \
     const int64_t tot = static_cast<int64_t>(iters) * N * C * H * W;           \
     int64_t pad_h = 0, pad_w = 0;                                              \
     if (P == SAME) {                                                           \
-      pad_h = KH / 2;                                                          \
-      pad_w = KW / 2;                                                          \
+      pad_h = (KH - 1) * dilation / 2;                                         \
+      pad_w = (KW - 1) * dilation / 2;                                         \
     }                                                                          \
     int64_t oh =                                                               \
         (H + 2 * pad_h - KH - (KH - 1) * (dilation - 1)) / STRIDE + 1;         \
@@ -123,40 +124,52 @@ void DepthwiseConv2d(int iters,
     mace::testing::MaccProcessed(macc);                                        \
     mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                        \
     DepthwiseConv2d<DEVICE, TYPE>(iters, N, C, H, W, KH, KW, STRIDE,           \
-                                  mace::Padding::P, M);                        \
+                                  DILATION, mace::Padding::P, M);              \
   }                                                                            \
   MACE_BENCHMARK(                                                              \
       MACE_BM_DEPTHWISE_CONV_2D_##N##_##C##_##H##_##W##_K##KH##x##KW##S##STRIDE\
-        ##_##P##_##M##_##TYPE##_##DEVICE)
-
-#define MACE_BM_DEPTHWISE_CONV_2D(N, C, H, W, KH, KW, S, P, M)                 \
-  MACE_BM_DEPTHWISE_CONV_2D_MACRO(N, C, H, W, KH, KW, S, P, M, float, CPU);    \
-  MACE_BM_DEPTHWISE_CONV_2D_MACRO(N, C, H, W, KH, KW, S, P, M, float, GPU);    \
-  MACE_BM_DEPTHWISE_CONV_2D_MACRO(N, C, H, W, KH, KW, S, P, M, half, GPU);
-
-MACE_BM_DEPTHWISE_CONV_2D(1, 32, 112, 112, 3, 3, 1, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 32, 56, 56, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 32, 112, 112, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 32, 224, 224, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 56, 56, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 112, 112, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 224, 224, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 1, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 1, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 1, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 1, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 1, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 1, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 2, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 2, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 2, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 3, 112, 112, 3, 3, 2, VALID, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 3, 224, 224, 3, 3, 2, SAME, 1);
-MACE_BM_DEPTHWISE_CONV_2D(1, 8, 224, 224, 3, 3, 2, SAME, 1);
+        ##D##DILATION##_##P##_##M##_##TYPE##_##DEVICE)
 
+#define MACE_BM_DEPTHWISE_CONV_2D(N, C, H, W, KH, KW, S, D, P, M)              \
+  MACE_BM_DEPTHWISE_CONV_2D_MACRO(N, C, H, W, KH, KW, S, D, P, M, float, CPU); \
+  MACE_BM_DEPTHWISE_CONV_2D_MACRO(N, C, H, W, KH, KW, S, D, P, M, float, GPU); \
+  MACE_BM_DEPTHWISE_CONV_2D_MACRO(N, C, H, W, KH, KW, S, D, P, M, half, GPU);
+
+MACE_BM_DEPTHWISE_CONV_2D(1, 32, 112, 112, 3, 3, 1, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 32, 56, 56, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 32, 112, 112, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 32, 224, 224, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 56, 56, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 112, 112, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 224, 224, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 1, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 1, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 1, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 1, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 1, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 1, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 32, 32, 3, 3, 2, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 33, 31, 3, 3, 2, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 3, 512, 512, 3, 3, 2, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 3, 112, 112, 3, 3, 2, 1, VALID, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 3, 224, 224, 3, 3, 2, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 8, 224, 224, 3, 3, 2, 1, SAME, 1);
+
+// MobileNetV2 / EfficientNet like
+MACE_BM_DEPTHWISE_CONV_2D(1, 144, 56, 56, 3, 3, 1, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 144, 56, 56, 3, 3, 2, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 240, 28, 28, 5, 5, 1, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 144, 56, 56, 5, 5, 2, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 672, 14, 14, 5, 5, 1, 1, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 32, 112, 112, 3, 3, 1, 1, SAME, 2);
+
+// Dilated (DeepLab like)
+MACE_BM_DEPTHWISE_CONV_2D(1, 256, 33, 33, 3, 3, 1, 2, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 256, 65, 65, 3, 3, 1, 4, SAME, 1);
+MACE_BM_DEPTHWISE_CONV_2D(1, 64, 64, 64, 5, 5, 1, 2, SAME, 1);
 
 }  // namespace test
 }  // namespace ops
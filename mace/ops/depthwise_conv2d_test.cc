@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+
 #include "mace/ops/conv_2d.h"
 #include "mace/ops/ops_test_util.h"
 
@@ -112,7 +114,8 @@ void ComplexValidTest(index_t batch,
                       index_t width,
                       index_t kernel,
                       index_t multiplier,
-                      int stride) {
+                      int stride,
+                      int dilation = 1) {
   testing::internal::LogToStderr();
   // Construct graph
   OpsTestNet net;
@@ -141,7 +144,7 @@ void ComplexValidTest(index_t batch,
         .Output("OutputNCHW")
         .AddIntsArg("strides", {stride, stride})
         .AddIntArg("padding", Padding::SAME)
-        .AddIntsArg("dilations", {1, 1})
+        .AddIntsArg("dilations", {dilation, dilation})
         .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
         .Finalize(net.NewOperatorDef());
     // Run
@@ -162,7 +165,7 @@ void ComplexValidTest(index_t batch,
         .Output("OutputImage")
         .AddIntsArg("strides", {stride, stride})
         .AddIntArg("padding", Padding::SAME)
-        .AddIntsArg("dilations", {1, 1})
+        .AddIntsArg("dilations", {dilation, dilation})
         .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
         .Finalize(net.NewOperatorDef());
 
@@ -179,8 +182,11 @@ void ComplexValidTest(index_t batch,
   // expect
   index_t out_height = (height - 1) / stride + 1;
   index_t out_width = (width - 1) / stride + 1;
-  index_t pad_top = ((out_height - 1) * stride + kernel - height) >> 1;
-  index_t pad_left = ((out_width - 1) * stride + kernel - width) >> 1;
+  index_t kernel_extent = (kernel - 1) * dilation + 1;
+  index_t pad_top = std::max<index_t>(
+      0, (out_height - 1) * stride + kernel_extent - height) >> 1;
+  index_t pad_left = std::max<index_t>(
+      0, (out_width - 1) * stride + kernel_extent - width) >> 1;
   index_t out_channels = channel * multiplier;
   std::vector<T> expect(batch * out_height * out_width * out_channels);
   for (index_t b = 0; b < batch; ++b) {
@@ -194,8 +200,8 @@ void ComplexValidTest(index_t batch,
           float sum = 0;
           for (index_t kh = 0; kh < kernel; ++kh) {
             for (index_t kw = 0; kw < kernel; ++kw) {
-              index_t ih = h * stride - pad_top + kh;
-              index_t iw = w * stride - pad_left + kw;
+              index_t ih = h * stride - pad_top + kh * dilation;
+              index_t iw = w * stride - pad_left + kw * dilation;
               if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
                 index_t in_offset =
                     ((b * height + ih) * width + iw) * channel + c;
@@ -212,7 +218,7 @@ void ComplexValidTest(index_t batch,
   }
 
   auto expected =
-      CreateTensor<T>({1, out_height, out_width, out_channels}, expect);
+      CreateTensor<T>({batch, out_height, out_width, out_channels}, expect);
 
   if (DataTypeToEnum<T>::value == DT_FLOAT) {
     ExpectTensorNear<T>(*expected, *net.GetOutput("Output"), 1e-5);
@@ -234,6 +240,29 @@ TEST_F(DepthwiseConv2dOpTest, ComplexCPU3x3s2) {
   ComplexValidTest<DeviceType::CPU, float>(1, 3, 10, 10, 3, 1, 2);
 }
 
+TEST_F(DepthwiseConv2dOpTest, ComplexCPU5x5) {
+  ComplexValidTest<DeviceType::CPU, float>(1, 3, 10, 10, 5, 1, 1);
+  ComplexValidTest<DeviceType::CPU, float>(2, 5, 37, 43, 5, 1, 1);
+  ComplexValidTest<DeviceType::CPU, float>(2, 5, 37, 43, 5, 1, 2);
+}
+
+TEST_F(DepthwiseConv2dOpTest, ComplexCPUWide) {
+  // wide enough for the vectorized interior
+  ComplexValidTest<DeviceType::CPU, float>(2, 5, 37, 43, 3, 1, 1);
+  ComplexValidTest<DeviceType::CPU, float>(2, 5, 37, 43, 3, 1, 2);
+  ComplexValidTest<DeviceType::CPU, float>(1, 4, 19, 50, 3, 2, 2);
+  ComplexValidTest<DeviceType::CPU, float>(1, 4, 19, 50, 5, 3, 1);
+}
+
+TEST_F(DepthwiseConv2dOpTest, ComplexCPUDilation) {
+  ComplexValidTest<DeviceType::CPU, float>(1, 3, 33, 35, 3, 1, 1, 2);
+  ComplexValidTest<DeviceType::CPU, float>(1, 3, 33, 35, 5, 2, 1, 3);
+  ComplexValidTest<DeviceType::CPU, float>(1, 3, 10, 10, 3, 1, 1, 4);
+  // general kernel
+  ComplexValidTest<DeviceType::CPU, float>(1, 3, 21, 22, 7, 1, 1, 2);
+  ComplexValidTest<DeviceType::CPU, float>(1, 3, 21, 22, 7, 1, 2);
+}
+
 TEST_F(DepthwiseConv2dOpTest, ComplexOpenCL) {
   ComplexValidTest<DeviceType::GPU, float>(1, 3, 10, 10, 5, 1, 2);
 }
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "mace/core/operator.h"
 #include "mace/core/testing/test_benchmark.h"
@@ -74,6 +76,41 @@ void EltwiseBenchmark(
     net.Sync();
   }
 }
+
+template <DeviceType D, typename T>
+void EltwiseBroadcastBenchmark(int iters,
+                               kernels::EltwiseType type,
+                               const std::vector<index_t> &shape0,
+                               const std::vector<index_t> &shape1,
+                               const DataFormat data_format) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  // Add input data
+  net.AddRandomInput<D, T>("Input0", shape0, true);
+  net.AddRandomInput<D, T>("Input1", shape1, true);
+
+  OpDefBuilder("Eltwise", "EltwiseTest")
+      .Input("Input0")
+      .Input("Input1")
+      .AddIntArg("type", static_cast<int>(type))
+      .AddIntArg("data_format", data_format)
+      .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  for (int i = 0; i < 5; ++i) {
+    net.RunOp(D);
+    net.Sync();
+  }
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.RunOp(D);
+    net.Sync();
+  }
+}
 }  // namespace
 
 #define MACE_BM_ELTWISE_MACRO(ELT_TYPE, N, H, W, C, TYPE, DEVICE)             \
@@ -102,6 +139,45 @@ MACE_BM_ELTWISE(0, 1, 240, 240, 256);
 MACE_BM_ELTWISE(5, 1, 128, 128, 32);
 MACE_BM_ELTWISE(5, 1, 240, 240, 256);
 
+// input0 [N, H, W, C] <ELT_TYPE> input1 [N1, H1, W1, C1], broadcast as numpy
+#define MACE_BM_ELTWISE_BROADCAST_MACRO(ELT_TYPE, N, H, W, C, N1, H1, W1, C1, \
+                                        TYPE, DEVICE)                         \
+  static void                                                                 \
+      MACE_BM_ELTWISE_BROADCAST_##ELT_TYPE##_##N##_##H##_##W##_##C##_##N1##_##\
+      H1##_##W1##_##C1##_##TYPE##_##DEVICE(int iters) {                       \
+    const int64_t tot = static_cast<int64_t>(iters) * std::max(N, N1) *       \
+        std::max(H, H1) * std::max(W, W1) * std::max(C, C1);                  \
+    mace::testing::MaccProcessed(tot);                                        \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                       \
+    EltwiseBroadcastBenchmark<DEVICE, TYPE>(                                  \
+        iters, static_cast<kernels::EltwiseType>(ELT_TYPE), {N, H, W, C},     \
+        {N1, H1, W1, C1}, NHWC);                                              \
+  }                                                                           \
+  MACE_BENCHMARK(                                                             \
+      MACE_BM_ELTWISE_BROADCAST_##ELT_TYPE##_##N##_##H##_##W##_##C##_##N1##_##\
+      H1##_##W1##_##C1##_##TYPE##_##DEVICE)
+
+#define MACE_BM_ELTWISE_BROADCAST(ELT_TYPE, N, H, W, C, N1, H1, W1, C1)      \
+  MACE_BM_ELTWISE_BROADCAST_MACRO(ELT_TYPE, N, H, W, C, N1, H1, W1, C1,      \
+                                  float, CPU);
+
+// per channel, channel last and channel first
+MACE_BM_ELTWISE_BROADCAST(0, 1, 128, 128, 32, 1, 1, 1, 32);
+MACE_BM_ELTWISE_BROADCAST(2, 1, 32, 128, 128, 1, 32, 1, 1);
+// scalar
+MACE_BM_ELTWISE_BROADCAST(2, 1, 128, 128, 32, 1, 1, 1, 1);
+// attention scores + mask: [batch, heads, len, len] + [batch, 1, 1, len]
+MACE_BM_ELTWISE_BROADCAST(0, 1, 8, 128, 128, 1, 1, 1, 128);
+MACE_BM_ELTWISE_BROADCAST(0, 4, 8, 128, 128, 4, 1, 1, 128);
+// normalization: x - mean over the last dim, x / std over H and W
+MACE_BM_ELTWISE_BROADCAST(1, 1, 128, 128, 64, 1, 128, 128, 1);
+MACE_BM_ELTWISE_BROADCAST(3, 2, 64, 64, 32, 2, 1, 1, 32);
+MACE_BM_ELTWISE_BROADCAST(8, 1, 128, 128, 64, 1, 128, 128, 1);
+// pow by a scalar exponent
+MACE_BM_ELTWISE_BROADCAST(9, 1, 128, 128, 64, 1, 1, 1, 1);
+// outer: [1, len, 1] x [1, 1, len]
+MACE_BM_ELTWISE_BROADCAST(2, 1, 1, 512, 1, 1, 1, 1, 512);
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -12,6 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
 #include "mace/kernels/eltwise.h"
 #include "mace/core/operator.h"
 #include "mace/ops/ops_test_util.h"
@@ -694,6 +702,161 @@ TEST_F(EltwiseOpTest, TensorGeneralBroadcast) {
       {1, 1, 2, 1}, {1, 2}, {1, 1, 2, 3}, {1, 0, 0, 0, 0, 0});
 }
 
+namespace {
+template <typename T, typename DstType>
+DstType EltwiseRef(const kernels::EltwiseType type,
+                   const T a,
+                   const T b,
+                   const std::vector<float> &coeff) {
+  switch (type) {
+    case kernels::EltwiseType::SUM:
+      return coeff.empty() ? a + b : a * coeff[0] + b * coeff[1];
+    case kernels::EltwiseType::SUB:
+      return a - b;
+    case kernels::EltwiseType::PROD:
+      return a * b;
+    case kernels::EltwiseType::DIV:
+      return a / b;
+    case kernels::EltwiseType::MIN:
+      return std::min(a, b);
+    case kernels::EltwiseType::MAX:
+      return std::max(a, b);
+    case kernels::EltwiseType::NEG:
+      return -a;
+    case kernels::EltwiseType::ABS:
+      return std::abs(a);
+    case kernels::EltwiseType::SQR_DIFF:
+      return (a - b) * (a - b);
+    case kernels::EltwiseType::POW:
+      return std::pow(a, b);
+    case kernels::EltwiseType::EQUAL:
+      return a == b;
+    default:
+      LOG(FATAL) << "Unsupported type " << type;
+      return 0;
+  }
+}
+
+template <typename T, typename DstType>
+void RandomGeneralBroadcast(const kernels::EltwiseType type,
+                            const std::vector<index_t> &shape0,
+                            const std::vector<index_t> &shape1,
+                            const std::vector<float> &coeff = {}) {
+  // Inputs in [-2, -0.5] and [0.5, 2] (positive for POW), with ties for
+  // EQUAL and MIN/MAX
+  std::mt19937 rng(static_cast<unsigned int>(shape0.size() * 31 + type));
+  std::uniform_int_distribution<int> dist(1, 4);
+  auto random_input = [&](const std::vector<index_t> &shape) {
+    std::vector<T> data(std::accumulate(shape.begin(), shape.end(), 1,
+                                        std::multiplies<index_t>()));
+    for (auto &value : data) {
+      const int sign =
+          type == kernels::EltwiseType::POW || dist(rng) > 2 ? 1 : -1;
+      value = static_cast<T>(sign * dist(rng) *
+                             (std::is_integral<T>::value ? 1 : 0.5f));
+    }
+    return data;
+  };
+  const std::vector<T> input0 = random_input(shape0);
+  const std::vector<T> input1 = random_input(shape1);
+
+  OpsTestNet net;
+  net.AddInputFromArray<DeviceType::CPU, T>("Input0", shape0, input0);
+  net.AddInputFromArray<DeviceType::CPU, T>("Input1", shape1, input1);
+  OpDefBuilder("Eltwise", "EltwiseTest")
+      .AddIntArg("T", DataTypeToEnum<T>::v())
+      .Input("Input0")
+      .Input("Input1")
+      .AddIntArg("type", static_cast<int>(type))
+      .AddFloatsArg("coeff", coeff)
+      .OutputType({kernels::IsLogicalType(type) ? DT_INT32
+                                                : DataTypeToEnum<T>::v()})
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(DeviceType::CPU);
+
+  // Reference with numpy broadcasting
+  const size_t rank = std::max(shape0.size(), shape1.size());
+  std::vector<index_t> dims0(rank - shape0.size(), 1);
+  dims0.insert(dims0.end(), shape0.begin(), shape0.end());
+  std::vector<index_t> dims1(rank - shape1.size(), 1);
+  dims1.insert(dims1.end(), shape1.begin(), shape1.end());
+  std::vector<index_t> output_shape(rank);
+  for (size_t i = 0; i < rank; ++i) {
+    output_shape[i] = std::max(dims0[i], dims1[i]);
+  }
+  if (type == kernels::EltwiseType::NEG ||
+      type == kernels::EltwiseType::ABS) {
+    output_shape = shape0;
+    dims0 = shape0;
+    dims1.assign(shape0.size(), 1);
+  }
+  const index_t output_size =
+      std::accumulate(output_shape.begin(), output_shape.end(), 1,
+                      std::multiplies<index_t>());
+  std::vector<DstType> expected(output_size);
+  std::vector<index_t> index(output_shape.size(), 0);
+  for (index_t i = 0; i < output_size; ++i) {
+    index_t idx0 = 0;
+    index_t idx1 = 0;
+    for (size_t d = 0; d < output_shape.size(); ++d) {
+      idx0 = idx0 * dims0[d] + (dims0[d] == 1 ? 0 : index[d]);
+      idx1 = idx1 * dims1[d] + (dims1[d] == 1 ? 0 : index[d]);
+    }
+    expected[i] = EltwiseRef<T, DstType>(type, input0[idx0], input1[idx1],
+                                         coeff);
+    for (int d = static_cast<int>(output_shape.size()) - 1; d >= 0; --d) {
+      if (++index[d] < output_shape[d]) break;
+      index[d] = 0;
+    }
+  }
+
+  auto expected_tensor = CreateTensor<DstType>(output_shape, expected);
+  ExpectTensorNear<DstType>(*expected_tensor, *net.GetOutput("Output"), 1e-5,
+                            1e-6);
+}
+}  // namespace
+
+TEST_F(EltwiseOpTest, RandomTensorGeneralBroadcast) {
+  typedef kernels::EltwiseType Type;
+  RandomGeneralBroadcast<float, float>(Type::SUM, {2, 3, 4, 5}, {5});
+  RandomGeneralBroadcast<float, float>(Type::SUM, {3, 1, 5}, {3, 4, 5},
+                                       {0.5, -2});
+  RandomGeneralBroadcast<float, float>(Type::SUB, {2, 1, 4, 1},
+                                       {1, 3, 1, 5});
+  RandomGeneralBroadcast<float, float>(Type::PROD, {1, 8, 1, 1, 17},
+                                       {2, 1, 3, 5, 1});
+  RandomGeneralBroadcast<float, float>(Type::DIV, {4}, {3, 1, 4});
+  RandomGeneralBroadcast<float, float>(Type::DIV, {2, 20000}, {2, 1});
+  RandomGeneralBroadcast<float, float>(Type::MIN, {2, 3, 1}, {2, 1, 37});
+  RandomGeneralBroadcast<float, float>(Type::MAX, {8, 1, 64}, {8, 64, 64});
+  RandomGeneralBroadcast<float, float>(Type::SQR_DIFF, {4, 16, 9},
+                                       {4, 16, 1});
+  RandomGeneralBroadcast<float, float>(Type::NEG, {3, 20}, {1});
+  RandomGeneralBroadcast<float, float>(Type::ABS, {3, 20}, {1});
+  RandomGeneralBroadcast<float, float>(Type::POW, {5, 33}, {1});
+  RandomGeneralBroadcast<float, float>(Type::POW, {5, 33}, {5, 1});
+  RandomGeneralBroadcast<float, float>(Type::POW, {1, 33}, {5, 33});
+  RandomGeneralBroadcast<float, int32_t>(Type::EQUAL, {6, 1, 7}, {5, 1});
+  RandomGeneralBroadcast<int32_t, int32_t>(Type::SUM, {2, 3, 4, 5}, {3, 1, 1},
+                                           {2, 3});
+  RandomGeneralBroadcast<int32_t, int32_t>(Type::MAX, {7, 1}, {1, 9});
+  RandomGeneralBroadcast<int32_t, int32_t>(Type::EQUAL, {2, 1, 4, 1},
+                                           {1, 3, 1, 5});
+}
+
+TEST_F(EltwiseOpTest, CPUPowScalarExponent) {
+  SimpleTensorScalar<DeviceType::CPU, float, float>(
+      kernels::EltwiseType::POW, {1, 1, 2, 3}, {-1, 2, -3, 4, 5, 6}, 2,
+      {1, 4, 9, 16, 25, 36});
+  SimpleTensorScalar<DeviceType::CPU, float, float>(
+      kernels::EltwiseType::POW, {1, 1, 2, 3}, {1, 4, 9, 16, 25, 36}, 0.5,
+      {1, 2, 3, 4, 5, 6});
+  SimpleTensorScalar<DeviceType::CPU, float, float>(
+      kernels::EltwiseType::POW, {1, 1, 2, 3}, {-1, 2, -3, 4, 5, 6}, 3,
+      {-1, 8, -27, 64, 125, 216});
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -0,0 +1,88 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/reduce.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+template <DeviceType D, typename T>
+void EmbeddingBagBenchmark(int iters,
+                           index_t bags,
+                           index_t bag_size,
+                           index_t vocab_len,
+                           index_t embedding_len) {
+  mace::testing::StopTiming();
+  static unsigned int seed = time(NULL);
+
+  OpsTestNet net;
+  std::vector<int32_t> index(bags * bag_size);
+  for (size_t i = 0; i < index.size(); ++i) {
+    index[i] = rand_r(&seed) % vocab_len;
+  }
+  net.AddInputFromArray<D, int32_t>("Indices", {bags, bag_size}, index);
+  net.AddRandomInput<D, T>("Params", {vocab_len, embedding_len});
+
+  OpDefBuilder("EmbeddingBag", "EmbeddingBagTest")
+      .Input("Params")
+      .Input("Indices")
+      .AddIntArg("reduce_type", static_cast<int>(kernels::REDUCE_MEAN))
+      .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  for (int i = 0; i < 2; ++i) {
+    net.RunOp(D);
+    net.Sync();
+  }
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.RunOp(D);
+    net.Sync();
+  }
+}
+}  // namespace
+
+#define MACE_BM_EMBEDDING_BAG_MACRO(N, B, V, E, TYPE, DEVICE)            \
+  static void                                                            \
+      MACE_BM_EMBEDDING_BAG##_##N##_##B##_##V##_##E##_##TYPE##_##DEVICE( \
+          int iters) {                                                   \
+    const int64_t tot = static_cast<int64_t>(iters) * N * B * E;         \
+    mace::testing::MaccProcessed(tot);                                   \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                  \
+    EmbeddingBagBenchmark<DEVICE, TYPE>(iters, N, B, V, E);              \
+  }                                                                      \
+  MACE_BENCHMARK(                                                        \
+      MACE_BM_EMBEDDING_BAG##_##N##_##B##_##V##_##E##_##TYPE##_##DEVICE)
+
+#define MACE_BM_EMBEDDING_BAG(N, BAG, VOCAB, EMBEDDING) \
+  MACE_BM_EMBEDDING_BAG_MACRO(N, BAG, VOCAB, EMBEDDING, float, CPU);
+
+MACE_BM_EMBEDDING_BAG(1, 100, 48165, 256);
+MACE_BM_EMBEDDING_BAG(64, 64, 200000, 64);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,131 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <random>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/kernels/reduce.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class EmbeddingBagOpTest : public OpsTestBase {};
+
+namespace {
+void TestEmbeddingBag(const kernels::ReduceType type,
+                      const std::vector<index_t> &params_shape,
+                      const std::vector<float> &params,
+                      const std::vector<index_t> &indices_shape,
+                      const std::vector<int32_t> &indices,
+                      const std::vector<int32_t> &offsets,
+                      const std::vector<index_t> &output_shape,
+                      const std::vector<float> &output) {
+  OpsTestNet net;
+  net.AddInputFromArray<CPU, float>("Params", params_shape, params);
+  net.AddInputFromArray<CPU, int32_t>("Indices", indices_shape, indices);
+
+  OpDefBuilder builder("EmbeddingBag", "EmbeddingBagTest");
+  builder.Input("Params").Input("Indices");
+  if (!offsets.empty()) {
+    net.AddInputFromArray<CPU, int32_t>(
+        "Offsets", {static_cast<index_t>(offsets.size())}, offsets);
+    builder.Input("Offsets");
+  }
+  builder.AddIntArg("reduce_type", static_cast<int>(type))
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(CPU);
+
+  auto expected = CreateTensor<float>(output_shape, output);
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5);
+}
+
+// Compare against Gather followed by Reduce over the bag axis.
+void TestEmbeddingBagRandom(const kernels::ReduceType type,
+                            const index_t vocab,
+                            const index_t row_size,
+                            const std::vector<index_t> &indices_shape) {
+  OpsTestNet net;
+  net.AddRandomInput<CPU, float>("Params", {vocab, row_size});
+  index_t index_size = 1;
+  for (index_t dim : indices_shape) index_size *= dim;
+  std::mt19937 gen(index_size);
+  std::uniform_int_distribution<int32_t> dist(0, vocab - 1);
+  std::vector<int32_t> indices(index_size);
+  for (int32_t &index : indices) index = dist(gen);
+  net.AddInputFromArray<CPU, int32_t>("Indices", indices_shape, indices);
+
+  OpDefBuilder("EmbeddingBag", "EmbeddingBagTest")
+      .Input("Params")
+      .Input("Indices")
+      .AddIntArg("reduce_type", static_cast<int>(type))
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(CPU);
+
+  OpDefBuilder("Gather", "GatherTest")
+      .Input("Params")
+      .Input("Indices")
+      .Output("Gathered")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(CPU);
+  OpDefBuilder("Reduce", "ReduceTest")
+      .Input("Gathered")
+      .AddIntArg("reduce_type", static_cast<int>(type))
+      .AddIntsArg("axis", {static_cast<int>(indices_shape.size()) - 1})
+      .Output("Expected")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(CPU);
+
+  ExpectTensorNear<float>(*net.GetOutput("Expected"),
+                          *net.GetOutput("Output"), 1e-4, 1e-4);
+}
+}  // namespace
+
+TEST_F(EmbeddingBagOpTest, CPUSumFixedBags) {
+  TestEmbeddingBag(kernels::REDUCE_SUM,
+                   {5, 2}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9},
+                   {2, 2}, {0, 1, 4, 4}, {},
+                   {2, 2}, {2, 4, 16, 18});
+}
+
+TEST_F(EmbeddingBagOpTest, CPUMeanOffsets) {
+  // the middle bag is empty
+  TestEmbeddingBag(kernels::REDUCE_MEAN,
+                   {5, 2}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9},
+                   {4}, {0, 2, 4, 1}, {0, 2, 2},
+                   {3, 2}, {2, 3, 0, 0, 5, 6});
+}
+
+TEST_F(EmbeddingBagOpTest, CPUHighRankParams) {
+  TestEmbeddingBag(kernels::REDUCE_SUM,
+                   {3, 1, 2}, {0, 1, 2, 3, 4, 5},
+                   {1, 3}, {2, 0, 2}, {},
+                   {1, 1, 2}, {8, 11});
+}
+
+TEST_F(EmbeddingBagOpTest, CPURandom) {
+  TestEmbeddingBagRandom(kernels::REDUCE_SUM, 1000, 67, {16, 37});
+  TestEmbeddingBagRandom(kernels::REDUCE_MEAN, 1000, 67, {16, 37});
+  TestEmbeddingBagRandom(kernels::REDUCE_SUM, 100, 5, {3, 4, 20});
+  TestEmbeddingBagRandom(kernels::REDUCE_MEAN, 5000, 256, {2, 100});
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -16,6 +16,7 @@
 #define MACE_OPS_FULLY_CONNECTED_H_
 
 #include <string>
+#include <vector>
 
 #include "mace/core/operator.h"
 #include "mace/kernels/fully_connected.h"
@@ -31,7 +32,9 @@ class FullyConnectedOp : public Operator<D, T> {
         functor_(kernels::StringToActivationType(
                      OperatorBase::GetOptionalArg<std::string>("activation",
                                                                "NOOP")),
-                 OperatorBase::GetOptionalArg<float>("max_limit", 0.0f)) {}
+                 OperatorBase::GetOptionalArg<float>("max_limit", 0.0f)),
+        sparse_weight_shape_(OperatorBase::GetRepeatedArgs<index_t>(
+            "sparse_weight_shape")) {}
 
   MaceStatus Run(StatsFuture *future) override {
     const Tensor *input = this->Input(INPUT);
@@ -39,7 +42,16 @@ class FullyConnectedOp : public Operator<D, T> {
     const Tensor *bias = this->InputSize() >= 3 ? this->Input(BIAS) : nullptr;
     Tensor *output = this->Output(OUTPUT);
 
-    if (D == DeviceType::CPU) {
+    if (!sparse_weight_shape_.empty()) {
+      const std::vector<index_t> &weight_shape = sparse_weight_shape_;
+      MACE_CHECK(
+          input->dim(1) == weight_shape[1] && input->dim(2) == weight_shape[2]
+              && input->dim(3) == weight_shape[3]
+              && weight_shape[0] == bias->dim(0),
+          "The shape of Input: ", MakeString(input->shape()),
+          "The shape of sparse Weight: ", MakeString(weight_shape),
+          " and Bias ", bias->dim(0), " don't match.");
+    } else if (D == DeviceType::CPU) {
       MACE_CHECK(
           input->dim(1) == weight->dim(1) && input->dim(2) == weight->dim(2) &&
               input->dim(3) == weight->dim(3) && weight->dim(0) == bias->dim(0),
@@ -58,14 +70,29 @@ class FullyConnectedOp : public Operator<D, T> {
     return functor_(input, weight, bias, output, future);
   }
 
+  MaceStatus Init() override { return MaceStatus::MACE_SUCCESS; }
+
  private:
   kernels::FullyConnectedFunctor<D, T> functor_;
+  std::vector<index_t> sparse_weight_shape_;
 
  protected:
-  MACE_OP_INPUT_TAGS(INPUT, WEIGHT, BIAS);
+  MACE_OP_INPUT_TAGS(INPUT, WEIGHT, BIAS, SPARSE_ROW_PTR, SPARSE_COL_IDX);
   MACE_OP_OUTPUT_TAGS(OUTPUT);
 };
 
+template <>
+inline MaceStatus FullyConnectedOp<DeviceType::CPU, float>::Init() {
+  if (!sparse_weight_shape_.empty()) {
+    MACE_CHECK(this->InputSize() == 5, "sparse weight needs bias, row_ptr "
+               "and col_idx inputs");
+    functor_.SetSparseWeight(sparse_weight_shape_,
+                             this->Input(SPARSE_ROW_PTR),
+                             this->Input(SPARSE_COL_IDX));
+  }
+  return MaceStatus::MACE_SUCCESS;
+}
+
 }  // namespace ops
 }  // namespace mace
 
@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <random>
 #include <string>
+#include <vector>
 
 #include "mace/core/operator.h"
 #include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/sparse_gemm.h"
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -80,6 +83,69 @@ void FCBenchmark(
   }
   net.Sync();
 }
+
+// FC with a weight of which `sparsity` percent of the blocks are zero, stored
+// as block-CSR.
+void SparseFCBenchmark(int iters,
+                       int batch,
+                       int channel,
+                       int out_channel,
+                       int block_rows,
+                       int block_cols,
+                       int sparsity) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  std::vector<float> weight(out_channel * channel);
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> ud(0, 99);
+  for (int r = 0; r < out_channel; r += block_rows) {
+    for (int c = 0; c < channel; c += block_cols) {
+      const float value = ud(gen) < sparsity ? 0.f : 1.f;
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          weight[(r + i) * channel + c + j] = value;
+        }
+      }
+    }
+  }
+  std::vector<int32_t> row_ptr;
+  std::vector<int32_t> col_idx;
+  std::vector<float> values;
+  kernels::BlockSparseEncode(weight.data(), out_channel, channel, block_rows,
+                             block_cols, &row_ptr, &col_idx, &values);
+
+  net.AddRandomInput<DeviceType::CPU, float>("Input", {batch, channel, 1, 1});
+  net.AddInputFromArray<DeviceType::CPU, float>(
+      "Weight",
+      {static_cast<index_t>(col_idx.size()), block_rows, block_cols}, values);
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "RowPtr", {static_cast<index_t>(row_ptr.size())}, row_ptr);
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "ColIdx", {static_cast<index_t>(col_idx.size())}, col_idx);
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {out_channel});
+
+  OpDefBuilder("FullyConnected", "FullyConnectedTest")
+      .Input("Input")
+      .Input("Weight")
+      .Input("Bias")
+      .Input("RowPtr")
+      .Input("ColIdx")
+      .Output("Output")
+      .AddIntsArg("sparse_weight_shape", {out_channel, channel, 1, 1})
+      .Finalize(net.NewOperatorDef());
+  net.Setup(DeviceType::CPU);
+
+  // Warm-up
+  for (int i = 0; i < 5; ++i) {
+    net.Run();
+  }
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.Run();
+  }
+}
 }  // namespace
 
 #define MACE_BM_FC_MACRO(N, H, W, C, OC, TYPE, DEVICE)                     \
@@ -105,6 +171,34 @@ MACE_BM_FC(1, 8, 8, 32, 1000);
 MACE_BM_FC(1, 2, 2, 512, 2);
 MACE_BM_FC(1, 7, 7, 512, 2048);
 
+// Small batches, e.g. dynamically batched ranking models
+MACE_BM_FC(1, 1, 1, 1024, 1024);
+MACE_BM_FC(4, 1, 1, 1024, 1024);
+MACE_BM_FC(8, 1, 1, 1024, 1024);
+MACE_BM_FC(16, 1, 1, 1024, 1024);
+MACE_BM_FC(64, 1, 1, 1024, 1024);
+MACE_BM_FC(256, 1, 1, 1024, 1024);
+MACE_BM_FC(16, 1, 1, 4096, 256);
+MACE_BM_FC(16, 1, 1, 256, 4096);
+
+// The MACCs are those of the dense layer, so that the rates compare with the
+// dense ones above.
+#define MACE_BM_SPARSE_FC(N, C, OC, BR, BC, SPARSITY)                        \
+  static void                                                                \
+      MACE_BM_SPARSE_FC_##N##_##C##_##OC##_##BR##x##BC##_##SPARSITY(         \
+          int iters) {                                                       \
+    const int64_t macc = static_cast<int64_t>(iters) * N * C * OC;           \
+    mace::testing::MaccProcessed(macc);                                      \
+    SparseFCBenchmark(iters, N, C, OC, BR, BC, SPARSITY);                    \
+  }                                                                          \
+  MACE_BENCHMARK(MACE_BM_SPARSE_FC_##N##_##C##_##OC##_##BR##x##BC##_##SPARSITY)
+
+MACE_BM_SPARSE_FC(1, 1024, 1024, 4, 1, 70);
+MACE_BM_SPARSE_FC(1, 1024, 1024, 4, 1, 90);
+MACE_BM_SPARSE_FC(1, 1024, 1024, 1, 4, 90);
+MACE_BM_SPARSE_FC(16, 1024, 1024, 4, 1, 90);
+MACE_BM_SPARSE_FC(16, 1024, 1024, 1, 4, 90);
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
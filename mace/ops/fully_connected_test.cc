@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include <fstream>
+#include <random>
+#include <vector>
 
 #include "mace/core/operator.h"
+#include "mace/kernels/sparse_gemm.h"
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -189,6 +192,88 @@ void Random(const index_t batch,
 }
 }  // namespace
 
+namespace {
+// FullyConnected with the weight given as block-CSR versus dense, for a
+// weight with about `sparsity` of its blocks zero.
+void TestSparse(const index_t batch,
+                const index_t height,
+                const index_t width,
+                const index_t channels,
+                const index_t out_channel,
+                const int block_rows,
+                const int block_cols,
+                const float sparsity) {
+  OpsTestNet net;
+  const index_t input_size = channels * height * width;
+  std::vector<index_t> weight_shape = {out_channel, channels, height, width};
+  std::vector<float> weight(out_channel * input_size);
+  std::mt19937 gen(0);
+  std::normal_distribution<float> nd(0, 1);
+  std::uniform_real_distribution<float> ud(0, 1);
+  for (index_t r = 0; r < out_channel; r += block_rows) {
+    for (index_t c = 0; c < input_size; c += block_cols) {
+      const bool zero = ud(gen) < sparsity;
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          weight[(r + i) * input_size + c + j] = zero ? 0.f : nd(gen);
+        }
+      }
+    }
+  }
+  std::vector<int32_t> row_ptr;
+  std::vector<int32_t> col_idx;
+  std::vector<float> values;
+  kernels::BlockSparseEncode(weight.data(), out_channel, input_size,
+                             block_rows, block_cols, &row_ptr, &col_idx,
+                             &values);
+
+  net.AddRandomInput<DeviceType::CPU, float>(
+      "Input", {batch, channels, height, width});
+  net.AddInputFromArray<DeviceType::CPU, float>("Weight", weight_shape, weight);
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {out_channel});
+  net.AddInputFromArray<DeviceType::CPU, float>(
+      "SparseWeight",
+      {static_cast<index_t>(col_idx.size()), block_rows, block_cols}, values);
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "RowPtr", {static_cast<index_t>(row_ptr.size())}, row_ptr);
+  net.AddInputFromArray<DeviceType::CPU, int32_t>(
+      "ColIdx", {static_cast<index_t>(col_idx.size())}, col_idx);
+
+  OpDefBuilder("FullyConnected", "FullyConnectedTest")
+      .Input("Input")
+      .Input("Weight")
+      .Input("Bias")
+      .Output("Output")
+      .AddStringArg("activation", "RELU")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(DeviceType::CPU);
+  Tensor expected;
+  expected.Copy(*net.GetOutput("Output"));
+
+  std::vector<int> sparse_weight_shape(weight_shape.begin(),
+                                       weight_shape.end());
+  OpDefBuilder("FullyConnected", "FullyConnectedTest")
+      .Input("Input")
+      .Input("SparseWeight")
+      .Input("Bias")
+      .Input("RowPtr")
+      .Input("ColIdx")
+      .Output("Output")
+      .AddStringArg("activation", "RELU")
+      .AddIntsArg("sparse_weight_shape", sparse_weight_shape)
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(DeviceType::CPU);
+  ExpectTensorNear<float>(expected, *net.GetOutput("Output"), 1e-4, 1e-4);
+}
+}  // namespace
+
+TEST_F(FullyConnectedOpTest, SparseCPU) {
+  TestSparse(1, 1, 1, 512, 128, 4, 1, 0.8f);
+  TestSparse(1, 1, 1, 512, 128, 1, 4, 0.8f);
+  TestSparse(3, 7, 7, 16, 32, 4, 1, 0.7f);
+  TestSparse(5, 2, 2, 8, 12, 1, 4, 0.9f);
+}
+
 TEST_F(FullyConnectedOpTest, ComplexAligned) {
   Random<float>(1, 16, 16, 32, 16);
   Random<float>(1, 7, 7, 32, 16);
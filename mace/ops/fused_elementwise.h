@@ -0,0 +1,60 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MACE_OPS_FUSED_ELEMENTWISE_H_
+#define MACE_OPS_FUSED_ELEMENTWISE_H_
+
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/kernels/fused_elementwise.h"
+
+namespace mace {
+namespace ops {
+
+// A chain of element-wise ops evaluated in one pass, see
+// kernels::FusedElementwiseType for the steps. Input 0 is the data, the
+// others are the operands of the steps.
+template <DeviceType D, typename T>
+class FusedElementwiseOp : public Operator<D, T> {
+ public:
+  FusedElementwiseOp(const OperatorDef &op_def, Workspace *ws)
+      : Operator<D, T>(op_def, ws),
+        functor_(OperatorBase::GetRepeatedArgs<int>("step_types"),
+                 OperatorBase::GetRepeatedArgs<int>("step_inputs"),
+                 OperatorBase::GetRepeatedArgs<float>("step_values"),
+                 static_cast<DataFormat>(OperatorBase::GetOptionalArg<int>(
+                     "data_format", 0))) {}
+
+  MaceStatus Run(StatsFuture *future) override {
+    const Tensor *input = this->Input(0);
+    std::vector<const Tensor *> operands;
+    for (int i = 1; i < this->InputSize(); ++i) {
+      operands.push_back(this->Input(i));
+    }
+    Tensor *output = this->Output(OUTPUT);
+    return functor_(input, operands, output, future);
+  }
+
+ private:
+  kernels::FusedElementwiseFunctor<D, T> functor_;
+
+ private:
+  MACE_OP_OUTPUT_TAGS(OUTPUT);
+};
+
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_FUSED_ELEMENTWISE_H_
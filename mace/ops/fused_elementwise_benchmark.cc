@@ -0,0 +1,124 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/eltwise.h"
+#include "mace/kernels/fused_elementwise.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+// A chain of `steps` ops repeating x * scale[c], x + offset[c], relu on an
+// NCHW tensor, as separate Eltwise / Activation ops or one FusedElementwise.
+template <DeviceType D>
+void FusedElementwise(
+    int iters, int batch, int channels, int height, int width, int steps,
+    bool fused) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  net.AddRandomInput<D, float>("Input", {batch, channels, height, width});
+  net.AddRandomInput<D, float>("Scale", {channels});
+  net.AddRandomInput<D, float>("Offset", {channels});
+
+  if (fused) {
+    std::vector<int> step_types;
+    std::vector<int> step_inputs;
+    for (int i = 0; i < steps; ++i) {
+      step_types.push_back(i % 3 == 0 ? kernels::FUSED_MUL :
+                           i % 3 == 1 ? kernels::FUSED_ADD :
+                                        kernels::FUSED_RELU);
+      step_inputs.push_back(i % 3 == 2 ? 0 : i % 3 + 1);
+    }
+    OpDefBuilder("FusedElementwise", "FusedElementwiseBM")
+        .Input("Input")
+        .Input("Scale")
+        .Input("Offset")
+        .AddIntsArg("step_types", step_types)
+        .AddIntsArg("step_inputs", step_inputs)
+        .AddFloatsArg("step_values", std::vector<float>(steps, 0.f))
+        .AddIntArg("data_format", NCHW)
+        .Output("Output")
+        .Finalize(net.NewOperatorDef());
+  } else {
+    std::string input = "Input";
+    for (int i = 0; i < steps; ++i) {
+      const std::string output = "Output" + MakeString(i);
+      OperatorDef *op_def =
+          i == 0 ? net.NewOperatorDef() : net.AddNewOperatorDef();
+      if (i % 3 == 2) {
+        OpDefBuilder("Activation", "ReluBM" + MakeString(i))
+            .Input(input)
+            .AddStringArg("activation", "RELU")
+            .Output(output)
+            .Finalize(op_def);
+      } else {
+        OpDefBuilder("Eltwise", "EltwiseBM" + MakeString(i))
+            .Input(input)
+            .Input(i % 3 == 0 ? "Scale" : "Offset")
+            .AddIntArg("type", i % 3 == 0 ? kernels::EltwiseType::PROD
+                                          : kernels::EltwiseType::SUM)
+            .AddIntArg("data_format", NCHW)
+            .Output(output)
+            .Finalize(op_def);
+      }
+      input = output;
+    }
+  }
+
+  // Warm-up
+  for (int i = 0; i < 5; ++i) {
+    net.RunOp(D);
+  }
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.RunOp(D);
+  }
+}
+}  // namespace
+
+#define MACE_BM_FUSED_ELEMENTWISE_MACRO(N, C, H, W, STEPS, FUSED, DEVICE)     \
+  static void                                                                 \
+      MACE_BM_FUSED_ELEMENTWISE_##N##_##C##_##H##_##W##_##STEPS##_##FUSED##_##\
+      DEVICE(int iters) {                                                     \
+    const int64_t tot =                                                       \
+        static_cast<int64_t>(iters) * N * C * H * W * STEPS;                  \
+    mace::testing::MaccProcessed(tot);                                        \
+    mace::testing::BytesProcessed(tot *(sizeof(float)));                      \
+    FusedElementwise<DEVICE>(iters, N, C, H, W, STEPS, FUSED);                \
+  }                                                                           \
+  MACE_BENCHMARK(                                                             \
+      MACE_BM_FUSED_ELEMENTWISE_##N##_##C##_##H##_##W##_##STEPS##_##FUSED##_##\
+      DEVICE)
+
+#define MACE_BM_FUSED_ELEMENTWISE(N, C, H, W, STEPS)                   \
+  MACE_BM_FUSED_ELEMENTWISE_MACRO(N, C, H, W, STEPS, false, CPU);      \
+  MACE_BM_FUSED_ELEMENTWISE_MACRO(N, C, H, W, STEPS, true, CPU);
+
+MACE_BM_FUSED_ELEMENTWISE(1, 64, 112, 112, 3);
+MACE_BM_FUSED_ELEMENTWISE(1, 64, 112, 112, 6);
+MACE_BM_FUSED_ELEMENTWISE(1, 256, 28, 28, 3);
+MACE_BM_FUSED_ELEMENTWISE(1, 512, 7, 7, 3);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,166 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/kernels/fused_elementwise.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class FusedElementwiseOpTest : public OpsTestBase {};
+
+namespace {
+float FusedStepRef(const kernels::FusedElementwiseType type,
+                   const float x,
+                   const float a) {
+  switch (type) {
+    case kernels::FUSED_ADD: return x + a;
+    case kernels::FUSED_SUB: return x - a;
+    case kernels::FUSED_RSUB: return a - x;
+    case kernels::FUSED_MUL: return x * a;
+    case kernels::FUSED_DIV: return x / a;
+    case kernels::FUSED_RDIV: return a / x;
+    case kernels::FUSED_MIN: return std::min(x, a);
+    case kernels::FUSED_MAX: return std::max(x, a);
+    case kernels::FUSED_SQR_DIFF: return (x - a) * (x - a);
+    case kernels::FUSED_POW: return std::pow(x, a);
+    case kernels::FUSED_NEG: return -x;
+    case kernels::FUSED_ABS: return std::fabs(x);
+    case kernels::FUSED_RELU: return std::max(x, 0.f);
+    case kernels::FUSED_RELUX: return std::min(std::max(x, 0.f), a);
+    case kernels::FUSED_PRELU: return x < 0 ? x * a : x;
+    case kernels::FUSED_TANH: return std::tanh(x);
+    case kernels::FUSED_SIGMOID: return 1.f / (1.f + std::exp(-x));
+    default:
+      LOG(FATAL) << "Unknown step type " << type;
+      return 0;
+  }
+}
+
+// step_inputs[i] > 0 makes step i take a random per channel operand
+void TestFusedElementwise(const std::vector<index_t> &shape,
+                          const DataFormat data_format,
+                          const std::vector<int> &step_types,
+                          const std::vector<int> &step_inputs,
+                          const std::vector<float> &step_values) {
+  const int rank = static_cast<int>(shape.size());
+  const int channel_axis = data_format == NCHW && rank == 4 ? 1 : rank - 1;
+  const index_t channels = shape[channel_axis];
+  index_t inner_size = 1;
+  for (int i = channel_axis + 1; i < rank; ++i) {
+    inner_size *= shape[i];
+  }
+
+  std::mt19937 rng(static_cast<unsigned int>(step_types.size() + rank));
+  std::uniform_real_distribution<float> dist(0.5f, 2.f);
+  std::uniform_int_distribution<int> sign(0, 1);
+  auto random_data = [&](const index_t size) {
+    std::vector<float> data(size);
+    for (auto &value : data) {
+      value = sign(rng) ? dist(rng) : -dist(rng);
+    }
+    return data;
+  };
+
+  OpsTestNet net;
+  const std::vector<float> input =
+      random_data(std::accumulate(shape.begin(), shape.end(), 1,
+                                  std::multiplies<index_t>()));
+  net.AddInputFromArray<DeviceType::CPU, float>("Input", shape, input);
+  OpDefBuilder builder("FusedElementwise", "FusedElementwiseTest");
+  builder.Input("Input");
+  const int operand_count =
+      *std::max_element(step_inputs.begin(), step_inputs.end());
+  std::vector<std::vector<float>> operands;
+  for (int i = 0; i < operand_count; ++i) {
+    operands.push_back(random_data(channels));
+    const std::string name = "Operand" + MakeString(i);
+    net.AddInputFromArray<DeviceType::CPU, float>(name, {channels},
+                                                  operands.back());
+    builder.Input(name);
+  }
+  builder.AddIntsArg("step_types", step_types)
+      .AddIntsArg("step_inputs", step_inputs)
+      .AddFloatsArg("step_values", step_values)
+      .AddIntArg("data_format", data_format)
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp(DeviceType::CPU);
+
+  std::vector<float> expected(input.size());
+  for (size_t i = 0; i < input.size(); ++i) {
+    const index_t c = (i / inner_size) % channels;
+    float x = input[i];
+    for (size_t s = 0; s < step_types.size(); ++s) {
+      const float a = step_inputs[s] > 0 ? operands[step_inputs[s] - 1][c]
+                                         : step_values[s];
+      x = FusedStepRef(static_cast<kernels::FusedElementwiseType>(
+                           step_types[s]), x, a);
+    }
+    expected[i] = x;
+  }
+  auto expected_tensor = CreateTensor<float>(shape, expected);
+  ExpectTensorNear<float>(*expected_tensor, *net.GetOutput("Output"), 1e-5,
+                          1e-5);
+}
+}  // namespace
+
+TEST_F(FusedElementwiseOpTest, BatchNormRelu) {
+  // x * scale + offset, relu: NCHW planes, small NCHW channels and NHWC
+  const std::vector<int> types = {kernels::FUSED_MUL, kernels::FUSED_ADD,
+                                  kernels::FUSED_RELU};
+  TestFusedElementwise({2, 5, 31, 37}, NCHW, types, {1, 2, 0}, {0, 0, 0});
+  TestFusedElementwise({2, 5, 3, 3}, NCHW, types, {1, 2, 0}, {0, 0, 0});
+  TestFusedElementwise({2, 3, 7, 13}, NHWC, types, {1, 2, 0}, {0, 0, 0});
+  TestFusedElementwise({3, 2000}, NHWC, types, {1, 2, 0}, {0, 0, 0});
+}
+
+TEST_F(FusedElementwiseOpTest, AllSteps) {
+  TestFusedElementwise(
+      {1, 4, 17, 19}, NCHW,
+      {kernels::FUSED_SUB, kernels::FUSED_RSUB, kernels::FUSED_DIV,
+       kernels::FUSED_RDIV, kernels::FUSED_MIN, kernels::FUSED_MAX,
+       kernels::FUSED_SQR_DIFF, kernels::FUSED_NEG, kernels::FUSED_ABS,
+       kernels::FUSED_POW, kernels::FUSED_PRELU, kernels::FUSED_RELUX,
+       kernels::FUSED_TANH, kernels::FUSED_SIGMOID},
+      {1, 0, 2, 0, 3, 0, 1, 0, 0, 0, 2, 0, 0, 0},
+      {0, 1.5, 0, 2, 0, -1, 0, 0, 0, 0.5, 0, 0.8, 0, 0});
+  TestFusedElementwise(
+      {2, 9, 5, 6}, NHWC,
+      {kernels::FUSED_ADD, kernels::FUSED_PRELU, kernels::FUSED_MUL,
+       kernels::FUSED_ABS, kernels::FUSED_POW, kernels::FUSED_RELUX},
+      {1, 2, 0, 0, 0, 0}, {0, 0, -2, 0, 2, 1.5});
+}
+
+TEST_F(FusedElementwiseOpTest, ScalarSteps) {
+  const std::vector<int> types = {kernels::FUSED_MUL, kernels::FUSED_ADD,
+                                  kernels::FUSED_TANH};
+  TestFusedElementwise({1, 3, 64, 64}, NCHW, types, {0, 0, 0},
+                       {0.5, -0.2, 0});
+  TestFusedElementwise({7}, NHWC, types, {0, 0, 0}, {0.5, -0.2, 0});
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
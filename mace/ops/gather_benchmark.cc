@@ -81,6 +81,7 @@ void GatherBenchmark(int iters,
 MACE_BM_GATHER(1, 7, 48165, 256);
 MACE_BM_GATHER(1, 20, 48165, 256);
 MACE_BM_GATHER(1, 100, 48165, 256);
+MACE_BM_GATHER(1, 4096, 200000, 64);
 
 }  // namespace test
 }  // namespace ops
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <fstream>
+#include <random>
+#include <vector>
 
 #include "mace/core/operator.h"
 #include "mace/ops/ops_test_util.h"
@@ -77,6 +79,28 @@ TEST_F(GatherOpTest, CPURankHighIndex) {
              {1, 3}, {2, 4, 6}, 0, 1.0, {1, 3, 2}, {4, 5, 8, 9, 12, 13});
 }
 
+TEST_F(GatherOpTest, CPURandomScaled) {
+  // enough indices for several blocks, rows not a multiple of the vector
+  const index_t vocab = 1000;
+  const index_t row_size = 67;
+  const index_t index_size = 300;
+  std::mt19937 gen(index_size);
+  std::uniform_real_distribution<float> value_dist(-1.f, 1.f);
+  std::uniform_int_distribution<int32_t> index_dist(0, vocab - 1);
+  std::vector<float> params(vocab * row_size);
+  for (float &value : params) value = value_dist(gen);
+  std::vector<int32_t> indices(index_size);
+  for (int32_t &index : indices) index = index_dist(gen);
+  std::vector<float> expected(index_size * row_size);
+  for (index_t i = 0; i < index_size; ++i) {
+    for (index_t j = 0; j < row_size; ++j) {
+      expected[i * row_size + j] = 0.5f * params[indices[i] * row_size + j];
+    }
+  }
+  TestGather({vocab, row_size}, params, {3, index_size / 3}, indices, 0, 0.5,
+             {3, index_size / 3, row_size}, expected);
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
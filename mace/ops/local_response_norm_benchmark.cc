@@ -22,7 +22,8 @@ namespace test {
 
 template <DeviceType D, typename T>
 static void LocalResponseNorm(
-    int iters, int batch, int channels, int height, int width) {
+    int iters, int batch, int channels, int height, int width,
+    float beta = 0.5f) {
   mace::testing::StopTiming();
 
   OpsTestNet net;
@@ -34,6 +35,7 @@ static void LocalResponseNorm(
 
   OpDefBuilder("LocalResponseNorm", "LocalResponseNormBM")
       .Input("Input")
+      .AddFloatArg("beta", beta)
       .Output("Output")
       .Finalize(net.NewOperatorDef());
 
@@ -70,6 +72,19 @@ static void LocalResponseNorm(
 #define MACE_BM_LOCAL_RESPONSE_NORM(N, C, H, W)                 \
   MACE_BM_LOCAL_RESPONSE_NORM_MACRO(N, C, H, W, float, CPU);
 
+// BETA is beta * 100, e.g. 75 for the AlexNet/GoogLeNet beta of 0.75
+#define MACE_BM_LOCAL_RESPONSE_NORM_BETA(N, C, H, W, BETA)                    \
+  static void                                                                  \
+      MACE_BM_LOCAL_RESPONSE_NORM_##N##_##C##_##H##_##W##_BETA##BETA(          \
+          int iters) {                                                         \
+    const int64_t tot = static_cast<int64_t>(iters) * N * C * H * W;           \
+    mace::testing::MaccProcessed(tot);                                         \
+    mace::testing::BytesProcessed(tot *(sizeof(float)));                       \
+    LocalResponseNorm<CPU, float>(iters, N, C, H, W, BETA / 100.f);            \
+  }                                                                            \
+  MACE_BENCHMARK(                                                              \
+      MACE_BM_LOCAL_RESPONSE_NORM_##N##_##C##_##H##_##W##_BETA##BETA)
+
 MACE_BM_LOCAL_RESPONSE_NORM(1, 1, 512, 512);
 MACE_BM_LOCAL_RESPONSE_NORM(1, 3, 128, 128);
 MACE_BM_LOCAL_RESPONSE_NORM(1, 3, 512, 512);
@@ -83,6 +98,9 @@ MACE_BM_LOCAL_RESPONSE_NORM(1, 512, 14, 14);
 MACE_BM_LOCAL_RESPONSE_NORM(1, 1024, 7, 7);
 MACE_BM_LOCAL_RESPONSE_NORM(32, 1, 256, 256);
 MACE_BM_LOCAL_RESPONSE_NORM(32, 3, 256, 256);
+MACE_BM_LOCAL_RESPONSE_NORM_BETA(1, 96, 55, 55, 75);
+MACE_BM_LOCAL_RESPONSE_NORM_BETA(1, 192, 56, 56, 75);
+MACE_BM_LOCAL_RESPONSE_NORM_BETA(1, 256, 27, 27, 60);
 
 }  // namespace test
 }  // namespace ops
@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "mace/core/operator.h"
 #include "mace/ops/ops_test_util.h"
 
@@ -55,6 +59,64 @@ void Simple() {
 
 TEST_F(LocalResponseNormOpTest, SimpleCPU) { Simple<DeviceType::CPU>(); }
 
+namespace {
+void RandomTest(const std::vector<index_t> &shape,
+                int depth_radius,
+                float bias,
+                float alpha,
+                float beta) {
+  OpsTestNet net;
+
+  // Add input data
+  net.AddRandomInput<DeviceType::CPU, float>("Input", shape);
+
+  OpDefBuilder("LocalResponseNorm", "LocalResponseNormTest")
+      .Input("Input")
+      .AddIntArg("depth_radius", depth_radius)
+      .AddFloatArg("bias", bias)
+      .AddFloatArg("alpha", alpha)
+      .AddFloatArg("beta", beta)
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+  // Run
+  net.RunOp(DeviceType::CPU);
+
+  // Reference: sum the window from scratch for every element
+  const index_t channels = shape[1];
+  const index_t image_size = shape[2] * shape[3];
+  const float *input = net.GetTensor("Input")->data<float>();
+  std::vector<float> expected(shape[0] * channels * image_size);
+  for (index_t b = 0; b < shape[0]; ++b) {
+    for (index_t c = 0; c < channels; ++c) {
+      for (index_t hw = 0; hw < image_size; ++hw) {
+        double accum = 0;
+        for (index_t k = std::max<index_t>(0, c - depth_radius);
+             k < std::min<index_t>(channels, c + depth_radius + 1); ++k) {
+          const float val = input[(b * channels + k) * image_size + hw];
+          accum += val * val;
+        }
+        const index_t idx = (b * channels + c) * image_size + hw;
+        expected[idx] = input[idx] * std::pow(bias + alpha * accum, -beta);
+      }
+    }
+  }
+  auto expected_tensor = CreateTensor<float>(shape, expected);
+
+  ExpectTensorNear<float>(*expected_tensor, *net.GetOutput("Output"), 1e-5,
+                          1e-4);
+}
+}  // namespace
+
+TEST_F(LocalResponseNormOpTest, RandomCPU) {
+  RandomTest({1, 3, 7, 9}, 5, 1.0f, 1.0f, 0.5f);
+  RandomTest({2, 17, 13, 11}, 2, 2.0f, 1e-4f, 0.75f);
+  RandomTest({1, 150, 5, 7}, 5, 1.0f, 0.5f, 0.75f);
+  RandomTest({2, 70, 37, 41}, 3, 1.0f, 0.1f, 0.5f);
+  RandomTest({1, 9, 16, 16}, 1, 0.5f, 1.0f, 1.0f);
+  RandomTest({1, 9, 5, 5}, 4, 1.0f, 0.3f, 0.6f);
+  RandomTest({1, 9, 5, 5}, 2, 1.0f, 0.3f, 0.f);
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -49,6 +49,8 @@ class MatMulOp : public Operator<D, T> {
     return functor_(A, B, C, transpose_a_, transpose_b_, future);
   }
 
+  MaceStatus Init() override { return MaceStatus::MACE_SUCCESS; }
+
  private:
   MACE_OP_INPUT_TAGS(INPUT_A, INPUT_B);
   MACE_OP_OUTPUT_TAGS(OUTPUT);
@@ -58,6 +60,21 @@ class MatMulOp : public Operator<D, T> {
   bool transpose_b_;
 };
 
+template <>
+inline MaceStatus MatMulOp<DeviceType::CPU, float>::Init() {
+  const Tensor *A = this->Input(INPUT_A);
+  const Tensor *B = this->Input(INPUT_B);
+  if (A->is_weight()) {
+    MACE_RETURN_IF_ERROR(functor_.PackA(
+        A, transpose_a_, this->InPlacePackableWeight(INPUT_A)));
+  }
+  if (B->is_weight()) {
+    MACE_RETURN_IF_ERROR(functor_.PackB(
+        B, transpose_b_, this->InPlacePackableWeight(INPUT_B)));
+  }
+  return MaceStatus::MACE_SUCCESS;
+}
+
 }  // namespace ops
 }  // namespace mace
 
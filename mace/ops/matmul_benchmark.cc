@@ -68,7 +68,8 @@ void MatMulBenchmark(
 
 template <DeviceType D, typename T>
 void MatMulTransposeBenchmark(
-    int iters, int batch, int height, int channels, int out_width) {
+    int iters, int batch, int height, int channels, int out_width,
+    bool is_weight) {
   mace::testing::StopTiming();
 
   OpsTestNet net;
@@ -76,6 +77,7 @@ void MatMulTransposeBenchmark(
   // Add input data
   net.AddRandomInput<D, float>("A", {batch, height, channels});
   net.AddRandomInput<D, float>("B", {batch, out_width, channels});
+  net.GetTensor("B")->SetIsWeight(is_weight);
 
   if (D == DeviceType::CPU) {
     OpDefBuilder("MatMul", "MatMulBM")
@@ -87,16 +89,17 @@ void MatMulTransposeBenchmark(
   } else {
     MACE_NOT_IMPLEMENTED;
   }
+  net.Setup(D);
 
   // Warm-up
   for (int i = 0; i < 5; ++i) {
-    net.RunOp(D);
+    net.Run();
   }
   net.Sync();
 
   mace::testing::StartTiming();
   while (iters--) {
-    net.RunOp(D);
+    net.Run();
   }
   net.Sync();
 }
@@ -118,19 +121,27 @@ void MatMulTransposeBenchmark(
   MACE_BM_MATMUL_MACRO(N, H, C, W, float, GPU);    \
   MACE_BM_MATMUL_MACRO(N, H, C, W, half, GPU);
 
-#define MACE_BM_MATMUL_TRANSPOSE_MACRO(N, H, C, W, TYPE, DEVICE)               \
-  static void MACE_BM_MATMUL_##T_##N##_##H##_##C##_##W##_##TYPE##_##DEVICE(    \
+// B is either an input Gemm transposes on every run or a const weight packed
+// once at init.
+enum MatMulOperand { INPUT, WEIGHT };
+
+#define MACE_BM_MATMUL_TRANSPOSE_MACRO(N, H, C, W, B, TYPE, DEVICE)            \
+  static void                                                                  \
+  MACE_BM_MATMUL_##T_##N##_##H##_##C##_##W##_##B##_##TYPE##_##DEVICE(          \
       int iters) {                                                             \
     const int64_t macc = static_cast<int64_t>(iters) * N * C * H * W;          \
     const int64_t tot = static_cast<int64_t>(iters) * N * (C * H + H * W);     \
     mace::testing::MaccProcessed(macc);                                        \
     mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                        \
-    MatMulTransposeBenchmark<DEVICE, TYPE>(iters, N, H, C, W);                 \
+    MatMulTransposeBenchmark<DEVICE, TYPE>(iters, N, H, C, W,                  \
+                                           B == WEIGHT);                       \
   }                                                                            \
-  MACE_BENCHMARK(MACE_BM_MATMUL_##T_##N##_##H##_##C##_##W##_##TYPE##_##DEVICE)
+  MACE_BENCHMARK(                                                              \
+      MACE_BM_MATMUL_##T_##N##_##H##_##C##_##W##_##B##_##TYPE##_##DEVICE)
 
-#define MACE_BM_MATMUL_TRANPOSE(N, H, C, W)                   \
-  MACE_BM_MATMUL_TRANSPOSE_MACRO(N, H, C, W, float, CPU);
+#define MACE_BM_MATMUL_TRANPOSE(N, H, C, W)                         \
+  MACE_BM_MATMUL_TRANSPOSE_MACRO(N, H, C, W, INPUT, float, CPU);    \
+  MACE_BM_MATMUL_TRANSPOSE_MACRO(N, H, C, W, WEIGHT, float, CPU);
 
 MACE_BM_MATMUL(16, 32, 128, 49);
 MACE_BM_MATMUL(16, 32, 128, 961);
@@ -145,6 +156,7 @@ MACE_BM_MATMUL_TRANPOSE(16, 32, 128, 3969);
 MACE_BM_MATMUL_TRANPOSE(16, 128, 128, 49);
 MACE_BM_MATMUL_TRANPOSE(16, 128, 128, 961);
 MACE_BM_MATMUL_TRANPOSE(16, 128, 128, 3969);
+MACE_BM_MATMUL_TRANPOSE(1, 32, 1024, 1024);
 
 }  // namespace test
 }  // namespace ops
@@ -15,7 +15,9 @@
 #include <fstream>
 
 #include "mace/core/operator.h"
+#include "mace/kernels/gemm.h"
 #include "mace/ops/ops_test_util.h"
+#include "mace/public/mace_runtime.h"
 
 namespace mace {
 namespace ops {
@@ -213,6 +215,72 @@ TEST_F(MatMulOpTest, OPENCLHalfUnAlignedWithBatch) {
   Complex<half>({2, 3}, 31, 61, 67);
 }
 
+namespace {
+void PackedWeight(const bool transpose_a, const bool keep_unpacked_weights) {
+  const index_t batch = 2;
+  const index_t height = 17;
+  const index_t K = 70;
+  const index_t width = 97;
+
+  // Construct graph
+  OpsTestNet net;
+
+  // Add input data
+  if (transpose_a) {
+    net.AddRandomInput<DeviceType::CPU, float>("A", {batch, K, height});
+  } else {
+    net.AddRandomInput<DeviceType::CPU, float>("A", {batch, height, K});
+  }
+  net.AddRandomInput<DeviceType::CPU, float>("B", {batch, width, K});
+
+  OpDefBuilder("MatMul", "MatMulTest")
+      .Input("A")
+      .Input("B")
+      .Output("Output")
+      .AddIntArg("transpose_a", transpose_a)
+      .AddIntArg("transpose_b", 1)
+      .Finalize(net.NewOperatorDef());
+
+  // Run with B transposed by Gemm
+  net.RunOp();
+  Tensor expected;
+  expected.Copy(*net.GetOutput("Output"));
+  Tensor unpacked_b;
+  unpacked_b.Copy(*net.GetTensor("B"));
+
+  // Run with B (and A) packed at init
+  net.GetTensor("A")->SetIsWeight(transpose_a);
+  net.GetTensor("B")->SetIsWeight(true);
+  SetKeepUnpackedWeights(keep_unpacked_weights);
+  net.Setup(DeviceType::CPU);
+  SetKeepUnpackedWeights(true);
+  net.Run();
+  net.Run();
+
+  // Check
+  ExpectTensorNear<float>(expected, *net.GetOutput("Output"), 1e-5);
+  if (keep_unpacked_weights) {
+    ExpectTensorNear<float>(unpacked_b, *net.GetTensor("B"));
+  } else {
+    Tensor packed_b;
+    packed_b.Resize(unpacked_b.shape());
+    kernels::GemmPackB(unpacked_b.data<float>(), batch, K, width, true,
+                       packed_b.mutable_data<float>());
+    ExpectTensorNear<float>(packed_b, *net.GetTensor("B"));
+  }
+}
+}  // namespace
+
+TEST_F(MatMulOpTest, PackedWeightCPU) {
+  PackedWeight(false, true);
+  PackedWeight(true, true);
+}
+
+TEST_F(MatMulOpTest, PackedWeightInPlaceCPU) {
+  PackedWeight(false, false);
+  PackedWeight(true, false);
+}
+
 // TODO(liyin): test transpose after implementing gpu runtime
 // now transpose test is in kernels_test
 
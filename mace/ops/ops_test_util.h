@@ -353,7 +353,7 @@ class OpsTestNet {
     }
     net_ = CreateNet(op_registry_, net_def, &ws_, device);
     device_ = device;
-    return net_ != nullptr;
+    return net_ != nullptr && net_->Init() == MaceStatus::MACE_SUCCESS;
   }
 
   MaceStatus Run() {
@@ -379,6 +379,7 @@ class OpsTestNet {
     net_ = CreateNet(op_registry_, net_def, &ws_, device, NetMode::INIT);
     MACE_RETURN_IF_ERROR(net_->Run());
     net_ = CreateNet(op_registry_, net_def, &ws_, device);
+    MACE_RETURN_IF_ERROR(net_->Init());
     return net_->Run();
   }
 
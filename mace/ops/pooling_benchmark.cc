@@ -112,6 +112,13 @@ MACE_BM_POOLING(1, 3, 257, 257, 2, 2, SAME, MAX);
 MACE_BM_POOLING(1, 3, 513, 513, 2, 2, SAME, MAX);
 MACE_BM_POOLING(1, 3, 1025, 1025, 2, 2, SAME, MAX);
 MACE_BM_POOLING(1, 32, 480, 640, 480, 640, VALID, AVG);
+MACE_BM_POOLING(1, 64, 112, 112, 3, 2, SAME, MAX);
+MACE_BM_POOLING(1, 64, 56, 56, 3, 1, SAME, MAX);
+MACE_BM_POOLING(1, 128, 56, 56, 2, 2, VALID, AVG);
+MACE_BM_POOLING(1, 192, 28, 28, 3, 1, SAME, AVG);
+MACE_BM_POOLING(1, 256, 28, 28, 3, 2, VALID, AVG);
+MACE_BM_POOLING(1, 1024, 7, 7, 7, 1, VALID, AVG);
+MACE_BM_POOLING(1, 2048, 7, 7, 7, 1, VALID, MAX);
 
 }  // namespace test
 }  // namespace ops
@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <functional>
+#include <numeric>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "mace/core/operator.h"
@@ -333,6 +337,78 @@ TEST_F(PoolingOpTest, AVG_VALID) {
   ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5);
 }
 
+namespace {
+// The specialized CPU kernels against the generic loops of the functor
+void TestCPUPoolingKernel(const std::vector<index_t> &shape,
+                          const std::vector<int> &kernels,
+                          const int stride,
+                          const Padding padding,
+                          const PoolingType pooling_type) {
+  OpsTestNet net;
+  net.AddRandomInput<CPU, float>("Input", shape);
+  OpDefBuilder("Pooling", "PoolingTest")
+      .Input("Input")
+      .Output("Output")
+      .AddIntArg("pooling_type", pooling_type)
+      .AddIntsArg("kernels", kernels)
+      .AddIntsArg("strides", {stride, stride})
+      .AddIntArg("padding", padding)
+      .AddIntsArg("dilations", {1, 1})
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+
+  const int strides[2] = {stride, stride};
+  const int dilations[2] = {1, 1};
+  std::vector<index_t> filter_shape = {shape[1], shape[1], kernels[0],
+                                       kernels[1]};
+  std::vector<index_t> output_shape(4);
+  std::vector<int> paddings(2);
+  kernels::CalcNCHWPaddingAndOutputSize(shape.data(), filter_shape.data(),
+                                        dilations, strides, padding,
+                                        output_shape.data(), paddings.data());
+  const int pad_hw[2] = {paddings[0] / 2, paddings[1] / 2};
+
+  auto expected = CreateTensor<float>(
+      output_shape,
+      std::vector<float>(std::accumulate(output_shape.begin(),
+                                         output_shape.end(), 1,
+                                         std::multiplies<index_t>())));
+  kernels::PoolingFunctor<CPU, float> functor(pooling_type, kernels.data(),
+                                              strides, padding, {},
+                                              dilations);
+  const float *input = net.GetTensor("Input")->data<float>();
+  if (pooling_type == PoolingType::MAX) {
+    functor.MaxPooling(input, shape.data(), output_shape.data(),
+                       kernels.data(), strides, dilations, pad_hw,
+                       expected->mutable_data<float>());
+  } else {
+    functor.AvgPooling(input, shape.data(), output_shape.data(),
+                       kernels.data(), strides, dilations, pad_hw,
+                       expected->mutable_data<float>());
+  }
+
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"), 1e-5);
+}
+}  // namespace
+
+TEST_F(PoolingOpTest, CPUPoolingKernels) {
+  for (PoolingType pooling_type : {PoolingType::MAX, PoolingType::AVG}) {
+    for (Padding padding : {Padding::VALID, Padding::SAME}) {
+      for (auto shape : std::vector<std::vector<index_t>>{
+               {1, 1, 3, 4}, {1, 3, 7, 9}, {2, 5, 31, 34}, {1, 4, 64, 67}}) {
+        TestCPUPoolingKernel(shape, {2, 2}, 2, padding, pooling_type);
+        TestCPUPoolingKernel(shape, {3, 3}, 1, padding, pooling_type);
+        TestCPUPoolingKernel(shape, {3, 3}, 2, padding, pooling_type);
+      }
+    }
+    // global
+    TestCPUPoolingKernel({2, 5, 7, 7}, {7, 7}, 1, Padding::VALID,
+                         pooling_type);
+    TestCPUPoolingKernel({1, 3, 13, 29}, {13, 29}, 2, Padding::VALID,
+                         pooling_type);
+  }
+}
+
 namespace {
 template <DeviceType D>
 void SimpleAvgPoolingTest() {
@@ -0,0 +1,85 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+template <DeviceType D, typename T>
+void Proposal(int iters, int height, int width, int pre_nms_top_n,
+              int post_nms_top_n) {
+  mace::testing::StopTiming();
+
+  const int feat_stride = 16;
+  OpsTestNet net;
+  OpDefBuilder("Proposal", "ProposalBM")
+      .Input("RpnCLSProb")
+      .Input("RpnBBoxPred")
+      .Input("ImgInfo")
+      .AddIntArg("min_size", 16)
+      .AddFloatArg("nms_thresh", 0.7)
+      .AddIntArg("pre_nms_top_n", pre_nms_top_n)
+      .AddIntArg("post_nms_top_n", post_nms_top_n)
+      .AddIntArg("feat_stride", feat_stride)
+      .AddIntArg("base_size", 16)
+      .AddIntsArg("scales", {8, 16, 32})
+      .AddFloatsArg("ratios", {0.5, 1, 2})
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+
+  // Add input data
+  net.AddRandomInput<D, float>("RpnCLSProb", {1, height, width, 18}, true);
+  net.AddRandomInput<D, float>("RpnBBoxPred", {1, height, width, 4 * 9},
+                              false);
+  net.AddInputFromArray<D, float>(
+      "ImgInfo", {1, 1, 1, 3},
+      {static_cast<float>(height * feat_stride),
+       static_cast<float>(width * feat_stride), 1});
+
+  // Warm-up
+  for (int i = 0; i < 2; ++i) {
+    net.RunOp(D);
+  }
+  net.Sync();
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.RunOp(D);
+  }
+  net.Sync();
+}
+}  // namespace
+
+#define MACE_BM_PROPOSAL_MACRO(H, W, PRE, POST)                             \
+  static void MACE_BM_PROPOSAL_##H##_##W##_##PRE##_##POST(int iters) {      \
+    mace::testing::MaccProcessed(static_cast<int64_t>(iters) * H * W * 9);  \
+    Proposal<DeviceType::CPU, float>(iters, H, W, PRE, POST);               \
+  }                                                                         \
+  MACE_BENCHMARK(MACE_BM_PROPOSAL_##H##_##W##_##PRE##_##POST)
+
+// 600x800 and 1024x1024 images at stride 16
+MACE_BM_PROPOSAL_MACRO(38, 50, 6000, 300);
+MACE_BM_PROPOSAL_MACRO(64, 64, 12000, 2000);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
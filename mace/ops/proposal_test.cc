@@ -12,7 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "mace/core/operator.h"
+#include "mace/kernels/proposal.h"
 #include "mace/ops/ops_test_util.h"
 
 namespace mace {
@@ -65,6 +70,61 @@ TEST_F(ProposalOpTest, CPUSimple) {
   ExpectTensorNear<float>(*expected_tensor, *net.GetTensor("Output"), 1e-5);
 }
 
+namespace {
+std::vector<int> GreedyNMS(const std::vector<float> &bboxes,
+                           const float thresh,
+                           const int max_keep) {
+  const int num = static_cast<int>(bboxes.size() / 4);
+  std::vector<int> keep;
+  std::vector<bool> suppressed(num, false);
+  for (int i = 0; i < num && static_cast<int>(keep.size()) < max_keep; ++i) {
+    if (suppressed[i]) continue;
+    keep.push_back(i);
+    const float *a = bboxes.data() + i * 4;
+    const float area_a = (a[2] - a[0] + 1) * (a[3] - a[1] + 1);
+    for (int j = i + 1; j < num; ++j) {
+      const float *b = bboxes.data() + j * 4;
+      const float area_b = (b[2] - b[0] + 1) * (b[3] - b[1] + 1);
+      const float w =
+          std::max(0.f, std::min(a[2], b[2]) - std::max(a[0], b[0]) + 1);
+      const float h =
+          std::max(0.f, std::min(a[3], b[3]) - std::max(a[1], b[1]) + 1);
+      if (w * h / (area_a + area_b - w * h) >= thresh) {
+        suppressed[j] = true;
+      }
+    }
+  }
+  return keep;
+}
+
+void TestRandomNMS(const int num, const float thresh, const int max_keep) {
+  std::mt19937 gen(num);
+  std::uniform_real_distribution<float> pos(0, 200);
+  std::uniform_real_distribution<float> size(4, 120);
+  std::vector<float> bboxes(num * 4);
+  for (int i = 0; i < num; ++i) {
+    bboxes[i * 4] = pos(gen);
+    bboxes[i * 4 + 1] = pos(gen);
+    bboxes[i * 4 + 2] = bboxes[i * 4] + size(gen);
+    bboxes[i * 4 + 3] = bboxes[i * 4 + 1] + size(gen);
+  }
+  const std::vector<int> expected = GreedyNMS(bboxes, thresh, max_keep);
+  const std::vector<int> actual =
+      kernels::NMS(bboxes.data(), num, thresh, max_keep);
+  EXPECT_EQ(expected, actual);
+}
+}  // namespace
+
+TEST_F(ProposalOpTest, RandomNMS) {
+  TestRandomNMS(1, 0.7, 300);
+  TestRandomNMS(63, 0.7, 300);
+  TestRandomNMS(64, 0.5, 300);
+  TestRandomNMS(65, 0.3, 300);
+  TestRandomNMS(1000, 0.7, 300);
+  TestRandomNMS(3001, 0.7, 2000);
+  TestRandomNMS(3001, 0.7, 10);
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
@@ -0,0 +1,87 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/kernels/reduce.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+template <DeviceType D, typename T>
+void Reduce(int iters,
+            kernels::ReduceType type,
+            const std::vector<index_t> &shape,
+            const std::vector<int> &axis) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  // Add input data
+  net.AddRandomInput<D, T>("Input", shape);
+
+  OpDefBuilder("Reduce", "ReduceBM")
+      .Input("Input")
+      .AddIntArg("reduce_type", static_cast<int>(type))
+      .AddIntsArg("axis", axis)
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+
+  // Warm-up
+  for (int i = 0; i < 5; ++i) {
+    net.RunOp(D);
+  }
+  net.Sync();
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.RunOp(D);
+  }
+  net.Sync();
+}
+}  // namespace
+
+// NAME tells the axes apart, e.g. HW for the spatial axes of NCHW
+#define MACE_BM_REDUCE_MACRO(TYPE, N, C, H, W, NAME, ...)                 \
+  static void MACE_BM_REDUCE_##TYPE##_##N##_##C##_##H##_##W##_##NAME(     \
+      int iters) {                                                        \
+    const int64_t tot = static_cast<int64_t>(iters) * N * C * H * W;      \
+    mace::testing::MaccProcessed(tot);                                    \
+    mace::testing::BytesProcessed(tot * sizeof(float));                   \
+    Reduce<DeviceType::CPU, float>(iters, kernels::REDUCE_##TYPE,         \
+                                   {N, C, H, W}, __VA_ARGS__);            \
+  }                                                                       \
+  MACE_BENCHMARK(MACE_BM_REDUCE_##TYPE##_##N##_##C##_##H##_##W##_##NAME)
+
+// global average pooling, NCHW and NHWC
+MACE_BM_REDUCE_MACRO(MEAN, 1, 1024, 7, 7, HW, {2, 3});
+MACE_BM_REDUCE_MACRO(MEAN, 1, 7, 7, 1024, HW, {1, 2});
+MACE_BM_REDUCE_MACRO(MEAN, 8, 32, 112, 112, HW, {2, 3});
+MACE_BM_REDUCE_MACRO(MEAN, 8, 112, 112, 32, HW, {1, 2});
+// layer norm statistics over the last axis
+MACE_BM_REDUCE_MACRO(MEAN, 1, 1, 384, 768, C, {3});
+MACE_BM_REDUCE_MACRO(MAX, 1, 12, 384, 384, C, {3});
+// reduce over channels and everything
+MACE_BM_REDUCE_MACRO(SUM, 1, 64, 128, 128, C, {1});
+MACE_BM_REDUCE_MACRO(MIN, 1, 64, 128, 128, ALL, {});
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
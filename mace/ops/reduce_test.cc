@@ -0,0 +1,161 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/kernels/reduce.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class ReduceOpTest : public OpsTestBase {};
+
+namespace {
+void TestReduce(const kernels::ReduceType type,
+                const std::vector<index_t> &input_shape,
+                const std::vector<int> &axis,
+                const bool keep_dims) {
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>("Input", input_shape);
+
+  OpDefBuilder("Reduce", "ReduceTest")
+      .Input("Input")
+      .AddIntArg("reduce_type", static_cast<int>(type))
+      .AddIntsArg("axis", axis)
+      .AddIntArg("keepdims", keep_dims ? 1 : 0)
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+
+  // Reference: visit the input in order and combine into the output
+  const int rank = static_cast<int>(input_shape.size());
+  std::vector<bool> reduced(rank, axis.empty());
+  for (int a : axis) {
+    reduced[a < 0 ? a + rank : a] = true;
+  }
+  std::vector<index_t> output_shape;
+  std::vector<index_t> expected_shape;
+  for (int i = 0; i < rank; ++i) {
+    output_shape.push_back(reduced[i] ? 1 : input_shape[i]);
+    if (!reduced[i] || keep_dims) {
+      expected_shape.push_back(output_shape.back());
+    }
+  }
+  index_t output_size = 1;
+  for (index_t dim : output_shape) output_size *= dim;
+  const Tensor *input = net.GetTensor("Input");
+  const float *input_data = input->data<float>();
+  std::vector<double> result(output_size);
+  std::vector<bool> initialized(output_size, false);
+  index_t reduce_size = input->size() / output_size;
+  for (index_t i = 0; i < input->size(); ++i) {
+    index_t remain = i;
+    index_t out_index = 0;
+    index_t out_stride = 1;
+    for (int d = rank - 1; d >= 0; --d) {
+      const index_t index = remain % input_shape[d];
+      remain /= input_shape[d];
+      if (!reduced[d]) out_index += index * out_stride;
+      out_stride *= output_shape[d];
+    }
+    const double value = input_data[i];
+    double &acc = result[out_index];
+    if (!initialized[out_index]) {
+      acc = value;
+      initialized[out_index] = true;
+    } else if (type == kernels::REDUCE_MAX) {
+      acc = std::max(acc, value);
+    } else if (type == kernels::REDUCE_MIN) {
+      acc = std::min(acc, value);
+    } else if (type == kernels::REDUCE_PROD) {
+      acc *= value;
+    } else {
+      acc += value;
+    }
+  }
+  std::vector<float> expected(output_size);
+  for (index_t i = 0; i < output_size; ++i) {
+    expected[i] = static_cast<float>(
+        type == kernels::REDUCE_MEAN ? result[i] / reduce_size : result[i]);
+  }
+  net.AddInputFromArray<DeviceType::CPU, float>("Expected", expected_shape,
+                                                expected);
+
+  ExpectTensorNear<float>(*net.GetTensor("Expected"),
+                          *net.GetOutput("Output"), 1e-5, 1e-3);
+}
+
+void TestAllTypes(const std::vector<index_t> &input_shape,
+                  const std::vector<int> &axis) {
+  for (kernels::ReduceType type : {kernels::REDUCE_MEAN,
+                                   kernels::REDUCE_SUM,
+                                   kernels::REDUCE_MAX,
+                                   kernels::REDUCE_MIN}) {
+    TestReduce(type, input_shape, axis, true);
+    TestReduce(type, input_shape, axis, false);
+  }
+}
+}  // namespace
+
+TEST_F(ReduceOpTest, Simple) {
+  OpsTestNet net;
+  net.AddInputFromArray<DeviceType::CPU, float>(
+      "Input", {2, 3}, {1, -2, 3, 4, 5, -6});
+  OpDefBuilder("Reduce", "ReduceTest")
+      .Input("Input")
+      .AddIntArg("reduce_type", static_cast<int>(kernels::REDUCE_MAX))
+      .AddIntsArg("axis", {1})
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  auto expected = CreateTensor<float>({2}, {3, 5});
+  ExpectTensorNear<float>(*expected, *net.GetOutput("Output"));
+}
+
+TEST_F(ReduceOpTest, InnerAxis) {
+  TestAllTypes({3, 37}, {1});
+  TestAllTypes({2, 5, 7, 9}, {2, 3});
+  TestAllTypes({1, 3, 200, 300}, {-2, -1});
+  TestAllTypes({2, 70000}, {1});
+}
+
+TEST_F(ReduceOpTest, OuterAxis) {
+  TestAllTypes({37, 3}, {0});
+  TestAllTypes({2, 113, 113, 32}, {1, 2});
+  TestAllTypes({5000, 3}, {0});
+  TestAllTypes({3, 1, 1100, 7}, {0, 1});
+}
+
+TEST_F(ReduceOpTest, MultipleAxis) {
+  TestAllTypes({2, 3, 5, 7}, {0, 2});
+  TestAllTypes({2, 3, 5, 7}, {1, 3});
+  TestAllTypes({4, 1, 6, 5, 3}, {0, 2, 4});
+  TestAllTypes({2, 3, 5, 7}, {});
+  TestAllTypes({3, 4}, {0, 1});
+}
+
+TEST_F(ReduceOpTest, Prod) {
+  TestReduce(kernels::REDUCE_PROD, {3, 5, 7}, {1}, false);
+  TestReduce(kernels::REDUCE_PROD, {3, 5, 7}, {0, 2}, true);
+  TestReduce(kernels::REDUCE_PROD, {20, 19}, {1}, false);
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
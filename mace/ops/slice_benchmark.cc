@@ -24,7 +24,8 @@ namespace {
 template<DeviceType D, typename T>
 void BMSliceHelper(int iters,
                    const std::vector<index_t> &input_shape,
-                   const index_t num_outputs) {
+                   const index_t num_outputs,
+                   const int axis = 3) {
   mace::testing::StopTiming();
 
   // Construct graph
@@ -51,7 +52,7 @@ void BMSliceHelper(int iters,
         .AddIntArg("T", static_cast<int>(DataTypeToEnum<T>::value))
         .Finalize(net.NewOperatorDef());
   } else {
-    auto builder = OpDefBuilder("Slice", "SliceTest");
+    auto builder = OpDefBuilder("Slice", "SliceTest").AddIntArg("axis", axis);
     builder.Input("Input");
     for (int i = 0; i < num_outputs; ++i) {
       builder = builder.Output(MakeString("Output", i));
@@ -96,6 +97,20 @@ MACE_BM_SLICE(1, 32, 32, 256, 2);
 MACE_BM_SLICE(1, 128, 128, 32, 2);
 MACE_BM_SLICE(1, 128, 128, 128, 2);
 
+// channel split of NCHW, e.g. the ShuffleNetV2 units on CPU
+#define MACE_BM_SLICE_NCHW(N, C, H, W, NO)                                   \
+  static void MACE_BM_SLICE_NCHW_##N##_##C##_##H##_##W##_##NO(int iters) {   \
+    const int64_t tot = static_cast<int64_t>(iters) * N * C * H * W;         \
+    mace::testing::MaccProcessed(tot);                                       \
+    mace::testing::BytesProcessed(tot * sizeof(float));                      \
+    BMSliceHelper<DeviceType::CPU, float>(iters, {N, C, H, W}, NO, 1);       \
+  }                                                                          \
+  MACE_BENCHMARK(MACE_BM_SLICE_NCHW_##N##_##C##_##H##_##W##_##NO)
+
+MACE_BM_SLICE_NCHW(1, 116, 28, 28, 2);
+MACE_BM_SLICE_NCHW(1, 464, 7, 7, 2);
+MACE_BM_SLICE_NCHW(1, 128, 128, 128, 2);
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
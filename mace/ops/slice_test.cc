@@ -123,6 +123,35 @@ TEST_F(SliceOpTest, CPUAxis1) {
   RandomTest<DeviceType::CPU, float>(11, 1);
 }
 
+TEST_F(SliceOpTest, CPUView) {
+  // channel split of a single image, the outputs view the input
+  OpsTestNet net;
+  std::vector<float> input_data(1 * 6 * 5 * 7);
+  GenerateRandomRealTypeData({1, 6, 5, 7}, &input_data);
+  net.AddInputFromArray<DeviceType::CPU, float>("Input", {1, 6, 5, 7},
+                                                input_data);
+  OpDefBuilder("Slice", "SliceTest")
+      .Input("Input")
+      .Output("Output0")
+      .Output("Output1")
+      .AddIntArg("axis", 1)
+      .Finalize(net.NewOperatorDef());
+
+  net.RunOp();
+
+  const float *input_ptr = net.GetTensor("Input")->data<float>();
+  for (int i = 0; i < 2; ++i) {
+    Tensor *output = net.GetOutput(MakeString("Output", i).c_str());
+    EXPECT_THAT(output->shape(),
+                ::testing::ContainerEq(std::vector<index_t>({1, 3, 5, 7})));
+    EXPECT_TRUE(output->is_view());
+    EXPECT_EQ(input_ptr + i * 3 * 5 * 7, output->data<float>());
+    for (index_t j = 0; j < output->size(); ++j) {
+      ASSERT_EQ(input_data[i * output->size() + j], output->data<float>()[j]);
+    }
+  }
+}
+
 TEST_F(SliceOpTest, OPENCLFloat) {
   RandomTest<DeviceType::GPU, float>(2, 3);
   RandomTest<DeviceType::GPU, float>(4, 3);
@@ -90,6 +90,10 @@ MACE_BM_SOFTMAX(1, 3, 512, 512);
 MACE_BM_SOFTMAX(1, 4, 512, 512);
 MACE_BM_SOFTMAX(1, 10, 256, 256);
 MACE_BM_SOFTMAX(1, 1024, 7, 7);
+// segmentation heads
+MACE_BM_SOFTMAX(1, 21, 512, 512);
+MACE_BM_SOFTMAX(1, 19, 256, 512);
+MACE_BM_SOFTMAX(1, 150, 128, 128);
 
 }  // namespace test
 }  // namespace ops
@@ -85,6 +85,42 @@ void Simple() {
 TEST_F(SoftmaxOpTest, CPUSimple) { Simple<DeviceType::CPU>(); }
 TEST_F(SoftmaxOpTest, OPENCLSimple) { Simple<DeviceType::GPU>(); }
 
+namespace {
+// The tiled NCHW softmax against the 2d one on the same data
+void TestCPUTiled(const std::vector<index_t> &nhwc_shape) {
+  OpsTestNet net;
+  net.AddRandomInput<CPU, float>("Input", nhwc_shape);
+  net.TransformDataFormat<CPU, float>("Input", NHWC, "InputNCHW", NCHW);
+
+  OpDefBuilder("Softmax", "SoftmaxTest")
+      .Input("InputNCHW")
+      .Output("OutputNCHW")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  net.TransformDataFormat<CPU, float>("OutputNCHW", NCHW, "Output", NHWC);
+
+  const index_t class_count = nhwc_shape[3];
+  net.GetTensor("Input")->Reshape(
+      {nhwc_shape[0] * nhwc_shape[1] * nhwc_shape[2], class_count});
+  OpDefBuilder("Softmax", "SoftmaxTest")
+      .Input("Input")
+      .Output("Output2d")
+      .Finalize(net.NewOperatorDef());
+  net.RunOp();
+  net.GetOutput("Output2d")->Reshape(nhwc_shape);
+
+  ExpectTensorNear<float>(*net.GetOutput("Output2d"),
+                          *net.GetOutput("Output"), 1e-5);
+}
+}  // namespace
+
+TEST_F(SoftmaxOpTest, CPUTiled) {
+  TestCPUTiled({1, 7, 9, 3});
+  TestCPUTiled({2, 17, 19, 21});
+  TestCPUTiled({1, 64, 65, 150});
+  TestCPUTiled({1, 3, 5, 1000});
+}
+
 namespace {
 template <DeviceType D>
 void Complex(const std::vector<index_t> &logits_shape) {
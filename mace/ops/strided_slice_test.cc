@@ -146,6 +146,36 @@ TEST_F(StridedSliceOpTest, TestStridedSliceRank2) {
                    0, 3, {}, {6});
 }
 
+TEST_F(StridedSliceOpTest, TestStridedSliceView) {
+  std::vector<float> input(2 * 4 * 2 * 3);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = i;
+  }
+  // a contiguous range of a rank 4 tensor only views the input
+  TestStridedSlice({2, 4, 2, 3}, input, {1, 1, 0, 0}, {2, 3, 2, 3},
+                   {1, 1, 1, 1}, 0, 0, 0, 0, 1, {2, 2, 3},
+                   {30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41});
+  TestStridedSlice({2, 4, 2, 3}, input, {0, 2, 1, 0}, {1, 3, 2, 3},
+                   {1, 1, 1, 1}, 0, 0, 0, 0, 0, {1, 1, 1, 3}, {15, 16, 17});
+
+  OpsTestNet net;
+  net.AddInputFromArray<CPU, float>("Input", {2, 4, 2, 3}, input);
+  net.AddInputFromArray<CPU, int32_t>("BeginIndices", {2}, {1, 1});
+  net.AddInputFromArray<CPU, int32_t>("EndIndices", {2}, {2, 3});
+  OpDefBuilder("StridedSlice", "StridedSliceOpTest")
+      .Input("Input")
+      .Input("BeginIndices")
+      .Input("EndIndices")
+      .Output("Output")
+      .Finalize(net.NewOperatorDef());
+
+  net.RunOp();
+
+  Tensor *output = net.GetOutput("Output");
+  EXPECT_TRUE(output->is_view());
+  EXPECT_EQ(net.GetTensor("Input")->data<float>() + 30, output->data<float>());
+}
+
 TEST_F(StridedSliceOpTest, TestSlice) {
   TestSlice({2, 3}, {1, 2, 3, 4, 5, 6}, {0, 0}, {2, 3}, {2, 3},
             {1, 2, 3, 4, 5, 6});
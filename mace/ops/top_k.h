@@ -0,0 +1,49 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MACE_OPS_TOP_K_H_
+#define MACE_OPS_TOP_K_H_
+
+#include "mace/core/operator.h"
+#include "mace/kernels/top_k.h"
+
+namespace mace {
+namespace ops {
+
+template <DeviceType D, class T>
+class TopKOp : public Operator<D, T> {
+ public:
+  TopKOp(const OperatorDef &operator_def, Workspace *ws)
+      : Operator<D, T>(operator_def, ws) {}
+
+  MaceStatus Run(StatsFuture *future) override {
+    const Tensor *input = this->Input(INPUT);
+    const Tensor *k = this->Input(K);
+    Tensor *values = this->Output(VALUES);
+    Tensor *indices = this->Output(INDICES);
+    return functor_(input, k, values, indices, future);
+  }
+
+ private:
+  kernels::TopKFunctor<D, T> functor_;
+
+  MACE_OP_INPUT_TAGS(INPUT, K);
+  MACE_OP_OUTPUT_TAGS(VALUES, INDICES);
+};
+
+}  // namespace ops
+}  // namespace mace
+
+#endif  // MACE_OPS_TOP_K_H_
@@ -0,0 +1,88 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string>
+
+#include "mace/core/operator.h"
+#include "mace/core/testing/test_benchmark.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+namespace {
+// k of 0 benchmarks ArgMax over the last axis
+template <DeviceType D, typename T>
+void TopKBenchmark(int iters, index_t n, index_t classes, int k) {
+  mace::testing::StopTiming();
+
+  OpsTestNet net;
+  net.AddRandomInput<D, T>("Input", {n, classes}, false);
+  if (k > 0) {
+    net.AddInputFromArray<D, int32_t>("K", {}, {k});
+    OpDefBuilder("TopK", "TopKBM")
+        .Input("Input")
+        .Input("K")
+        .Output("Values")
+        .Output("Indices")
+        .OutputType({DT_FLOAT, DT_INT32})
+        .Finalize(net.NewOperatorDef());
+  } else {
+    net.AddInputFromArray<D, int32_t>("Axis", {}, {-1});
+    OpDefBuilder("ArgMax", "ArgMaxBM")
+        .Input("Input")
+        .Input("Axis")
+        .Output("Output")
+        .OutputType({DT_INT32})
+        .Finalize(net.NewOperatorDef());
+  }
+
+  // Warm-up
+  for (int i = 0; i < 2; ++i) {
+    net.RunOp(D);
+    net.Sync();
+  }
+
+  mace::testing::StartTiming();
+  while (iters--) {
+    net.RunOp(D);
+    net.Sync();
+  }
+}
+}  // namespace
+
+#define MACE_BM_TOP_K_MACRO(N, C, K, TYPE, DEVICE)                     \
+  static void MACE_BM_TOP_K_##N##_##C##_##K##_##TYPE##_##DEVICE(       \
+      int iters) {                                                     \
+    const int64_t tot = static_cast<int64_t>(iters) * N * C;           \
+    mace::testing::MaccProcessed(0);                                   \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                \
+    TopKBenchmark<DEVICE, TYPE>(iters, N, C, K);                       \
+  }                                                                    \
+  MACE_BENCHMARK(MACE_BM_TOP_K_##N##_##C##_##K##_##TYPE##_##DEVICE)
+
+#define MACE_BM_TOP_K(N, C, K) MACE_BM_TOP_K_MACRO(N, C, K, float, CPU);
+
+MACE_BM_TOP_K(1, 1001, 0);
+MACE_BM_TOP_K(1, 20000, 0);
+MACE_BM_TOP_K(32, 20000, 0);
+MACE_BM_TOP_K(1, 20000, 5);
+MACE_BM_TOP_K(32, 20000, 5);
+MACE_BM_TOP_K(1, 20000, 100);
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,125 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class TopKOpTest : public OpsTestBase {};
+
+namespace {
+void RunTopK(OpsTestNet *net, const int k) {
+  net->AddInputFromArray<CPU, int32_t>("K", {}, {k});
+  OpDefBuilder("TopK", "TopKTest")
+      .Input("Input")
+      .Input("K")
+      .Output("Values")
+      .Output("Indices")
+      .OutputType({DT_FLOAT, DT_INT32})
+      .Finalize(net->NewOperatorDef());
+  net->RunOp(CPU);
+}
+
+void TestTopK(const std::vector<index_t> &input_shape,
+              const std::vector<float> &input,
+              const int k,
+              const std::vector<index_t> &output_shape,
+              const std::vector<float> &values,
+              const std::vector<int32_t> &indices) {
+  OpsTestNet net;
+  net.AddInputFromArray<CPU, float>("Input", input_shape, input);
+  RunTopK(&net, k);
+
+  auto expected_values = CreateTensor<float>(output_shape, values);
+  auto expected_indices = CreateTensor<int32_t>(output_shape, indices);
+  ExpectTensorNear<float>(*expected_values, *net.GetOutput("Values"), 1e-5);
+  ExpectTensorNear<int32_t>(*expected_indices, *net.GetOutput("Indices"),
+                            1e-5);
+}
+
+// Compare against a stable sort of each row, values are drawn from a small
+// set so that there are many ties.
+void TestTopKRandom(const index_t rows, const index_t row_size, const int k) {
+  std::mt19937 gen(row_size + k);
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+  std::vector<float> input(rows * row_size);
+  for (float &value : input) value = dist(gen) * 0.25f;
+
+  OpsTestNet net;
+  net.AddInputFromArray<CPU, float>("Input", {rows, row_size}, input);
+  RunTopK(&net, k);
+
+  std::vector<float> values;
+  std::vector<int32_t> indices;
+  for (index_t i = 0; i < rows; ++i) {
+    const float *row = input.data() + i * row_size;
+    std::vector<int32_t> order(row_size);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [row](int32_t a, int32_t b) { return row[a] > row[b]; });
+    for (int j = 0; j < k; ++j) {
+      values.push_back(row[order[j]]);
+      indices.push_back(order[j]);
+    }
+  }
+  auto expected_values = CreateTensor<float>({rows, k}, values);
+  auto expected_indices = CreateTensor<int32_t>({rows, k}, indices);
+  ExpectTensorNear<float>(*expected_values, *net.GetOutput("Values"), 1e-5);
+  ExpectTensorNear<int32_t>(*expected_indices, *net.GetOutput("Indices"),
+                            1e-5);
+}
+}  // namespace
+
+TEST_F(TopKOpTest, Vector) {
+  TestTopK({5}, {1, 5, -2, 4, 3}, 3, {3}, {5, 4, 3}, {1, 3, 4});
+}
+
+TEST_F(TopKOpTest, TiesKeepIndexOrder) {
+  TestTopK({2, 4}, {2, 7, 2, 7, 1, 1, 1, 1}, 3, {2, 3},
+           {7, 7, 2, 1, 1, 1}, {1, 3, 0, 0, 1, 2});
+}
+
+TEST_F(TopKOpTest, KZero) {
+  OpsTestNet net;
+  net.AddInputFromArray<CPU, float>("Input", {2, 3}, {1, 3, 2, 6, 5, 4});
+  RunTopK(&net, 0);
+  EXPECT_EQ(std::vector<index_t>({2, 0}), net.GetOutput("Values")->shape());
+  EXPECT_EQ(std::vector<index_t>({2, 0}), net.GetOutput("Indices")->shape());
+}
+
+TEST_F(TopKOpTest, KFull) {
+  TestTopK({2, 3}, {1, 3, 2, 6, 5, 4}, 3, {2, 3},
+           {3, 2, 1, 6, 5, 4}, {1, 2, 0, 0, 1, 2});
+}
+
+TEST_F(TopKOpTest, Random) {
+  TestTopKRandom(3, 20000, 5);
+  TestTopKRandom(4, 1001, 1);
+  TestTopKRandom(4, 1001, 37);
+  TestTopKRandom(2, 100, 50);
+  TestTopKRandom(5, 67, 3);
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -0,0 +1,175 @@
+// Copyright 2018 Xiaomi, Inc.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <string>
+#include <vector>
+
+#include "mace/core/operator.h"
+#include "mace/kernels/eltwise.h"
+#include "mace/kernels/pooling.h"
+#include "mace/ops/ops_test_util.h"
+
+namespace mace {
+namespace ops {
+namespace test {
+
+class TransformDataFormatOpTest : public OpsTestBase {};
+
+namespace {
+void TestRoundTrip(const DataFormat data_format,
+                   const std::vector<index_t> &shape) {
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>("Input", shape);
+
+  OpDefBuilder("TransformDataFormat", "ToNCHWc")
+      .Input("Input")
+      .Output("InputNCHWc")
+      .AddIntArg("data_format", data_format)
+      .Finalize(net.NewOperatorDef());
+  OpDefBuilder("TransformDataFormat", "ToNCHW")
+      .Input("InputNCHWc")
+      .Output("Output")
+      .AddIntArg("data_format", NCHW)
+      .Finalize(net.AddNewOperatorDef());
+  net.RunOp();
+
+  const int block = data_format == NCHW4C ? 4 : 8;
+  const Tensor *blocked = net.GetOutput("InputNCHWc");
+  EXPECT_EQ(blocked->shape(), std::vector<index_t>(
+      {shape[0], shape[1] / block, shape[2], shape[3], block}));
+  // Channel c of pixel (h, w) is at [c / block][h][w][c % block].
+  const Tensor *input = net.GetTensor("Input");
+  EXPECT_EQ(input->data<float>()[(block + 1) * shape[2] * shape[3] + 2],
+            blocked->data<float>()[(shape[2] * shape[3] + 2) * block + 1]);
+  ExpectTensorNear<float>(*input, *net.GetOutput("Output"));
+}
+
+// A run of blocked ops, DepthwiseConv2d -> Pooling -> PRELU -> Eltwise ->
+// Concat, against the same ops in NCHW.
+void TestBlockedOps(const DataFormat data_format,
+                    const std::vector<index_t> &shape,
+                    const int kernel,
+                    const int stride) {
+  const index_t channels = shape[1];
+
+  OpsTestNet net;
+  net.AddRandomInput<DeviceType::CPU, float>("Input", shape);
+  net.AddRandomInput<DeviceType::CPU, float>("Filter",
+                                             {1, channels, kernel, kernel});
+  net.AddRandomInput<DeviceType::CPU, float>("Bias", {channels});
+  net.AddRandomInput<DeviceType::CPU, float>("Alpha", {channels});
+  net.GetTensor("Filter")->SetIsWeight(true);
+
+  std::vector<std::string> tensors = {"Input", "Dw", "MaxPool", "AvgPool",
+                                      "Prelu", "Sum", "Output"};
+  for (DataFormat format : {NCHW, data_format}) {
+    std::vector<std::string> names(tensors);
+    if (format != NCHW) {
+      for (auto &name : names) {
+        name += "NCHWc";
+      }
+      OpDefBuilder("TransformDataFormat", "ToNCHWc")
+          .Input("Input")
+          .Output(names[0])
+          .AddIntArg("data_format", format)
+          .Finalize(net.NewOperatorDef());
+    }
+    OpDefBuilder("DepthwiseConv2d", "DepthwiseConv2dTest")
+        .Input(names[0])
+        .Input("Filter")
+        .Input("Bias")
+        .Output(names[1])
+        .AddIntsArg("strides", {stride, stride})
+        .AddIntArg("padding", Padding::SAME)
+        .AddIntsArg("dilations", {1, 1})
+        .AddStringArg("activation", "RELUX")
+        .AddFloatArg("max_limit", 0.8f)
+        .AddIntArg("data_format", format)
+        .Finalize(format == NCHW ? net.NewOperatorDef()
+                                 : net.AddNewOperatorDef());
+    OpDefBuilder("Pooling", "MaxPoolingTest")
+        .Input(names[1])
+        .Output(names[2])
+        .AddIntArg("pooling_type", PoolingType::MAX)
+        .AddIntsArg("kernels", {3, 3})
+        .AddIntsArg("strides", {2, 2})
+        .AddIntArg("padding", Padding::SAME)
+        .AddIntsArg("dilations", {1, 1})
+        .AddIntArg("data_format", format)
+        .Finalize(net.AddNewOperatorDef());
+    OpDefBuilder("Pooling", "AvgPoolingTest")
+        .Input(names[1])
+        .Output(names[3])
+        .AddIntArg("pooling_type", PoolingType::AVG)
+        .AddIntsArg("kernels", {2, 2})
+        .AddIntsArg("strides", {2, 2})
+        .AddIntArg("padding", Padding::SAME)
+        .AddIntsArg("dilations", {1, 1})
+        .AddIntArg("data_format", format)
+        .Finalize(net.AddNewOperatorDef());
+    OpDefBuilder("Activation", "PreluTest")
+        .Input(names[2])
+        .Input("Alpha")
+        .Output(names[4])
+        .AddStringArg("activation", "PRELU")
+        .AddIntArg("data_format", format)
+        .Finalize(net.AddNewOperatorDef());
+    OpDefBuilder("Eltwise", "EltwiseTest")
+        .Input(names[4])
+        .Input(names[3])
+        .Output(names[5])
+        .AddIntArg("type", static_cast<int>(kernels::EltwiseType::SUM))
+        .AddIntArg("data_format", format)
+        .Finalize(net.AddNewOperatorDef());
+    OpDefBuilder("Concat", "ConcatTest")
+        .Input(names[5])
+        .Input(names[3])
+        .Output(names[6])
+        // the converter rewrites a negative channel axis to 1 when blocking
+        .AddIntArg("axis", format == NCHW ? -3 : 1)
+        .AddIntArg("data_format", format)
+        .Finalize(net.AddNewOperatorDef());
+    if (format != NCHW) {
+      OpDefBuilder("TransformDataFormat", "ToNCHW")
+          .Input(names[6])
+          .Output("BlockedOutput")
+          .AddIntArg("data_format", NCHW)
+          .Finalize(net.AddNewOperatorDef());
+    }
+    net.RunOp();
+  }
+
+  EXPECT_EQ(5, net.GetOutput("OutputNCHWc")->dim_size());
+  ExpectTensorNear<float>(*net.GetOutput("Output"),
+                          *net.GetOutput("BlockedOutput"), 1e-5, 1e-4);
+}
+}  // namespace
+
+TEST_F(TransformDataFormatOpTest, RoundTrip) {
+  TestRoundTrip(NCHW4C, {2, 8, 3, 5});
+  TestRoundTrip(NCHW8C, {1, 16, 7, 6});
+}
+
+TEST_F(TransformDataFormatOpTest, BlockedOps) {
+  for (DataFormat data_format : {NCHW4C, NCHW8C}) {
+    TestBlockedOps(data_format, {1, 16, 17, 19}, 3, 1);
+    TestBlockedOps(data_format, {2, 8, 16, 16}, 3, 2);
+    TestBlockedOps(data_format, {1, 24, 13, 11}, 5, 1);
+  }
+}
+
+}  // namespace test
+}  // namespace ops
+}  // namespace mace
@@ -35,9 +35,9 @@ class TransposeOp : public Operator<D, T> {
     const Tensor *input = this->Input(INPUT);
     Tensor *output = this->Output(OUTPUT);
     const std::vector<index_t> &input_shape = input->shape();
-    MACE_CHECK((input_shape.size() == 4 && dims_.size() == 4) ||
-                   (input_shape.size() == 2 && dims_.size() == 2),
-               "rank should be 2 or 4");
+    MACE_CHECK(input_shape.size() == dims_.size(),
+               "Transpose dims size ", dims_.size(), " != input rank ",
+               input_shape.size());
     std::vector<index_t> output_shape;
     for (size_t i = 0; i < dims_.size(); ++i) {
       output_shape.push_back(input_shape[dims_[i]]);
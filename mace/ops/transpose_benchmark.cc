@@ -68,6 +68,21 @@ void TransposeBenchmark(int iters,
 #define MACE_BM_TRANSPOSE2D(H, W)                                    \
   MACE_BM_TRANSPOSE2D_MACRO(H, W, float, CPU);
 
+#define MACE_BM_TRANSPOSE3D_MACRO(H, W, C, D0, D1, D2, TYPE, DEVICE)          \
+  static void                                                                 \
+    MACE_BM_TRANSPOSE3D_##H##_##W##_##C##_##D0##D1##D2##_##TYPE##_##DEVICE(   \
+      int iters) {                                                            \
+    const int64_t tot = static_cast<int64_t>(iters) * H * W * C;              \
+    mace::testing::MaccProcessed(tot);                                        \
+    mace::testing::BytesProcessed(tot *(sizeof(TYPE)));                       \
+    TransposeBenchmark<DEVICE, TYPE>(iters, {H, W, C}, {D0, D1, D2});         \
+  }                                                                           \
+  MACE_BENCHMARK(                                                             \
+    MACE_BM_TRANSPOSE3D_##H##_##W##_##C##_##D0##D1##D2##_##TYPE##_##DEVICE)
+
+#define MACE_BM_TRANSPOSE3D(H, W, C, D0, D1, D2)                          \
+  MACE_BM_TRANSPOSE3D_MACRO(H, W, C, D0, D1, D2, float, CPU);
+
 #define MACE_BM_TRANSPOSE4D_MACRO(N, C, H, W, D0, D1, D2, D3, TYPE, DEVICE)   \
   static void                                                                 \
     MACE_BM_TRANSPOSE4D_##N##_##C##_##H##_##W##_##D0##D1##D2##D3##_##TYPE##_##\
@@ -88,8 +103,15 @@ MACE_BM_TRANSPOSE4D(1, 512, 512, 3, 0, 3, 1, 2);
 MACE_BM_TRANSPOSE4D(1, 2, 512, 512, 0, 2, 3, 1);
 MACE_BM_TRANSPOSE4D(1, 64, 64, 512, 0, 3, 1, 2);
 MACE_BM_TRANSPOSE4D(1, 512, 64, 64, 0, 2, 3, 1);
+MACE_BM_TRANSPOSE4D(1, 56, 56, 256, 0, 3, 1, 2);
+MACE_BM_TRANSPOSE4D(1, 256, 56, 56, 0, 2, 3, 1);
+MACE_BM_TRANSPOSE4D(1, 8, 384, 64, 0, 2, 1, 3);
+MACE_BM_TRANSPOSE4D(1, 384, 8, 64, 0, 2, 3, 1);
+MACE_BM_TRANSPOSE3D(384, 12, 64, 1, 0, 2);
+MACE_BM_TRANSPOSE3D(12, 384, 64, 0, 2, 1);
 MACE_BM_TRANSPOSE2D(128, 128);
 MACE_BM_TRANSPOSE2D(512, 512);
+MACE_BM_TRANSPOSE2D(1024, 1000);
 
 }  // namespace test
 }  // namespace ops
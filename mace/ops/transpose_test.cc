@@ -65,6 +65,52 @@ void TransposeNHWCTest(const std::vector<index_t> &input_shape) {
   ExpectTensorNear<float>(*net.GetOutput("InputNHWC"),
                           *net.GetOutput("Output"));
 }
+
+void TransposeRandomTest(const std::vector<index_t> &input_shape,
+                         const std::vector<int> &dims) {
+  // Construct graph
+  OpsTestNet net;
+  // Add input data
+  net.AddRandomInput<CPU, float>("Input", input_shape);
+
+  OpDefBuilder("Transpose", "TransposeRandomTest")
+      .Input("Input")
+      .Output("Output")
+      .AddIntsArg("dims", dims)
+      .Finalize(net.NewOperatorDef());
+
+  // Run on cpu
+  net.RunOp();
+
+  // Reference: walk the output in order and gather from the input
+  const int rank = static_cast<int>(input_shape.size());
+  std::vector<index_t> output_shape(rank);
+  std::vector<index_t> in_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * input_shape[i + 1];
+  }
+  index_t size = 1;
+  for (int i = 0; i < rank; ++i) {
+    output_shape[i] = input_shape[dims[i]];
+    size *= output_shape[i];
+  }
+  const float *input_data = net.GetTensor("Input")->data<float>();
+  std::vector<float> expected(size);
+  for (index_t o = 0; o < size; ++o) {
+    index_t remain = o;
+    index_t in_offset = 0;
+    for (int i = rank - 1; i >= 0; --i) {
+      in_offset += remain % output_shape[i] * in_strides[dims[i]];
+      remain /= output_shape[i];
+    }
+    expected[o] = input_data[in_offset];
+  }
+  net.AddInputFromArray<CPU, float>("ExpectedOutput", output_shape,
+                                    expected);
+
+  ExpectTensorNear<float>(*net.GetOutput("ExpectedOutput"),
+                          *net.GetOutput("Output"));
+}
 }  // namespace
 
 TEST_F(TransposeOpTest, NHWC_to_NCHW) {
@@ -102,6 +148,22 @@ TEST_F(TransposeOpTest, Rank2) {
                           *net.GetOutput("Output"));
 }
 
+TEST_F(TransposeOpTest, RandomPermutation) {
+  TransposeRandomTest({37, 45}, {1, 0});
+  TransposeRandomTest({3, 5, 7}, {2, 0, 1});
+  TransposeRandomTest({2, 33, 70}, {0, 2, 1});
+  TransposeRandomTest({4, 9, 65}, {1, 0, 2});
+  TransposeRandomTest({1, 8, 17, 64}, {0, 2, 1, 3});
+  TransposeRandomTest({2, 3, 19, 23}, {3, 1, 0, 2});
+  TransposeRandomTest({1, 1, 40, 3}, {3, 2, 1, 0});
+  TransposeRandomTest({2, 3, 4, 5, 6}, {4, 2, 0, 3, 1});
+  TransposeRandomTest({2, 1, 3, 1, 9, 2}, {5, 3, 0, 4, 2, 1});
+  TransposeRandomTest({1, 2, 5, 7}, {0, 2, 3, 1});
+  TransposeRandomTest({2, 3, 9, 3}, {0, 3, 1, 2});
+  TransposeRandomTest({3, 4, 5}, {0, 1, 2});
+  TransposeRandomTest({2, 2, 2, 2, 2, 2}, {1, 3, 5, 0, 2, 4});
+}
+
 }  // namespace test
 }  // namespace ops
 }  // namespace mace
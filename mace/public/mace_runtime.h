@@ -86,6 +86,13 @@ void SetKVStorageFactory(std::shared_ptr<KVStorageFactory> storage_factory);
 // you should update the binary when OpenCL Driver changed.
 void SetOpenCLBinaryPaths(const std::vector<std::string> &paths);
 
+// Set whether CPU ops keep the original layout of the const weights they
+// repack at init (true by default). When false, a weight read by only one op
+// is repacked in place instead of into a second copy, which saves memory but
+// modifies the model data passed to MaceEngine::Init, so it must be writable
+// and can not be shared with another engine. (Call before MaceEngine::Init)
+void SetKeepUnpackedWeights(bool keep_unpacked_weights);
+
 // Set GPU hints, currently only supports Adreno GPU.
 //
 // Caution: this function may hurt performance if improper parameters provided.
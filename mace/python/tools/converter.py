@@ -113,6 +113,8 @@ def main(unused_args):
         else:
             option = cvt.ConverterOption()
         option.winograd = FLAGS.winograd
+        option.channel_block = FLAGS.channel_block
+        option.sparse_weight_threshold = FLAGS.sparse_weight_threshold
 
         input_node_names = FLAGS.input_node.split(',')
         input_node_shapes = FLAGS.input_shape.split(':')
@@ -264,6 +266,18 @@ def parse_args():
         type=int,
         default=0,
         help="Which version of winograd convolution to use. [2 | 4]")
+    parser.add_argument(
+        "--channel_block",
+        type=int,
+        default=0,
+        help="Channel block size of the blocked CPU layout. [0 | 4 | 8]")
+    parser.add_argument(
+        "--sparse_weight_threshold",
+        type=float,
+        default=0,
+        help="Store CPU fully connected and 1x1 conv weights as block-CSR "
+             "when at least this fraction of their 1x4 or 4x1 blocks is "
+             "zero, 0 to disable.")
     parser.add_argument(
         "--dsp_mode", type=int, default=0, help="dsp run mode, defalut=0")
     parser.add_argument(
@@ -27,6 +27,28 @@ class DeviceType(Enum):
 class DataFormat(Enum):
     NHWC = 0
     NCHW = 1
+    NCHW4C = 5
+    NCHW8C = 6
+
+
+class FusedElementwiseType(Enum):
+    ADD = 0
+    SUB = 1
+    RSUB = 2
+    MUL = 3
+    DIV = 4
+    RDIV = 5
+    MIN = 6
+    MAX = 7
+    SQR_DIFF = 8
+    POW = 9
+    NEG = 10
+    ABS = 11
+    RELU = 12
+    RELUX = 13
+    PRELU = 14
+    TANH = 15
+    SIGMOID = 16
 
 
 class FilterFormat(Enum):
@@ -69,6 +91,14 @@ class EltwiseType(Enum):
     EQUAL = 10
 
 
+class ReduceType(Enum):
+    MEAN = 0
+    SUM = 1
+    MAX = 2
+    MIN = 3
+    PROD = 4
+
+
 MaceSupportedOps = [
     'Activation',
     'AddN',
@@ -85,8 +115,10 @@ MaceSupportedOps = [
     'DepthwiseConv2d',
     'Dequantize',
     'Eltwise',
+    'EmbeddingBag',
     'FoldedBatchNorm',
     'FullyConnected',
+    'FusedElementwise',
     'Gather',
     'Identity',
     'LocalResponseNorm',
@@ -95,6 +127,7 @@ MaceSupportedOps = [
     'Pooling',
     'Proposal',
     'Quantize',
+    'Reduce',
     'ReduceMean',
     'Requantize',
     'Reshape',
@@ -107,6 +140,8 @@ MaceSupportedOps = [
     'Softmax',
     'SpaceToBatchND',
     'SpaceToDepth',
+    'TopK',
+    'TransformDataFormat',
     'Transpose',
     'WinogradInverseTransform',
     'WinogradTransform',
@@ -134,6 +169,7 @@ class MaceKeyword(object):
     mace_data_format_str = 'data_format'
     mace_filter_format_str = 'filter_format'
     mace_element_type_str = 'type'
+    mace_coeff_str = 'coeff'
     mace_activation_type_str = 'activation'
     mace_activation_max_limit_str = 'max_limit'
     mace_resize_size_str = 'size'
@@ -146,6 +182,7 @@ class MaceKeyword(object):
     mace_dims_str = 'dims'
     mace_axis_str = 'axis'
     mace_keepdims_str = 'keepdims'
+    mace_reduce_type_str = 'reduce_type'
     mace_shape_str = 'shape'
     mace_winograd_filter_transformed = 'is_filter_transformed'
     mace_device = 'device'
@@ -160,6 +197,10 @@ class MaceKeyword(object):
     mace_transpose_a_str = 'transpose_a'
     mace_transpose_b_str = 'transpose_b'
     mace_op_data_type_str = 'T'
+    mace_sparse_weight_shape_str = 'sparse_weight_shape'
+    mace_step_types_str = 'step_types'
+    mace_step_inputs_str = 'step_inputs'
+    mace_step_values_str = 'step_values'
 
 
 class TransformerRule(Enum):
@@ -185,6 +226,12 @@ class TransformerRule(Enum):
     ADD_IN_OUT_TENSOR_INFO = 20
     ADD_MACE_INPUT_AND_OUTPUT_NODES = 21
     UPDATE_FLOAT_OP_DATA_TYPE = 22
+    FOLD_RESIDUAL_ADD = 23
+    TRANSFORM_CHANNEL_BLOCK = 24
+    TRANSFORM_SPARSE_WEIGHT = 25
+    FUSE_ELEMENTWISE = 26
+    FOLD_PAD = 27
+    FOLD_EMBEDDING_BAG = 28
 
 
 class ConverterInterface(object):
@@ -230,6 +277,8 @@ class ConverterOption(object):
         self._data_type = mace_pb2.DT_FLOAT
         self._device = DeviceType.CPU.value
         self._winograd = 0
+        self._channel_block = 0
+        self._sparse_weight_threshold = 0
         if transformers:
             self._transformer_option = [TransformerRule[transformer]
                                         for transformer in transformers]
@@ -239,19 +288,25 @@ class ConverterOption(object):
                 TransformerRule.TRANSFORM_GLOBAL_POOLING,
                 TransformerRule.FOLD_RESHAPE,
                 TransformerRule.TRANSFORM_MATMUL_TO_FC,
+                TransformerRule.FOLD_EMBEDDING_BAG,
+                TransformerRule.FLATTEN_ATROUS_CONV,
                 TransformerRule.FOLD_BATCHNORM,
                 TransformerRule.FOLD_CONV_AND_BN,
                 TransformerRule.FOLD_DEPTHWISE_CONV_AND_BN,
+                TransformerRule.FOLD_PAD,
                 TransformerRule.TRANSFORM_GPU_WINOGRAD,
                 TransformerRule.TRANSFORM_ADD_TO_BIASADD,
                 TransformerRule.FOLD_BIASADD,
-                TransformerRule.FLATTEN_ATROUS_CONV,
+                TransformerRule.FOLD_RESIDUAL_ADD,
                 TransformerRule.FOLD_ACTIVATION,
                 TransformerRule.TRANSPOSE_FILTERS,
                 TransformerRule.TRANSPOSE_DATA_FORMAT,
                 TransformerRule.ADD_IN_OUT_TENSOR_INFO,
                 TransformerRule.TRANSFORM_GLOBAL_CONV_TO_FC,
                 TransformerRule.RESHAPE_FC_WEIGHT,
+                TransformerRule.TRANSFORM_CHANNEL_BLOCK,
+                TransformerRule.TRANSFORM_SPARSE_WEIGHT,
+                TransformerRule.FUSE_ELEMENTWISE,
                 TransformerRule.TRANSFORM_BUFFER_IMAGE,
                 TransformerRule.ADD_DEVICE,
                 TransformerRule.UPDATE_FLOAT_OP_DATA_TYPE,
@@ -279,6 +334,14 @@ class ConverterOption(object):
     def winograd(self):
         return self._winograd
 
+    @property
+    def channel_block(self):
+        return self._channel_block
+
+    @property
+    def sparse_weight_threshold(self):
+        return self._sparse_weight_threshold
+
     @property
     def transformer_option(self):
         return self._transformer_option
@@ -311,6 +374,14 @@ class ConverterOption(object):
     def winograd(self, winograd):
         self._winograd = winograd
 
+    @channel_block.setter
+    def channel_block(self, channel_block):
+        self._channel_block = channel_block
+
+    @sparse_weight_threshold.setter
+    def sparse_weight_threshold(self, sparse_weight_threshold):
+        self._sparse_weight_threshold = sparse_weight_threshold
+
     def disable_transpose_filters(self):
         if TransformerRule.TRANSPOSE_FILTERS in self._transformer_option:
             self._transformer_option.remove(TransformerRule.TRANSPOSE_FILTERS)
@@ -343,6 +414,10 @@ class ConverterUtil(object):
             return DataFormat.NHWC
         elif arg.i == DataFormat.NCHW.value:
             return DataFormat.NCHW
+        elif arg.i == DataFormat.NCHW4C.value:
+            return DataFormat.NCHW4C
+        elif arg.i == DataFormat.NCHW8C.value:
+            return DataFormat.NCHW8C
         else:
             return None
 
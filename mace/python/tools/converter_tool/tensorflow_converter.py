@@ -24,6 +24,7 @@ from mace.python.tools.converter_tool.base_converter import PoolingType
 from mace.python.tools.converter_tool.base_converter import PaddingMode
 from mace.python.tools.converter_tool.base_converter import ActivationType
 from mace.python.tools.converter_tool.base_converter import EltwiseType
+from mace.python.tools.converter_tool.base_converter import ReduceType
 from mace.python.tools.converter_tool.base_converter import DataFormat
 from mace.python.tools.converter_tool.base_converter import FilterFormat
 from mace.python.tools.converter_tool.base_converter import MaceOp
@@ -55,6 +56,8 @@ TFSupportedOps = [
     'Div',
     'Min',
     'Max',
+    'Maximum',
+    'Minimum',
     'Neg',
     'Abs',
     'Pow',
@@ -87,6 +90,8 @@ TFSupportedOps = [
     'Pad',
     'ConcatV2',
     'Mean',
+    'Sum',
+    'Prod',
     'Const',
     'Gather',
     'StridedSlice',
@@ -95,6 +100,7 @@ TFSupportedOps = [
     'Pack',
     'Cast',
     'ArgMax',
+    'TopKV2',
 ]
 
 TFOpType = Enum('TFOpType', [(op, op) for op in TFSupportedOps], type=str)
@@ -119,8 +125,8 @@ class TensorflowConverter(base_converter.ConverterInterface):
         TFOpType.Sub.name: EltwiseType.SUB,
         TFOpType.Mul.name: EltwiseType.PROD,
         TFOpType.Div.name: EltwiseType.DIV,
-        TFOpType.Min.name: EltwiseType.MIN,
-        TFOpType.Max.name: EltwiseType.MAX,
+        TFOpType.Maximum.name: EltwiseType.MAX,
+        TFOpType.Minimum.name: EltwiseType.MIN,
         TFOpType.Neg.name: EltwiseType.NEG,
         TFOpType.Abs.name: EltwiseType.ABS,
         TFOpType.Pow.name: EltwiseType.POW,
@@ -130,6 +136,13 @@ class TensorflowConverter(base_converter.ConverterInterface):
         TFOpType.Rsqrt.name: EltwiseType.POW,
         TFOpType.Equal.name: EltwiseType.EQUAL,
     }
+    reduce_type = {
+        TFOpType.Mean.name: ReduceType.MEAN,
+        TFOpType.Sum.name: ReduceType.SUM,
+        TFOpType.Max.name: ReduceType.MAX,
+        TFOpType.Min.name: ReduceType.MIN,
+        TFOpType.Prod.name: ReduceType.PROD,
+    }
     activation_type = {
         TFOpType.Relu.name: ActivationType.RELU,
         TFOpType.Relu6.name: ActivationType.RELUX,
@@ -147,8 +160,8 @@ class TensorflowConverter(base_converter.ConverterInterface):
             TFOpType.Sub.name: self.convert_elementwise,
             TFOpType.Mul.name: self.convert_elementwise,
             TFOpType.Div.name: self.convert_elementwise,
-            TFOpType.Min.name: self.convert_elementwise,
-            TFOpType.Max.name: self.convert_elementwise,
+            TFOpType.Maximum.name: self.convert_elementwise,
+            TFOpType.Minimum.name: self.convert_elementwise,
             TFOpType.Neg.name: self.convert_elementwise,
             TFOpType.Abs.name: self.convert_elementwise,
             TFOpType.Pow.name: self.convert_elementwise,
@@ -180,7 +193,11 @@ class TensorflowConverter(base_converter.ConverterInterface):
             TFOpType.SpaceToDepth.name: self.convert_space_depth,
             TFOpType.Pad.name: self.convert_pad,
             TFOpType.ConcatV2.name: self.convert_concat,
-            TFOpType.Mean.name: self.convert_mean,
+            TFOpType.Mean.name: self.convert_reduce,
+            TFOpType.Sum.name: self.convert_reduce,
+            TFOpType.Max.name: self.convert_reduce,
+            TFOpType.Min.name: self.convert_reduce,
+            TFOpType.Prod.name: self.convert_reduce,
             TFOpType.Const.name: self.convert_nop,
             TFOpType.Gather.name: self.convert_gather,
             TFOpType.StridedSlice.name: self.convert_stridedslice,
@@ -189,6 +206,7 @@ class TensorflowConverter(base_converter.ConverterInterface):
             TFOpType.Stack.name: self.convert_stack,
             TFOpType.Cast.name: self.convert_cast,
             TFOpType.ArgMax.name: self.convert_argmax,
+            TFOpType.TopKV2.name: self.convert_topk,
         }
         self._option = option
         self._mace_net_def = mace_pb2.NetDef()
@@ -637,11 +655,17 @@ class TensorflowConverter(base_converter.ConverterInterface):
             dims_arg.name = MaceKeyword.mace_dims_str
             dims_arg.ints.extend(perm)
 
-    def convert_mean(self, tf_op):
+    def convert_reduce(self, tf_op):
         op = self.convert_general_op(tf_op)
         del op.input[1:]
 
-        op.type = MaceOp.ReduceMean.name
+        if tf_op.type == TFOpType.Mean.name:
+            op.type = MaceOp.ReduceMean.name
+        else:
+            op.type = MaceOp.Reduce.name
+            type_arg = op.arg.add()
+            type_arg.name = MaceKeyword.mace_reduce_type_str
+            type_arg.i = self.reduce_type[tf_op.type].value
         axis_arg = op.arg.add()
         axis_arg.name = MaceKeyword.mace_axis_str
         if len(tf_op.inputs) > 1:
@@ -741,3 +765,9 @@ class TensorflowConverter(base_converter.ConverterInterface):
         op = self.convert_general_op(tf_op)
         op.type = MaceOp.ArgMax.name
         op.output_type.extend([mace_pb2.DT_INT32])
+
+    def convert_topk(self, tf_op):
+        # the outputs are always sorted, which also satisfies sorted=False
+        op = self.convert_general_op(tf_op)
+        op.type = MaceOp.TopK.name
+        op.output_type.extend([self._option.data_type, mace_pb2.DT_INT32])
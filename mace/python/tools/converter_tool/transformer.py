@@ -24,9 +24,12 @@ from mace.python.tools.converter_tool.base_converter import DataFormat
 from mace.python.tools.converter_tool.base_converter import DeviceType
 from mace.python.tools.converter_tool.base_converter import EltwiseType
 from mace.python.tools.converter_tool.base_converter import FilterFormat
+from mace.python.tools.converter_tool.base_converter import FusedElementwiseType  # noqa
 from mace.python.tools.converter_tool.base_converter import MaceKeyword
 from mace.python.tools.converter_tool.base_converter import MaceOp
 from mace.python.tools.converter_tool.base_converter import PaddingMode
+from mace.python.tools.converter_tool.base_converter import PoolingType
+from mace.python.tools.converter_tool.base_converter import ReduceType
 from mace.python.tools.converter_tool.base_converter import TransformerRule
 from mace.python.tools.convert_util import mace_check
 
@@ -61,16 +64,19 @@ class Transformer(base_converter.ConverterInterface):
             TransformerRule.FOLD_RESHAPE: self.fold_reshape,
             TransformerRule.TRANSFORM_MATMUL_TO_FC:
                 self.transform_matmul_to_fc,
+            TransformerRule.FOLD_EMBEDDING_BAG: self.fold_embedding_bag,
             TransformerRule.FOLD_BATCHNORM: self.fold_batchnorm,
             TransformerRule.FOLD_CONV_AND_BN:
                 self.fold_conv_and_bn,  # data_format related
             TransformerRule.FOLD_DEPTHWISE_CONV_AND_BN:
                 self.fold_depthwise_conv_and_bn,  # data_format related
+            TransformerRule.FOLD_PAD: self.fold_pad,  # data_format related
             TransformerRule.TRANSFORM_GPU_WINOGRAD:
                 self.transform_gpu_winograd,  # data_format related
             TransformerRule.TRANSFORM_ADD_TO_BIASADD:
                 self.transform_add_to_biasadd,
             TransformerRule.FOLD_BIASADD: self.fold_biasadd,
+            TransformerRule.FOLD_RESIDUAL_ADD: self.fold_residual_add,
             TransformerRule.FLATTEN_ATROUS_CONV: self.flatten_atrous_conv,
             TransformerRule.FOLD_ACTIVATION: self.fold_activation,
             TransformerRule.TRANSPOSE_FILTERS: self.transpose_filters,
@@ -80,6 +86,12 @@ class Transformer(base_converter.ConverterInterface):
             TransformerRule.TRANSFORM_GLOBAL_CONV_TO_FC:
                 self.transform_global_conv_to_fc,
             TransformerRule.RESHAPE_FC_WEIGHT: self.reshape_fc_weight,
+            TransformerRule.TRANSFORM_CHANNEL_BLOCK:
+                self.transform_channel_block,
+            TransformerRule.TRANSFORM_SPARSE_WEIGHT:
+                self.transform_sparse_weight,
+            TransformerRule.FUSE_ELEMENTWISE:
+                self.fuse_elementwise,
             TransformerRule.TRANSFORM_BUFFER_IMAGE:
                 self.transform_buffer_image,
             TransformerRule.ADD_DEVICE:
@@ -408,6 +420,151 @@ class Transformer(base_converter.ConverterInterface):
 
         return False
 
+    def is_non_negative(self, tensor_name):
+        producer = self._producer.get(tensor_name, None)
+        if producer is None:
+            return False
+        activation = ConverterUtil.get_arg(
+            producer, MaceKeyword.mace_activation_type_str)
+        return activation is not None \
+            and activation.s in [ActivationType.RELU.name,
+                                 ActivationType.RELUX.name]
+
+    def fold_embedding_bag(self):
+        """Fold a Gather of constant rows followed by a sum or mean over the
+        last index axis into an EmbeddingBag, which pools the rows without
+        storing the gathered ones."""
+        net = self._model
+        for op in net.op:
+            if op.type != MaceOp.Gather.name \
+                    or op.input[0] not in self._consts \
+                    or self.consumer_count(op.output[0]) != 1 \
+                    or self.is_op_output_node(op):
+                continue
+            axis = ConverterUtil.get_arg(op, MaceKeyword.mace_axis_str)
+            if axis is not None and axis.i != 0:
+                continue
+            consumer_op = self._consumers[op.output[0]][0]
+            if consumer_op.type == MaceOp.ReduceMean.name:
+                reduce_type = ReduceType.MEAN
+            elif consumer_op.type == MaceOp.Reduce.name:
+                reduce_type = ReduceType(ConverterUtil.get_arg(
+                    consumer_op, MaceKeyword.mace_reduce_type_str).i)
+                if reduce_type != ReduceType.SUM \
+                        and reduce_type != ReduceType.MEAN:
+                    continue
+            else:
+                continue
+            keep_dims = ConverterUtil.get_arg(
+                consumer_op, MaceKeyword.mace_keepdims_str)
+            if keep_dims is not None and keep_dims.i != 0:
+                continue
+            # the gathered tensor is indices.shape + params.shape[1:]
+            rank = len(op.output_shape[0].dims)
+            index_rank = rank - len(self._consts[op.input[0]].dims) + 1
+            reduce_axis = ConverterUtil.get_arg(consumer_op,
+                                                MaceKeyword.mace_axis_str)
+            if reduce_axis is None or index_rank < 1 \
+                    or [a % rank for a in reduce_axis.ints] \
+                    != [index_rank - 1]:
+                continue
+
+            print("Fold embedding bag: %s(%s)" % (op.name, op.type))
+            op.type = MaceOp.EmbeddingBag.name
+            if axis is not None:
+                op.arg.remove(axis)
+            type_arg = op.arg.add()
+            type_arg.name = MaceKeyword.mace_reduce_type_str
+            type_arg.i = reduce_type.value
+            op.output_shape[0].dims[:] = consumer_op.output_shape[0].dims[:]
+            self.safe_remove_node(consumer_op, op)
+            return True
+
+        return False
+
+    def fold_pad(self):
+        """Fold a zero Pad of the spatial dims into the padding_values of the
+        conv or max pooling consuming it, which pads virtually instead of
+        reading a padded copy of the input."""
+        net = self._model
+        for op in net.op:
+            if op.type != MaceOp.Pad.name \
+                    or self.consumer_count(op.output[0]) != 1 \
+                    or self.is_op_output_node(op):
+                continue
+            consumer_op = self._consumers[op.output[0]][0]
+            if consumer_op.input[0] != op.output[0]:
+                continue
+            if consumer_op.type == MaceOp.Pooling.name:
+                # avg pooling leaves the padding out of the average
+                pooling_type = ConverterUtil.get_arg(
+                    consumer_op, MaceKeyword.mace_pooling_type_str)
+                if pooling_type.i != PoolingType.MAX.value \
+                        or not self.is_non_negative(op.input[0]):
+                    continue
+            elif consumer_op.type != MaceOp.Conv2D.name \
+                    and consumer_op.type != MaceOp.DepthwiseConv2d.name:
+                continue
+
+            constant_value = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_constant_value_str)
+            if constant_value is not None and constant_value.i != 0:
+                continue
+            paddings = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_paddings_str).ints
+            data_format = ConverterUtil.data_format(op)
+            if data_format == DataFormat.NHWC:
+                h, w, n, c = 2, 4, 0, 6
+            elif data_format == DataFormat.NCHW:
+                h, w, n, c = 4, 6, 0, 2
+            else:
+                continue
+            if any(paddings[n:n + 2]) or any(paddings[c:c + 2]):
+                continue
+
+            padding = ConverterUtil.get_arg(consumer_op,
+                                            MaceKeyword.mace_padding_str)
+            padding_values = ConverterUtil.get_arg(
+                consumer_op, MaceKeyword.mace_padding_values_str)
+            if padding_values is not None:
+                totals = list(padding_values.ints)
+            elif padding is not None \
+                    and padding.i == PaddingMode.VALID.value:
+                totals = [0, 0]
+            else:
+                continue
+            # the ops pad total >> 1 at the top and left
+            new_totals = [totals[0] + paddings[h] + paddings[h + 1],
+                          totals[1] + paddings[w] + paddings[w + 1]]
+            if (totals[0] >> 1) + paddings[h] != new_totals[0] >> 1 \
+                    or (totals[1] >> 1) + paddings[w] != new_totals[1] >> 1:
+                continue
+
+            if consumer_op.type == MaceOp.Pooling.name:
+                # pooling rounds up with explicit paddings but down with
+                # VALID, it has to come out even
+                kernels = ConverterUtil.get_arg(
+                    consumer_op, MaceKeyword.mace_kernel_str).ints
+                strides = ConverterUtil.get_arg(
+                    consumer_op, MaceKeyword.mace_strides_str).ints
+                _, height, width, _ = self.sort_feature_map_shape(
+                    op.output_shape[0].dims, data_format)
+                if (height - kernels[0]) % strides[0] != 0 \
+                        or (width - kernels[1]) % strides[1] != 0:
+                    continue
+
+            print("Fold pad: %s(%s)" % (consumer_op.name, consumer_op.type))
+            if padding is not None:
+                consumer_op.arg.remove(padding)
+            if padding_values is None:
+                padding_values = consumer_op.arg.add()
+                padding_values.name = MaceKeyword.mace_padding_values_str
+            padding_values.ints[:] = new_totals
+            self.safe_remove_node(op, None)
+            return True
+
+        return False
+
     @staticmethod
     def sort_feature_map_shape(shape, data_format):
         """Return shape in NHWC order"""
@@ -617,63 +774,147 @@ class Transformer(base_converter.ConverterInterface):
 
         return False
 
-    def flatten_atrous_conv(self):
-        if self._option.device != DeviceType.GPU.value:
-            return
+    def fold_residual_add(self):
+        """Fold Eltwise SUM of a conv output and another tensor of the same
+        shape into the conv, which adds the residual while its output is
+        still in cache. Must run before FOLD_ACTIVATION so that the
+        activation after the add can be folded as well."""
+        if self._option.device != DeviceType.CPU.value:
+            return False
 
         net = self._model
         for op in net.op:
-            if (op.type == MaceOp.SpaceToBatchND.name
-                    and len(self._consumers.get(op.output[0], [])) == 1):
-                conv_op = self._consumers.get(op.output[0])[0]
-                if (conv_op.type == MaceOp.Conv2D.name
-                        or conv_op.type == MaceOp.DepthwiseConv2d.name) \
-                        and len(self._consumers.get(conv_op.output[0], [])) == 1:  # noqa
-                    b2s_op = self._consumers.get(conv_op.output[0])[0]
-                    if b2s_op.type == MaceOp.BatchToSpaceND.name:
-                        print "Flatten atrous convolution"
-                        # Add args.
-                        padding_arg_values = ConverterUtil.get_arg(
-                            op,
-                            MaceKeyword.mace_paddings_str).ints
-                        blocks_arg_values = ConverterUtil.get_arg(
-                            b2s_op,
-                            MaceKeyword.mace_space_batch_block_shape_str).ints
-                        dilation_arg = ConverterUtil.get_arg(
+            if op.type != MaceOp.Eltwise.name \
+                    or ConverterUtil.get_arg(
+                        op, MaceKeyword.mace_element_type_str).i \
+                    != EltwiseType.SUM.value \
+                    or len(op.input) != 2:
+                continue
+            coeff_arg = ConverterUtil.get_arg(op, MaceKeyword.mace_coeff_str)
+            if coeff_arg is not None \
+                    and any(coeff != 1.0 for coeff in coeff_arg.floats):
+                continue
+            if op.input[0] not in self._producer \
+                    or op.input[1] not in self._producer:
+                continue
+
+            for conv_idx in xrange(2):
+                conv_output = op.input[conv_idx]
+                residual = op.input[1 - conv_idx]
+                conv_op = self._producer[conv_output]
+                if conv_op.type != MaceOp.Conv2D.name \
+                        or len(conv_op.input) > 3 \
+                        or conv_output == residual \
+                        or self.consumer_count(conv_output) != 1 \
+                        or self.is_op_output_node(conv_op) \
+                        or ConverterUtil.get_arg(
                             conv_op,
-                            MaceKeyword.mace_dilations_str)
-                        if dilation_arg is None:
-                            dilation_arg = conv_op.arg.add()
-                        dilation_arg.name = MaceKeyword.mace_dilations_str
-                        dilation_arg.ints[:] = blocks_arg_values
+                            MaceKeyword.mace_activation_type_str) is not None:
+                    continue
+                if self.get_tensor_shape(conv_output) \
+                        != self.get_tensor_shape(residual):
+                    continue
+
+                print("Fold residual add: %s(%s)" % (op.name, op.type))
+                if len(conv_op.input) == 2:
+                    conv_shape = self.get_tensor_shape(conv_output)
+                    if ConverterUtil.data_format(conv_op) == DataFormat.NHWC:
+                        channels = conv_shape[3]
+                    else:
+                        channels = conv_shape[1]
+                    bias = net.tensors.add()
+                    bias.name = conv_op.name + '_bias'
+                    bias.dims.extend([channels])
+                    bias.data_type = mace_pb2.DT_FLOAT
+                    bias.float_data.extend([0.0] * channels)
+                    conv_op.input.append(bias.name)
+                conv_op.input.append(residual)
+                conv_op.name = op.name
+                self.safe_remove_node(op, conv_op)
+                return True
 
-                        padding_arg = ConverterUtil.get_arg(
-                            conv_op,
-                            MaceKeyword.mace_padding_str)
-                        if padding_arg is None:
-                            padding_arg = conv_op.arg.add()
-                        padding_arg.name = MaceKeyword.mace_padding_str
-                        if len(padding_arg_values) > 0 \
-                                and padding_arg_values[0] > 0:
-                            padding_arg.i = PaddingMode.SAME.value
-                        else:
-                            padding_arg.i = PaddingMode.VALID.value
+        return False
+
+    def flatten_atrous_conv(self):
+        """Collapse SpaceToBatchND -> conv -> BatchToSpaceND into one dilated
+        conv: the block shape becomes the dilation, and the paddings left
+        after the crops become its padding_values."""
+        net = self._model
+        for op in net.op:
+            if op.type != MaceOp.SpaceToBatchND.name \
+                    or self.consumer_count(op.output[0]) != 1:
+                continue
+            conv_op = self._consumers[op.output[0]][0]
+            if (conv_op.type != MaceOp.Conv2D.name
+                    and conv_op.type != MaceOp.DepthwiseConv2d.name) \
+                    or conv_op.input[0] != op.output[0] \
+                    or self.consumer_count(conv_op.output[0]) != 1:
+                continue
+            b2s_op = self._consumers[conv_op.output[0]][0]
+            if b2s_op.type != MaceOp.BatchToSpaceND.name:
+                continue
+            block_shape = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_space_batch_block_shape_str).ints
+            if list(block_shape) != list(ConverterUtil.get_arg(
+                    b2s_op,
+                    MaceKeyword.mace_space_batch_block_shape_str).ints):
+                continue
+
+            # the conv has to run densely and unpadded on each phase
+            strides_arg = ConverterUtil.get_arg(conv_op,
+                                                MaceKeyword.mace_strides_str)
+            dilation_arg = ConverterUtil.get_arg(
+                conv_op, MaceKeyword.mace_dilations_str)
+            padding_arg = ConverterUtil.get_arg(conv_op,
+                                                MaceKeyword.mace_padding_str)
+            padding_values_arg = ConverterUtil.get_arg(
+                conv_op, MaceKeyword.mace_padding_values_str)
+            if (strides_arg is not None and any(
+                    stride != 1 for stride in strides_arg.ints)) \
+                    or (dilation_arg is not None and any(
+                        dilation != 1 for dilation in dilation_arg.ints)):
+                continue
+            if padding_values_arg is not None:
+                if any(padding_values_arg.ints):
+                    continue
+            elif padding_arg is None \
+                    or padding_arg.i != PaddingMode.VALID.value:
+                continue
+
+            # [top, bottom, left, right]
+            paddings = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_paddings_str).ints
+            crops = ConverterUtil.get_arg(
+                b2s_op, MaceKeyword.mace_batch_to_space_crops_str).ints
+            pads = [paddings[i] - crops[i] for i in xrange(4)]
+            # the ops pad total >> 1 at the top and left
+            if min(pads) < 0 or pads[0] != (pads[0] + pads[1]) >> 1 \
+                    or pads[2] != (pads[2] + pads[3]) >> 1:
+                continue
+
+            print("Flatten atrous convolution: %s(%s)"
+                  % (conv_op.name, conv_op.type))
+            if dilation_arg is None:
+                dilation_arg = conv_op.arg.add()
+                dilation_arg.name = MaceKeyword.mace_dilations_str
+            dilation_arg.ints[:] = block_shape
+            if padding_arg is not None:
+                conv_op.arg.remove(padding_arg)
+            if padding_values_arg is None:
+                padding_values_arg = conv_op.arg.add()
+                padding_values_arg.name = \
+                    MaceKeyword.mace_padding_values_str
+            padding_values_arg.ints[:] = [pads[0] + pads[1],
+                                          pads[2] + pads[3]]
+
+            # update output shape
+            conv_op.output_shape[0].dims[:] = \
+                b2s_op.output_shape[0].dims[:]
+
+            self.safe_remove_node(op, None)
+            self.safe_remove_node(b2s_op, conv_op)
+            return True
 
-                        strides_arg = ConverterUtil.get_arg(
-                            conv_op,
-                            MaceKeyword.mace_strides_str)
-                        if strides_arg is None:
-                            strides_arg = conv_op.arg.add()
-                        strides_arg.name = MaceKeyword.mace_strides_str
-                        strides_arg.ints[:] = [1, 1]
-
-                        # update output shape
-                        conv_op.output_shape[0].dims[:] = \
-                            b2s_op.output_shape[0].dims[:]
-
-                        self.safe_remove_node(op, None)
-                        self.safe_remove_node(b2s_op, conv_op)
-                        return True
         return False
 
     def fold_activation(self):
@@ -766,7 +1007,8 @@ class Transformer(base_converter.ConverterInterface):
                                        'only support squeeze at at [2, 3]')
                             arg.ints[:] = [1, 2]
 
-            elif op.type == MaceOp.ReduceMean.name:
+            elif op.type == MaceOp.ReduceMean.name \
+                    or op.type == MaceOp.Reduce.name:
                 for arg in op.arg:
                     if arg.name == MaceKeyword.mace_axis_str:
                         if ConverterUtil.data_format(
@@ -923,6 +1165,456 @@ class Transformer(base_converter.ConverterInterface):
 
         return False
 
+    def transform_channel_block(self):
+        """Run chains of CPU conv/depthwise conv/pooling/activation/eltwise/
+        concat ops in the blocked NCHW4C/NCHW8C layout, inserting
+        TransformDataFormat ops where the chain meets the rest of the
+        graph."""
+        block = self._option.channel_block
+        if self._option.device != DeviceType.CPU.value \
+                or block not in [4, 8]:
+            return False
+
+        print("Transform to channel block %d" % block)
+        net = self._model
+        if block == 4:
+            blocked_format = DataFormat.NCHW4C
+        else:
+            blocked_format = DataFormat.NCHW8C
+
+        def is_blockable(shape):
+            return len(shape) == 4 and shape[1] % block == 0
+
+        def is_scalar(tensor_name):
+            return reduce(lambda x, y: x * y,
+                          self._consts[tensor_name].dims, 1) == 1
+
+        def blocked_shape(shape):
+            return [shape[0], shape[1] // block, shape[2], shape[3], block]
+
+        def can_follow(op, blocked_ops):
+            if len(op.output) != 1 or len(op.output_shape) != 1 \
+                    or not is_blockable(op.output_shape[0].dims):
+                return False
+            if op.type == MaceOp.Concat.name:
+                axis = ConverterUtil.get_arg(op, MaceKeyword.mace_axis_str)
+                if axis is None or axis.i not in [1, -3]:
+                    return False
+            elif op.type == MaceOp.Eltwise.name:
+                output_shape = list(op.output_shape[0].dims)
+                for input_tensor in op.input:
+                    if input_tensor in self._consts:
+                        if not is_scalar(input_tensor):
+                            return False
+                    elif self.get_tensor_shape(input_tensor) \
+                            != output_shape:
+                        return False
+            elif op.type != MaceOp.Pooling.name \
+                    and op.type != MaceOp.Activation.name:
+                return False
+            follows_blocked_op = False
+            for input_tensor in op.input:
+                if input_tensor in self._consts:
+                    continue
+                if not is_blockable(self.get_tensor_shape(input_tensor)):
+                    return False
+                if self._producer[input_tensor].name in blocked_ops:
+                    follows_blocked_op = True
+            return follows_blocked_op
+
+        blocked_ops = set()
+        for op in net.op:
+            if len(op.output_shape) != 1 \
+                    or not is_blockable(op.output_shape[0].dims):
+                continue
+            if op.type == MaceOp.Conv2D.name:
+                filter = self._consts[op.input[1]]
+                if filter.dims[1] % block == 0:
+                    blocked_ops.add(op.name)
+            elif op.type == MaceOp.DepthwiseConv2d.name:
+                filter = self._consts[op.input[1]]
+                if filter.dims[0] == 1:
+                    blocked_ops.add(op.name)
+
+        changed = True
+        while changed:
+            changed = False
+            for op in net.op:
+                if op.name not in blocked_ops \
+                        and can_follow(op, blocked_ops):
+                    blocked_ops.add(op.name)
+                    changed = True
+
+        if not blocked_ops:
+            return False
+
+        def add_transform_op(input_name, output_name, output_shape,
+                             data_format):
+            op_def = net.op.add()
+            op_def.name = self.normalize_op_name(output_name)
+            op_def.type = MaceOp.TransformDataFormat.name
+            op_def.input.extend([input_name])
+            op_def.output.extend([output_name])
+            op_def.output_shape.add().dims.extend(output_shape)
+            ConverterUtil.add_data_format_arg(op_def, data_format)
+
+        # Outputs that leave the blocked chain are renamed, and the original
+        # tensor is re-created in NCHW so other consumers and output nodes
+        # keep their names.
+        blocked_outputs = set()
+        for op in list(net.op):
+            if op.name not in blocked_ops:
+                continue
+            output_name = op.output[0]
+            blocked_outputs.add(output_name)
+            consumers = self._consumers.get(output_name, [])
+            if output_name in self._option.output_nodes \
+                    or any(consumer.name not in blocked_ops
+                           for consumer in consumers):
+                blocked_name = output_name + '_nchwc'
+                blocked_outputs.add(blocked_name)
+                op.output[0] = blocked_name
+                for consumer in consumers:
+                    if consumer.name in blocked_ops:
+                        self.replace(consumer.input, output_name,
+                                     blocked_name)
+                add_transform_op(blocked_name, output_name,
+                                 op.output_shape[0].dims, DataFormat.NCHW)
+
+        blocked_inputs = {}
+        for op in list(net.op):
+            if op.name not in blocked_ops:
+                continue
+            for i in xrange(len(op.input)):
+                input_tensor = op.input[i]
+                if input_tensor in self._consts \
+                        or input_tensor in blocked_outputs:
+                    continue
+                if input_tensor not in blocked_inputs:
+                    blocked_name = input_tensor + '_nchwc'
+                    add_transform_op(
+                        input_tensor, blocked_name,
+                        blocked_shape(self.get_tensor_shape(input_tensor)),
+                        blocked_format)
+                    blocked_inputs[input_tensor] = blocked_name
+                op.input[i] = blocked_inputs[input_tensor]
+
+            output_shape = blocked_shape(op.output_shape[0].dims)
+            op.output_shape[0].dims[:] = output_shape
+            data_format_arg = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_data_format_str)
+            if data_format_arg is None:
+                ConverterUtil.add_data_format_arg(op, blocked_format)
+            else:
+                data_format_arg.i = blocked_format.value
+            if op.type == MaceOp.Concat.name:
+                # a negative channel axis would count from the 5-D end
+                ConverterUtil.get_arg(op, MaceKeyword.mace_axis_str).i = 1
+
+        return False
+
+    @staticmethod
+    def block_sparsity(weight, block_rows, block_cols):
+        rows, cols = weight.shape
+        blocks = weight.reshape(rows // block_rows, block_rows,
+                                cols // block_cols, block_cols)
+        non_zero = np.any(blocks != 0, axis=(1, 3))
+        return 1.0 - float(np.count_nonzero(non_zero)) / non_zero.size
+
+    def transform_sparse_weight(self):
+        """Store pruned CPU FC and 1x1 conv weights as block-CSR: the weight
+        tensor keeps the non-zero 4x1 or 1x4 blocks ([blocks, rows, cols]),
+        row_ptr and col_idx tensors are appended to the op inputs and the
+        dense shape is kept in the sparse_weight_shape arg."""
+        threshold = self._option.sparse_weight_threshold
+        if self._option.device != DeviceType.CPU.value or threshold <= 0:
+            return False
+
+        net = self._model
+        for op in net.op:
+            if op.type == MaceOp.FullyConnected.name:
+                pass
+            elif op.type == MaceOp.Conv2D.name:
+                strides = ConverterUtil.get_arg(op,
+                                                MaceKeyword.mace_strides_str)
+                padding_values = ConverterUtil.get_arg(
+                    op, MaceKeyword.mace_padding_values_str)
+                if ConverterUtil.data_format(op) != DataFormat.NCHW \
+                        or len(op.input) > 4 \
+                        or (strides is not None
+                            and list(strides.ints) != [1, 1]) \
+                        or (padding_values is not None
+                            and any(padding_values.ints)):
+                    continue
+            else:
+                continue
+            weight = self._consts.get(op.input[1], None)
+            if weight is None or weight.data_type != mace_pb2.DT_FLOAT \
+                    or self.consumer_count(weight.name) != 1 \
+                    or len(weight.dims) != 4:
+                continue
+            if op.type == MaceOp.Conv2D.name \
+                    and list(weight.dims[2:]) != [1, 1]:
+                continue
+
+            rows = weight.dims[0]
+            cols = weight.dims[1] * weight.dims[2] * weight.dims[3]
+            weight_data = np.array(weight.float_data).reshape(rows, cols)
+            best_block = None
+            best_sparsity = 0
+            for block_rows, block_cols in [(4, 1), (1, 4)]:
+                if rows % block_rows != 0 or cols % block_cols != 0:
+                    continue
+                sparsity = self.block_sparsity(weight_data, block_rows,
+                                               block_cols)
+                if sparsity > best_sparsity:
+                    best_block = (block_rows, block_cols)
+                    best_sparsity = sparsity
+            if best_block is None or best_sparsity < threshold \
+                    or best_sparsity == 1:
+                continue
+
+            print("Transform sparse weight: %s(%s) %dx%d blocks, "
+                  "sparsity %.2f" % (op.name, op.type, best_block[0],
+                                     best_block[1], best_sparsity))
+            block_rows, block_cols = best_block
+            blocks = weight_data.reshape(
+                rows // block_rows, block_rows, cols // block_cols,
+                block_cols).transpose(0, 2, 1, 3)
+            row_ptr = [0]
+            col_idx = []
+            values = []
+            for r in xrange(blocks.shape[0]):
+                for c in xrange(blocks.shape[1]):
+                    if np.any(blocks[r, c] != 0):
+                        col_idx.append(c * block_cols)
+                        values.extend(blocks[r, c].flat)
+                row_ptr.append(len(col_idx))
+
+            if len(op.input) < 3:
+                bias = net.tensors.add()
+                bias.name = op.name + '_bias'
+                bias.dims.extend([rows])
+                bias.data_type = mace_pb2.DT_FLOAT
+                bias.float_data.extend([0.0] * rows)
+                op.input.append(bias.name)
+
+            for name, data in [(weight.name + '_row_ptr', row_ptr),
+                               (weight.name + '_col_idx', col_idx)]:
+                index_tensor = net.tensors.add()
+                index_tensor.name = name
+                index_tensor.dims.extend([len(data)])
+                index_tensor.data_type = mace_pb2.DT_INT32
+                index_tensor.int32_data.extend(data)
+                op.input.append(name)
+
+            shape_arg = op.arg.add()
+            shape_arg.name = MaceKeyword.mace_sparse_weight_shape_str
+            shape_arg.ints.extend(weight.dims)
+            weight.dims[:] = [len(col_idx), block_rows, block_cols]
+            weight.float_data[:] = values
+
+        return False
+
+    def elementwise_steps(self, op, data_input):
+        """Return the fused element-wise steps of op applied to its input
+        tensor data_input as (type, operand const name or None, value)
+        tuples, or None if op cannot join a fused chain."""
+        data_format = ConverterUtil.data_format(op)
+        if data_format not in [DataFormat.NHWC, DataFormat.NCHW] \
+                or len(op.output) != 1 \
+                or data_input not in self._producer:
+            return None
+        shape = list(op.output_shape[0].dims)
+        if self.get_tensor_shape(data_input) != shape:
+            return None
+        if data_format == DataFormat.NCHW and len(shape) == 4:
+            channels = shape[1]
+        else:
+            channels = shape[-1] if shape else 1
+
+        def operand(name):
+            if name not in self._consts:
+                return None
+            tensor = self._consts[name]
+            if tensor.data_type != mace_pb2.DT_FLOAT:
+                return None
+            size = int(np.prod(tensor.dims)) if tensor.dims else 1
+            if size == 1 or (len(tensor.dims) == 1 and size == channels):
+                return name
+            return None
+
+        def activation_steps(activation, max_limit):
+            if activation == ActivationType.RELU.name:
+                return [(FusedElementwiseType.RELU, None, 0.0)]
+            elif activation == ActivationType.RELUX.name:
+                return [(FusedElementwiseType.RELUX, None, max_limit)]
+            elif activation == ActivationType.TANH.name:
+                return [(FusedElementwiseType.TANH, None, 0.0)]
+            elif activation == ActivationType.SIGMOID.name:
+                return [(FusedElementwiseType.SIGMOID, None, 0.0)]
+            return None
+
+        if op.type == MaceOp.Eltwise.name:
+            coeff = ConverterUtil.get_arg(op, MaceKeyword.mace_coeff_str)
+            if coeff is not None and any(c != 1 for c in coeff.floats):
+                return None
+            eltwise_types = {
+                EltwiseType.SUM.value: FusedElementwiseType.ADD,
+                EltwiseType.SUB.value: FusedElementwiseType.SUB,
+                EltwiseType.PROD.value: FusedElementwiseType.MUL,
+                EltwiseType.DIV.value: FusedElementwiseType.DIV,
+                EltwiseType.MIN.value: FusedElementwiseType.MIN,
+                EltwiseType.MAX.value: FusedElementwiseType.MAX,
+                EltwiseType.NEG.value: FusedElementwiseType.NEG,
+                EltwiseType.ABS.value: FusedElementwiseType.ABS,
+                EltwiseType.SQR_DIFF.value: FusedElementwiseType.SQR_DIFF,
+                EltwiseType.POW.value: FusedElementwiseType.POW,
+            }
+            element_type = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_element_type_str).i
+            if element_type not in eltwise_types:
+                return None
+            step_type = eltwise_types[element_type]
+            if step_type in [FusedElementwiseType.NEG,
+                             FusedElementwiseType.ABS]:
+                return [(step_type, None, 0.0)]
+            if len(op.input) == 1:
+                value = ConverterUtil.get_arg(op, MaceKeyword.mace_value_str)
+                return [(step_type, None,
+                         value.f if value is not None else 1.0)]
+            if len(op.input) != 2 or op.input[0] == op.input[1]:
+                return None
+            if op.input[1] == data_input:
+                reversed_types = {
+                    FusedElementwiseType.SUB: FusedElementwiseType.RSUB,
+                    FusedElementwiseType.DIV: FusedElementwiseType.RDIV,
+                    FusedElementwiseType.POW: None,
+                }
+                step_type = reversed_types.get(step_type, step_type)
+                other = op.input[0]
+            else:
+                other = op.input[1]
+            other = operand(other)
+            if step_type is None or other is None:
+                return None
+            return [(step_type, other, 0.0)]
+        elif op.type == MaceOp.Activation.name:
+            activation = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_activation_type_str).s
+            if activation == ActivationType.PRELU.name:
+                alpha = operand(op.input[1]) if len(op.input) == 2 else None
+                if alpha is None:
+                    return None
+                return [(FusedElementwiseType.PRELU, alpha, 0.0)]
+            max_limit = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_activation_max_limit_str)
+            return activation_steps(
+                activation, max_limit.f if max_limit is not None else 0.0)
+        elif op.type == MaceOp.BiasAdd.name \
+                or op.type == MaceOp.FoldedBatchNorm.name:
+            operands = [operand(name) for name in op.input[1:]]
+            if not operands or None in operands:
+                return None
+            if op.type == MaceOp.BiasAdd.name:
+                return [(FusedElementwiseType.ADD, operands[0], 0.0)]
+            if len(operands) != 2:
+                return None
+            steps = [(FusedElementwiseType.MUL, operands[0], 0.0),
+                     (FusedElementwiseType.ADD, operands[1], 0.0)]
+            activation = ConverterUtil.get_arg(
+                op, MaceKeyword.mace_activation_type_str)
+            if activation is not None:
+                max_limit = ConverterUtil.get_arg(
+                    op, MaceKeyword.mace_activation_max_limit_str)
+                activation_step = activation_steps(
+                    activation.s,
+                    max_limit.f if max_limit is not None else 0.0)
+                if activation_step is None:
+                    return None
+                steps.extend(activation_step)
+            return steps
+        return None
+
+    def fuse_elementwise(self):
+        """Fuse chains of CPU element-wise ops (Eltwise with a scalar or
+        per-channel const operand, BiasAdd, FoldedBatchNorm and
+        Activation) into one FusedElementwise op, so the chain makes a
+        single pass over the tensor instead of one pass per op."""
+        if self._option.device != DeviceType.CPU.value:
+            return False
+
+        net = self._model
+        for op in net.op:
+            if op.type == MaceOp.FusedElementwise.name or not op.input:
+                continue
+            steps = self.elementwise_steps(op, op.input[0])
+            if steps is None and op.type == MaceOp.Eltwise.name \
+                    and len(op.input) == 2:
+                steps = self.elementwise_steps(op, op.input[1])
+                data_input = op.input[1]
+            else:
+                data_input = op.input[0]
+            if steps is None:
+                continue
+
+            chain = [op]
+            while True:
+                tail = chain[-1]
+                if self.is_op_output_node(tail) \
+                        or self.consumer_count(tail.output[0]) != 1:
+                    break
+                consumer_op = self._consumers[tail.output[0]][0]
+                if ConverterUtil.data_format(consumer_op) \
+                        != ConverterUtil.data_format(op):
+                    break
+                consumer_steps = self.elementwise_steps(consumer_op,
+                                                        tail.output[0])
+                if consumer_steps is None:
+                    break
+                chain.append(consumer_op)
+                steps.extend(consumer_steps)
+            if len(chain) < 2:
+                continue
+
+            print("Fuse elementwise: %s" % ', '.join(
+                ["%s(%s)" % (chain_op.name, chain_op.type)
+                 for chain_op in chain]))
+            last_op = chain[-1]
+            fused_op = net.op.add()
+            fused_op.name = last_op.name
+            fused_op.type = MaceOp.FusedElementwise.name
+            fused_op.input.append(data_input)
+            fused_op.output.extend(last_op.output)
+            fused_op.output_shape.extend(last_op.output_shape)
+            step_inputs = []
+            for step_type, operand_name, value in steps:
+                if operand_name is None:
+                    step_inputs.append(0)
+                    continue
+                if operand_name not in fused_op.input[1:]:
+                    fused_op.input.append(operand_name)
+                step_inputs.append(
+                    list(fused_op.input[1:]).index(operand_name) + 1)
+
+            step_types_arg = fused_op.arg.add()
+            step_types_arg.name = MaceKeyword.mace_step_types_str
+            step_types_arg.ints.extend([step[0].value for step in steps])
+            step_inputs_arg = fused_op.arg.add()
+            step_inputs_arg.name = MaceKeyword.mace_step_inputs_str
+            step_inputs_arg.ints.extend(step_inputs)
+            step_values_arg = fused_op.arg.add()
+            step_values_arg.name = MaceKeyword.mace_step_values_str
+            step_values_arg.floats.extend([step[2] for step in steps])
+            ConverterUtil.add_data_format_arg(fused_op,
+                                              ConverterUtil.data_format(op))
+
+            for chain_op in chain:
+                net.op.remove(chain_op)
+            return True
+
+        return False
+
     def buffer_to_image(self, op, input_idx, input_type):
         net = self._model
         input_name = op.input[input_idx]
@@ -26,6 +26,16 @@ class MemoryOptimizer(object):
         self.total_mem_count = 0
         self.input_ref_counter = {}
         self.mem_ref_counter = {}
+        self.const_tensors = {}
+        self.tensor_shapes = {}
+        for tensor in net_def.tensors:
+            self.const_tensors[tensor.name] = tensor
+            self.tensor_shapes[tensor.name] = list(tensor.dims)
+        for input_info in net_def.input_info:
+            self.tensor_shapes[input_info.name] = list(input_info.dims)
+        for op in net_def.op:
+            for output, output_shape in zip(op.output, op.output_shape):
+                self.tensor_shapes[output] = list(output_shape.dims)
 
         consumers = {}
         for op in net_def.op:
@@ -90,7 +100,151 @@ class MemoryOptimizer(object):
         return op.type == 'Reshape' or op.type == 'Identity' \
                or op.type == 'Squeeze'
 
+    def get_arg(self, op, name, default):
+        for arg in op.arg:
+            if arg.name == name:
+                return arg.i
+        return default
+
+    def is_view_op(self, op):
+        """Slice and StridedSlice outputs which are contiguous ranges of the
+        input become views of it, they are not given memory of their own but
+        keep the input memory alive."""
+        if not op.output_shape:
+            return False
+        if op.type == 'Slice':
+            output_dims = op.output_shape[0].dims
+            axis = self.get_arg(op, 'axis', 3)
+            if axis < 0:
+                axis += len(output_dims)
+            return reduce(operator.mul, output_dims[:axis], 1) == 1
+        if op.type != 'StridedSlice' \
+                or self.get_arg(op, 'ellipsis_mask', 0) != 0 \
+                or self.get_arg(op, 'new_axis_mask', 0) != 0:
+            return False
+        input_dims = self.tensor_shapes.get(op.input[0])
+        if input_dims is None:
+            return False
+        if len(op.input) > 3:
+            strides = self.const_tensors.get(op.input[3])
+            if strides is None or any(s != 1 for s in strides.int32_data):
+                return False
+        shrink_axis_mask = self.get_arg(op, 'shrink_axis_mask', 0)
+        output_dims = list(op.output_shape[0].dims)
+        for d in range(len(input_dims)):
+            if shrink_axis_mask & (1 << d):
+                output_dims.insert(d, 1)
+        if len(output_dims) != len(input_dims):
+            return False
+        # leading dims taken once, the first longer one any range, and
+        # the rest whole
+        leading = True
+        for out_dim, in_dim in zip(output_dims, input_dims):
+            if leading:
+                if out_dim != 1:
+                    if out_dim <= 0:
+                        return False
+                    leading = False
+            elif out_dim != in_dim:
+                return False
+        return True
+
+    def concat_slice_enabled(self):
+        return True
+
+    def plan_concat_slices(self):
+        """Let the producers of a Concat's inputs write into slices of the
+        Concat output, which makes the Concat a no-op. Only done when the
+        slices are contiguous, i.e. the concat axis has outer size 1.
+        Returns {input tensor: (concat output tensor, element offset)}."""
+        slices = {}
+        if not self.concat_slice_enabled():
+            return slices
+        producers = {}
+        for op in self.net_def.op:
+            for output in op.output:
+                producers[output] = op
+        for op in self.net_def.op:
+            if op.type != 'Concat' or len(op.output) != 1 \
+                    or len(op.output_shape) != 1 \
+                    or not self.op_need_optimize_memory(op) \
+                    or len(set(op.input)) != len(op.input):
+                continue
+            output_dims = op.output_shape[0].dims
+            axis = 3
+            for arg in op.arg:
+                if arg.name == 'axis':
+                    axis = arg.i
+            if axis < 0:
+                axis += len(output_dims)
+            if reduce(operator.mul, output_dims[:axis], 1) != 1:
+                continue
+            op_slices = {}
+            offset = 0
+            for ipt in op.input:
+                producer = producers.get(ipt)
+                if producer is None or ipt in slices \
+                        or len(producer.output) != 1 \
+                        or len(producer.output_shape) != 1 \
+                        or producer.type == 'Concat' \
+                        or self.is_memory_reuse_op(producer) \
+                        or self.is_view_op(producer) \
+                        or not self.op_need_optimize_memory(producer):
+                    break
+                op_slices[ipt] = (op.output[0], offset)
+                offset += reduce(operator.mul,
+                                 producer.output_shape[0].dims, 1)
+            else:
+                if offset == reduce(operator.mul, output_dims, 1):
+                    slices.update(op_slices)
+        return slices
+
+    def alloc_mem(self, op_type, output_shape):
+        op_mem_block = self.get_op_mem_block(op_type, output_shape)
+        mem_id = -1
+        if len(self.idle_mem) > 0:
+            best_mem_add_size = sys.maxint
+            best_mem_waste_size = sys.maxint
+            for mid in self.idle_mem:
+                old_mem_block = self.mem_block[mid]
+                new_mem_block = self.resize_mem_block(
+                    old_mem_block, op_mem_block)
+                add_mem_size = self.sub_mem_block(new_mem_block,
+                                                  old_mem_block)
+                waste_mem_size = self.sub_mem_block(new_mem_block,
+                                                    op_mem_block)
+
+                # minimize add_mem_size; if best_mem_add_size is 0,
+                # then minimize waste_mem_size
+                if (best_mem_add_size > 0 and
+                        add_mem_size < best_mem_add_size) \
+                        or (best_mem_add_size == 0 and
+                            waste_mem_size < best_mem_waste_size):
+                    best_mem_id = mid
+                    best_mem_add_size = add_mem_size
+                    best_mem_waste_size = waste_mem_size
+                    best_mem_block = new_mem_block
+
+            # if add mem size < op mem size, then reuse it
+            if best_mem_add_size <= self.mem_size(op_mem_block):
+                self.mem_block[best_mem_id] = best_mem_block
+                mem_id = best_mem_id
+                self.idle_mem.remove(mem_id)
+
+        if mem_id == -1:
+            mem_id = self.mem_id_base() + self.total_mem_count
+            self.total_mem_count += 1
+            self.mem_block[mem_id] = op_mem_block
+        return mem_id
+
     def optimize(self):
+        concat_slices = self.plan_concat_slices()
+        concat_outputs = set([out for out, _ in concat_slices.values()])
+        concat_shapes = {}
+        for op in self.net_def.op:
+            if op.type == 'Concat' and op.output[0] in concat_outputs:
+                concat_shapes[op.output[0]] = op.output_shape[0].dims
+
         for op in self.net_def.op:
             if not self.op_need_optimize_memory(op):
                 continue
@@ -102,51 +256,29 @@ class MemoryOptimizer(object):
                 print('WARNING: the number of output shape is not equal to '
                       'the number of output.')
                 return
+            is_view_op = self.is_view_op(op)
             for i in range(len(op.output)):
-                if self.is_memory_reuse_op(op):
+                if self.is_memory_reuse_op(op) or is_view_op:
                     # make these ops reuse memory of input tensor
                     mem_id = self.op_mem.get(op.input[0], -1)
+                elif op.output[i] in concat_slices:
+                    # the concat output is allocated with its first input
+                    concat_output, offset = concat_slices[op.output[i]]
+                    if concat_output not in self.op_mem:
+                        self.op_mem[concat_output] = self.alloc_mem(
+                            'Concat', concat_shapes[concat_output])
+                    mem_id = self.op_mem[concat_output]
+                    offset_arg = op.arg.add()
+                    offset_arg.name = 'mem_offset'
+                    offset_arg.i = offset
+                elif op.output[i] in self.op_mem:
+                    mem_id = self.op_mem[op.output[i]]
                 else:
-                    op_mem_block = self.get_op_mem_block(
-                        op.type,
-                        op.output_shape[i].dims)
-                    mem_id = -1
-                    if len(self.idle_mem) > 0:
-                        best_mem_add_size = sys.maxint
-                        best_mem_waste_size = sys.maxint
-                        for mid in self.idle_mem:
-                            old_mem_block = self.mem_block[mid]
-                            new_mem_block = self.resize_mem_block(
-                                old_mem_block, op_mem_block)
-                            add_mem_size = self.sub_mem_block(new_mem_block,
-                                                              old_mem_block)
-                            waste_mem_size = self.sub_mem_block(new_mem_block,
-                                                                op_mem_block)
-
-                            # minimize add_mem_size; if best_mem_add_size is 0,
-                            # then minimize waste_mem_size
-                            if (best_mem_add_size > 0 and
-                                    add_mem_size < best_mem_add_size) \
-                                    or (best_mem_add_size == 0 and
-                                        waste_mem_size < best_mem_waste_size):
-                                best_mem_id = mid
-                                best_mem_add_size = add_mem_size
-                                best_mem_waste_size = waste_mem_size
-                                best_mem_block = new_mem_block
-
-                        # if add mem size < op mem size, then reuse it
-                        if best_mem_add_size <= self.mem_size(op_mem_block):
-                            self.mem_block[best_mem_id] = best_mem_block
-                            mem_id = best_mem_id
-                            self.idle_mem.remove(mem_id)
-
-                    if mem_id == -1:
-                        mem_id = self.mem_id_base() + self.total_mem_count
-                        self.total_mem_count += 1
-                        self.mem_block[mem_id] = op_mem_block
+                    mem_id = self.alloc_mem(op.type, op.output_shape[i].dims)
 
                 if mem_id != -1:
-                    op.mem_id.extend([mem_id])
+                    if not is_view_op:
+                        op.mem_id.extend([mem_id])
                     self.op_mem[op.output[i]] = mem_id
                     if mem_id not in self.mem_ref_counter:
                         self.mem_ref_counter[mem_id] = 1
@@ -221,6 +353,13 @@ class GPUMemoryOptimizer(MemoryOptimizer):
     def mem_id_base(self):
         return 20000
 
+    def is_view_op(self, op):
+        return False
+
+    def concat_slice_enabled(self):
+        # images can not be sliced
+        return False
+
 
 def optimize_gpu_memory(net_def):
     mem_optimizer = GPUMemoryOptimizer(net_def)